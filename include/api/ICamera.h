@@ -74,6 +74,12 @@
  *******************************************************************************
  *     Version        0.64       Remove deprecated VC API
  * ------------------------------------------------------------------------------
+ *******************************************************************************
+ *     Version        0.65       Add API camera_get_statistics() to query runtime statistics
+ * ------------------------------------------------------------------------------
+ *******************************************************************************
+ *     Version        0.66       Add the memory usage of the subsystems to camera_stats_t
+ * ------------------------------------------------------------------------------
  *
  */
 
@@ -101,6 +107,78 @@ typedef struct {
     // VIRTUAL_CHANNEL_E
 } camera_info_t;
 
+#define MAX_STATS_STREAM_NUM 8
+
+/**
+ * \struct camera_duration_stats_t: Statistics of a per-frame duration, in microseconds.
+ * The mean and p99 are calculated over the latest frames.
+ */
+typedef struct {
+    int64_t mean_us;
+    int64_t p99_us;
+    uint64_t count; /**< Number of frames measured since the streams are configured */
+} camera_duration_stats_t;
+
+/**
+ * \struct camera_stream_stats_t: Runtime statistics of one stream
+ */
+typedef struct {
+    int id;                    /**< Stream id filled by camera_device_config_streams() */
+    float fps;                 /**< Delivered frame rate over the latest frames */
+    uint64_t delivered_frames; /**< Buffers dequeued by the user */
+    int buffers_queued;        /**< Buffers queued by the user and not dequeued yet */
+} camera_stream_stats_t;
+
+/**
+ * \enum camera_memory_subsystem_t: The subsystems whose memory is accounted
+ */
+typedef enum {
+    CAMERA_MEMORY_BUFFERS = 0,     /**< Internal frame, ISYS and stats buffers */
+    CAMERA_MEMORY_CCA_SHM,         /**< Memory allocated for CCA, e.g. the makernote data */
+    CAMERA_MEMORY_PAC_PAYLOAD,     /**< PAC terminal payload and parameter buffers */
+    CAMERA_MEMORY_CB_STAGE,        /**< CB stage internal output and node to self buffers */
+    CAMERA_MEMORY_POST_PROCESSING, /**< Post processor intermediate buffers */
+    CAMERA_MEMORY_ICBM,            /**< Buffers allocated by ICBM */
+    CAMERA_MEMORY_SUBSYSTEM_NUM,
+} camera_memory_subsystem_t;
+
+/**
+ * \struct camera_memory_usage_t: Memory usage in bytes.
+ * The peak is the high-water mark since the camera library is loaded.
+ */
+typedef struct {
+    uint64_t current_bytes;
+    uint64_t peak_bytes;
+} camera_memory_usage_t;
+
+/**
+ * \struct camera_memory_stats_t: Memory allocated by libcamhal for one camera
+ */
+typedef struct {
+    camera_memory_usage_t total; /**< The peak of the total, not the sum of the peaks */
+    camera_memory_usage_t subsystems[CAMERA_MEMORY_SUBSYSTEM_NUM];
+} camera_memory_stats_t;
+
+/**
+ * \struct camera_stats_t: Runtime statistics of a camera device.
+ * The counters start from zero when the streams are configured.
+ */
+typedef struct {
+    int num_streams;
+    camera_stream_stats_t streams[MAX_STATS_STREAM_NUM];
+    uint64_t dropped_frames; /**< Frames missed by ISYS, found by the sequence gaps */
+    uint64_t skipped_frames; /**< Frames captured but not delivered, e.g. for 3A converging */
+    camera_duration_stats_t isys_time;            /**< From SOF to ISYS frame done */
+    camera_duration_stats_t psys_time;            /**< PSys processing */
+    camera_duration_stats_t post_processing_time; /**< SW/GPU post processing */
+    camera_duration_stats_t aiq_run_time;         /**< 3A run */
+    camera_duration_stats_t request_latency;      /**< From qbuf to the buffer is ready */
+    int pending_requests;       /**< Requests waiting to be processed */
+    int requests_in_processing; /**< Requests being processed */
+    int buffers_in_device;      /**< Buffers queued to ISYS */
+    camera_memory_stats_t memory;
+} camera_stats_t;
+
 /**
  * \brief
  *   Get numbers of camera
@@ -536,6 +614,36 @@ int camera_set_parameters(int camera_id, const Parameters& param);
  **/
 int camera_get_parameters(int camera_id, Parameters& param, int64_t sequence = -1);
 
+/**
+ * \brief
+ *   Get the runtime statistics of the camera device.
+ *
+ * \note
+ *   It can be called at any time after camera_device_open(), it doesn't block the
+ *   streaming and is cheap enough to be polled by the monitoring every second.
+ *
+ * \param[in]
+ *   int camera_id: ID of the camera
+ * \param[out]
+ *   camera_stats_t stats: the statistics filled by libcamhal
+ *
+ * \return
+ *   0 succeed to get the statistics
+ * \return
+ *   <0 error code, failed to get the statistics
+ *
+ * \par Sample code:
+ *
+ * \code
+ *   camera_stats_t stats;
+ *   int ret = camera_get_statistics(camera_id, stats);
+ *   for (int i = 0; i < stats.num_streams; i++) {
+ *       printf("stream %d fps %f\n", stats.streams[i].id, stats.streams[i].fps);
+ *   }
+ * \endcode
+ **/
+int camera_get_statistics(int camera_id, camera_stats_t& stats);
+
 /**************************************Optional API ******************************
  * The API defined in this section is optional.
  */
@@ -201,6 +201,11 @@ typedef struct {
  * \struct camera_buffer_flags_t: Specify a buffer's properties.
  *
  * The buffer's properties can be one of them or combined with some of them.
+ *
+ * BUFFER_FLAG_ZERO_COPY: only for the userptr RAW output buffer. Instead of copying the RAW
+ * frame into the buffer, the HAL may point buffer addr to its own ISYS buffer, which is valid
+ * until this buffer is queued again or the device is stopped. The HAL restores the addr of
+ * the app when the buffer is queued. The frame is copied if the buffers aren't compatible.
  */
 typedef enum : uint32_t{
     BUFFER_FLAG_DMA_EXPORT = 1 << 0,
@@ -208,6 +213,7 @@ typedef enum : uint32_t{
     BUFFER_FLAG_SW_READ = 1 << 2,
     BUFFER_FLAG_SW_WRITE = 1 << 3,
     BUFFER_FLAG_NO_FLUSH = 1 << 4,
+    BUFFER_FLAG_ZERO_COPY = 1 << 5,
 } camera_buffer_flags_t;
 
 /**
@@ -279,6 +285,29 @@ typedef enum {
      */
     CAMERA_STREAM_BIDIRECTIONAL = 2,
 
+    /**
+     * This stream is an output stream with the same image as another output stream;
+     * the camera HAL device doesn't produce a separate image for it, and delivers the
+     * buffer of the source stream to it instead.
+     *
+     * The source stream is the first CAMERA_STREAM_OUTPUT stream with the same format,
+     * width, height and memory type. Only V4L2_MEMORY_USERPTR is supported, and the
+     * buffer of this stream can only be queued in the same request as the buffer of
+     * the source stream.
+     *
+     * When the buffer is returned, camera_buffer_t.addr points to the memory of the
+     * source stream's buffer, and the own memory is given back when the buffer is
+     * queued again. The source buffer isn't filled again until all the buffers
+     * sharing it are queued again. The source stream's buffers are filled in the
+     * request order, so while a shared buffer isn't queued again, the source buffers
+     * of all the later requests wait too, and the source stream stalls. Queue the
+     * shared buffers back as soon as they are consumed.
+     *
+     * This kind of stream is used to deliver one image to several consumers, such as
+     * preview and video encoder, without an extra ISP output or copy.
+     */
+    CAMERA_STREAM_SHARED_OUTPUT = 3,
+
     /**
      * Total number of framework-defined stream types
      */
@@ -21,6 +21,7 @@
 
 #include <condition_variable>
 #include <mutex>
+#include <string>
 
 namespace icamera {
 extern bool gPerfettoEnabled;
@@ -32,6 +33,9 @@ PERFETTO_DEFINE_CATEGORIES(
     perfetto::Category(PERFETTO_CATEGORIES).SetDescription("Trace from libcamera"));
 
 extern void initPerfettoTrace();
+// The counter track keeps the name pointer, so the name is interned once by its user
+extern const char* perfettoInternCounterName(const std::string& name);
+extern void perfettoTraceCounter(const char* name, int64_t value);
 
 class ScopedPerfetto {
  public:
@@ -56,6 +60,10 @@ class ScopedPerfetto {
 #define PERF_CAMERA_ATRACE_PARAM3(note1, value1, note2, value2, note3, value3) \
     PERFETTO_TRACE_EVENT(note1, value1, note2, value2, note3, value3)
 
+#define PERF_CAMERA_ATRACE_COUNTER_NAME(name) perfettoInternCounterName(name)
+#define PERF_CAMERA_ATRACE_COUNTER_ENABLED() (icamera::gPerfettoEnabled)
+#define PERF_CAMERA_ATRACE_COUNTER(name, value) perfettoTraceCounter(name, value)
+
 #define PERF_CAMERA_ATRACE_IMAGING(...) PERFETTO_TRACE_EVENT(__VA_ARGS__)
 
 #define PERF_CAMERA_ATRACE_PARAM1_IMAGING(note1, value1) PERFETTO_TRACE_EVENT(note1, value1)
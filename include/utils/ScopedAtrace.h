@@ -18,6 +18,7 @@
 
 #include <unistd.h>
 #include <cstdint>
+#include <string>
 
 #define PERF_LOG_TAG_STR(X) PERF_LOG_TAG_STR1(X)
 #define PERF_LOG_TAG_STR1(X) #X
@@ -40,6 +41,10 @@ class ScopedAtrace {
                  const char* note3 = NULL, int value3 = -1);
     ~ScopedAtrace();
     static void setTraceLevel(uint32_t);
+    static bool isTraceEnabled(uint32_t level);
+    // The counter name is kept until the process exits, called once by the counter user
+    static const char* internCounterName(const std::string& name);
+    static void traceCounter(uint32_t level, const char* name, int64_t value);
 
  private:
     bool mEnableAtraceEnd;
@@ -60,6 +65,16 @@ class ScopedAtrace {
     icamera::ScopedAtrace atrace(CAMERA_DEBUG_LOG_ATRACE_OS, __func__, PERF_LOG_TAG_STR(LOG_TAG), \
                                  note, value, note2, value2, note3, value3);
 
+/**
+ * Trace a counter track, such as queue depth, sampled when the value changes or per frame.
+ * The name is got by PERF_CAMERA_ATRACE_COUNTER_NAME() once, not for each sample.
+ */
+#define PERF_CAMERA_ATRACE_COUNTER_NAME(name) icamera::ScopedAtrace::internCounterName(name)
+#define PERF_CAMERA_ATRACE_COUNTER_ENABLED() \
+    icamera::ScopedAtrace::isTraceEnabled(CAMERA_DEBUG_LOG_ATRACE_OS)
+#define PERF_CAMERA_ATRACE_COUNTER(name, value) \
+    icamera::ScopedAtrace::traceCounter(CAMERA_DEBUG_LOG_ATRACE_OS, name, value)
+
 #define PERF_CAMERA_ATRACE_IMAGING()                                        \
     icamera::ScopedAtrace atrace(CAMERA_DEBUG_LOG_ATRACE_IMAGING, __func__, \
                                  PERF_LOG_TAG_STR(LOG_TAG));
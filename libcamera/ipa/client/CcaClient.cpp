@@ -447,6 +447,11 @@ void* IntelCca::allocMem(int streamId, const std::string& name, int index, int s
     memInfo.mSize = size;
 
     mMemsOuter[memInfo.mAddr] = memInfo;
+    // The PAC payload buffers are allocated in the scope of IpuPacAdaptor
+    const camera_memory_subsystem_t subsystem =
+        MemoryAccounting::currentSubsystem(CAMERA_MEMORY_CCA_SHM);
+    mMemsOuterSubsystem[memInfo.mAddr] = subsystem;
+    MemoryAccounting::add(mCameraId, subsystem, size);
 
     return memInfo.mAddr;
 }
@@ -457,7 +462,9 @@ void IntelCca::freeMem(void* addr) {
     if (mMemsOuter.find(addr) != mMemsOuter.end()) {
         mAlgoClient->freeShmMem(mMemsOuter[addr].mName, mMemsOuter[addr].mAddr,
                                 mMemsOuter[addr].mHandle);
+        MemoryAccounting::remove(mCameraId, mMemsOuterSubsystem[addr], mMemsOuter[addr].mSize);
         mMemsOuter.erase(addr);
+        mMemsOuterSubsystem.erase(addr);
         return;
     }
     LOGW("@%s, there is no addr:%p, in the mMemsOuter", __func__, addr);
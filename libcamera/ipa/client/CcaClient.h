@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "CameraTypes.h"
+#include "iutils/MemoryAccounting.h"
 #include "iutils/Thread.h"
 
 #include "IPCCca.h"
@@ -121,6 +122,8 @@ class IntelCca {
     std::vector<ShmMem> mMems;
 
     std::unordered_map<void*, ShmMemInfo> mMemsOuter;
+    // The subsystem which mMemsOuter is accounted to
+    std::unordered_map<void*, camera_memory_subsystem_t> mMemsOuterSubsystem;
 
  private:
     struct CCAHandle {
@@ -16,6 +16,8 @@
 
 #define LOG_TAG IntelCca
 
+#include <chrono>
+#include <future>
 #include <vector>
 
 #include "modules/algowrapper/IntelCca.h"
@@ -38,7 +40,10 @@ IntelCca* IntelCca::getInstance(int cameraId, TuningMode mode) {
             if (it.ccaHandle.find(mode) == it.ccaHandle.end()) {
                 it.ccaHandle[mode] = new IntelCca(cameraId, mode);
             }
-            return it.ccaHandle[mode];
+            IntelCca* cca = it.ccaHandle[mode];
+            CheckAndLogError(cca->isInitFailed(), nullptr, "<id%d>@%s, init of mode:%d failed",
+                             cameraId, __func__, mode);
+            return cca;
         }
     }
 
@@ -50,6 +55,18 @@ IntelCca* IntelCca::getInstance(int cameraId, TuningMode mode) {
     return handle.ccaHandle[mode];
 }
 
+IntelCca* IntelCca::findInstance(int cameraId, TuningMode mode) {
+    AutoMutex lock(sLock);
+    for (auto &it : sCcaInstance) {
+        if (cameraId == it.cameraId) {
+            auto cca = it.ccaHandle.find(mode);
+            return (cca != it.ccaHandle.end()) ? cca->second : nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
 void IntelCca::releaseInstance(int cameraId, TuningMode mode) {
     LOG2("<id%d>@%s, tuningMode:%d", cameraId, __func__, mode);
 
@@ -75,6 +92,11 @@ IntelCca::~IntelCca() {
 }
 
 cca::IntelCCA* IntelCca::getIntelCCA() {
+    // Don't use the handle of a failed init
+    if (waitInitDone() != ia_err_none) {
+        return nullptr;
+    }
+
     if (mIntelCCA == nullptr) {
         mIntelCCA = new cca::IntelCCA();
     }
@@ -82,19 +104,59 @@ cca::IntelCCA* IntelCca::getIntelCCA() {
 }
 
 void IntelCca::releaseIntelCCA() {
+    (void)waitInitDone();
+
     delete mIntelCCA;
     mIntelCCA = nullptr;
 }
 ia_err IntelCca::init(const cca::cca_init_params& initParams) {
-    const ia_err ret = getIntelCCA()->init(initParams);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->init(initParams);
     LOG2("@%s, bitmap:0x%x, ret:%d, version:%s", __func__, initParams.bitmap, ret,
-         getIntelCCA()->getVersion());
+         intelCCA->getVersion());
 
     return ret;
 }
 
+void IntelCca::initAsync(std::shared_ptr<cca::cca_init_params> initParams) {
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, VOID_VALUE, "@%s, cca isn't available", __func__);
+    LOG2("<id%d>@%s, tuningMode:%d", mCameraId, __func__, mTuningMode);
+
+    mInitResult = std::async(std::launch::async, [this, intelCCA, initParams]() {
+        const ia_err ret = intelCCA->init(*initParams);
+        if (ret != ia_err_none) {
+            LOGE("<id%d>initAsync, init fails, tuningMode:%d, ret:%d", mCameraId, mTuningMode,
+                 ret);
+        }
+        return ret;
+    }).share();
+}
+
+ia_err IntelCca::waitInitDone() {
+    if (!mInitResult.valid()) {
+        return ia_err_none;
+    }
+
+    return mInitResult.get();
+}
+
+bool IntelCca::isInitFailed() const {
+    if (!mInitResult.valid() ||
+        (mInitResult.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) {
+        return false;
+    }
+
+    return mInitResult.get() != ia_err_none;
+}
+
 ia_err IntelCca::reinitAic(const int32_t aicId) {
-    const ia_err ret = getIntelCCA()->reinitAic(aicId);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->reinitAic(aicId);
 
     LOG2("@%s, aicId:%d, ret:%d", __func__, aicId, ret);
 
@@ -102,7 +164,10 @@ ia_err IntelCca::reinitAic(const int32_t aicId) {
 }
 
 ia_err IntelCca::setStatsParams(const cca::cca_stats_params& params) {
-    const ia_err ret = getIntelCCA()->setStatsParams(params);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->setStatsParams(params);
     LOG2("@%s, ret:%d", __func__, ret);
 
     return ret;
@@ -112,7 +177,10 @@ ia_err IntelCca::runAEC(uint64_t frameId, const cca::cca_ae_input_params& params
                         cca::cca_ae_results* results) {
     CheckAndLogError(results == nullptr, ia_err_argument, "@%s, results is nullptr", __func__);
 
-    const ia_err ret = getIntelCCA()->runAEC(frameId, params, results);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->runAEC(frameId, params, results);
     LOG2("@%s, ret:%d", __func__, ret);
 
     return ret;
@@ -122,7 +190,10 @@ ia_err IntelCca::runAIQ(uint64_t frameId, const cca::cca_aiq_params& params,
                         cca::cca_aiq_results* results) {
     CheckAndLogError(results == nullptr, ia_err_argument, "@%s, results is nullptr", __func__);
 
-    const ia_err ret = getIntelCCA()->runAIQ(frameId, params, results);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->runAIQ(frameId, params, results);
     LOG2("@%s, ret:%d", __func__, ret);
 
     return ret;
@@ -131,7 +202,10 @@ ia_err IntelCca::runAIQ(uint64_t frameId, const cca::cca_aiq_params& params,
 ia_err IntelCca::updateTuning(uint8_t lardTags, const ia_lard_input_params& lardParams,
                               const cca::cca_nvm& nvm, int32_t streamId) {
     ia_lard_input_params& lardInputParam = const_cast<ia_lard_input_params&>(lardParams);
-    const ia_err ret = getIntelCCA()->updateTuning(lardTags, lardInputParam, nvm, streamId);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->updateTuning(lardTags, lardInputParam, nvm, streamId);
     LOG2("@%s, ret:%d", __func__, ret);
 
     return ret;
@@ -140,7 +214,10 @@ ia_err IntelCca::updateTuning(uint8_t lardTags, const ia_lard_input_params& lard
 ia_err IntelCca::getCMC(cca::cca_cmc* cmc) {
     CheckAndLogError(cmc == nullptr, ia_err_argument, "@%s, cmc is nullptr", __func__);
 
-    const ia_err ret = getIntelCCA()->getCMC(*cmc);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->getCMC(*cmc);
     LOG2("@%s, ret:%d", __func__, ret);
 
     return ret;
@@ -149,7 +226,10 @@ ia_err IntelCca::getCMC(cca::cca_cmc* cmc) {
 ia_err IntelCca::getMKN(ia_mkn_trg type, cca::cca_mkn* mkn) {
     CheckAndLogError(mkn == nullptr, ia_err_argument, "@%s, mkn is nullptr", __func__);
 
-    const ia_err ret = getIntelCCA()->getMKN(type, *mkn);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->getMKN(type, *mkn);
     LOG2("@%s, ret:%d", __func__, ret);
 
     return ret;
@@ -158,7 +238,10 @@ ia_err IntelCca::getMKN(ia_mkn_trg type, cca::cca_mkn* mkn) {
 ia_err IntelCca::getAiqd(cca::cca_aiqd* aiqd) {
     CheckAndLogError(aiqd == nullptr, ia_err_argument, "@%s, aiqd is nullptr", __func__);
 
-    const ia_err ret = getIntelCCA()->getAiqd(*aiqd);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->getAiqd(*aiqd);
     LOG2("@%s, ret:%d", __func__, ret);
 
     return ret;
@@ -170,17 +253,38 @@ void* IntelCca::allocMem(int streamId, const std::string& name, int index, int s
 
     void* ptr = nullptr;
     const int ret = posix_memalign(&ptr, PAGE_SIZE_U, PAGE_ALIGN(size));
-    if (ret != 0) LOGE("alloc fail");
+    if (ret != 0) {
+        LOGE("alloc fail");
+        return nullptr;
+    }
+
+    // The PAC payload buffers are allocated in the scope of IpuPacAdaptor
+    const MemAccount account = {static_cast<size_t>(PAGE_ALIGN(size)),
+                                MemoryAccounting::currentSubsystem(CAMERA_MEMORY_CCA_SHM)};
+    MemoryAccounting::add(mCameraId, account.subsystem, account.size);
+    AutoMutex l(mMemLock);
+    mMemAccounts[ptr] = account;
     return ptr;
 }
 
 void IntelCca::freeMem(void* addr) {
     LOG1("@%s addr: %p", __func__, addr);
+    {
+        AutoMutex l(mMemLock);
+        auto it = mMemAccounts.find(addr);
+        if (it != mMemAccounts.end()) {
+            MemoryAccounting::remove(mCameraId, it->second.subsystem, it->second.size);
+            mMemAccounts.erase(it);
+        }
+    }
     free(addr);
 }
 
 void IntelCca::deinit() {
-    getIntelCCA()->deinit();
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    if (intelCCA != nullptr) {
+        intelCCA->deinit();
+    }
     releaseIntelCCA();
 }
 
@@ -188,7 +292,10 @@ ia_err IntelCca::configAic(const cca::cca_aic_config& aicConf,
                            const cca::cca_aic_kernel_offset& kernelOffset, uint32_t* offsetPtr,
                            cca::cca_aic_terminal_config& termConfig, int32_t aicId,
                            const int32_t* statsBufToTermIds) {
-    const ia_err ret = getIntelCCA()->configAIC(aicConf, kernelOffset, termConfig, aicId,
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->configAIC(aicConf, kernelOffset, termConfig, aicId,
                                           statsBufToTermIds);
     LOG2("@%s, ret:%d", __func__, ret);
 
@@ -196,14 +303,20 @@ ia_err IntelCca::configAic(const cca::cca_aic_config& aicConf,
 }
 
 ia_err IntelCca::registerAicBuf(const cca::cca_aic_terminal_config& termConfig, int32_t aicId) {
-    const ia_err ret = getIntelCCA()->registerAICBuf(termConfig, aicId);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->registerAICBuf(termConfig, aicId);
     LOG2("@%s, ret:%d", __func__, ret);
 
     return ret;
 }
 
 ia_err IntelCca::getAicBuf(cca::cca_aic_terminal_config& termConfig, int32_t aicId) {
-    const ia_err ret = getIntelCCA()->getAICBuf(termConfig, aicId);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->getAICBuf(termConfig, aicId);
     LOG2("@%s, ret:%d", __func__, ret);
 
     return ret;
@@ -211,11 +324,14 @@ ia_err IntelCca::getAicBuf(cca::cca_aic_terminal_config& termConfig, int32_t aic
 
 ia_err IntelCca::decodeStats(int32_t groupId, int64_t sequence, int32_t aicId,
                              cca::cca_out_stats* outStats) {
-    const ia_err ret = getIntelCCA()->decodeStats(groupId, sequence, aicId);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->decodeStats(groupId, sequence, aicId);
     LOG2("@%s, ret:%d", __func__, ret);
 
     if ((ret == ia_err_none) && ((outStats != nullptr) && outStats->get_rgbs_stats)) {
-        auto stats = getIntelCCA()->queryStatsBuf(cca::STATS_BUF_LATEST);
+        auto stats = intelCCA->queryStatsBuf(cca::STATS_BUF_LATEST);
         if (stats != nullptr) {
             outStats->rgbs_grid[0].grid_width = stats->stats.rgbs_grids[0].grid_width;
             outStats->rgbs_grid[0].grid_height = stats->stats.rgbs_grids[0].grid_height;
@@ -239,7 +355,10 @@ ia_err IntelCca::decodeStats(int32_t groupId, int64_t sequence, int32_t aicId,
 ia_err IntelCca::runAIC(uint64_t frameId, const cca::cca_pal_input_params* params,
                          uint8_t bitmap, int32_t aicId) {
     cca::cca_multi_pal_output output = {};
-    const ia_err ret = getIntelCCA()->runAIC(frameId, *params, output, bitmap, aicId);
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
+    const ia_err ret = intelCCA->runAIC(frameId, *params, output, bitmap, aicId);
     LOG2("@%s, ret:%d", __func__, ret);
 
     return ret;
@@ -247,8 +366,11 @@ ia_err IntelCca::runAIC(uint64_t frameId, const cca::cca_pal_input_params* param
 
 ia_err IntelCca::updateConfigurationResolutions(const cca::cca_aic_config& aicConf,
                                                 int32_t aicId, bool isKeyResChanged) {
+    cca::IntelCCA* intelCCA = getIntelCCA();
+    CheckAndLogError(intelCCA == nullptr, ia_err_not_run, "@%s, cca isn't available", __func__);
+
     const ia_err ret =
-        getIntelCCA()->updateConfigurationResolutions(aicConf, aicId, isKeyResChanged);
+        intelCCA->updateConfigurationResolutions(aicConf, aicId, isKeyResChanged);
     LOG2("@%s, ret:%d ", __func__, ret);
 
     return ret;
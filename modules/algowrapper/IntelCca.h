@@ -18,12 +18,14 @@
 
 #include <IntelCCA.h>
 
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <map>
 
+#include "iutils/MemoryAccounting.h"
 #include "iutils/Thread.h"
 #include "CameraTypes.h"
 
@@ -33,10 +35,42 @@ class IntelCca {
     IntelCca(int cameraId, TuningMode mode);
     virtual ~IntelCca();
 
+    /**
+     * \brief Get the instance of the mode, it's created if it doesn't exist
+     *
+     * \return nullptr if the init of the instance failed, it's kept until releaseInstance
+     */
     static IntelCca* getInstance(int cameraId, TuningMode mode);
+
+    /**
+     * \brief Find the instance of the mode whatever its init result is, for the owner to
+     * wait for the init and to release the instance
+     *
+     * \return nullptr if the instance doesn't exist
+     */
+    static IntelCca* findInstance(int cameraId, TuningMode mode);
     static void releaseInstance(int cameraId, TuningMode mode);
 
     ia_err init(const cca::cca_init_params& initParams);
+
+    /**
+     * \brief Run init in a worker thread, other calls wait until the init is done
+     *
+     * \param initParams: init parameters, owned by the worker until init is done
+     */
+    void initAsync(std::shared_ptr<cca::cca_init_params> initParams);
+
+    /**
+     * \brief Wait for the init started by initAsync
+     *
+     * \return the result of init, ia_err_none if there is no pending init
+     */
+    ia_err waitInitDone();
+
+    /**
+     * \brief Check if the init started by initAsync is done and failed, without waiting
+     */
+    bool isInitFailed() const;
     ia_err reinitAic(const int32_t aicId);
 
     ia_err setStatsParams(const cca::cca_stats_params& params);
@@ -87,5 +121,16 @@ class IntelCca {
     static Mutex sLock;
 
     cca::IntelCCA* mIntelCCA;
+
+    // The size and subsystem of the memory allocated by allocMem, for the accounting
+    struct MemAccount {
+        size_t size;
+        camera_memory_subsystem_t subsystem;
+    };
+    Mutex mMemLock;
+    std::unordered_map<void*, MemAccount> mMemAccounts;
+
+    // Result of the init started by initAsync, invalid if init isn't started asynchronously
+    std::shared_future<ia_err> mInitResult;
 };
 } /* namespace icamera */
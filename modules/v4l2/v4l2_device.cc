@@ -31,6 +31,7 @@
 #include "iutils/CameraLog.h"
 #include "iutils/Errors.h"
 #include "iutils/Utils.h"
+#include "v4l2/SysCall.h"
 using namespace icamera::Log;
 using namespace icamera;
 
@@ -52,7 +53,7 @@ int V4L2Device::Open(int flags) {
     }
 
     struct stat st = {};
-    if (stat(name_.c_str(), &st) == -1) {
+    if (SysCall::getInstance()->stat(name_.c_str(), &st) == -1) {
         LOGE("%s: Failed to stat device node %s %s", __func__, name_.c_str(), strerror(errno));
         return -ENODEV;
     }
@@ -61,7 +62,7 @@ int V4L2Device::Open(int flags) {
         return -ENODEV;
     }
 
-    fd_ = ::open(name_.c_str(), flags);
+    fd_ = SysCall::getInstance()->open(name_.c_str(), flags);
     if (fd_ < 0) {
         LOGE("%s: Failed to open device node %s %s", __func__, name_.c_str(), strerror(errno));
         return -errno;
@@ -77,7 +78,7 @@ int V4L2Device::Close() {
         return -EINVAL;
     }
 
-    int ret = ::close(fd_);
+    int ret = SysCall::getInstance()->close(fd_);
     if (ret < 0) {
         LOGE("%s: Cannot close device node %s %s", __func__, name_.c_str(), strerror(errno));
         return ret;
@@ -97,7 +98,7 @@ int V4L2Device::SubscribeEvent(int event) {
 
     struct v4l2_event_subscription sub = {};
     sub.type = event;
-    int ret = ::ioctl(fd_, VIDIOC_SUBSCRIBE_EVENT, &sub);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_SUBSCRIBE_EVENT, &sub);
     if (ret < 0) {
         LOGE("%s: Device node %s IOCTL VIDIOC_SUBSCRIBE_EVENT error: %s", __func__, name_.c_str(),
              strerror(errno));
@@ -118,7 +119,7 @@ int V4L2Device::SubscribeEvent(int event, int id) {
     struct v4l2_event_subscription sub = {};
     sub.type = event;
     sub.id = id;
-    int ret = ::ioctl(fd_, VIDIOC_SUBSCRIBE_EVENT, &sub);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_SUBSCRIBE_EVENT, &sub);
     if (ret < 0) {
         LOGE("%s: Device node %s IOCTL VIDIOC_SUBSCRIBE_EVENT error: %s", __func__, name_.c_str(),
              strerror(errno));
@@ -139,7 +140,7 @@ int V4L2Device::UnsubscribeEvent(int event) {
     struct v4l2_event_subscription sub = {};
     sub.type = event;
 
-    int ret = ::ioctl(fd_, VIDIOC_UNSUBSCRIBE_EVENT, &sub);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_UNSUBSCRIBE_EVENT, &sub);
 
     if (ret < 0) {
         LOGE("%s: Device node %s IOCTL VIDIOC_UNSUBSCRIBE_EVENT error: %s", __func__, name_.c_str(),
@@ -162,7 +163,7 @@ int V4L2Device::UnsubscribeEvent(int event, int id) {
     sub.type = event;
     sub.id = id;
 
-    int ret = ::ioctl(fd_, VIDIOC_UNSUBSCRIBE_EVENT, &sub);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_UNSUBSCRIBE_EVENT, &sub);
     if (ret < 0) {
         LOGE("%s: Device node %s IOCTL VIDIOC_UNSUBSCRIBE_EVENT error: %s", __func__, name_.c_str(),
              strerror(errno));
@@ -185,7 +186,7 @@ int V4L2Device::DequeueEvent(struct v4l2_event* event) {
         return -1;
     }
 
-    int ret = ::ioctl(fd_, VIDIOC_DQEVENT, event);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_DQEVENT, event);
     if (ret < 0) {
         LOGE("%s: Device node %s IOCTL VIDIOC_DQEVENT error: %s", __func__, name_.c_str(),
              strerror(errno));
@@ -206,7 +207,7 @@ int V4L2Device::SetControl(struct v4l2_control* control) {
         LOGE("%s: Device node %s control is nullptr", __func__, name_.c_str());
         return -EINVAL;
     }
-    return ::ioctl(fd_, VIDIOC_S_CTRL, control);
+    return SysCall::getInstance()->ioctl(fd_, VIDIOC_S_CTRL, control);
 }
 
 int V4L2Device::SetControl(struct v4l2_ext_control* ext_control) {
@@ -224,7 +225,7 @@ int V4L2Device::SetControl(struct v4l2_ext_control* ext_control) {
     controls.ctrl_class = V4L2_CTRL_ID2CLASS(ext_control->id);
     controls.count = 1;
     controls.controls = ext_control;
-    return ::ioctl(fd_, VIDIOC_S_EXT_CTRLS, &controls);
+    return SysCall::getInstance()->ioctl(fd_, VIDIOC_S_EXT_CTRLS, &controls);
 }
 
 int V4L2Device::SetControl(int id, int32_t value) {
@@ -283,7 +284,7 @@ int V4L2Device::GetControl(struct v4l2_ext_control* ext_control) {
     controls.count = 1;
     controls.controls = ext_control;
 
-    int ret = ::ioctl(fd_, VIDIOC_G_EXT_CTRLS, &controls);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_G_EXT_CTRLS, &controls);
     if (ret != 0) {
         LOGE("%s: Device node %s IOCTL VIDIOC_G_EXT_CTRLS error: %s", __func__, name_.c_str(),
              strerror(errno));
@@ -353,7 +354,7 @@ int V4L2Device::QueryMenu(v4l2_querymenu* menu) {
         return -EINVAL;
     }
 
-    int ret = ::ioctl(fd_, VIDIOC_QUERYMENU, menu);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_QUERYMENU, menu);
     if (ret != 0) {
         LOGE("%s: Device node %s IOCTL VIDIOC_QUERYMENU error: %s", __func__, name_.c_str(),
              strerror(errno));
@@ -374,7 +375,7 @@ int V4L2Device::QueryControl(v4l2_queryctrl* control) {
         return -EINVAL;
     }
 
-    int ret = ::ioctl(fd_, VIDIOC_QUERYCTRL, control);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_QUERYCTRL, control);
     if (ret != 0) {
         LOGW("%s: Device node %s IOCTL VIDIOC_QUERYCTRL error: %s", __func__, name_.c_str(),
              strerror(errno));
@@ -396,7 +397,7 @@ int V4L2Device::Poll(int timeout) {
     pfd.fd = fd_;
     pfd.events = POLLPRI | POLLIN | POLLERR;
 
-    ret = ::poll(&pfd, 1, timeout);
+    ret = SysCall::getInstance()->poll(&pfd, 1, timeout);
 
     if (ret < 0) {
         LOGE("%s: Device node %s poll error: %s", __func__, name_.c_str(), strerror(errno));
@@ -441,7 +442,7 @@ int V4L2DevicePoller::Poll(int timeout_ms, int events, std::vector<V4L2Device*>*
     for (size_t i = 0; i < devices_.size(); i++) {
         poll_fds_[i].events = events;
     }
-    int ret = ::poll(poll_fds_.data(), poll_fds_.size(), timeout_ms);
+    int ret = SysCall::getInstance()->poll(poll_fds_.data(), poll_fds_.size(), timeout_ms);
     if (ret <= 0) {
         for (size_t i = 0; i < devices_.size(); i++) {
             LOGE("%s: Device node fd %d poll timeout.", __func__, devices_[i]->fd_);
@@ -26,6 +26,7 @@
 #include "iutils/CameraLog.h"
 #include "iutils/Errors.h"
 #include "iutils/Utils.h"
+#include "v4l2/SysCall.h"
 
 using namespace icamera::Log;
 using namespace icamera;
@@ -55,7 +56,7 @@ int V4L2Subdevice::Open(int flags) {
     if (status == 0) state_ = SubdevState::OPEN;
 
     clientcap.capabilities = V4L2_SUBDEV_CLIENT_CAP_STREAMS;
-    status = ioctl(fd_, VIDIOC_SUBDEV_S_CLIENT_CAP, &clientcap);
+    status = SysCall::getInstance()->ioctl(fd_, VIDIOC_SUBDEV_S_CLIENT_CAP, &clientcap);
     if (status < 0)
         LOG1("Failed to set client capabilities %s", strerror(errno));
 
@@ -78,7 +79,8 @@ int V4L2Subdevice::SetFormat(const struct v4l2_subdev_format& format) {
         return -EINVAL;
     }
 
-    int ret = ::ioctl(fd_, VIDIOC_SUBDEV_S_FMT, &format);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_SUBDEV_S_FMT,
+                                            const_cast<struct v4l2_subdev_format*>(&format));
     if (ret < 0) {
         LOGE("%s: Device node %s IOCTL VIDIOC_SUBDEV_S_FMT error: %s", __func__, name_.c_str(),
              strerror(errno));
@@ -97,7 +99,7 @@ int V4L2Subdevice::GetFormat(struct v4l2_subdev_format* format) {
         return -EINVAL;
     }
 
-    int ret = ::ioctl(fd_, VIDIOC_SUBDEV_G_FMT, format);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_SUBDEV_G_FMT, format);
     if (ret < 0) {
         LOGE("%s: Device node %s IOCTL VIDIOC_SUBDEV_G_FMT error: %s", __func__, name_.c_str(),
              strerror(errno));
@@ -135,7 +137,8 @@ int V4L2Subdevice::SetSelection(const struct v4l2_subdev_selection& selection) {
         return -EINVAL;
     }
 
-    int ret = ::ioctl(fd_, VIDIOC_SUBDEV_S_SELECTION, &selection);
+    int ret = SysCall::getInstance()->ioctl(
+        fd_, VIDIOC_SUBDEV_S_SELECTION, const_cast<struct v4l2_subdev_selection*>(&selection));
     if (ret < 0) {
         LOGE("%s: Device node %s IOCTL VIDIOC_SUBDEV_S_SELECTION error: %s", __func__,
              name_.c_str(), strerror(errno));
@@ -157,7 +160,7 @@ int V4L2Subdevice::SetRouting(v4l2_subdev_route* routes, uint32_t numRoutes) {
     r.num_routes = numRoutes;
     r.routes = reinterpret_cast<uint64_t>(routes);
 
-    int ret = ::ioctl(fd_, VIDIOC_SUBDEV_S_ROUTING, &r);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_SUBDEV_S_ROUTING, &r);
     if (ret < 0) {
         LOG1("%s: Device node %s IOCTL VIDIOC_SUBDEV_S_ROUTING error: %s", __func__, name_.c_str(),
              strerror(errno));
@@ -181,7 +184,7 @@ int V4L2Subdevice::GetRouting(v4l2_subdev_route* routes, uint32_t* numRoutes) {
     r.num_routes = *numRoutes;
     r.routes = reinterpret_cast<uint64_t>(routes);
 
-    int ret = ::ioctl(fd_, VIDIOC_SUBDEV_G_ROUTING, &r);
+    int ret = SysCall::getInstance()->ioctl(fd_, VIDIOC_SUBDEV_G_ROUTING, &r);
     if (ret < 0) {
         LOG1("%s: Device node %s IOCTL VIDIOC_SUBDEV_G_ROUTING error: %s", __func__, name_.c_str(),
              strerror(errno));
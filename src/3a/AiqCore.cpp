@@ -48,6 +48,7 @@ AiqCore::AiqCore(int cameraId)
           mShadingMode(SHADING_MODE_FAST),
           mLensShadingMapMode(LENS_SHADING_MAP_MODE_OFF),
           mLscGridRGGBLen(0),
+          mLscGridHash(0U),
           mLastEvShift(0.0f),
           mAeAndAwbConverged(false),
           mAeBypassed(false),
@@ -56,6 +57,10 @@ AiqCore::AiqCore(int cameraId)
           mLockedExposureTimeUs(0),
           mLockedIso(0) {
     mIntel3AParameter = std::unique_ptr<Intel3AParameter>(new Intel3AParameter(cameraId));
+    if (PlatformData::isSceneChangeDetectionEnabled(cameraId)) {
+        mSceneChangeDetector =
+            std::unique_ptr<SceneChangeDetector>(new SceneChangeDetector(cameraId));
+    }
 
     CLEAR(mFrameParams);
     CLEAR(mLastAeResult);
@@ -65,11 +70,6 @@ AiqCore::AiqCore(int cameraId)
     CLEAR(mSaParams);
     CLEAR(mPaColorGains);
 
-    CLEAR(mResizeLscGridR);
-    CLEAR(mResizeLscGridGr);
-    CLEAR(mResizeLscGridGb);
-    CLEAR(mResizeLscGridB);
-
     CLEAR(mLensShadingMapSize);
     CLEAR(mLscGridRGGB);
 
@@ -135,6 +135,11 @@ void AiqCore::init() {
     mAeRunTime = 0U;
     mAwbRunTime = 0U;
     mAiqRunTime = 0U;
+    mLscGridHash = 0U;
+
+    if (mSceneChangeDetector) {
+        mSceneChangeDetector->reset();
+    }
 }
 
 void AiqCore::deinit() {
@@ -260,6 +265,10 @@ int AiqCore::setStatsParams(const cca::cca_stats_params& statsParams, AiqStatist
 
     mTimestamp = statsParams.frame_timestamp;
 
+    if (mSceneChangeDetector && (aiqStats != nullptr)) {
+        (void)mSceneChangeDetector->update(*aiqStats);
+    }
+
     return ret;
 }
 
@@ -562,10 +571,95 @@ int AiqCore::reFormatLensShadingMap(const LSCGrid& inputLscGrid, float* dstLscGr
     return OK;
 }
 
+void AiqCore::updateLscResizeTable(int srcSize, int dstSize, LscResizeTable* table) {
+    if ((table->srcSize == srcSize) && (table->dstSize == dstSize)) {
+        return;
+    }
+
+    // Same fixed point linear interpolation as AiqUtils::resize2dArray
+    const uint32_t fracBits = 8U;
+    const uint32_t stepSize = ((srcSize - 1) << fracBits) / (dstSize - 1);
+    table->lower.resize(dstSize);
+    table->weight0.resize(dstSize);
+    table->weight1.resize(dstSize);
+    for (int i = 0; i < dstSize; i++) {
+        const uint32_t loc = i * stepSize;
+        const uint32_t lower = (loc > 0U) ? ((loc - 1U) >> fracBits) : 0U;
+        table->lower[i] = lower;
+        table->weight0[i] = ((lower + 1U) << fracBits) - loc;
+        table->weight1[i] = loc - (lower << fracBits);
+    }
+    table->srcSize = srcSize;
+    table->dstSize = dstSize;
+}
+
+int AiqCore::resizeLensShadingMap(const LSCGrid& inputLscGrid, const LSCGrid& resizeLscGrid,
+                                  float* dstLscGridRGGB) {
+    const int width = inputLscGrid.width;
+    const int height = inputLscGrid.height;
+    const int destWidth = resizeLscGrid.width;
+    const int destHeight = resizeLscGrid.height;
+    CheckAndLogError((width < 2) || (height < 2) || (destWidth < 2) || (destHeight < 2),
+                     BAD_VALUE, "@%s, Bad lens shading map size", __func__);
+
+    updateLscResizeTable(width, destWidth, &mLscResizeX);
+    updateLscResizeTable(height, destHeight, &mLscResizeY);
+
+    // Interpolate the 4 channels together and write them in [R, Geven, Godd, B] order,
+    // the inner loop only walks the pre-calculated tables to keep it vectorizable.
+    const uint32_t rounding = 1U << 15;
+    const uint16_t* grids[4] = {inputLscGrid.gridR, inputLscGrid.gridGr, inputLscGrid.gridGb,
+                                inputLscGrid.gridB};
+    const uint32_t* lowerX = mLscResizeX.lower.data();
+    const uint32_t* w0X = mLscResizeX.weight0.data();
+    const uint32_t* w1X = mLscResizeX.weight1.data();
+    for (int j = 0; j < destHeight; j++) {
+        const uint32_t rowOffset = mLscResizeY.lower[j] * width;
+        const uint32_t w0Y = mLscResizeY.weight0[j];
+        const uint32_t w1Y = mLscResizeY.weight1[j];
+        float* dst = dstLscGridRGGB + static_cast<size_t>(j) * destWidth * 4U;
+        for (int c = 0; c < 4; c++) {
+            const uint16_t* row0 = grids[c] + rowOffset;
+            const uint16_t* row1 = row0 + width;
+            for (int i = 0; i < destWidth; i++) {
+                const uint32_t x = lowerX[i];
+                const uint32_t value = (row0[x] * w0X[i] * w0Y + row0[x + 1] * w1X[i] * w0Y +
+                                        row1[x] * w0X[i] * w1Y + row1[x + 1] * w1X[i] * w1Y +
+                                        rounding) >> 16;
+                dst[i * 4 + c] = static_cast<uint16_t>(value);
+            }
+        }
+    }
+
+    return OK;
+}
+
+uint64_t AiqCore::hashLensShadingMap(const LSCGrid& inputLscGrid, const LSCGrid& resizeLscGrid) {
+    // FNV-1a over the grid sizes and the 4 channels
+    const uint64_t prime = 0x100000001b3ULL;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    const uint16_t sizes[4] = {inputLscGrid.width, inputLscGrid.height, resizeLscGrid.width,
+                               resizeLscGrid.height};
+    for (const auto dim : sizes) {
+        hash = (hash ^ dim) * prime;
+    }
+
+    const uint16_t* grids[4] = {inputLscGrid.gridR, inputLscGrid.gridGr, inputLscGrid.gridGb,
+                                inputLscGrid.gridB};
+    const size_t size = inputLscGrid.width * inputLscGrid.height;
+    for (const auto grid : grids) {
+        for (size_t i = 0U; i < size; i++) {
+            hash = (hash ^ grid[i]) * prime;
+        }
+    }
+
+    return hash;
+}
+
 int AiqCore::storeLensShadingMap(const LSCGrid& inputLscGrid, const LSCGrid& resizeLscGrid,
                                  float* dstLscGridRGGB) {
-    CheckAndLogError(inputLscGrid.isBad() || resizeLscGrid.isBad() ||
-                     (dstLscGridRGGB == nullptr), BAD_VALUE,
+    CheckAndLogError(inputLscGrid.isBad() || (resizeLscGrid.width == 0) ||
+                     (resizeLscGrid.height == 0) || (dstLscGridRGGB == nullptr), BAD_VALUE,
                      "@%s, Bad input values for lens shading map storing", __func__);
 
     const int destWidth = resizeLscGrid.width;
@@ -573,35 +667,21 @@ int AiqCore::storeLensShadingMap(const LSCGrid& inputLscGrid, const LSCGrid& res
     const int width = inputLscGrid.width;
     const int height = inputLscGrid.height;
 
-    if ((width != destWidth) || (height != destHeight)) {
-        // requests lensShadingMapSize must be smaller than 64*64
-        // and it is a constant size.
-        // Our lensShadingMapSize is dynamic based on the resolution, so need
-        // to do resize for 4 channels separately
-
-        nsecs_t startTime = CameraUtils::systemTime();
-        AiqUtils::resize2dArray(inputLscGrid.gridR, width, height, resizeLscGrid.gridR, destWidth,
-                                destHeight);
-        AiqUtils::resize2dArray(inputLscGrid.gridGr, width, height, resizeLscGrid.gridGr, destWidth,
-                                destHeight);
-        AiqUtils::resize2dArray(inputLscGrid.gridGb, width, height, resizeLscGrid.gridGb, destWidth,
-                                destHeight);
-        AiqUtils::resize2dArray(inputLscGrid.gridB, width, height, resizeLscGrid.gridB, destWidth,
-                                destHeight);
-        LOG2("resize the 2D array cost %dus",
-             static_cast<unsigned>(((CameraUtils::systemTime() - startTime) / 1000U)));
-
-        LOG2("%s:resize lens shading map from [%d,%d] to [%d,%d]", __func__, width, height,
-             destWidth, destHeight);
-    } else {
-        const size_t size = destWidth * destHeight * sizeof(resizeLscGrid.gridR[0]);
-        STDCOPY((int8_t*)resizeLscGrid.gridR, (int8_t*)inputLscGrid.gridR, size);
-        STDCOPY((int8_t*)resizeLscGrid.gridGr, (int8_t*)inputLscGrid.gridGr, size);
-        STDCOPY((int8_t*)resizeLscGrid.gridGb, (int8_t*)inputLscGrid.gridGb, size);
-        STDCOPY((int8_t*)resizeLscGrid.gridB, (int8_t*)inputLscGrid.gridB, size);
+    if ((width == destWidth) && (height == destHeight)) {
+        return reFormatLensShadingMap(inputLscGrid, dstLscGridRGGB);
     }
 
-    return reFormatLensShadingMap(resizeLscGrid, dstLscGridRGGB);
+    // requests lensShadingMapSize must be smaller than 64*64
+    // and it is a constant size.
+    // Our lensShadingMapSize is dynamic based on the resolution, so need
+    // to do resize for 4 channels
+    nsecs_t startTime = CameraUtils::systemTime();
+    const int ret = resizeLensShadingMap(inputLscGrid, resizeLscGrid, dstLscGridRGGB);
+    LOG2("%s: resize lens shading map from [%d,%d] to [%d,%d] cost %dus", __func__, width,
+         height, destWidth, destHeight,
+         static_cast<unsigned>(((CameraUtils::systemTime() - startTime) / 1000U)));
+
+    return ret;
 }
 
 int AiqCore::processSAResults(cca::cca_sa_results* saResults, float* lensShadingMap) {
@@ -627,28 +707,32 @@ int AiqCore::processSAResults(cca::cca_sa_results* saResults, float* lensShading
         inputGrid.width = saResults->width;
         inputGrid.height = saResults->height;
 
+        // Only the size of resizeGrid is used, resampled data goes to mLscGridRGGB directly
         LSCGrid resizeGrid;
-        resizeGrid.gridB = mResizeLscGridB;
-        resizeGrid.gridR = mResizeLscGridR;
-        resizeGrid.gridGr = mResizeLscGridGr;
-        resizeGrid.gridGb = mResizeLscGridGb;
         resizeGrid.width = mLensShadingMapSize.x;
         resizeGrid.height = mLensShadingMapSize.y;
 
-        (void)storeLensShadingMap(inputGrid, resizeGrid, mLscGridRGGB);
-
-        // resizeGrid's width and height should be equal to inputGrid's width and height
-        mLscGridRGGBLen = static_cast<uint64_t>(resizeGrid.width) *
-                          static_cast<uint64_t>(resizeGrid.height) * 4U;
-        size_t errCount = 0U;
-        for (size_t i = 0U; i < mLscGridRGGBLen; i++) {
-            if (mLscGridRGGB[i] < 1.0F) {
-                mLscGridRGGB[i] = 1.0F;
-                errCount++;
+        const uint64_t hash = hashLensShadingMap(inputGrid, resizeGrid);
+        if ((mLscGridHash != 0U) && (hash == mLscGridHash)) {
+            LOG2("%s, lens shading map unchanged, skip resampling", __func__);
+        } else {
+            ret = storeLensShadingMap(inputGrid, resizeGrid, mLscGridRGGB);
+            mLscGridHash = (ret == OK) ? hash : 0U;
+
+            // resizeGrid's width and height should be equal to inputGrid's width and height
+            mLscGridRGGBLen = static_cast<uint64_t>(resizeGrid.width) *
+                              static_cast<uint64_t>(resizeGrid.height) * 4U;
+            size_t errCount = 0U;
+            for (size_t i = 0U; i < mLscGridRGGBLen; i++) {
+                if (mLscGridRGGB[i] < 1.0F) {
+                    mLscGridRGGB[i] = 1.0F;
+                    errCount++;
+                }
+            }
+            if (errCount != 0U) {
+                LOGW("Error - SA produced too small values (%zu/%zu)!", errCount,
+                     mLscGridRGGBLen);
             }
-        }
-        if (errCount != 0U) {
-            LOGW("Error - SA produced too small values (%zu/%zu)!", errCount, mLscGridRGGBLen);
         }
     }
 
@@ -712,7 +796,27 @@ bool AiqCore::bypassAwb(const aiq_parameter_t& param) {
 }
 
 bool AiqCore::skipAlgoRunning(RunRateInfo* info, int algo, bool converged) {
-    const float configRunningRate = PlatformData::getAlgoRunningRate(algo, mCameraId);
+    float configRunningRate = PlatformData::getAlgoRunningRate(algo, mCameraId);
+    if (mSceneChangeDetector) {
+        const SceneChangeDetector::SceneState state = mSceneChangeDetector->getState();
+        if (state == SceneChangeDetector::SCENE_CHANGING) {
+            // Run algo every frame until the scene settles down
+            info->reset();
+            return false;
+        } else if (state == SceneChangeDetector::SCENE_STATIC) {
+            // The times counted at the config rate don't apply to the static scene rate
+            if (!info->staticScene) {
+                info->reset();
+                info->staticScene = true;
+            }
+            const float staticRunningRate = PlatformData::getStaticSceneRunningRate(mCameraId);
+            if ((configRunningRate < EPSILON) || (staticRunningRate < configRunningRate)) {
+                configRunningRate = staticRunningRate;
+            }
+        } else {
+            info->staticScene = false;
+        }
+    }
     if (configRunningRate < EPSILON) {
         return false;
     }
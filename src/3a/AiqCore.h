@@ -18,11 +18,13 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "AiqResult.h"
 #include "AiqSetting.h"
 #include "AiqStatistics.h"
 #include "Intel3AParameter.h"
+#include "SceneChangeDetector.h"
 
 #ifdef IPA_SANDBOXING
 #include "IntelCcaWorker.h"
@@ -119,6 +121,9 @@ class AiqCore {
     int storeLensShadingMap(const LSCGrid& inputLscGrid, const LSCGrid& resizeLscGrid,
                             float* dstLscGridRGGB);
     int reFormatLensShadingMap(const LSCGrid& inputLscGrid, float* dstLscGridRGGB);
+    int resizeLensShadingMap(const LSCGrid& inputLscGrid, const LSCGrid& resizeLscGrid,
+                             float* dstLscGridRGGB);
+    uint64_t hashLensShadingMap(const LSCGrid& inputLscGrid, const LSCGrid& resizeLscGrid);
 
     int calculateDepthOfField(const cca::cca_af_results& afResults, camera_range_t* focusRange);
     int initAiqPlusParams();
@@ -126,10 +131,12 @@ class AiqCore {
     struct RunRateInfo {
         int runCcaTime;   // cca (like runAEC, runAIQ) running time after converged
         int runAlgoTime;  // algo (like AE, AF ...) running time after converged
+        bool staticScene;  // The running times are counted at the static scene rate
         RunRateInfo() { reset(); }
         void reset() {
             runCcaTime = 0;
             runAlgoTime = 0;
+            staticScene = false;
         }
     };
     bool bypassAe(const aiq_parameter_t& param);
@@ -172,13 +179,24 @@ class AiqCore {
     camera_shading_mode_t mShadingMode;
     camera_lens_shading_map_mode_type_t mLensShadingMapMode;
     camera_coordinate_t mLensShadingMapSize;
-    uint16_t mResizeLscGridR[DEFAULT_LSC_GRID_SIZE];
-    uint16_t mResizeLscGridGr[DEFAULT_LSC_GRID_SIZE];
-    uint16_t mResizeLscGridGb[DEFAULT_LSC_GRID_SIZE];
-    uint16_t mResizeLscGridB[DEFAULT_LSC_GRID_SIZE];
     float mLscOffGrid[DEFAULT_LSC_GRID_SIZE * 4];
     float mLscGridRGGB[DEFAULT_LSC_GRID_SIZE * 4];
     size_t mLscGridRGGBLen;
+    // Hash of the SA grid that mLscGridRGGB is generated from, skip resampling if unchanged
+    uint64_t mLscGridHash;
+
+    // Bilinear resampling table of one dimension, rebuilt only when grid sizes change
+    struct LscResizeTable {
+        int srcSize;
+        int dstSize;
+        std::vector<uint32_t> lower;    // index of the lower source sample
+        std::vector<uint32_t> weight0;  // weight of the lower source sample
+        std::vector<uint32_t> weight1;  // weight of the upper source sample
+        LscResizeTable() : srcSize(0), dstSize(0) {}
+    };
+    void updateLscResizeTable(int srcSize, int dstSize, LscResizeTable* table);
+    LscResizeTable mLscResizeX;
+    LscResizeTable mLscResizeY;
     float mLastEvShift;
 
     cca::cca_ae_results mLastAeResult;
@@ -198,6 +216,9 @@ class AiqCore {
     uint32_t mLockedExposureTimeUs;
     uint16_t mLockedIso;
 
+    // Adjust algo running rate by scene change, nullptr if not enabled
+    std::unique_ptr<SceneChangeDetector> mSceneChangeDetector;
+
  private:
     DISALLOW_COPY_AND_ASSIGN(AiqCore);
 };
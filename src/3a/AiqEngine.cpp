@@ -26,6 +26,7 @@
 #include "iutils/Errors.h"
 #include "iutils/Utils.h"
 #include "CameraContext.h"
+#include "CameraStatistics.h"
 
 namespace icamera {
 
@@ -108,7 +109,12 @@ int AiqEngine::run3A(int64_t ccaId, int64_t applyingSeq, int64_t frameNumber, in
 
     bool aiqRun = false;
     if (state == AIQ_STATE_RUN) {
+        const nsecs_t startTime = CameraUtils::systemTime();
         state = runAiq(ccaId, applyingSeq, aiqResult, &aiqRun);
+        if (aiqRun) {
+            cameraContext->getStatistics()->addDuration(CameraStatistics::DURATION_AIQ_RUN,
+                                                        CameraUtils::systemTime() - startTime);
+        }
     }
     if (state == AIQ_STATE_RESULT_SET) {
         state = handleAiqResult(dataContext->mAiqParams, aiqResult);
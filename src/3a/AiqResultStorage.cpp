@@ -23,6 +23,8 @@ namespace icamera {
 
 AiqResultStorage::AiqResultStorage(int cameraId) :
     mCameraId(cameraId) {
+    mAgeTraceName =
+        PERF_CAMERA_ATRACE_COUNTER_NAME("Cam" + std::to_string(cameraId) + " aiq result age");
     for (int i = 0; i < kStorageSize; i++) {
         mAiqResults[i] = new AiqResult(mCameraId);
         mAiqResults[i]->init();
@@ -117,6 +119,9 @@ const AiqResult* AiqResultStorage::getAiqResult(int64_t sequence) {
         // Search from the newest result
         const int tmpIdx = (mCurrentIndex + kStorageSize - i) % kStorageSize;
         if ((mAiqResults[tmpIdx]->mSequence >= 0) && (sequence >= mAiqResults[tmpIdx]->mSequence)) {
+            // How many frames the result used by this sequence lags behind
+            PERF_CAMERA_ATRACE_COUNTER(mAgeTraceName,
+                                       sequence - mAiqResults[tmpIdx]->mSequence);
             return mAiqResults[tmpIdx];
         }
     }
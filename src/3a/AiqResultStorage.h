@@ -17,6 +17,7 @@
 #pragma once
 
 #include <map>
+#include <string>
 
 #include "AiqResult.h"
 
@@ -132,6 +133,7 @@ private:
     static const int kStorageSize = MAX_SETTING_COUNT; // Should > MAX_BUFFER_COUNT + sensorLag
     int mCurrentIndex = -1;
     AiqResult* mAiqResults[kStorageSize];
+    const char* mAgeTraceName;  // Interned counter track name
 
     static const int kAiqStatsStorageSize = 3; // Always use the latest, but may hold for long time
     int mCurrentAiqStatsIndex = -1;
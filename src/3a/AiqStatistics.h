@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2018-2024 Intel Corporation.
+ * Copyright (C) 2018-2025 Intel Corporation.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,6 +17,9 @@
 #pragma once
 
 namespace icamera {
+// Coarse luma grid (width and height) summarized from RGBS stats for scene change detection
+static const unsigned int kSceneLumaGridSize = 8U;
+
 /*
  * This struct is used to envelop AIQ statistics.
  */
@@ -25,11 +28,15 @@ struct AiqStatistics {
     unsigned long long mTimestamp;
     TuningMode mTuningMode;
     bool mInUse;
+    bool mSceneLumaValid;
+    uint16_t mSceneLuma[kSceneLumaGridSize * kSceneLumaGridSize];
 
     AiqStatistics() : mSequence(-1),
                       mTimestamp(0),
                       mTuningMode(TUNING_MODE_MAX),
-                      mInUse(false) {}
+                      mInUse(false),
+                      mSceneLumaValid(false),
+                      mSceneLuma{} {}
 };
 } /* namespace icamera */
 
@@ -16,6 +16,7 @@
 
 #define LOG_TAG AiqUnit
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <memory>
@@ -114,7 +115,10 @@ int AiqUnit::initIntelCcaHandle(const std::vector<ConfigMode> &configModes) {
 
     LOG1("<id%d>@%s", mCameraId, __func__);
     mTuningModes.clear();
+    mPendingTuningModes.clear();
+    mFailedTuningModes.clear();
     std::vector<int32_t> streamIds;
+    TuningMode startTuningMode = TUNING_MODE_MAX;
     for (const auto &cfg : configModes) {
         TuningMode tuningMode;
         int ret = PlatformData::getTuningModeByConfigMode(mCameraId, cfg, tuningMode);
@@ -122,7 +126,7 @@ int AiqUnit::initIntelCcaHandle(const std::vector<ConfigMode> &configModes) {
 
         PERF_CAMERA_ATRACE_PARAM1_IMAGING("intelCca->init", 1U);
 
-        const auto params = std::unique_ptr<cca::cca_init_params>(new cca::cca_init_params);
+        const auto params = std::shared_ptr<cca::cca_init_params>(new cca::cca_init_params);
         // Initialize cca_cpf data
         ia_binary_data cpfData;
         ret = PlatformData::getCpf(mCameraId, tuningMode, &cpfData);
@@ -188,6 +192,7 @@ int AiqUnit::initIntelCcaHandle(const std::vector<ConfigMode> &configModes) {
         IntelCca *intelCca = IntelCca::getInstance(mCameraId, tuningMode);
         CheckAndLogError(intelCca == nullptr, UNKNOWN_ERROR,
                          "Failed to get cca. mode:%d cameraId:%d", tuningMode, mCameraId);
+#ifdef IPA_SANDBOXING
         const ia_err iaErr = intelCca->init(*params);
         if (iaErr == ia_err_none) {
             mTuningModes.push_back(tuningMode);
@@ -196,6 +201,16 @@ int AiqUnit::initIntelCcaHandle(const std::vector<ConfigMode> &configModes) {
             IntelCca::releaseInstance(mCameraId, tuningMode);
             return UNKNOWN_ERROR;
         }
+#else
+        // Init all modes in parallel, only wait for the mode to be started below.
+        // Other modes are waited for when they are used for the first time.
+        intelCca->initAsync(params);
+        mTuningModes.push_back(tuningMode);
+        mPendingTuningModes.push_back(tuningMode);
+        if (startTuningMode == TUNING_MODE_MAX) {
+            startTuningMode = tuningMode;
+        }
+#endif
 
         ret = PlatformData::initMakernote(mCameraId, tuningMode);
         CheckAndLogError(ret != OK, UNKNOWN_ERROR, "%s, PlatformData::initMakernote fails",
@@ -206,15 +221,62 @@ int AiqUnit::initIntelCcaHandle(const std::vector<ConfigMode> &configModes) {
 
     mActiveStreamCount = streamIds.size();
     mCcaInitialized = true;
+
+    if (startTuningMode != TUNING_MODE_MAX) {
+        PERF_CAMERA_ATRACE_PARAM1_IMAGING("intelCca->waitInitDone", 1U);
+        const int ret = waitTuningModeInit(startTuningMode);
+        CheckAndLogError(ret != OK, UNKNOWN_ERROR, "%s, start mode:%d isn't available",
+                         __func__, startTuningMode);
+    }
+
     return OK;
 }
 
+int AiqUnit::waitTuningModeInit(TuningMode tuningMode) {
+    if (std::find(mFailedTuningModes.begin(), mFailedTuningModes.end(), tuningMode) !=
+        mFailedTuningModes.end()) {
+        return UNKNOWN_ERROR;
+    }
+
+    auto pending = std::find(mPendingTuningModes.begin(), mPendingTuningModes.end(), tuningMode);
+    if (pending == mPendingTuningModes.end()) {
+        return OK;
+    }
+    mPendingTuningModes.erase(pending);
+
+    IntelCca* intelCca = IntelCca::findInstance(mCameraId, tuningMode);
+    CheckAndLogError(intelCca == nullptr, UNKNOWN_ERROR, "Failed to get cca. mode:%d cameraId:%d",
+                     tuningMode, mCameraId);
+    const ia_err iaErr = intelCca->waitInitDone();
+    if (iaErr == ia_err_none) {
+        return OK;
+    }
+
+    // Other users may still hold the instance, it's released in deinit.
+    // IntelCca::getInstance() returns nullptr for it from now on.
+    LOGE("%s, init IntelCca fails. mode:%d cameraId:%d", __func__, tuningMode, mCameraId);
+    mTuningModes.erase(std::find(mTuningModes.begin(), mTuningModes.end(), tuningMode));
+    mFailedTuningModes.push_back(tuningMode);
+    return UNKNOWN_ERROR;
+}
+
 void AiqUnit::deinitIntelCcaHandle() {
     if (!mCcaInitialized) {
         return;
     }
 
     LOG1("<id%d>@%s", mCameraId, __func__);
+    // The modes failing to initialize are moved to mFailedTuningModes
+    while (!mPendingTuningModes.empty()) {
+        (void)waitTuningModeInit(mPendingTuningModes.front());
+    }
+
+    for (const auto &mode : mFailedTuningModes) {
+        (void)PlatformData::deinitMakernote(mCameraId, mode);
+        IntelCca::releaseInstance(mCameraId, mode);
+    }
+    mFailedTuningModes.clear();
+
     for (const auto &mode : mTuningModes) {
         IntelCca *intelCca = IntelCca::getInstance(mCameraId, mode);
         CheckAndLogError(intelCca == nullptr, VOID_VALUE,
@@ -278,6 +340,16 @@ int AiqUnit::run3A(int64_t ccaId, int64_t applyingSeq, int64_t frameNumber, int6
         return BAD_VALUE;
     }
 
+    // The tuning mode of this frame may be used for the first time
+    if (!mPendingTuningModes.empty() || !mFailedTuningModes.empty()) {
+        const DataContext* dataContext =
+            CameraContext::getInstance(mCameraId)->acquireDataContextByFn(frameNumber);
+        const TuningMode tuningMode = dataContext->mAiqParams.tuningMode;
+        const int ret = waitTuningModeInit(tuningMode);
+        CheckAndLogError(ret != OK, ret, "%s, tuning mode:%d isn't available", __func__,
+                         tuningMode);
+    }
+
     const int ret = mAiqEngine->run3A(ccaId, applyingSeq, frameNumber, effectSeq);
     CheckAndLogError(ret != OK, ret, "run 3A failed.");
 
@@ -128,6 +128,8 @@ private:
     int initIntelCcaHandle(const std::vector<ConfigMode> &configModes);
     void deinitIntelCcaHandle();
     void dumpCcaInitParam(const cca::cca_init_params& params);
+    // Wait for the async init of the tuning mode, it's released if the init fails
+    int waitTuningModeInit(TuningMode tuningMode);
 
 private:
     int mCameraId;
@@ -149,6 +151,10 @@ private:
     Mutex mAiqUnitLock;
 
     std::vector<TuningMode> mTuningModes;
+    // The tuning modes still initializing, waited for before they are used for the first time
+    std::vector<TuningMode> mPendingTuningModes;
+    // The tuning modes failing to initialize, they can't be used
+    std::vector<TuningMode> mFailedTuningModes;
     bool mCcaInitialized;
     size_t mActiveStreamCount;
 };
@@ -66,7 +66,8 @@ int MakerNote::deinit(int cameraId, TuningMode tuningMode) {
     AutoMutex lock(mMknLock);
     CheckAndLogError(mMknState != INIT, NO_INIT, "@%s, mkn isn't initialized", __func__);
 
-    IntelCca* intelCca = IntelCca::getInstance(cameraId, tuningMode);
+    // Only the memory is freed, the instance may have failed to initialize
+    IntelCca* intelCca = IntelCca::findInstance(cameraId, tuningMode);
     CheckAndLogError(intelCca == nullptr, BAD_VALUE, "@%s, Failed to get intelCca instance",
                      __func__);
 
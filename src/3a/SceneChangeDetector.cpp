@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG SceneChangeDetector
+
+#include "SceneChangeDetector.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "iutils/CameraLog.h"
+
+namespace icamera {
+
+// Relative change of the mean luma to be treated as lighting change, in percent
+static const uint32_t kLightingChangePercent = 8U;
+// Mean absolute difference of the luma grid to be treated as motion, in percent of mean luma
+static const uint32_t kMotionChangePercent = 6U;
+// Frames without change before the scene is treated as static
+static const int kStaticFrameCount = 30;
+
+SceneChangeDetector::SceneChangeDetector(int cameraId) : mCameraId(cameraId) {
+    reset();
+}
+
+void SceneChangeDetector::reset() {
+    mState = SCENE_CHANGING;
+    mLastSequence = -1;
+    mLastLumaValid = false;
+    mLastMeanLuma = 0U;
+    CLEAR(mLastLuma);
+    mStableCount = 0;
+}
+
+SceneChangeDetector::SceneState SceneChangeDetector::update(const AiqStatistics& aiqStats) {
+    if (!aiqStats.mSceneLumaValid || (aiqStats.mSequence == mLastSequence)) {
+        return mState;
+    }
+    mLastSequence = aiqStats.mSequence;
+
+    const uint32_t gridSize = kSceneLumaGridSize * kSceneLumaGridSize;
+    uint32_t sum = 0U;
+    for (uint32_t i = 0U; i < gridSize; i++) {
+        sum += aiqStats.mSceneLuma[i];
+    }
+    const uint32_t meanLuma = sum / gridSize;
+
+    bool changed = true;
+    if (mLastLumaValid) {
+        uint32_t diffSum = 0U;
+        for (uint32_t i = 0U; i < gridSize; i++) {
+            diffSum += static_cast<uint32_t>(abs(static_cast<int>(aiqStats.mSceneLuma[i]) -
+                                                 static_cast<int>(mLastLuma[i])));
+        }
+        const uint32_t base = std::max(mLastMeanLuma, 1U);
+        const uint32_t meanDiff = static_cast<uint32_t>(
+            abs(static_cast<int>(meanLuma) - static_cast<int>(mLastMeanLuma)));
+        const bool lightingChanged = (meanDiff * 100U) > (base * kLightingChangePercent);
+        const bool motion = (diffSum * 100U / gridSize) > (base * kMotionChangePercent);
+        changed = lightingChanged || motion;
+        LOG2("<id%d><seq%ld>%s, mean luma %u->%u, grid diff %u, lighting %d, motion %d",
+             mCameraId, aiqStats.mSequence, __func__, mLastMeanLuma, meanLuma,
+             diffSum / gridSize, lightingChanged, motion);
+    }
+
+    MEMCPY_S(mLastLuma, sizeof(mLastLuma), aiqStats.mSceneLuma, sizeof(aiqStats.mSceneLuma));
+    mLastMeanLuma = meanLuma;
+    mLastLumaValid = true;
+
+    if (changed) {
+        mStableCount = 0;
+        mState = SCENE_CHANGING;
+    } else {
+        if (mStableCount < kStaticFrameCount) {
+            mStableCount++;
+        }
+        mState = (mStableCount >= kStaticFrameCount) ? SCENE_STATIC : SCENE_SETTLING;
+    }
+
+    return mState;
+}
+
+void SceneChangeDetector::summarizeRgbs(const cca::cca_out_stats& outStats,
+                                       AiqStatistics* aiqStats) {
+    aiqStats->mSceneLumaValid = false;
+
+    const uint32_t width = outStats.rgbs_grid[0].grid_width;
+    const uint32_t height = outStats.rgbs_grid[0].grid_height;
+    if ((width < kSceneLumaGridSize) || (height < kSceneLumaGridSize)) {
+        return;
+    }
+
+    // Average the rgbs blocks covered by every coarse luma cell
+    for (uint32_t y = 0U; y < kSceneLumaGridSize; y++) {
+        const uint32_t startY = y * height / kSceneLumaGridSize;
+        const uint32_t endY = (y + 1U) * height / kSceneLumaGridSize;
+        for (uint32_t x = 0U; x < kSceneLumaGridSize; x++) {
+            const uint32_t startX = x * width / kSceneLumaGridSize;
+            const uint32_t endX = (x + 1U) * width / kSceneLumaGridSize;
+            uint32_t sum = 0U;
+            for (uint32_t j = startY; j < endY; j++) {
+                for (uint32_t i = startX; i < endX; i++) {
+                    const auto& block = outStats.rgbs_blocks[0][j * width + i];
+                    sum += static_cast<uint32_t>(block.avg_r) + block.avg_gr + block.avg_gb +
+                           block.avg_b;
+                }
+            }
+            const uint32_t count = (endY - startY) * (endX - startX);
+            aiqStats->mSceneLuma[y * kSceneLumaGridSize + x] =
+                static_cast<uint16_t>(sum / count);
+        }
+    }
+    aiqStats->mSceneLumaValid = true;
+}
+
+} /* namespace icamera */
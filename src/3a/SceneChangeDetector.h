@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "AiqUtils.h"
+#include "AiqStatistics.h"
+#include "iutils/Utils.h"
+
+namespace icamera {
+
+/*
+ * \class SceneChangeDetector
+ * This class compares the coarse luma grid of consecutive AIQ statistics to
+ * find out motion or lighting change, so that AiqCore can raise the 3A running
+ * rate when the scene changes and lower it when the scene stays static.
+ */
+class SceneChangeDetector {
+ public:
+    enum SceneState {
+        SCENE_CHANGING = 0,  // motion or lighting change detected
+        SCENE_SETTLING,      // no change, but not stable long enough
+        SCENE_STATIC,        // no change for kStaticFrameCount frames
+    };
+
+    explicit SceneChangeDetector(int cameraId);
+    ~SceneChangeDetector() {}
+
+    /**
+     * \brief Forget the history, called when AIQ is started
+     */
+    void reset();
+
+    /**
+     * \brief Compare new statistics with the last one and update the scene state
+     *
+     * \param[in] aiqStats: statistics with valid scene luma grid
+     * \return the updated scene state
+     */
+    SceneState update(const AiqStatistics& aiqStats);
+
+    SceneState getState() const { return mState; }
+
+    /**
+     * \brief Summarize the decoded RGBS grid to the coarse luma grid of AiqStatistics
+     *
+     * \param[in] outStats: decoded stats with rgbs grid filled
+     * \param[out] aiqStats: the statistics to store the luma grid
+     */
+    static void summarizeRgbs(const cca::cca_out_stats& outStats, AiqStatistics* aiqStats);
+
+ private:
+    int mCameraId;
+    SceneState mState;
+    int64_t mLastSequence;
+    bool mLastLumaValid;
+    uint32_t mLastMeanLuma;
+    uint16_t mLastLuma[kSceneLumaGridSize * kSceneLumaGridSize];
+    int mStableCount;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(SceneChangeDetector);
+};
+
+} /* namespace icamera */
@@ -20,6 +20,8 @@
 #include "iutils/CameraLog.h"
 
 #include "AiqUtils.h"
+#include "CameraContext.h"
+#include "FrameTimeline.h"
 #include "SensorManager.h"
 #include "PlatformData.h"
 
@@ -79,6 +81,11 @@ void SensorManager::handleSofEvent(EventData eventData) {
         LOG2("<seq%ld> SOF timestamp = %ld", eventData.data.sync.sequence,
              TIMEVAL2USECS(eventData.data.sync.timestamp));
         mLastSofSequence = eventData.data.sync.sequence;
+        FrameTimeline* timeline = CameraContext::getInstance(mCameraId)->getFrameTimeline();
+        if (timeline != nullptr) {
+            timeline->recordEvent(mLastSofSequence, TIMELINE_SOF,
+                                  TIMEVAL2NSECS(eventData.data.sync.timestamp));
+        }
         handleSensorExposure();
 
         // HDR_FEATURE_S
@@ -172,6 +179,11 @@ void SensorManager::handleSensorExposure() {
                                         exposureData.frameLengthLines);
         mSensorHwCtrl->setExposure(exposureData.coarseExposures, exposureData.fineExposures);
         mExposureDataMap.erase(mLastSofSequence);
+
+        FrameTimeline* timeline = CameraContext::getInstance(mCameraId)->getFrameTimeline();
+        if (timeline != nullptr) {
+            timeline->recordEvent(mLastSofSequence, TIMELINE_EXPOSURE_APPLIED);
+        }
     }
 
     if (mAnalogGainMap.find(mLastSofSequence) != mAnalogGainMap.end()) {
@@ -226,6 +238,11 @@ uint32_t SensorManager::updateSensorExposure(SensorExpGroup sensorExposures, int
             mSensorHwCtrl->setFrameDuration(exposureData.lineLengthPixels,
                                             exposureData.frameLengthLines);
             mSensorHwCtrl->setExposure(exposureData.coarseExposures, exposureData.fineExposures);
+
+            FrameTimeline* timeline = CameraContext::getInstance(mCameraId)->getFrameTimeline();
+            if (timeline != nullptr) {
+                timeline->recordEvent(sensorSeq, TIMELINE_EXPOSURE_APPLIED);
+            }
         } else {
             mExposureDataMap[sensorSeq] = exposureData;
         }
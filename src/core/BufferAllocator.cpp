@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG BufferAllocator
+
+#include "BufferAllocator.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/dma-heap.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "iutils/CameraLog.h"
+#include "iutils/Errors.h"
+
+namespace icamera {
+
+// Only the x86 2M huge page is used, the buffers smaller than it stay in the heap
+static const size_t kHugePageSize = 2U * 1024U * 1024U;
+static const char* kDmaHeapPath = "/dev/dma_heap/system";
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+static bool sPrefault = false;
+static bool sLockPages = false;
+
+BufferAllocator* BufferAllocator::getInstance() {
+    static BufferAllocator* sInstance = nullptr;
+    static std::once_flag sOnce;
+
+    std::call_once(sOnce, [] {
+        const char* type = getenv("cameraBufferAllocator");
+        const char* prefault = getenv("cameraBufferPrefault");
+        sPrefault = (prefault != nullptr) && (strcmp(prefault, "0") != 0);
+        sLockPages = (prefault != nullptr) && (strcmp(prefault, "mlock") == 0);
+
+        if ((type == nullptr) || (strcmp(type, "heap") == 0)) {
+            sInstance = new HeapAllocator();
+        } else if (strcmp(type, "thp") == 0) {
+            sInstance = new HugePageAllocator(false);
+        } else if (strcmp(type, "hugetlb") == 0) {
+            sInstance = new HugePageAllocator(true);
+        } else if (strcmp(type, "memfd") == 0) {
+            sInstance = new MemfdAllocator(false);
+        } else if (strcmp(type, "memfd_hugetlb") == 0) {
+            sInstance = new MemfdAllocator(true);
+        } else {
+            LOGW("Unknown buffer allocator %s, use heap", type);
+            sInstance = new HeapAllocator();
+        }
+        LOG1("%s: buffer allocator %s, prefault %d, mlock %d", __func__,
+             (type != nullptr) ? type : "heap", sPrefault, sLockPages);
+    });
+
+    return sInstance;
+}
+
+BufferAllocator* BufferAllocator::getInstance(int streamId) {
+    static BufferAllocator* sDmaHeap = nullptr;
+    static bool sAllStreams = false;
+    static std::set<int> sStreams;
+    static std::once_flag sOnce;
+
+    std::call_once(sOnce, [] {
+        const char* streams = getenv("cameraDmaHeapStreams");
+        if (streams == nullptr) {
+            return;
+        }
+
+        sAllStreams = (strcmp(streams, "all") == 0);
+        if (!sAllStreams) {
+            std::istringstream list(streams);
+            std::string id;
+            while (std::getline(list, id, ',')) {
+                sStreams.insert(atoi(id.c_str()));
+            }
+        }
+        sDmaHeap = new DmaHeapAllocator();
+        LOG1("%s: dma-heap buffers for streams %s", __func__, streams);
+    });
+
+    if ((sDmaHeap != nullptr) && (sAllStreams || (sStreams.count(streamId) > 0U))) {
+        return sDmaHeap;
+    }
+    return getInstance();
+}
+
+bool BufferAllocator::isPrefaultEnabled() {
+    (void)getInstance();
+    return sPrefault;
+}
+
+void BufferAllocator::prefault(void* addr, size_t size) {
+    CheckAndLogError(addr == nullptr, VOID_VALUE, "%s, null address", __func__);
+
+    // The populated pages are read as zero, writing one byte of each page is enough
+    const size_t pageSize = static_cast<size_t>(getpagesize());
+    volatile uint8_t* ptr = static_cast<uint8_t*>(addr);
+    for (size_t offset = 0U; offset < size; offset += pageSize) {
+        ptr[offset] = 0U;
+    }
+}
+
+void BufferAllocator::populate(void* addr, size_t size) {
+    CheckAndLogError(addr == nullptr, VOID_VALUE, "%s, null address", __func__);
+
+    const uintptr_t pageSize = static_cast<uintptr_t>(getpagesize());
+    const uintptr_t start = reinterpret_cast<uintptr_t>(addr) & ~(pageSize - 1U);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(addr) + size;
+    if (::madvise(reinterpret_cast<void*>(start), end - start, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+
+    // Kernel before 5.14, the pages are mapped by reading them at least
+    volatile const uint8_t* ptr = static_cast<uint8_t*>(addr);
+    for (size_t offset = 0U; offset < size; offset += pageSize) {
+        (void)ptr[offset];
+    }
+}
+
+void BufferAllocator::warmUp(void* addr, size_t size, bool hasData) {
+    if (!isPrefaultEnabled()) {
+        return;
+    }
+
+    if (sLockPages) {
+        // mlock populates the pages too, only touch them if it fails
+        if (::mlock(addr, size) == 0) {
+            return;
+        }
+        static std::once_flag sWarnOnce;
+        const int err = errno;
+        std::call_once(sWarnOnce, [err] {
+            LOGW("mlock failed: %s, touch the pages instead", strerror(err));
+        });
+    }
+
+    if (hasData) {
+        populate(addr, size);
+    } else {
+        prefault(addr, size);
+    }
+}
+
+void BufferAllocator::unlock(void* addr, size_t size) {
+    if (sLockPages && (addr != nullptr)) {
+        (void)::munlock(addr, size);
+    }
+}
+
+void BufferAllocator::free(BufferAllocation* alloc) {
+    if (alloc->addr == nullptr) {
+        return;
+    }
+
+    unlock(alloc->addr, alloc->size);
+
+    if (alloc->type == BUFFER_ALLOCATOR_HEAP) {
+        ::free(alloc->addr);
+    } else {
+        const int ret = ::munmap(alloc->addr, alloc->size);
+        CheckWarningNoReturn(ret != 0, "%s, munmap failed: %s", __func__, strerror(errno));
+    }
+    if (alloc->fd >= 0) {
+        ::close(alloc->fd);
+    }
+
+    alloc->addr = nullptr;
+    alloc->fd = -1;
+}
+
+int HeapAllocator::allocate(size_t size, BufferAllocation* alloc) {
+    void* buffer = nullptr;
+    const int ret = posix_memalign(&buffer, getpagesize(), size);
+    CheckAndLogError(ret != 0, NO_MEMORY, "%s, posix_memalign fails, ret:%d", __func__, ret);
+
+    alloc->addr = buffer;
+    alloc->size = size;
+    alloc->fd = -1;
+    alloc->type = BUFFER_ALLOCATOR_HEAP;
+    return OK;
+}
+
+int HugePageAllocator::allocateThp(size_t size, BufferAllocation* alloc) {
+    // Map one more huge page, and trim the head and tail to get the 2M aligned range
+    const size_t alignedSize = ALIGN(size, kHugePageSize);
+    const size_t mapSize = alignedSize + kHugePageSize;
+    void* addr = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1, 0);
+    CheckAndLogError(addr == MAP_FAILED, NO_MEMORY, "%s, mmap %zu failed: %s", __func__,
+                     mapSize, strerror(errno));
+
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(addr);
+    const uintptr_t alignedBegin = ALIGN(begin, kHugePageSize);
+    const size_t head = alignedBegin - begin;
+    if (head > 0U) {
+        (void)::munmap(addr, head);
+    }
+    const size_t tail = mapSize - head - alignedSize;
+    if (tail > 0U) {
+        (void)::munmap(reinterpret_cast<void*>(alignedBegin + alignedSize), tail);
+    }
+
+    void* buffer = reinterpret_cast<void*>(alignedBegin);
+    const int ret = ::madvise(buffer, alignedSize, MADV_HUGEPAGE);
+    CheckWarningNoReturn(ret != 0, "%s, MADV_HUGEPAGE failed: %s", __func__, strerror(errno));
+
+    alloc->addr = buffer;
+    alloc->size = alignedSize;
+    alloc->fd = -1;
+    alloc->type = BUFFER_ALLOCATOR_THP;
+    return OK;
+}
+
+int HugePageAllocator::allocate(size_t size, BufferAllocation* alloc) {
+    if (size < kHugePageSize) {
+        HeapAllocator heap;
+        return heap.allocate(size, alloc);
+    }
+
+    if (mExplicit) {
+        const size_t alignedSize = ALIGN(size, kHugePageSize);
+        void* addr = ::mmap(nullptr, alignedSize, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (addr != MAP_FAILED) {
+            alloc->addr = addr;
+            alloc->size = alignedSize;
+            alloc->fd = -1;
+            alloc->type = BUFFER_ALLOCATOR_HUGETLB;
+            return OK;
+        }
+        LOG1("%s, no huge page for %zu bytes (%s), use thp", __func__, alignedSize,
+             strerror(errno));
+    }
+
+    return allocateThp(size, alloc);
+}
+
+int MemfdAllocator::allocateMemfd(size_t size, bool hugePage, BufferAllocation* alloc) {
+    const size_t alignedSize =
+        hugePage ? ALIGN(size, kHugePageSize) : ALIGN(size, static_cast<size_t>(getpagesize()));
+    const unsigned int flags = MFD_CLOEXEC | (hugePage ? MFD_HUGETLB : 0U);
+    const int fd = memfd_create("camera_buffer", flags);
+    if (fd < 0) {
+        LOG1("%s, memfd_create flags 0x%x failed: %s", __func__, flags, strerror(errno));
+        return NO_MEMORY;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(alignedSize)) != 0) {
+        LOG1("%s, ftruncate %zu failed: %s", __func__, alignedSize, strerror(errno));
+        ::close(fd);
+        return NO_MEMORY;
+    }
+
+    void* addr = ::mmap(nullptr, alignedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        LOG1("%s, mmap %zu failed: %s", __func__, alignedSize, strerror(errno));
+        ::close(fd);
+        return NO_MEMORY;
+    }
+
+    alloc->addr = addr;
+    alloc->size = alignedSize;
+    alloc->fd = fd;
+    alloc->type = hugePage ? BUFFER_ALLOCATOR_MEMFD_HUGETLB : BUFFER_ALLOCATOR_MEMFD;
+    return OK;
+}
+
+int MemfdAllocator::allocate(size_t size, BufferAllocation* alloc) {
+    if (mHugePage && (size >= kHugePageSize) && (allocateMemfd(size, true, alloc) == OK)) {
+        return OK;
+    }
+
+    const int ret = allocateMemfd(size, false, alloc);
+    CheckAndLogError(ret != OK, ret, "%s, failed to allocate %zu bytes", __func__, size);
+    return OK;
+}
+
+DmaHeapAllocator::DmaHeapAllocator() : mHeapFd(::open(kDmaHeapPath, O_RDWR | O_CLOEXEC)) {
+    CheckWarningNoReturn(mHeapFd < 0, "Failed to open %s: %s, use heap", kDmaHeapPath,
+                         strerror(errno));
+}
+
+DmaHeapAllocator::~DmaHeapAllocator() {
+    if (mHeapFd >= 0) {
+        ::close(mHeapFd);
+    }
+}
+
+int DmaHeapAllocator::allocate(size_t size, BufferAllocation* alloc) {
+    const size_t alignedSize = ALIGN(size, static_cast<size_t>(getpagesize()));
+    if (mHeapFd >= 0) {
+        struct dma_heap_allocation_data data;
+        CLEAR(data);
+        data.len = alignedSize;
+        data.fd_flags = O_RDWR | O_CLOEXEC;
+        if (::ioctl(mHeapFd, DMA_HEAP_IOCTL_ALLOC, &data) == 0) {
+            const int fd = static_cast<int>(data.fd);
+            void* addr = ::mmap(nullptr, alignedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED) {
+                alloc->addr = addr;
+                alloc->size = alignedSize;
+                alloc->fd = fd;
+                alloc->type = BUFFER_ALLOCATOR_DMA_HEAP;
+                return OK;
+            }
+            LOG1("%s, mmap %zu failed: %s", __func__, alignedSize, strerror(errno));
+            ::close(fd);
+        } else {
+            LOG1("%s, alloc %zu failed: %s", __func__, alignedSize, strerror(errno));
+        }
+    }
+
+    HeapAllocator heap;
+    return heap.allocate(size, alloc);
+}
+
+}  // namespace icamera
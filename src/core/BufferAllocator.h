@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include "iutils/Utils.h"
+
+namespace icamera {
+
+/**
+ * The memory of the internal buffers (V4L2_MEMORY_USERPTR CameraBuffer), selected by
+ * "export cameraBufferAllocator=<type>":
+ *   heap:          posix_memalign, page aligned (default)
+ *   thp:           anonymous mapping, 2M aligned and advised as transparent huge pages
+ *   hugetlb:       explicit huge pages (MAP_HUGETLB), needs the pages reserved in
+ *                  /proc/sys/vm/nr_hugepages, falls back to thp
+ *   memfd:         memfd_create() backed, the fd can be shared with other processes
+ *   memfd_hugetlb: memfd_create() with MFD_HUGETLB, falls back to memfd
+ * And "export cameraBufferPrefault=1" touches all the pages at allocation, which is done
+ * at configure time, to avoid the page faults in the first frames. "cameraBufferPrefault=mlock"
+ * locks the pages instead, so they aren't reclaimed either, it falls back to touching the
+ * pages if RLIMIT_MEMLOCK is exceeded. Either of them also warms up the pipeline at start,
+ * see CBStage::warmUpBuffers().
+ *
+ * The internal buffers of the pipeline streams listed in "export cameraDmaHeapStreams=<id>,<id>"
+ * ("all" for all the streams) are allocated from the dma-heap (/dev/dma_heap/system), so they
+ * are dma-buf fds which can be shared with other devices and processes, and are mapped to
+ * PSys by fd. The dma-heap mapping can't be used as V4L2 USERPTR memory, so it's only for the
+ * buffers between the PSys stages and post processing, not for the ISYS buffers.
+ */
+enum BufferAllocatorType {
+    BUFFER_ALLOCATOR_HEAP = 0,
+    BUFFER_ALLOCATOR_THP,
+    BUFFER_ALLOCATOR_HUGETLB,
+    BUFFER_ALLOCATOR_MEMFD,
+    BUFFER_ALLOCATOR_MEMFD_HUGETLB,
+    BUFFER_ALLOCATOR_DMA_HEAP,
+};
+
+struct BufferAllocation {
+    void* addr;
+    size_t size;      // The mapped size, may be larger than the requested size
+    int fd;           // -1 if the memory isn't backed by a fd
+    BufferAllocatorType type;
+};
+
+class BufferAllocator {
+ public:
+    static BufferAllocator* getInstance();
+    // The allocator of the internal buffers of the pipeline stream, see cameraDmaHeapStreams
+    static BufferAllocator* getInstance(int streamId);
+
+    virtual ~BufferAllocator() {}
+    virtual int allocate(size_t size, BufferAllocation* alloc) = 0;
+    // The allocators may fall back to other types, so the memory is freed by its type
+    void free(BufferAllocation* alloc);
+
+    // Write every page, so the pages are populated before the first use
+    static void prefault(void* addr, size_t size);
+    // Populate the pages without changing the data, for the memory already in use
+    static void populate(void* addr, size_t size);
+    static bool isPrefaultEnabled();
+
+    /**
+     * Prefault or mlock the memory by cameraBufferPrefault, also for the memory allocated out
+     * of BufferAllocator. hasData is true if the memory is in use, then it isn't written.
+     */
+    static void warmUp(void* addr, size_t size, bool hasData);
+    // Called before the memory passed to warmUp() is freed
+    static void unlock(void* addr, size_t size);
+
+ protected:
+    BufferAllocator() {}
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(BufferAllocator);
+};
+
+class HeapAllocator : public BufferAllocator {
+ public:
+    HeapAllocator() {}
+    virtual int allocate(size_t size, BufferAllocation* alloc);
+};
+
+class HugePageAllocator : public BufferAllocator {
+ public:
+    explicit HugePageAllocator(bool explicitHugePage) : mExplicit(explicitHugePage) {}
+    virtual int allocate(size_t size, BufferAllocation* alloc);
+
+ private:
+    int allocateThp(size_t size, BufferAllocation* alloc);
+
+ private:
+    bool mExplicit;
+};
+
+class MemfdAllocator : public BufferAllocator {
+ public:
+    explicit MemfdAllocator(bool hugePage) : mHugePage(hugePage) {}
+    virtual int allocate(size_t size, BufferAllocation* alloc);
+
+ private:
+    int allocateMemfd(size_t size, bool hugePage, BufferAllocation* alloc);
+
+ private:
+    bool mHugePage;
+};
+
+class DmaHeapAllocator : public BufferAllocator {
+ public:
+    DmaHeapAllocator();
+    virtual ~DmaHeapAllocator();
+    // Fall back to the heap if the dma-heap isn't available
+    virtual int allocate(size_t size, BufferAllocation* alloc);
+
+ private:
+    int mHeapFd;
+};
+
+}  // namespace icamera
@@ -39,6 +39,8 @@ class BufferProducer : public EventSource {
     virtual int allocateMemory(uuid port, const std::shared_ptr<CameraBuffer>& camBuffer) = 0;
     virtual void addFrameAvailableListener(BufferConsumer* listener) = 0;
     virtual void removeFrameAvailableListener(BufferConsumer* listener) = 0;
+    // Give back the buffer lent to a consumer buffer, which isn't queued again with it
+    virtual void returnLentBuffer(const std::shared_ptr<CameraBuffer>& buffer) {}
     int getMemoryType(void) const { return mMemType; }
 
  private:
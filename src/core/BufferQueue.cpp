@@ -28,7 +28,8 @@ BufferProducer::BufferProducer(int memType) : mMemType(memType) {
 }
 
 BufferQueue::BufferQueue()
-        : mThreadWaiting(true) {
+        : mQueueTraceTag("BufferQueue"),
+          mThreadWaiting(true) {
     LOG1("@%s BufferQueue %p created", __func__, this);
 }
 
@@ -45,6 +46,7 @@ int BufferQueue::queueInputBuffer(uuid port, const std::shared_ptr<CameraBuffer>
     CameraBufQ& input = mInputQueue[port];
     const bool needSignal = input.empty();
     input.push(camBuffer);
+    traceQueueSize(mInputQueueTraceName, port, input.size());
     if (needSignal) {
         mFrameAvailableSignal.notify_one();
     }
@@ -105,21 +107,59 @@ int BufferQueue::qbuf(uuid port, const std::shared_ptr<CameraBuffer>& camBuffer)
 
     CameraBufQ& output = mOutputQueue[port];
     output.push(camBuffer);
+    traceQueueSize(mOutputQueueTraceName, port, output.size());
 
     return OK;
 }
 
+void BufferQueue::setQueueTraceTag(int cameraId, const std::string& name) {
+    mQueueTraceTag = "Cam" + std::to_string(cameraId) + " " + name;
+}
+
 void BufferQueue::clearBufferQueues() {
     AutoMutex l(mBufferQueueLock);
 
+    char traceName[MAX_SYS_NAME];
     mInputQueue.clear();
+    mInputQueueTraceName.clear();
     for (const auto& input : mInputFrameInfo) {
         mInputQueue[input.first] = CameraBufQ();
+        snprintf(traceName, sizeof(traceName), "%s in:%x", mQueueTraceTag.c_str(), input.first);
+        mInputQueueTraceName[input.first] = PERF_CAMERA_ATRACE_COUNTER_NAME(traceName);
     }
 
     mOutputQueue.clear();
+    mOutputQueueTraceName.clear();
     for (const auto& output : mOutputFrameInfo) {
         mOutputQueue[output.first] = CameraBufQ();
+        snprintf(traceName, sizeof(traceName), "%s out:%x", mQueueTraceTag.c_str(), output.first);
+        mOutputQueueTraceName[output.first] = PERF_CAMERA_ATRACE_COUNTER_NAME(traceName);
+    }
+}
+
+void BufferQueue::traceQueueDepth() {
+    if (!PERF_CAMERA_ATRACE_COUNTER_ENABLED()) {
+        return;
+    }
+
+    for (const auto& input : mInputQueue) {
+        traceQueueSize(mInputQueueTraceName, input.first, input.second.size());
+    }
+    for (const auto& output : mOutputQueue) {
+        traceQueueSize(mOutputQueueTraceName, output.first, output.second.size());
+    }
+}
+
+void BufferQueue::traceQueueSize(const std::map<uuid, const char*>& traceNames, uuid port,
+                                 size_t size) {
+    if (!PERF_CAMERA_ATRACE_COUNTER_ENABLED()) {
+        return;
+    }
+
+    // Not to add the port by operator[] in the frame path
+    auto it = traceNames.find(port);
+    if (it != traceNames.end()) {
+        PERF_CAMERA_ATRACE_COUNTER(it->second, size);
     }
 }
 
@@ -142,7 +182,7 @@ void BufferQueue::setThreadWaiting(bool waiting) {
 }
 
 int BufferQueue::waitFreeBuffersInQueue(std::unique_lock<std::mutex>& lock,
-                                        std::map<uuid, std::shared_ptr<CameraBuffer> >& buffer,
+                                        CameraBufferPortMap& buffer,
                                         std::map<uuid, CameraBufQ>& bufferQueue,
                                         int64_t timeout) {
     timeout = (timeout != 0 ? timeout : kWaitDuration) * SLOWLY_MULTIPLIER;
@@ -175,8 +215,8 @@ int BufferQueue::waitFreeBuffersInQueue(std::unique_lock<std::mutex>& lock,
 }
 
 int BufferQueue::waitFreeBuffersInQueue(std::unique_lock<std::mutex>& lock,
-                                        std::map<uuid, std::shared_ptr<CameraBuffer> >& cInBuffer,
-                                        std::map<uuid, std::shared_ptr<CameraBuffer> >& cOutBuffer,
+                                        CameraBufferPortMap& cInBuffer,
+                                        CameraBufferPortMap& cOutBuffer,
                                         int64_t timeout) {
     int ret = OK;
     timeout = (timeout != 0 ? timeout : kWaitDuration) * SLOWLY_MULTIPLIER;
@@ -190,40 +230,36 @@ int BufferQueue::waitFreeBuffersInQueue(std::unique_lock<std::mutex>& lock,
     return waitFreeBuffersInQueue(lock, cOutBuffer, mOutputQueue, timeout);
 }
 
-int BufferQueue::getFreeBuffersInQueue(std::map<uuid, std::shared_ptr<CameraBuffer> >& inBuffers,
-                                       std::map<uuid, std::shared_ptr<CameraBuffer> >& outBuffers) {
-    for (auto& input : mInputQueue) {
-        const uuid port = input.first;
-        CameraBufQ& inputQueue = input.second;
-        if (inputQueue.empty()) {
+int BufferQueue::getFreeBuffersInQueue(CameraBufferPortMap& inBuffers,
+                                       CameraBufferPortMap& outBuffers) {
+    for (const auto& input : mInputQueue) {
+        if (input.second.empty()) {
             inBuffers.clear();
             return NOT_ENOUGH_DATA;
         }
-        inBuffers[port] = inputQueue.front();
     }
-
-    for (auto& output : mOutputQueue) {
-        const uuid port = output.first;
-        CameraBufQ& outputQueue = output.second;
-        if (outputQueue.empty()) {
+    for (const auto& output : mOutputQueue) {
+        if (output.second.empty()) {
             inBuffers.clear();
             outBuffers.clear();
             return NOT_ENOUGH_DATA;
         }
-        outBuffers[port] = outputQueue.front();
     }
 
+    // Move the buffers out of the queues, no reference count change
     for (auto& input : mInputQueue) {
+        inBuffers[input.first] = std::move(input.second.front());
         input.second.pop();
     }
     for (auto& output : mOutputQueue) {
+        outBuffers[output.first] = std::move(output.second.front());
         output.second.pop();
     }
+    traceQueueDepth();
     return OK;
 }
 
-void BufferQueue::returnBuffers(std::map<uuid, std::shared_ptr<CameraBuffer> >& inBuffers,
-                                std::map<uuid, std::shared_ptr<CameraBuffer> >& outBuffers) {
+void BufferQueue::returnBuffers(CameraBufferPortMap& inBuffers, CameraBufferPortMap& outBuffers) {
     // Return buffers
     if (mBufferProducer != nullptr) {
         for (auto const& portBufferPair : inBuffers) {
@@ -231,7 +267,7 @@ void BufferQueue::returnBuffers(std::map<uuid, std::shared_ptr<CameraBuffer> >&
         }
     }
     for (auto const& portBufferPair : outBuffers) {
-        std::shared_ptr<CameraBuffer> outBuf = portBufferPair.second;
+        const std::shared_ptr<CameraBuffer>& outBuf = portBufferPair.second;
         const uuid port = portBufferPair.first;
         // If the output buffer is nullptr, that means user doesn't request that buffer,
         // so it doesn't need to be handled here.
@@ -244,7 +280,7 @@ void BufferQueue::returnBuffers(std::map<uuid, std::shared_ptr<CameraBuffer> >&
     }
 }
 
-int BufferQueue::allocProducerBuffers(int camId, int bufNum) {
+int BufferQueue::allocProducerBuffers(int camId, int bufNum, BufferAllocator* allocator) {
     LOG1("%s: buffer queue size %d", __func__, bufNum);
 
     mInternalBuffers.clear();
@@ -270,7 +306,7 @@ int BufferQueue::allocProducerBuffers(int camId, int bufNum) {
                 case V4L2_MEMORY_USERPTR:
                     camBuffer =
                         CameraBuffer::create(V4L2_MEMORY_USERPTR, size, i, srcFmt, srcWidth,
-                                             srcHeight);
+                                             srcHeight, allocator);
                     CheckAndLogError(camBuffer == nullptr, NO_MEMORY,
                                      "Allocate producer userptr buffer failed");
                     break;
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <map>
+#include <string>
 #include <vector>
 #include <condition_variable>
 
@@ -24,11 +25,17 @@
 #include "CameraBuffer.h"
 #include "CameraEvent.h"
 #include "iutils/Errors.h"
+#include "iutils/FlatMap.h"
 #include "iutils/Thread.h"
 #include "StageDescriptor.h"
 
 namespace icamera {
 
+// More than the ports of any task in the pipeline
+static const size_t kMaxTaskPortNum = 16U;
+// The buffers of one task by port, it's built per frame so it doesn't allocate memory
+typedef FlatMap<uuid, std::shared_ptr<CameraBuffer>, kMaxTaskPortNum> CameraBufferPortMap;
+
 class BufferQueue : public BufferConsumer, public BufferProducer, public EventListener {
  public:
     BufferQueue();
@@ -93,44 +100,55 @@ class BufferQueue : public BufferConsumer, public BufferProducer, public EventLi
      * \brief Clear and initialize input and output buffer queues.
      */
     void clearBufferQueues();
+    /**
+     * \brief Name the queue depth counter tracks "Cam<id> <name> in/out:<port>"
+     *
+     * The names are interned, so they are built from the camera and the stage, not the
+     * instance, to keep the set bounded over the sessions. Called in the constructor.
+     */
+    void setQueueTraceTag(int cameraId, const std::string& name);
     /**
      * \brief Wait for available input and output buffers.
      *
      * should be called in a threadLoop, Only fetch buffer from the buffer queue, need pop buffer from
      * the queue after the buffer is used, and need to be protected by mBufferQueueLock.
      */
-    int waitFreeBuffersInQueue(std::unique_lock<std::mutex>& lock,
-                               std::map<uuid, std::shared_ptr<CameraBuffer> >& cInBuffer,
-                               std::map<uuid, std::shared_ptr<CameraBuffer> >& cOutBuffer,
-                               int64_t timeout = 0);
-    int waitFreeBuffersInQueue(std::unique_lock<std::mutex>& lock,
-                               std::map<uuid, std::shared_ptr<CameraBuffer> >& buffer,
+    int waitFreeBuffersInQueue(std::unique_lock<std::mutex>& lock, CameraBufferPortMap& cInBuffer,
+                               CameraBufferPortMap& cOutBuffer, int64_t timeout = 0);
+    int waitFreeBuffersInQueue(std::unique_lock<std::mutex>& lock, CameraBufferPortMap& buffer,
                                std::map<uuid, CameraBufQ>& bufferQueue, int64_t timeout);
     /**
      * \brief Get available input and output buffers and pop them from buffer queue.
      *
      * should be called in a threadLoop, and need to be protected by mBufferQueueLock.
      */
-    int getFreeBuffersInQueue(std::map<uuid, std::shared_ptr<CameraBuffer> >& inBuffers,
-                              std::map<uuid, std::shared_ptr<CameraBuffer> >& outBuffers);
+    int getFreeBuffersInQueue(CameraBufferPortMap& inBuffers, CameraBufferPortMap& outBuffers);
     /**
      * \brief Return buffers to producer and consumers
      */
-    void returnBuffers(std::map<uuid, std::shared_ptr<CameraBuffer> >& inBuffers,
-                       std::map<uuid, std::shared_ptr<CameraBuffer> >& outBuffers);
+    void returnBuffers(CameraBufferPortMap& inBuffers, CameraBufferPortMap& outBuffers);
 
     static const nsecs_t kWaitDuration = 10000000000;  // 10000ms
 
     /**
-     * \brief Buffers allocation for producer
+     * \brief Buffers allocation for producer, allocator is for the userptr buffers
      */
-    int allocProducerBuffers(int camId, int bufNum);
+    int allocProducerBuffers(int camId, int bufNum, BufferAllocator* allocator = nullptr);
 
    /**
    * \brief set thread waiting
    */
     void setThreadWaiting(bool waiting);
 
+    /**
+     * \brief Trace the depth of the input and output queues as counter tracks
+     *
+     * Need to be protected by mBufferQueueLock.
+     */
+    void traceQueueDepth();
+    static void traceQueueSize(const std::map<uuid, const char*>& traceNames, uuid port,
+                               size_t size);
+
     std::vector<BufferConsumer*> mBufferConsumerList;
 
     std::map<uuid, stream_t> mInputFrameInfo;
@@ -138,6 +156,10 @@ class BufferQueue : public BufferConsumer, public BufferProducer, public EventLi
 
     std::map<uuid, CameraBufQ> mInputQueue;
     std::map<uuid, CameraBufQ> mOutputQueue;
+    // Interned counter track names of the queue depth per port, prefixed by mQueueTraceTag
+    std::string mQueueTraceTag;
+    std::map<uuid, const char*> mInputQueueTraceName;
+    std::map<uuid, const char*> mOutputQueueTraceName;
 
     // For internal buffers allocation for producer
     std::map<uuid, CameraBufVector> mInternalBuffers;
@@ -26,7 +26,9 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <memory>
 #include <vector>
@@ -34,13 +36,22 @@
 #include "PlatformData.h"
 #include "iutils/CameraLog.h"
 #include "iutils/Utils.h"
+#include "v4l2/SysCall.h"
 
 namespace icamera {
 CameraBuffer::CameraBuffer(int memory, uint32_t size, int index)
         : mAllocatedMemory(false),
           mU(nullptr),
           mSettingSequence(-1),
-          mMmapAddrs(nullptr) {
+          mMmapAddrs(nullptr),
+          mAllocator(nullptr),
+          mDmaMapAddr(nullptr),
+          mDmaMapSize(0U),
+          mDmaMapIno(0),
+          mDmaMapRefCount(0),
+          mAccountCameraId(-1),
+          mAccountSubsystem(CAMERA_MEMORY_BUFFERS),
+          mAccountSize(0U) {
     LOG2("%s: construct buffer with memory:%d, size:%d, index:%d",  __func__, memory, size, index);
 
     mU = new camera_buffer_t;
@@ -48,7 +59,13 @@ CameraBuffer::CameraBuffer(int memory, uint32_t size, int index)
     mBufferflag = BUFFER_FLAG_INTERNAL;
     mU->flags = BUFFER_FLAG_INTERNAL;
     mU->sequence = -1;
+    CLEAR(mAllocation);
+    mAllocation.fd = -1;
 
+    initV4l2Buffer(memory, size, index);
+}
+
+void CameraBuffer::initV4l2Buffer(int memory, uint32_t size, int index) {
     mV.SetMemory(memory);
     mV.SetIndex(index);
     mV.SetType(V4L2_BUF_TYPE_VIDEO_CAPTURE);
@@ -59,6 +76,7 @@ CameraBuffer::CameraBuffer(int memory, uint32_t size, int index)
 }
 
 CameraBuffer::~CameraBuffer() {
+    releaseDmaBufferMapping();
     freeMemory();
 
     if ((mBufferflag & BUFFER_FLAG_INTERNAL) != 0U) {
@@ -68,7 +86,8 @@ CameraBuffer::~CameraBuffer() {
 
 // Helper function to construct a internal CameraBuffer with memory type
 std::shared_ptr<CameraBuffer> CameraBuffer::create(int memory, unsigned int size, int index,
-                                                   int srcFmt, int srcWidth, int srcHeight) {
+                                                   int srcFmt, int srcWidth, int srcHeight,
+                                                   BufferAllocator* allocator) {
     LOG1("%s, width:%d, height:%d, memory type:%d, size:%d, format:%d, index:%d", __func__,
          srcWidth, srcHeight, memory, size, srcFmt, index);
     std::shared_ptr<CameraBuffer> camBuffer =
@@ -76,6 +95,7 @@ std::shared_ptr<CameraBuffer> CameraBuffer::create(int memory, unsigned int size
     CheckAndLogError(camBuffer == nullptr, nullptr, "@%s: fail to alloc CameraBuffer", __func__);
 
     camBuffer->setUserBufferInfo(srcFmt, srcWidth, srcHeight);
+    camBuffer->mAllocator = allocator;
     int ret = camBuffer->allocateMemory();
     CheckAndLogError(ret != OK, nullptr, "Allocate memory failed ret %d", ret);
 
@@ -98,6 +118,29 @@ std::shared_ptr<CameraBuffer> CameraBuffer::create(int memory, int size, int ind
     return camBuffer;
 }
 
+// Reuse the CameraBuffer of an app buffer for another app buffer, instead of a new one
+int CameraBuffer::reset(int memory, int size, int index, camera_buffer_t* ubuffer) {
+    CheckAndLogError(ubuffer == nullptr, BAD_VALUE, "ubuffer is nullptr");
+    CheckAndLogError(isInternalBuffer() || mAllocatedMemory, INVALID_OPERATION,
+                     "%s, not an app buffer", __func__);
+    LOG2("%s, memory type:%d, size:%d, index:%d", __func__, memory, size, index);
+
+    {
+        std::lock_guard<std::mutex> l(mDmaMapLock);
+        releaseDmaBufferMapping();
+        mDmaMapRefCount = 0;
+    }
+    mSettingSequence = -1;
+    // The lent buffer is reclaimed by the stream before the CameraBuffer is reused
+    mLentBuffer = nullptr;
+    mV = V4L2Buffer();
+    initV4l2Buffer(memory, size, index);
+
+    setUserBufferInfo(ubuffer);
+    updateFlags();
+    return OK;
+}
+
 // Helper function to construct a CameraBuffer from void* pointer
 std::shared_ptr<CameraBuffer> CameraBuffer::create(int srcWidth, int srcHeight, int size,
                                                    int srcFmt, int index, void* buffer) {
@@ -140,6 +183,12 @@ void CameraBuffer::setUserBufferInfo(camera_buffer_t* ubuffer) {
     mU = ubuffer;
     mBufferflag = mU->flags;
 
+    // The user buffer is queued again, give back its own memory
+    if ((mLentBuffer != nullptr) && (ubuffer->addr == mLentBuffer->getBufferAddr()) &&
+        (mV.Memory() == V4L2_MEMORY_USERPTR)) {
+        ubuffer->addr = reinterpret_cast<void*>(mV.Userptr(0));
+    }
+
     mV.SetSequence(0);
     const struct timeval ts = {0};
     mV.SetTimestamp(ts);
@@ -212,6 +261,11 @@ int CameraBuffer::allocateMemory(V4L2VideoNode* vDevice) {
 
     if (ret == OK) {
         mAllocatedMemory = true;
+        // Account the memory to the camera and subsystem which allocate the buffer
+        mAccountCameraId = MemoryAccounting::currentCameraId();
+        mAccountSubsystem = MemoryAccounting::currentSubsystem(CAMERA_MEMORY_BUFFERS);
+        mAccountSize = (mV.Memory() == V4L2_MEMORY_USERPTR) ? mAllocation.size : mV.Length(0);
+        MemoryAccounting::add(mAccountCameraId, mAccountSubsystem, mAccountSize);
     }
 
     return ret;
@@ -235,19 +289,27 @@ void CameraBuffer::freeMemory() {
                  mV.Memory());
             break;
     }
+    MemoryAccounting::remove(mAccountCameraId, mAccountSubsystem, mAccountSize);
 }
 
 int CameraBuffer::allocateUserPtr() {
-    void* buffer = nullptr;
-    const int ret = posix_memalign(&buffer, getpagesize(), mV.Length(0));
-    CheckAndLogError(ret != 0, -1, "%s, posix_memalign fails, ret:%d", __func__, ret);
-    mV.SetUserptr(reinterpret_cast<uintptr_t>(buffer), 0);
+    BufferAllocator* allocator =
+        (mAllocator != nullptr) ? mAllocator : BufferAllocator::getInstance();
+    const int ret = allocator->allocate(mV.Length(0), &mAllocation);
+    CheckAndLogError(ret != OK, -1, "%s, allocate %u bytes fails, ret:%d", __func__,
+                     mV.Length(0), ret);
+    BufferAllocator::warmUp(mAllocation.addr, mAllocation.size, false);
+
+    mV.SetUserptr(reinterpret_cast<uintptr_t>(mAllocation.addr), 0);
+    // Export the fd of the memfd backed buffer
+    if (mAllocation.fd >= 0) {
+        mU->dmafd = mAllocation.fd;
+    }
     return OK;
 }
 
 void CameraBuffer::freeUserPtr() {
-    void* ptr = reinterpret_cast<void*>(mV.Userptr(0));
-    ::free(ptr);
+    BufferAllocator::getInstance()->free(&mAllocation);
     mV.SetUserptr(reinterpret_cast<uintptr_t>(nullptr), 0);
 }
 
@@ -325,14 +387,93 @@ void* CameraBuffer::mapDmaBufferAddr(int fd, unsigned int bufferSize) {
 #ifdef LIBDRM_SUPPORT_MMAP_OFFSET
     return mDeviceRender.mapDmaBufferAddr(fd, bufferSize);
 #else
-    return ::mmap(nullptr, bufferSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return SysCall::getInstance()->mmap(nullptr, bufferSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                        fd, 0);
 #endif
 }
 
 void CameraBuffer::unmapDmaBufferAddr(void* addr, unsigned int bufferSize) {
     CheckAndLogError((addr == nullptr) || (bufferSize == 0U), VOID_VALUE,
                      "%s, addr:%p, bufferSize:%u", __func__, addr, bufferSize);
-    munmap(addr, bufferSize);
+    SysCall::getInstance()->munmap(addr, bufferSize);
+}
+
+void CameraBuffer::syncDmaBuffer(int fd, uint64_t flags) {
+    struct dma_buf_sync sync = {flags};
+    // The whole buffer is synced, the uAPI doesn't take a range
+    const int ret =
+        SysCall::getInstance()->ioctl(fd, static_cast<int>(DMA_BUF_IOCTL_SYNC), &sync);
+    CheckWarningNoReturn(ret != 0, "%s, fd %d, flags 0x%lx failed: %s", __func__, fd, flags,
+                         strerror(errno));
+}
+
+void* CameraBuffer::mapDmaBuffer() {
+    std::lock_guard<std::mutex> l(mDmaMapLock);
+    if (mDmaMapRefCount == 0) {
+        if (mU->addr != nullptr) {
+            return nullptr;
+        }
+
+        const int fd = getFd();
+        const uint32_t size = getBufferSize();
+        struct stat statBuf;
+        CLEAR(statBuf);
+        if ((fstat(fd, &statBuf) != 0) || (statBuf.st_ino != mDmaMapIno) ||
+            (size != mDmaMapSize)) {
+            releaseDmaBufferMapping();
+        }
+
+        if (mDmaMapAddr == nullptr) {
+            void* addr = mapDmaBufferAddr(fd, size);
+            CheckAndLogError((addr == nullptr) || (addr == MAP_FAILED), nullptr,
+                             "%s, failed to map fd %d", __func__, fd);
+            mDmaMapAddr = addr;
+            mDmaMapSize = size;
+            mDmaMapIno = statBuf.st_ino;
+            LOG2("%s, map fd %d, size %u, addr %p", __func__, fd, size, addr);
+        }
+        mU->addr = mDmaMapAddr;
+    }
+
+    mDmaMapRefCount++;
+    return mDmaMapAddr;
+}
+
+void CameraBuffer::unmapDmaBuffer() {
+    std::lock_guard<std::mutex> l(mDmaMapLock);
+    if (mDmaMapRefCount == 0) {
+        return;
+    }
+
+    mDmaMapRefCount--;
+    if (mDmaMapRefCount == 0) {
+        // The user buffer doesn't have the address, keep the mapping in the cache
+        mU->addr = nullptr;
+    }
+}
+
+void CameraBuffer::lendBuffer(const std::shared_ptr<CameraBuffer>& buffer) {
+    mLentBuffer = buffer;
+    mU->addr = buffer->getBufferAddr();
+}
+
+void* CameraBuffer::getLentAddr() {
+    return (mLentBuffer != nullptr) ? mLentBuffer->getBufferAddr() : nullptr;
+}
+
+std::shared_ptr<CameraBuffer> CameraBuffer::reclaimLentBuffer() {
+    std::shared_ptr<CameraBuffer> buffer = mLentBuffer;
+    mLentBuffer = nullptr;
+    return buffer;
+}
+
+void CameraBuffer::releaseDmaBufferMapping() {
+    if (mDmaMapAddr != nullptr) {
+        unmapDmaBufferAddr(mDmaMapAddr, mDmaMapSize);
+        mDmaMapAddr = nullptr;
+        mDmaMapSize = 0U;
+        mDmaMapIno = 0;
+    }
 }
 
 void CameraBuffer::updateUserBuffer(void) {
@@ -364,7 +505,7 @@ int CameraBuffer::getFd() {
     int ret = -1;
     switch (mV.Memory()) {
         case V4L2_MEMORY_USERPTR:
-            ret = mV.Fd(0);
+            ret = isDmaHeapBuffer() ? mAllocation.fd : mV.Fd(0);
             break;
         case V4L2_MEMORY_DMABUF:
         case V4L2_MEMORY_MMAP:
@@ -377,6 +518,13 @@ int CameraBuffer::getFd() {
     return ret;
 }
 
+int CameraBuffer::getExportFd() {
+    if ((mV.Memory() == V4L2_MEMORY_USERPTR) && (mAllocation.fd >= 0)) {
+        return mAllocation.fd;
+    }
+    return getFd();
+}
+
 void* CameraBuffer::getBufferAddr() {
     void* ret = nullptr;
     switch (mV.Memory()) {
@@ -394,23 +542,29 @@ void* CameraBuffer::getBufferAddr() {
     return ret;
 }
 
-CameraBufferMapper::CameraBufferMapper(std::shared_ptr<CameraBuffer> buffer)
+CameraBufferMapper::CameraBufferMapper(std::shared_ptr<CameraBuffer> buffer, uint64_t access)
         : mBuffer(buffer),
-          mDMAMapped(false) {
-    if ((buffer->getMemory() == V4L2_MEMORY_DMABUF) &&
-        (mBuffer->getUserBuffer()->addr == nullptr)) {
-        void* addr = CameraBuffer::mapDmaBufferAddr(mBuffer->getFd(), mBuffer->getBufferSize());
-
-        mBuffer->getUserBuffer()->addr = addr;
-        mDMAMapped = true;
+          mDMAMapped(false),
+          mDMASynced(false),
+          mAccess(access) {
+    if (buffer->getMemory() == V4L2_MEMORY_DMABUF) {
+        mDMAMapped = (mBuffer->mapDmaBuffer() != nullptr);
+        mDMASynced = mDMAMapped;
+    } else {
+        // The dma-heap buffer is always mapped, only the CPU access is synced
+        mDMASynced = mBuffer->isDmaHeapBuffer();
+    }
+    if (mDMASynced) {
+        CameraBuffer::syncDmaBuffer(mBuffer->getFd(), DMA_BUF_SYNC_START | mAccess);
     }
 }
 
 CameraBufferMapper::~CameraBufferMapper() {
+    if (mDMASynced) {
+        CameraBuffer::syncDmaBuffer(mBuffer->getFd(), DMA_BUF_SYNC_END | mAccess);
+    }
     if (mDMAMapped) {
-        CameraBuffer::unmapDmaBufferAddr(mBuffer->getBufferAddr(), mBuffer->getBufferSize());
-
-        mBuffer->getUserBuffer()->addr = nullptr;
+        mBuffer->unmapDmaBuffer();
     }
 }
 
@@ -16,13 +16,20 @@
 
 #pragma once
 
+#include <sys/types.h>
+
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <vector>
 
+#include <linux/dma-buf.h>
 #include <linux/videodev2.h>
 #include <v4l2_device.h>
+#include "BufferAllocator.h"
 #include "ParamDataType.h"
+#include "iutils/MemoryAccounting.h"
+#include "iutils/RingQueue.h"
 #include "iutils/Utils.h"
 
 namespace icamera {
@@ -35,9 +42,11 @@ class CameraBuffer {
      * memory: V4L2_MEMORY_USERPTR heap buffer
      *         V4L2_MEMORY_MMAP    mmap buffer
      *         V4L2_MEMORY_DMABUF  camera APP buffer
+     * allocator: the allocator of the V4L2_MEMORY_USERPTR buffer, the default one if nullptr
      */
     static std::shared_ptr<CameraBuffer> create(int memory, unsigned int size, int index,
-                                                int srcFmt, int srcWidth, int srcHeight);
+                                                int srcFmt, int srcWidth, int srcHeight,
+                                                BufferAllocator* allocator = nullptr);
     // Construct a CameraBuffer from camera_buffer_t pointer.
     static std::shared_ptr<CameraBuffer> create(int memory, int size, int index,
                                                 camera_buffer_t* ubuffer);
@@ -48,6 +57,9 @@ class CameraBuffer {
     CameraBuffer(int memory, uint32_t size, int index);
     virtual ~CameraBuffer();
 
+    // Reuse the CameraBuffer constructed from camera_buffer_t for another camera_buffer_t.
+    int reset(int memory, int size, int index, camera_buffer_t* ubuffer);
+
     // user buffer information
     int getWidth() const { return mU->s.width; }
     int getHeight() const { return mU->s.height; }
@@ -71,8 +83,11 @@ class CameraBuffer {
     }
     void setTimestamp(struct timeval timestamp) { mV.SetTimestamp(timestamp); }
 
-    // Use for GFX/DMA/GBM buffer
+    // Use for GFX/DMA/GBM buffer, it's a dma-buf fd or -1
     int getFd();
+    // The fd to share the memory with other processes: the dma-buf fd, or the fd of the
+    // memfd backed internal buffer, which isn't a dma-buf
+    int getExportFd();
 
     uint32_t getMemory(void) const { return mV.Memory(); }
 
@@ -124,6 +139,11 @@ class CameraBuffer {
       return (mBufferflag & BUFFER_FLAG_INTERNAL) != 0;
     }
 
+    // The internal buffer is a dma-buf from the dma-heap, which is mapped to PSys by fd
+    bool isDmaHeapBuffer() const {
+      return (mAllocation.type == BUFFER_ALLOCATOR_DMA_HEAP) && (mAllocation.fd >= 0);
+    }
+
     void setSettingSequence(int64_t sequence) { mSettingSequence = sequence; }
     int64_t getSettingSequence() const { return mSettingSequence; }
 
@@ -132,12 +152,32 @@ class CameraBuffer {
 
     static void* mapDmaBufferAddr(int fd, unsigned int bufferSize);
     static void unmapDmaBufferAddr(void* addr, unsigned int bufferSize);
+    // flags: DMA_BUF_SYNC_START or DMA_BUF_SYNC_END with the access
+    static void syncDmaBuffer(int fd, uint64_t flags);
+
+    /* Map the V4L2_MEMORY_DMABUF buffer for CPU access. The mapping is kept until the
+     * CameraBuffer is destroyed (it lives in the buffer pool of CameraStream), and is
+     * reused if the same dma-buf is queued again, so the buffer isn't mmap'ed per frame.
+     * Return nullptr if the buffer already has the address from the user.
+     */
+    void* mapDmaBuffer();
+    void unmapDmaBuffer();
+
+    /* Zero copy output, see BUFFER_FLAG_ZERO_COPY: the user buffer gets the memory of
+     * another buffer, which is held until the user buffer is queued again.
+     */
+    void lendBuffer(const std::shared_ptr<CameraBuffer>& buffer);
+    void* getLentAddr();
+    // Called when the user buffer is queued again, return the lent buffer
+    std::shared_ptr<CameraBuffer> reclaimLentBuffer();
 
  private:
     CameraBuffer(const CameraBuffer&);
     CameraBuffer& operator=(const CameraBuffer&);
 
     void setUserBufferInfo(int format, int width, int height, void* usrPtr);
+    void initV4l2Buffer(int memory, uint32_t size, int index);
+    void releaseDmaBufferMapping();
 
     void freeMemory();
     int exportMmapDmabuf(V4L2VideoNode* vDevice);
@@ -161,6 +201,24 @@ class CameraBuffer {
     int64_t mSettingSequence;
 
     void* mMmapAddrs;
+    // The memory of V4L2_MEMORY_USERPTR buffer allocated by CameraBuffer
+    BufferAllocator* mAllocator;
+    BufferAllocation mAllocation;
+
+    // The cached CPU mapping of the V4L2_MEMORY_DMABUF buffer
+    std::mutex mDmaMapLock;
+    void* mDmaMapAddr;
+    uint32_t mDmaMapSize;
+    ino_t mDmaMapIno;  // The dma-buf identity, the fd number may be reused by the app
+    int mDmaMapRefCount;
+
+    // The memory accounted to MemoryAccounting when it's allocated
+    int mAccountCameraId;
+    camera_memory_subsystem_t mAccountSubsystem;
+    size_t mAccountSize;
+
+    // The buffer whose memory is given to the user buffer
+    std::shared_ptr<CameraBuffer> mLentBuffer;
 
 #ifdef LIBDRM_SUPPORT_MMAP_OFFSET
     class DeviceRender {
@@ -179,11 +237,13 @@ class CameraBuffer {
 };
 
 typedef std::vector<std::shared_ptr<CameraBuffer> > CameraBufVector;
-typedef std::queue<std::shared_ptr<CameraBuffer> > CameraBufQ;
+typedef RingQueue<std::shared_ptr<CameraBuffer> > CameraBufQ;
 
 class CameraBufferMapper {
  public:
-    explicit CameraBufferMapper(std::shared_ptr<CameraBuffer> buffer);
+    // access: DMA_BUF_SYNC_READ, DMA_BUF_SYNC_WRITE or DMA_BUF_SYNC_RW
+    explicit CameraBufferMapper(std::shared_ptr<CameraBuffer> buffer,
+                                uint64_t access = DMA_BUF_SYNC_RW);
     ~CameraBufferMapper();
 
     void* addr();
@@ -192,6 +252,8 @@ class CameraBufferMapper {
  private:
     std::shared_ptr<CameraBuffer> mBuffer;
     bool mDMAMapped;
+    bool mDMASynced;
+    uint64_t mAccess;
 };
 
 }  // namespace icamera
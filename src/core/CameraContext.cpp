@@ -22,6 +22,8 @@
 
 #include "PlatformData.h"
 #include "AiqResultStorage.h"
+#include "CameraStatistics.h"
+#include "FrameTimeline.h"
 #include "iutils/CameraLog.h"
 
 namespace icamera {
@@ -96,12 +98,22 @@ void CameraContext::releaseInstance(int cameraId) {
 
 CameraContext::CameraContext(int cameraId) :
     mCameraId(cameraId),
-    mCurrentIndex(-1) {
+    mCurrentIndex(-1),
+    mFrameTimeline(nullptr),
+    mDataContextPool(kContextSize * 3),
+    mFnToDataContextMap(std::less<int64_t>(), DataContextMap::allocator_type(&mDataContextPool)),
+    mSeqToDataContextMap(std::less<int64_t>(), DataContextMap::allocator_type(&mDataContextPool)),
+    mCcaIdToDataContextMap(std::less<int64_t>(),
+                           DataContextMap::allocator_type(&mDataContextPool)) {
     LOG1("<id%d> %s", cameraId, __func__);
     for (int i = 0; i < kContextSize; i++) {
         mDataContext[i] = new DataContext(mCameraId);
     }
     mAiqResultStorage = new AiqResultStorage(mCameraId);
+    mStatistics = new CameraStatistics(mCameraId);
+    if (FrameTimeline::isEnabled()) {
+        mFrameTimeline = new FrameTimeline(mCameraId);
+    }
 }
 
 CameraContext::~CameraContext() {
@@ -111,6 +123,8 @@ CameraContext::~CameraContext() {
     mSeqToDataContextMap.clear();
     mCcaIdToDataContextMap.clear();
 
+    delete mFrameTimeline;
+    delete mStatistics;
     delete mAiqResultStorage;
     for (int i = 0; i < kContextSize; i++) {
         delete mDataContext[i];
@@ -132,6 +146,14 @@ AiqResultStorage* CameraContext::getAiqResultStorage() {
     return mAiqResultStorage;
 }
 
+CameraStatistics* CameraContext::getStatistics() {
+    return mStatistics;
+}
+
+FrameTimeline* CameraContext::getFrameTimeline() {
+    return mFrameTimeline;
+}
+
 DataContext* CameraContext::acquireDataContext() {
     LOG2("<id%d> %s", mCameraId, __func__);
 
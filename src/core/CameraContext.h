@@ -24,6 +24,7 @@
 #include "AiqSetting.h"
 #include "CameraTypes.h"
 #include "ParamDataType.h"
+#include "iutils/NodePool.h"
 // JPEG_ENCODE_S
 #include "EXIFMetaData.h"
 // JPEG_ENCODE_E
@@ -31,6 +32,8 @@
 namespace icamera {
 
 class AiqResultStorage;
+class CameraStatistics;
+class FrameTimeline;
 class GraphConfig;
 
 struct IspParameters {
@@ -128,6 +131,10 @@ class CameraContext {
     void reset();
     // used to save aiq, face and statistics results
     AiqResultStorage* getAiqResultStorage();
+    // used to collect the runtime statistics
+    CameraStatistics* getStatistics();
+    // used to record the frame timeline, nullptr if it isn't enabled
+    FrameTimeline* getFrameTimeline();
 
     // only called when parsing request once
     DataContext* acquireDataContext();
@@ -164,11 +171,17 @@ class CameraContext {
     DataContext* mDataContext[kContextSize];
 
     AiqResultStorage* mAiqResultStorage;
+    CameraStatistics* mStatistics;
+    FrameTimeline* mFrameTimeline;
 
     std::mutex mLock;  // Guard all Maps and public APIs
-    std::map<int64_t, DataContext*> mFnToDataContextMap;
-    std::map<int64_t, DataContext*> mSeqToDataContextMap;
-    std::map<int64_t, DataContext*> mCcaIdToDataContextMap;
+    // Each map holds one item of each DataContext at most, the nodes are reused
+    typedef std::map<int64_t, DataContext*, std::less<int64_t>,
+                     PoolAllocator<std::pair<const int64_t, DataContext*>>> DataContextMap;
+    NodePool mDataContextPool;
+    DataContextMap mFnToDataContextMap;
+    DataContextMap mSeqToDataContextMap;
+    DataContextMap mCcaIdToDataContextMap;
     std::map<ConfigMode, std::shared_ptr<GraphConfig> > mGraphConfigMap;
 }; /* CameraContext */
 
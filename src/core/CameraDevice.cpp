@@ -21,8 +21,10 @@
 #include <vector>
 
 #include "iutils/CameraLog.h"
+#include "iutils/MemoryAccounting.h"
 #include "iutils/Utils.h"
 
+#include "FrameTimeline.h"
 #include "GraphConfig.h"
 #include "AiqUtils.h"
 #include "I3AControlFactory.h"
@@ -33,6 +35,7 @@
 // FILE_SOURCE_E
 #include "CaptureUnit.h"
 #include "CameraContext.h"
+#include "SharedOutputStream.h"
 #include "StageDescriptor.h"
 
 using std::vector;
@@ -135,6 +138,7 @@ int CameraDevice::init() {
     PERF_CAMERA_ATRACE();
     LOG1("<id%d>@%s, mState:%d", mCameraId, __func__, mState);
     AutoMutex m(mDeviceLock);
+    MemoryAccounting::Scope scope(mCameraId);
 
     int ret = mProducer->init();
     CheckAndLogError(ret < 0, ret, "%s: Init capture unit failed", __func__);
@@ -199,6 +203,8 @@ void CameraDevice::deinit() {
     mProducer->deinit();
 
     mState = DEVICE_UNINIT;
+    // Report the memory high-water of the camera when it is closed
+    MemoryAccounting::dump(mCameraId);
 }
 
 void CameraDevice::callbackRegister(const camera_callback_ops_t* callback) {
@@ -340,6 +346,13 @@ int CameraDevice::configure(stream_config_t* streamList) {
          static_cast<ConfigMode>(streamList->operation_mode));
 
     AutoMutex lock(mDeviceLock);
+    MemoryAccounting::Scope scope(mCameraId);
+
+    CameraContext* cameraContext = CameraContext::getInstance(mCameraId);
+    cameraContext->getStatistics()->reset();
+    if (cameraContext->getFrameTimeline() != nullptr) {
+        cameraContext->getFrameTimeline()->reset();
+    }
 
     // Release the resource created last time
     deleteStreams();
@@ -655,8 +668,13 @@ int CameraDevice::createStreams(const stream_config_t* streamList, int configure
              CameraUtils::pixelCode2String(streamConf.format), streamConf.width, streamConf.height);
 
         CameraStream* stream = nullptr;
+        if (mSharedStreamSource.find(streamId) != mSharedStreamSource.end()) {
+            // The image is from the source stream, without the producer port
+            stream = new SharedOutputStream(mCameraId, streamId, streamConf);
+        } else {
             // Create a normal CameraStream
             stream = new CameraStream(mCameraId, streamId, streamConf);
+        }
 
         stream->registerListener(EVENT_FRAME_AVAILABLE, mRequestThread);
         stream->registerListener(EVENT_FRAME_AVAILABLE, this);
@@ -666,6 +684,12 @@ int CameraDevice::createStreams(const stream_config_t* streamList, int configure
         LOG2("@%s: automation checkpoint: interlaced: %d", __func__, streamConf.field);
     }
 
+    for (const auto& item : mSharedStreamSource) {
+        SharedOutputStream* stream = static_cast<SharedOutputStream*>(mStreams[item.first]);
+        stream->setSourceStream(mStreams[item.second]);
+        mStreams[item.second]->addSharedStream(stream);
+    }
+
     return OK;
 }
 
@@ -685,6 +709,11 @@ int CameraDevice::analyzeStream(const stream_config_t* streamList, int* inputRaw
         stream.id = i;
         stream.max_buffers = PlatformData::getMaxPipelineDepth(mCameraId);
 
+        // No IPU output for the shared output stream, see analyzeSharedStreams()
+        if (stream.streamType == CAMERA_STREAM_SHARED_OUTPUT) {
+            continue;
+        }
+
         if (stream.streamType == CAMERA_STREAM_INPUT) {
             CheckAndLogError(*inputRawStreamId >= 0, BAD_VALUE, "Don't support two INPUT streams!");
             if ((stream.usage == CAMERA_STREAM_PREVIEW) ||
@@ -739,6 +768,45 @@ int CameraDevice::analyzeStream(const stream_config_t* streamList, int* inputRaw
         *preStreamIdForFace = -1;
     }
 
+    return analyzeSharedStreams(streamList);
+}
+
+/**
+ * Find the source stream of each CAMERA_STREAM_SHARED_OUTPUT stream: the first output stream
+ * with the same format, resolution and memory type. Only V4L2_MEMORY_USERPTR is supported since
+ * the shared buffer gets the address of the source buffer.
+ */
+int CameraDevice::analyzeSharedStreams(const stream_config_t* streamList) {
+    mSharedStreamSource.clear();
+
+    for (int i = 0; i < streamList->num_streams; i++) {
+        const stream_t& stream = streamList->streams[i];
+        if (stream.streamType != CAMERA_STREAM_SHARED_OUTPUT) {
+            continue;
+        }
+        CheckAndLogError(stream.memType != V4L2_MEMORY_USERPTR, BAD_VALUE,
+                         "Shared output stream %d only supports USERPTR memory", i);
+
+        int sourceId = -1;
+        for (int j = 0; j < streamList->num_streams; j++) {
+            const stream_t& source = streamList->streams[j];
+            if ((source.streamType == CAMERA_STREAM_OUTPUT) &&
+                (source.usage != CAMERA_STREAM_OPAQUE_RAW) && (source.format == stream.format) &&
+                (source.width == stream.width) && (source.height == stream.height) &&
+                (source.memType == stream.memType)) {
+                sourceId = j;
+                break;
+            }
+        }
+        CheckAndLogError(sourceId < 0, BAD_VALUE,
+                         "No source stream for shared output stream %d, format:%s (%dx%d)", i,
+                         CameraUtils::pixelCode2String(stream.format), stream.width,
+                         stream.height);
+
+        LOG1("%s: stream %d shares the output of stream %d", __func__, i, sourceId);
+        mSharedStreamSource[i] = sourceId;
+    }
+
     return OK;
 }
 
@@ -817,6 +885,7 @@ int CameraDevice::start() {
 
     {
         AutoMutex m(mDeviceLock);
+        MemoryAccounting::Scope scope(mCameraId);
         CheckAndLogError(mState != DEVICE_BUFFER_READY, BAD_VALUE,
                          "start camera in wrong status %d", mState);
         CheckAndLogError(mStreamNum == 0, BAD_VALUE,
@@ -862,6 +931,12 @@ int CameraDevice::stop() {
     mScheduler->stop();
     mState = DEVICE_STOP;
 
+    CameraContext* cameraContext = CameraContext::getInstance(mCameraId);
+    cameraContext->getStatistics()->resetInflight();
+    if (cameraContext->getFrameTimeline() != nullptr) {
+        cameraContext->getFrameTimeline()->markStale();
+    }
+
     return OK;
 }
 
@@ -874,6 +949,7 @@ int CameraDevice::allocateMemory(camera_buffer_t* ubuffer) {
     CheckAndLogError((ubuffer->s.id < 0) || (ubuffer->s.id >= mStreamNum), BAD_VALUE,
                      "@%s: Wrong stream id %d", __func__, ubuffer->s.id);
 
+    MemoryAccounting::Scope scope(mCameraId);
     const int ret = mStreams[ubuffer->s.id]->allocateMemory(ubuffer);
     CheckAndLogError(ret < 0, ret, "@%s: failed, index: %d", __func__, ubuffer->index);
 
@@ -901,6 +977,13 @@ int CameraDevice::dqbuf(int streamId, camera_buffer_t** ubuffer) {
     CheckAndLogError(((*ubuffer) == nullptr) || (ret != OK),
                      ret, "failed to get ubuffer from stream %d", streamId);
 
+    CameraContext* cameraContext = CameraContext::getInstance(mCameraId);
+    cameraContext->getStatistics()->onBufferDelivered(streamId);
+    FrameTimeline* timeline = cameraContext->getFrameTimeline();
+    if (timeline != nullptr) {
+        timeline->recordEvent((*ubuffer)->sequence, TIMELINE_DQBUF);
+    }
+
     return ret;
 }
 
@@ -963,8 +1046,34 @@ int CameraDevice::qbuf(camera_buffer_t** ubuffer, int bufferNum) {
     PERF_CAMERA_ATRACE();
     LOG2("<id%d>@%s", mCameraId, __func__);
 
+    for (int i = 0; i < bufferNum; i++) {
+        CheckAndLogError(ubuffer[i] == nullptr, BAD_VALUE, "@%s: buffer %d is nullptr", __func__,
+                         i);
+        CheckAndLogError((ubuffer[i]->s.id < 0) || (ubuffer[i]->s.id >= mStreamNum), BAD_VALUE,
+                         "@%s: invalid stream id:%d", __func__, ubuffer[i]->s.id);
+    }
+
     {
         AutoMutex m(mDeviceLock);
+        // The shared output stream only gets the image of the source buffer in the same
+        // request. mSharedStreamSource is refilled by configure(), so look it up with the lock.
+        for (int i = 0; i < bufferNum; i++) {
+            auto shared = mSharedStreamSource.find(ubuffer[i]->s.id);
+            if (shared == mSharedStreamSource.end()) {
+                continue;
+            }
+            bool hasSource = false;
+            for (int j = 0; j < bufferNum; j++) {
+                if (ubuffer[j]->s.id == shared->second) {
+                    hasSource = true;
+                    break;
+                }
+            }
+            CheckAndLogError(!hasSource, BAD_VALUE,
+                             "@%s: no buffer of stream %d for shared stream %d", __func__,
+                             shared->second, shared->first);
+        }
+
         if ((mState == DEVICE_CONFIGURE) || (mState == DEVICE_STOP)) {
             // Start 3A here then the HAL can run 3A for request
             mLensCtrl->start();
@@ -975,7 +1084,28 @@ int CameraDevice::qbuf(camera_buffer_t** ubuffer, int bufferNum) {
         }
     }
 
-    return mRequestThread->processRequest(bufferNum, ubuffer);
+    const nsecs_t queuedTime = CameraUtils::systemTime();
+    const int ret = mRequestThread->processRequest(bufferNum, ubuffer);
+    CheckAndLogError(ret != OK, ret, "@%s: process request failed:%d", __func__, ret);
+
+    // Only the accepted buffers are recorded, with the time before they were processed
+    CameraStatistics* statistics = CameraContext::getInstance(mCameraId)->getStatistics();
+    for (int i = 0; i < bufferNum; i++) {
+        statistics->onBufferQueued(ubuffer[i]->s.id, queuedTime);
+    }
+
+    return OK;
+}
+
+int CameraDevice::getStatistics(camera_stats_t* stats) {
+    CheckAndLogError(stats == nullptr, BAD_VALUE, "@%s: stats is nullptr", __func__);
+    LOG2("<id%d>@%s", mCameraId, __func__);
+
+    CameraContext::getInstance(mCameraId)->getStatistics()->getStatistics(stats);
+    mRequestThread->getRequestCount(&stats->pending_requests, &stats->requests_in_processing);
+    MemoryAccounting::getStatistics(mCameraId, &stats->memory);
+
+    return OK;
 }
 
 int CameraDevice::setParameters(const DataContext& dataContext) {
@@ -16,6 +16,7 @@
 
 #pragma once
 #include "AiqUnit.h"
+#include "CameraStatistics.h"
 #include "CameraStream.h"
 #ifdef LINUX_PRIVACY_MODE
 #include "InputEventMonitor.h"
@@ -183,12 +184,20 @@ class CameraDevice : public EventListener {
 
     void callbackRegister(const camera_callback_ops_t* callback);
 
+    /**
+     * \brief Get the runtime statistics of the device
+     *
+     * \return OK if succeed, other value indicates failed
+     */
+    int getStatistics(camera_stats_t* stats);
+
  private:
     StreamSource* createBufferProducer();
     std::map<uuid, stream_t> selectProducerConfig(const stream_config_t* streamList, int mcId);
     bool isProcessorNeeded(const stream_config_t* streamList, const stream_t& producerConfig) const;
     int analyzeStream(const stream_config_t* streamList, int* inputRawStreamId,
                       int* preStreamIdForFace, int* inputYuvStreamId);
+    int analyzeSharedStreams(const stream_config_t* streamList);
     int assignPortForStreams(const stream_config_t* streamList, int inputRawStreamId,
                              int inputYuvStreamId, int configuredStreamNum);
     int createStreams(const stream_config_t* streamList, int configuredStreamNum);
@@ -234,6 +243,7 @@ class CameraDevice : public EventListener {
     CameraStream* mStreams[MAX_STREAM_NUMBER];
     std::map<int, uuid> mStreamIdToPortMap;
     std::vector<int> mSortedStreamIds;  // Used to save sorted stream ids with descending order.
+    std::map<int, int> mSharedStreamSource;  // CAMERA_STREAM_SHARED_OUTPUT stream id -> source id
     StreamSource* mProducer;
 #ifdef LINUX_PRIVACY_MODE
     StreamSource* mBackupProducer;
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG CameraStatistics
+
+#include "CameraStatistics.h"
+
+#include <algorithm>
+
+#include "iutils/CameraLog.h"
+
+namespace icamera {
+
+CameraStatistics::CameraStatistics(int cameraId)
+        : mCameraId(cameraId),
+          mLastIsysSequence(-1),
+          mDroppedFrames(0U),
+          mSkippedFrames(0U),
+          mBuffersInDevice(0) {
+    CLEAR(mDurations);
+    clearFrameBeginLocked();
+}
+
+void CameraStatistics::reset() {
+    LOG1("<id%d>@%s", mCameraId, __func__);
+
+    std::lock_guard<std::mutex> l(mLock);
+    CLEAR(mDurations);
+    clearFrameBeginLocked();
+    mStreams.clear();
+    mLastIsysSequence = -1;
+    mDroppedFrames = 0U;
+    mSkippedFrames = 0U;
+    mBuffersInDevice = 0;
+}
+
+void CameraStatistics::resetInflight() {
+    LOG1("<id%d>@%s", mCameraId, __func__);
+
+    std::lock_guard<std::mutex> l(mLock);
+    clearFrameBeginLocked();
+    for (auto& stream : mStreams) {
+        stream.second.queuedHead = 0U;
+        stream.second.queuedNum = 0U;
+    }
+    // The sequence restarts after stream on
+    mLastIsysSequence = -1;
+    mBuffersInDevice = 0;
+}
+
+void CameraStatistics::clearFrameBeginLocked() {
+    for (auto& frames : mFrameBegin) {
+        for (auto& frame : frames) {
+            frame.sequence = -1;
+            frame.time = 0;
+        }
+    }
+}
+
+void CameraStatistics::addDurationLocked(DurationType type, nsecs_t duration) {
+    DurationWindow& window = mDurations[type];
+    window.samples[window.count % kDurationWindow] = duration;
+    window.count++;
+}
+
+void CameraStatistics::addDuration(DurationType type, nsecs_t duration) {
+    std::lock_guard<std::mutex> l(mLock);
+    addDurationLocked(type, duration);
+}
+
+void CameraStatistics::frameBegin(DurationType type, int64_t sequence) {
+    const nsecs_t now = CameraUtils::systemTime();
+
+    if (sequence < 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> l(mLock);
+    FrameBegin& frame = mFrameBegin[type][static_cast<uint64_t>(sequence) % kMaxFramesInflight];
+    frame.sequence = sequence;
+    frame.time = now;
+}
+
+void CameraStatistics::frameEnd(DurationType type, int64_t sequence) {
+    const nsecs_t now = CameraUtils::systemTime();
+
+    if (sequence < 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> l(mLock);
+    FrameBegin& frame = mFrameBegin[type][static_cast<uint64_t>(sequence) % kMaxFramesInflight];
+    if (frame.sequence != sequence) {
+        return;
+    }
+    addDurationLocked(type, now - frame.time);
+    frame.sequence = -1;
+}
+
+void CameraStatistics::onIsysFrame(int64_t sequence, const timeval& timestamp) {
+    // The frame timestamp is the SOF time of the monotonic clock
+    const nsecs_t isysTime =
+        CameraUtils::systemTime() - static_cast<nsecs_t>(TIMEVAL2NSECS(timestamp));
+
+    std::lock_guard<std::mutex> l(mLock);
+    if ((isysTime > 0) && (isysTime < kMaxIsysTime)) {
+        addDurationLocked(DURATION_ISYS, isysTime);
+    }
+
+    if ((mLastIsysSequence >= 0) && (sequence > mLastIsysSequence + 1)) {
+        LOG2("<id%d>@%s, %ld frames dropped before sequence %ld", mCameraId, __func__,
+             sequence - mLastIsysSequence - 1, sequence);
+        mDroppedFrames += sequence - mLastIsysSequence - 1;
+    }
+    mLastIsysSequence = sequence;
+}
+
+void CameraStatistics::onFrameSkipped() {
+    std::lock_guard<std::mutex> l(mLock);
+    mSkippedFrames++;
+}
+
+void CameraStatistics::setBuffersInDevice(int num) {
+    std::lock_guard<std::mutex> l(mLock);
+    mBuffersInDevice = num;
+}
+
+void CameraStatistics::onBufferQueued(int streamId, nsecs_t queuedTime) {
+    std::lock_guard<std::mutex> l(mLock);
+    if (mStreams.find(streamId) == mStreams.end()) {
+        CLEAR(mStreams[streamId]);
+    }
+
+    StreamStatistics& stream = mStreams[streamId];
+    if (stream.queuedNum == kMaxFramesInflight) {
+        stream.queuedHead = (stream.queuedHead + 1U) % kMaxFramesInflight;
+        stream.queuedNum--;
+    }
+    stream.queuedTime[(stream.queuedHead + stream.queuedNum) % kMaxFramesInflight] = queuedTime;
+    stream.queuedNum++;
+}
+
+void CameraStatistics::onBufferDelivered(int streamId) {
+    const nsecs_t now = CameraUtils::systemTime();
+
+    std::lock_guard<std::mutex> l(mLock);
+    auto it = mStreams.find(streamId);
+    if (it == mStreams.end()) {
+        return;
+    }
+
+    StreamStatistics& stream = it->second;
+    if (stream.queuedNum > 0U) {
+        addDurationLocked(DURATION_REQUEST_LATENCY, now - stream.queuedTime[stream.queuedHead]);
+        stream.queuedHead = (stream.queuedHead + 1U) % kMaxFramesInflight;
+        stream.queuedNum--;
+    }
+    stream.deliveredTime[stream.delivered % kFpsWindow] = now;
+    stream.delivered++;
+}
+
+void CameraStatistics::fillDuration(DurationType type, camera_duration_stats_t* stats) {
+    const DurationWindow& window = mDurations[type];
+    stats->count = window.count;
+    stats->mean_us = 0;
+    stats->p99_us = 0;
+    if (window.count == 0U) {
+        return;
+    }
+
+    const size_t num = std::min<uint64_t>(window.count, kDurationWindow);
+    nsecs_t samples[kDurationWindow];
+    nsecs_t sum = 0;
+    for (size_t i = 0U; i < num; i++) {
+        samples[i] = window.samples[i];
+        sum += samples[i];
+    }
+    const size_t p99Index = (num * 99U + 99U) / 100U - 1U;
+    std::nth_element(samples, samples + p99Index, samples + num);
+
+    stats->mean_us = sum / static_cast<nsecs_t>(num) / 1000;
+    stats->p99_us = samples[p99Index] / 1000;
+}
+
+void CameraStatistics::getStatistics(camera_stats_t* stats) {
+    CheckAndLogError(stats == nullptr, VOID_VALUE, "stats is nullptr");
+
+    std::lock_guard<std::mutex> l(mLock);
+    stats->num_streams = 0;
+    for (const auto& item : mStreams) {
+        if (stats->num_streams >= MAX_STATS_STREAM_NUM) {
+            break;
+        }
+
+        const StreamStatistics& stream = item.second;
+        camera_stream_stats_t& streamStats = stats->streams[stats->num_streams];
+        streamStats.id = item.first;
+        streamStats.delivered_frames = stream.delivered;
+        streamStats.buffers_queued = stream.queuedNum;
+        streamStats.fps = 0.0F;
+        if (stream.delivered > 1U) {
+            const int num = std::min<uint64_t>(stream.delivered, kFpsWindow);
+            const nsecs_t last = stream.deliveredTime[(stream.delivered - 1U) % kFpsWindow];
+            const nsecs_t first = stream.deliveredTime[(stream.delivered - num) % kFpsWindow];
+            if (last > first) {
+                streamStats.fps = (num - 1) * 1000000000.0F / (last - first);
+            }
+        }
+        stats->num_streams++;
+    }
+
+    stats->dropped_frames = mDroppedFrames;
+    stats->skipped_frames = mSkippedFrames;
+    fillDuration(DURATION_ISYS, &stats->isys_time);
+    fillDuration(DURATION_PSYS, &stats->psys_time);
+    fillDuration(DURATION_POST_PROCESSING, &stats->post_processing_time);
+    fillDuration(DURATION_AIQ_RUN, &stats->aiq_run_time);
+    fillDuration(DURATION_REQUEST_LATENCY, &stats->request_latency);
+    stats->buffers_in_device = mBuffersInDevice;
+}
+
+}  // namespace icamera
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/time.h>
+
+#include <map>
+#include <mutex>
+
+#include "ICamera.h"
+#include "iutils/Utils.h"
+
+namespace icamera {
+
+/**
+ * CameraStatistics collects the runtime statistics of one camera, which are reported
+ * by camera_get_statistics().
+ *
+ * The pipeline elements report the events of each frame, only the raw samples are
+ * saved here and the mean/p99 and fps are calculated when the statistics are queried.
+ */
+class CameraStatistics {
+ public:
+    enum DurationType {
+        DURATION_ISYS = 0,
+        DURATION_PSYS,
+        DURATION_POST_PROCESSING,
+        DURATION_AIQ_RUN,
+        DURATION_REQUEST_LATENCY,
+        DURATION_MAX,
+    };
+
+    explicit CameraStatistics(int cameraId);
+    ~CameraStatistics() {}
+
+    // Clear all the statistics, called when the streams are configured
+    void reset();
+    // Clear the frames in flight, called when the device is stopped
+    void resetInflight();
+
+    void addDuration(DurationType type, nsecs_t duration);
+    // For the durations which begin and end in different threads
+    void frameBegin(DurationType type, int64_t sequence);
+    void frameEnd(DurationType type, int64_t sequence);
+
+    void onIsysFrame(int64_t sequence, const timeval& timestamp);
+    void onFrameSkipped();
+    // queuedTime is taken before the request is processed, the buffer is recorded after it
+    void onBufferQueued(int streamId, nsecs_t queuedTime);
+    void onBufferDelivered(int streamId);
+    void setBuffersInDevice(int num);
+
+    void getStatistics(camera_stats_t* stats);
+
+ private:
+    static const int kDurationWindow = 256;
+    static const int kFpsWindow = 30;
+    // A begin timestamp which never ends (e.g. flushed tasks) is overwritten by the frame
+    // kMaxFramesInflight later, and so is the oldest queued time of a stream
+    static const size_t kMaxFramesInflight = 64U;
+    // The ISYS time is dropped if the frame timestamp isn't from the monotonic clock
+    static const nsecs_t kMaxIsysTime = 1000000000;  // 1s
+
+    struct DurationWindow {
+        nsecs_t samples[kDurationWindow];
+        uint64_t count;
+    };
+
+    // The fixed rings below are updated for each frame without allocating memory
+    struct FrameBegin {
+        int64_t sequence;  // -1 if the slot isn't used
+        nsecs_t time;
+    };
+
+    struct StreamStatistics {
+        uint64_t delivered;
+        // The buffers of one stream are delivered in the queued order
+        nsecs_t queuedTime[kMaxFramesInflight];
+        size_t queuedHead;
+        size_t queuedNum;
+        nsecs_t deliveredTime[kFpsWindow];
+    };
+
+    void clearFrameBeginLocked();
+    void addDurationLocked(DurationType type, nsecs_t duration);
+    void fillDuration(DurationType type, camera_duration_stats_t* stats);
+
+ private:
+    int mCameraId;
+
+    std::mutex mLock;
+    DurationWindow mDurations[DURATION_MAX];
+    FrameBegin mFrameBegin[DURATION_MAX][kMaxFramesInflight];  // Indexed by sequence
+    std::map<int, StreamStatistics> mStreams;
+    int64_t mLastIsysSequence;
+    uint64_t mDroppedFrames;
+    uint64_t mSkippedFrames;
+    int mBuffersInDevice;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(CameraStatistics);
+};
+
+}  // namespace icamera
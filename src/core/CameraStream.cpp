@@ -19,6 +19,7 @@
 #include "CameraStream.h"
 
 #include "PlatformData.h"
+#include "SharedOutputStream.h"
 #include "iutils/CameraLog.h"
 #include "iutils/Errors.h"
 #include "iutils/Utils.h"
@@ -28,6 +29,29 @@ using std::shared_ptr;
 
 namespace icamera {
 
+// The CameraBuffers kept for reuse when the app buffers are replaced
+static const size_t kMaxFreeBuffers = 8U;
+
+// Whether the CameraBuffer wraps the memory in the app buffer, or lends memory to it
+static bool isSameMemory(const shared_ptr<CameraBuffer>& camBuffer,
+                         const camera_buffer_t* ubuffer) {
+    if (camBuffer->getMemory() != static_cast<uint32_t>(ubuffer->s.memType)) {
+        return false;
+    }
+
+    const V4L2Buffer& v = camBuffer->getV4L2Buffer();
+    switch (ubuffer->s.memType) {
+        case V4L2_MEMORY_DMABUF:
+            return (ubuffer->dmafd >= 0) && (v.Fd(0) == ubuffer->dmafd);
+        case V4L2_MEMORY_USERPTR:
+            return (ubuffer->addr != nullptr) &&
+                   ((v.Userptr(0) == reinterpret_cast<uintptr_t>(ubuffer->addr)) ||
+                    (camBuffer->getLentAddr() == ubuffer->addr));
+        default:
+            return true;
+    }
+}
+
 CameraStream::CameraStream(int cameraId, int streamId, const stream_t& stream)
         : mCameraId(cameraId),
           mStreamId(streamId),
@@ -62,6 +86,13 @@ int CameraStream::stop() {
     mBufferInProcessing = 0;
 #endif
     mInputBuffersPool.clear();
+    mDmaFdIndex.clear();
+    mAddrIndex.clear();
+    mFreeBuffers.clear();
+
+    AutoMutex sharedLock(mSharedBufferLock);
+    mSharedBufferRefs.clear();
+    mDeferredBuffers.clear();
 
     return OK;
 }
@@ -91,32 +122,80 @@ shared_ptr<CameraBuffer> CameraStream::userBufferToCameraBuffer(camera_buffer_t*
     }
 
     shared_ptr<CameraBuffer> camBuffer = nullptr;
+    shared_ptr<CameraBuffer> lentBuffer = nullptr;
+    {
+        AutoMutex l(mBufferPoolLock);
+        camBuffer = userBufferToCameraBufferLocked(ubuffer, &lentBuffer);
+    }
 
-    AutoMutex l(mBufferPoolLock);
-    for (auto buffer = mInputBuffersPool.begin(); buffer != mInputBuffersPool.end(); buffer++) {
-        /* check if the buffer is already in the pool, when the userBuffer is same as ubuffer
-         * will continue to check the buffer, because the data addr in ubuffer may change */
-        if ((*buffer)->getUserBuffer() == ubuffer) {
-            /* when memType matches, the dmafd or the addr should match */
-            if (((*buffer)->getMemory() == static_cast<uint32_t>(ubuffer->s.memType)) &&
-                (((ubuffer->addr != nullptr) &&
-                ((*buffer)->getUserBuffer()->addr == ubuffer->addr)) || ((ubuffer->dmafd >= 0) &&
-                ((*buffer)->getUserBuffer()->dmafd == ubuffer->dmafd)))) {
-                camBuffer = *buffer;
-            } else {
-                mInputBuffersPool.erase(buffer);
+    // The app buffer is queued with other memory, so it doesn't use the lent buffer any more
+    if (lentBuffer != nullptr) {
+        releaseLentBuffer(lentBuffer);
+    }
+    return camBuffer;
+}
+
+void CameraStream::releaseLentBuffer(const shared_ptr<CameraBuffer>& buffer) {
+    // mBufferProducer will not change after start, no lock
+    if (mBufferProducer != nullptr) {
+        mBufferProducer->returnLentBuffer(buffer);
+    }
+}
+
+shared_ptr<CameraBuffer> CameraStream::userBufferToCameraBufferLocked(
+    camera_buffer_t* ubuffer, shared_ptr<CameraBuffer>* lentBuffer) {
+    shared_ptr<CameraBuffer> camBuffer = nullptr;
+
+    auto it = mInputBuffersPool.find(ubuffer);
+    if (it != mInputBuffersPool.end()) {
+        /* the data addr or dmafd in ubuffer may change, the buffer isn't used any more if
+         * the memory is changed */
+        if (isSameMemory(it->second, ubuffer)) {
+            camBuffer = it->second;
+        } else {
+            shared_ptr<CameraBuffer> oldBuffer = removeUserBuffer(ubuffer);
+            *lentBuffer = oldBuffer->reclaimLentBuffer();
+            // Keep it for reuse if it isn't in processing
+            if ((oldBuffer.use_count() == 1) && (mFreeBuffers.size() < kMaxFreeBuffers)) {
+                mFreeBuffers.push_back(oldBuffer);
             }
-            break;
+        }
+    }
+
+    if (camBuffer == nullptr) {
+        // The memory may be wrapped by another app buffer before, move it to this one
+        camera_buffer_t* owner = nullptr;
+        if ((ubuffer->s.memType == V4L2_MEMORY_DMABUF) && (ubuffer->dmafd >= 0)) {
+            auto fd = mDmaFdIndex.find(ubuffer->dmafd);
+            owner = (fd != mDmaFdIndex.end()) ? fd->second : nullptr;
+        } else if ((ubuffer->s.memType == V4L2_MEMORY_USERPTR) && (ubuffer->addr != nullptr)) {
+            auto addr = mAddrIndex.find(reinterpret_cast<uintptr_t>(ubuffer->addr));
+            owner = (addr != mAddrIndex.end()) ? addr->second : nullptr;
+        }
+        auto ownerBuffer = mInputBuffersPool.find(owner);
+        // The buffer in processing still returns to its owner
+        if ((ownerBuffer != mInputBuffersPool.end()) && (ownerBuffer->second.use_count() == 1) &&
+            isSameMemory(ownerBuffer->second, ubuffer)) {
+            camBuffer = removeUserBuffer(owner);
+            addUserBuffer(ubuffer, camBuffer);
         }
     }
 
     if (camBuffer == nullptr) {  // Not found in the pool, so create a new CameraBuffer for it.
         ubuffer->index = mInputBuffersPool.size();
-        camBuffer = CameraBuffer::create(ubuffer->s.memType, ubuffer->s.size, ubuffer->index,
-                                         ubuffer);
-        CheckAndLogError(camBuffer == nullptr, nullptr, "@%s: fail to alloc CameraBuffer",
-                         __func__);
-        mInputBuffersPool.push_back(camBuffer);
+        if (!mFreeBuffers.empty()) {
+            camBuffer = mFreeBuffers.back();
+            mFreeBuffers.pop_back();
+            int ret = camBuffer->reset(ubuffer->s.memType, ubuffer->s.size, ubuffer->index,
+                                       ubuffer);
+            CheckAndLogError(ret != OK, nullptr, "@%s: fail to reuse CameraBuffer", __func__);
+        } else {
+            camBuffer = CameraBuffer::create(ubuffer->s.memType, ubuffer->s.size,
+                                             ubuffer->index, ubuffer);
+            CheckAndLogError(camBuffer == nullptr, nullptr, "@%s: fail to alloc CameraBuffer",
+                             __func__);
+        }
+        addUserBuffer(ubuffer, camBuffer);
     } else {
         camBuffer->setUserBufferInfo(ubuffer);
         // Update the v4l2 flags
@@ -126,6 +205,43 @@ shared_ptr<CameraBuffer> CameraStream::userBufferToCameraBuffer(camera_buffer_t*
     return camBuffer;
 }
 
+void CameraStream::addUserBuffer(camera_buffer_t* ubuffer,
+                                 const shared_ptr<CameraBuffer>& camBuffer) {
+    mInputBuffersPool[ubuffer] = camBuffer;
+
+    const V4L2Buffer& v = camBuffer->getV4L2Buffer();
+    if (camBuffer->getMemory() == V4L2_MEMORY_DMABUF) {
+        mDmaFdIndex[v.Fd(0)] = ubuffer;
+    } else if (camBuffer->getMemory() == V4L2_MEMORY_USERPTR) {
+        mAddrIndex[v.Userptr(0)] = ubuffer;
+    }
+}
+
+shared_ptr<CameraBuffer> CameraStream::removeUserBuffer(camera_buffer_t* ubuffer) {
+    auto it = mInputBuffersPool.find(ubuffer);
+    if (it == mInputBuffersPool.end()) {
+        return nullptr;
+    }
+
+    shared_ptr<CameraBuffer> camBuffer = it->second;
+    mInputBuffersPool.erase(it);
+
+    // The index entries may belong to another app buffer with the same memory
+    const V4L2Buffer& v = camBuffer->getV4L2Buffer();
+    if (camBuffer->getMemory() == V4L2_MEMORY_DMABUF) {
+        auto fd = mDmaFdIndex.find(v.Fd(0));
+        if ((fd != mDmaFdIndex.end()) && (fd->second == ubuffer)) {
+            mDmaFdIndex.erase(fd);
+        }
+    } else if (camBuffer->getMemory() == V4L2_MEMORY_USERPTR) {
+        auto addr = mAddrIndex.find(v.Userptr(0));
+        if ((addr != mAddrIndex.end()) && (addr->second == ubuffer)) {
+            mAddrIndex.erase(addr);
+        }
+    }
+    return camBuffer;
+}
+
 // Q buffers to the stream processor which should be set by the CameraDevice
 int CameraStream::qbuf(camera_buffer_t* ubuffer, int64_t sequence, bool addExtraBuf) {
     UNUSED(addExtraBuf);
@@ -141,7 +257,7 @@ int CameraStream::qbuf(camera_buffer_t* ubuffer, int64_t sequence, bool addExtra
     int ret = BAD_VALUE;
     // mBufferProducer will not change after start, no lock
     if (mBufferProducer != nullptr) {
-        ret = mBufferProducer->qbuf(mPort, camBuffer);
+        ret = deferSharedBuffer(camBuffer) ? OK : mBufferProducer->qbuf(mPort, camBuffer);
         if (ret == OK) {
             AutoMutex l(mBufferPoolLock);
 #ifdef LINUX_PRIVACY_MODE
@@ -155,6 +271,59 @@ int CameraStream::qbuf(camera_buffer_t* ubuffer, int64_t sequence, bool addExtra
     return ret;
 }
 
+bool CameraStream::deferSharedBuffer(const shared_ptr<CameraBuffer>& camBuffer) {
+    // mSharedStreams will not change after configure
+    if (mSharedStreams.empty()) {
+        return false;
+    }
+
+    AutoMutex l(mSharedBufferLock);
+    // The following buffers wait too, the producer handles the buffers in the request order
+    if (mDeferredBuffers.empty() &&
+        ((camBuffer == nullptr) || (mSharedBufferRefs.find(camBuffer.get()) ==
+                                    mSharedBufferRefs.end()))) {
+        return false;
+    }
+
+    LOG2("<id%d>@%s, mStreamId:%d, CameraBuffer:%p is used by the shared streams", mCameraId,
+         __func__, mStreamId, camBuffer.get());
+    mDeferredBuffers.push_back(camBuffer);
+    return true;
+}
+
+void CameraStream::releaseSharedBuffer(const shared_ptr<CameraBuffer>& camBuffer) {
+    CameraBufVector readyBuffers;
+    {
+        AutoMutex l(mSharedBufferLock);
+        auto it = mSharedBufferRefs.find(camBuffer.get());
+        if (it == mSharedBufferRefs.end()) {
+            return;
+        }
+        it->second--;
+        if (it->second > 0) {
+            return;
+        }
+        mSharedBufferRefs.erase(it);
+
+        while (!mDeferredBuffers.empty()) {
+            const shared_ptr<CameraBuffer>& buffer = mDeferredBuffers.front();
+            if ((buffer != nullptr) &&
+                (mSharedBufferRefs.find(buffer.get()) != mSharedBufferRefs.end())) {
+                break;
+            }
+            readyBuffers.push_back(buffer);
+            mDeferredBuffers.pop_front();
+        }
+    }
+
+    // The buffers are queued by the request thread, so the order is kept without the lock
+    for (const auto& buffer : readyBuffers) {
+        const int ret = mBufferProducer->qbuf(mPort, buffer);
+        CheckWarningNoReturn(ret != OK, "@%s, queue buffer %p failed %d", __func__, buffer.get(),
+                             ret);
+    }
+}
+
 #ifdef LINUX_PRIVACY_MODE
 // This function is called in stop status, no lock
 void CameraStream::setBufferProducer(BufferProducer* producer) {
@@ -205,6 +374,17 @@ int CameraStream::onBufferAvailable(uuid port, const shared_ptr<CameraBuffer>& c
     // Update the user buffer info before return back
     camBuffer->updateUserBuffer();
 
+    // Deliver to the shared streams first, the buffer can't be queued again before that
+    for (auto& stream : mSharedStreams) {
+        {
+            AutoMutex l(mSharedBufferLock);
+            mSharedBufferRefs[camBuffer.get()]++;
+        }
+        if (!stream->onSourceBufferAvailable(camBuffer)) {
+            releaseSharedBuffer(camBuffer);
+        }
+    }
+
     EventFrameAvailable frameData;
     frameData.streamId = mStreamId;
     EventData eventData;
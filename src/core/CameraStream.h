@@ -16,6 +16,10 @@
 
 #pragma once
 #include <algorithm>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "ParamDataType.h"
 #include "BufferQueue.h"
@@ -23,6 +27,8 @@
 
 namespace icamera {
 
+class SharedOutputStream;
+
 /**
  * CameraStream: The HAL represent of the application stream.
  * CameraStream implement the BufferConsumer interface.
@@ -79,16 +85,48 @@ class CameraStream : public BufferConsumer, public EventSource {
     virtual void setBufferProducer(BufferProducer* producer);
 #endif
 
- private:
+    /**
+     * \brief Deliver the buffers of this stream to a CAMERA_STREAM_SHARED_OUTPUT stream
+     */
+    void addSharedStream(SharedOutputStream* stream) { mSharedStreams.push_back(stream); }
+
+    /**
+     * \brief Called when the shared stream doesn't use the buffer of this stream any more
+     *
+     * The buffer is queued to the producer after all the shared streams release it.
+     */
+    void releaseSharedBuffer(const std::shared_ptr<CameraBuffer>& camBuffer);
+
+ protected:
     std::shared_ptr<CameraBuffer> userBufferToCameraBuffer(camera_buffer_t* ubuffer);
+    // Give back the buffer lent to an app buffer which won't be queued again with it
+    virtual void releaseLentBuffer(const std::shared_ptr<CameraBuffer>& buffer);
+
+ private:
+    // Hold the buffer if it's still used by the shared streams, called before queued to producer.
+    // The buffers after a held one are held too to keep the request order, so the stream stalls
+    // until the shared streams release it.
+    bool deferSharedBuffer(const std::shared_ptr<CameraBuffer>& camBuffer);
+    // Called with mBufferPoolLock, the lent buffer of the replaced CameraBuffer is returned
+    std::shared_ptr<CameraBuffer> userBufferToCameraBufferLocked(
+        camera_buffer_t* ubuffer, std::shared_ptr<CameraBuffer>* lentBuffer);
+    // Remove the buffer from mInputBuffersPool and the indexes, called with mBufferPoolLock
+    std::shared_ptr<CameraBuffer> removeUserBuffer(camera_buffer_t* ubuffer);
+    void addUserBuffer(camera_buffer_t* ubuffer, const std::shared_ptr<CameraBuffer>& camBuffer);
 
  protected:
     int mCameraId;
     int mStreamId;
 
-    // Guard for member mInputBuffersPool and mBufferInProcessing
+    // Guard for the buffer pool, its indexes and mBufferInProcessing
     Mutex mBufferPoolLock;
-    CameraBufVector mInputBuffersPool;
+    // The CameraBuffers of the app buffers, indexed by the app buffer, and by the dma fd
+    // or the address of the memory, in case the app wraps the memory in another struct
+    std::unordered_map<camera_buffer_t*, std::shared_ptr<CameraBuffer>> mInputBuffersPool;
+    std::unordered_map<int, camera_buffer_t*> mDmaFdIndex;
+    std::unordered_map<uintptr_t, camera_buffer_t*> mAddrIndex;
+    // The CameraBuffers not used by any app buffer, reused for the new app buffers
+    CameraBufVector mFreeBuffers;
 
 #ifdef LINUX_PRIVACY_MODE
     // Container to track buffers currently being processed by this CameraStream
@@ -100,6 +138,14 @@ class CameraStream : public BufferConsumer, public EventSource {
 #endif
 
     uuid mPort;
+
+    std::vector<SharedOutputStream*> mSharedStreams;
+    // Guard for mSharedBufferRefs and mDeferredBuffers
+    Mutex mSharedBufferLock;
+    // The buffers lent to the shared streams, and how many shared streams use them
+    std::unordered_map<CameraBuffer*, int> mSharedBufferRefs;
+    // The queued buffers waiting for the shared streams, in the order of the requests
+    std::deque<std::shared_ptr<CameraBuffer>> mDeferredBuffers;
 };
 
 }  // namespace icamera
@@ -21,6 +21,8 @@
 #include <fcntl.h>
 #include <poll.h>
 
+#include "CameraContext.h"
+#include "CameraStatistics.h"
 #include "MediaControl.h"
 #include "PlatformData.h"
 #include "iutils/CameraDump.h"
@@ -62,6 +64,8 @@ CaptureUnit::CaptureUnit(int cameraId, int memType)
     if (mMaxBuffersInDevice < 2) {
         mMaxBuffersInDevice = 2;
     }
+    mBufferTraceName =
+        PERF_CAMERA_ATRACE_COUNTER_NAME("Cam" + std::to_string(cameraId) + " buffers in device");
 }
 
 CaptureUnit::~CaptureUnit() {
@@ -130,6 +134,13 @@ int CaptureUnit::createDevices() {
         CheckAndLogError(ret != OK, ret, "Configure device(%s) failed:%d", device->getName(), ret);
     }
 
+    std::vector<V4L2Device*> pollDevs;
+    for (const auto& device : mDevices) {
+        pollDevs.push_back(device->getV4l2Device());
+    }
+    mPoller.reset(new V4L2DevicePoller(pollDevs, mFlushFd[0]));
+    mReadyDevices.reserve(pollDevs.size());
+
     return OK;
 }
 
@@ -137,6 +148,8 @@ void CaptureUnit::destroyDevices() {
     PERF_CAMERA_ATRACE();
     LOG1("<id%d>%s", mCameraId, __func__);
 
+    mPoller.reset();
+    mReadyDevices.clear();
     for (auto device : mDevices) {
         device->closeDevice();
         delete device;
@@ -356,7 +369,10 @@ void CaptureUnit::onDequeueBuffer() {
 }
 
 int CaptureUnit::processPendingBuffers() {
-    LOG2("%s: buffers in device:%d", __func__, mDevices.front()->getBufferNumInDevice());
+    const int bufferNum = mDevices.front()->getBufferNumInDevice();
+    LOG2("%s: buffers in device:%d", __func__, bufferNum);
+    PERF_CAMERA_ATRACE_COUNTER(mBufferTraceName, bufferNum);
+    CameraContext::getInstance(mCameraId)->getStatistics()->setBuffersInDevice(bufferNum);
 
     while (mDevices.front()->getBufferNumInDevice() < mMaxBuffersInDevice) {
         for (auto device : mDevices) {
@@ -367,6 +383,8 @@ int CaptureUnit::processPendingBuffers() {
         }
 
         int ret = queueAllBuffers();
+        PERF_CAMERA_ATRACE_COUNTER(mBufferTraceName,
+                                   mDevices.front()->getBufferNumInDevice());
         if (mExitPending) {
             break;
         }
@@ -391,14 +409,16 @@ int CaptureUnit::poll() {
     CheckAndLogError(((mState != CAPTURE_CONFIGURE) && (mState != CAPTURE_START)),
                      INVALID_OPERATION, "@%s: poll buffer in wrong state %d", __func__, mState);
 
+    CheckAndLogError(mPoller == nullptr, INVALID_OPERATION, "@%s: no device to poll", __func__);
+
     int timeOutCount = poll_timeout_count;
-    std::vector<V4L2Device*> pollDevs, readyDevices;
     for (const auto& device : mDevices) {
-        pollDevs.push_back(device->getV4l2Device());
         LOG2("@%s: device:%s has %d buffers queued.", __func__, device->getName(),
              device->getBufferNumInDevice());
     }
 
+    mReadyDevices.clear();
+
     while (((timeOutCount--) != 0) && (ret == 0)) {
         // If stream off, no poll needed.
         if (mExitPending) {
@@ -407,8 +427,7 @@ int CaptureUnit::poll() {
             return -1;
         }
 
-        V4L2DevicePoller poller{pollDevs, mFlushFd[0]};
-        ret = poller.Poll(poll_timeout, POLLPRI | POLLIN | POLLOUT | POLLERR, &readyDevices);
+        ret = mPoller->Poll(poll_timeout, POLLPRI | POLLIN | POLLOUT | POLLERR, &mReadyDevices);
 
         LOG2("@%s: automation checkpoint: flag: poll_buffer, ret:%d", __func__, ret);
     }
@@ -425,7 +444,7 @@ int CaptureUnit::poll() {
         return OK;
     }
 
-    for (const auto& readyDevice : readyDevices) {
+    for (const auto& readyDevice : mReadyDevices) {
         for (auto device : mDevices) {
             if (device->getV4l2Device() == readyDevice) {
                 const int ret = device->dequeueBuffer();
@@ -16,6 +16,8 @@
 
 #pragma once
 #include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "CameraBuffer.h"
@@ -152,9 +154,13 @@ class CaptureUnit : public StreamSource, public DeviceCallback {
 
     int mCameraId;
     int mMaxBuffersInDevice;  // To control the number of buffers enqueued, for per-frame control.
+    const char* mBufferTraceName;  // Interned counter track name
 
     std::map<uuid, stream_t> mOutputFrameInfo;
     std::vector<DeviceBase*> mDevices;
+    // The poller of mDevices and its result, built with the devices not to allocate per frame
+    std::unique_ptr<V4L2DevicePoller> mPoller;
+    std::vector<V4L2Device*> mReadyDevices;
     uint32_t mMaxBufferNum;
 
     enum {
@@ -101,10 +101,15 @@ int CsiMetaDevice::initDev() {
 
     mConfiguredDevices.push_back(mCsiMetaDevice);
 
+    std::vector<V4L2Device*> pollDevs(mConfiguredDevices.begin(), mConfiguredDevices.end());
+    mPoller.reset(new V4L2DevicePoller(pollDevs, -1));
+    mReadyDevices.reserve(pollDevs.size());
+
     return OK;
 }
 
 void CsiMetaDevice::deinitDev() {
+    mPoller.reset();
     mConfiguredDevices.clear();
     if (mCsiMetaDevice != nullptr) {
         // Release V4L2 buffers
@@ -234,8 +239,6 @@ int CsiMetaDevice::poll() {
     const int poll_timeout_count = 10;
     const int poll_timeout = 1000;
 
-    std::vector<V4L2Device*> pollDevs;
-
     int ret = 0;
     int timeOutCount = poll_timeout_count;
 
@@ -246,14 +249,10 @@ int CsiMetaDevice::poll() {
         return OK;
     }
 
-    for (const auto& device : mConfiguredDevices) {
-        pollDevs.push_back(device);
-    }
-
-    std::vector<V4L2Device*> readyDevices;
+    CheckAndLogError(mPoller == nullptr, NO_INIT, "@%s, no device to poll", __func__);
+    mReadyDevices.clear();
     while (((timeOutCount--) != 0) && (ret == 0)) {
-        V4L2DevicePoller poller{pollDevs, -1};
-        ret = poller.Poll(poll_timeout, POLLPRI | POLLIN | POLLOUT | POLLERR, &readyDevices);
+        ret = mPoller->Poll(poll_timeout, POLLPRI | POLLIN | POLLOUT | POLLERR, &mReadyDevices);
 
         LOG2("@%s ing poll number buffer in devices: %d", __func__, mBuffersInCsiMetaDevice.load());
         if (mExitPending) {
@@ -19,6 +19,7 @@
 #include <v4l2_device.h>
 
 #include <atomic>
+#include <memory>
 #include <vector>
 
 #include "CameraBuffer.h"
@@ -83,6 +84,9 @@ class CsiMetaDevice : public EventSource {
     int mCameraId;
     V4L2VideoNode* mCsiMetaDevice;
     std::vector<V4L2VideoNode*> mConfiguredDevices;
+    // The poller of mConfiguredDevices and its result, not to allocate per frame
+    std::unique_ptr<V4L2DevicePoller> mPoller;
+    std::vector<V4L2Device*> mReadyDevices;
     EmbeddedMetaData mEmbeddedMetaData;
 
     // Guard for CsiMetaDevice public API
@@ -21,7 +21,10 @@
 
 #include "DeviceBase.h"
 
+#include "CameraContext.h"
 #include "CameraEventType.h"
+#include "CameraStatistics.h"
+#include "FrameTimeline.h"
 #include "PlatformData.h"
 #include "V4l2DeviceFactory.h"
 #include "iutils/CameraDump.h"
@@ -172,8 +175,8 @@ int DeviceBase::queueBuffer(int64_t sequence) {
 
         if (ret >= 0) {
             AutoMutex l(mBufferLock);
-            mPendingBuffers.pop_front();
-            mBuffersInDevice.push_back(buffer);
+            mPendingBuffers.pop();
+            mBuffersInDevice.push(buffer);
         } else {
             LOGE("%s, index:%u size:%u, memory:%u, used:%u", __func__, buffer->getIndex(),
                  buffer->getBufferSize(), buffer->getMemory(), buffer->getBytesused());
@@ -235,7 +238,7 @@ void DeviceBase::resetBuffers() {
     mBuffersInDevice.clear();
     mPendingBuffers.clear();
     for (const auto& buffer : mAllocatedBuffers) {
-        mPendingBuffers.push_back(buffer);
+        mPendingBuffers.push(buffer);
     }
 }
 
@@ -248,7 +251,7 @@ bool DeviceBase::hasPendingBuffer() {
 void DeviceBase::addPendingBuffer(const shared_ptr<CameraBuffer>& buffer) {
     AutoMutex l(mBufferLock);
 
-    mPendingBuffers.push_back(buffer);
+    mPendingBuffers.push(buffer);
 }
 
 int64_t DeviceBase::getPredictSequence() {
@@ -270,11 +273,11 @@ void DeviceBase::popBufferFromDevice() {
     }
 
     shared_ptr<CameraBuffer> camBuffer = mBuffersInDevice.front();
-    mBuffersInDevice.pop_front();
+    mBuffersInDevice.pop();
     mLatestSequence = camBuffer->getSequence();
 
     if (mNeedSkipFrame) {
-        mPendingBuffers.push_back(camBuffer);
+        mPendingBuffers.push(camBuffer);
     }
 }
 
@@ -337,7 +340,20 @@ int MainDevice::createBufferPool(const stream_t& config) {
 int MainDevice::onDequeueBuffer(shared_ptr<CameraBuffer> buffer) {
     mDeviceCB->onDequeueBuffer();
 
+    CameraContext* cameraContext = CameraContext::getInstance(DeviceBase::mCameraId);
+    CameraStatistics* statistics = cameraContext->getStatistics();
+    FrameTimeline* timeline = cameraContext->getFrameTimeline();
+    if ((timeline != nullptr) && (DeviceBase::mPort == MAIN_INPUT_PORT_UID)) {
+        timeline->recordEvent(buffer->getSequence(), TIMELINE_ISYS_DONE);
+    }
+
     if (DeviceBase::mNeedSkipFrame) {
+        if (DeviceBase::mPort == MAIN_INPUT_PORT_UID) {
+            statistics->onFrameSkipped();
+            if (timeline != nullptr) {
+                timeline->recordFlags(buffer->getSequence(), FRAME_TIMELINE_FLAG_ISYS_SKIPPED);
+            }
+        }
         return OK;
     }
 
@@ -352,6 +368,8 @@ int MainDevice::onDequeueBuffer(shared_ptr<CameraBuffer> buffer) {
     }
 
     if (DeviceBase::mPort == MAIN_INPUT_PORT_UID) {
+        statistics->onIsysFrame(buffer->getSequence(), buffer->getTimestamp());
+
         EventData frameData;
         frameData.type = EVENT_ISYS_FRAME;
         frameData.buffer = nullptr;
@@ -16,7 +16,6 @@
 
 #pragma once
 #include <atomic>
-#include <list>
 #include <set>
 
 #include <v4l2_device.h>
@@ -143,9 +142,9 @@ class DeviceBase : public EventSource {
      */
     std::vector<std::shared_ptr<CameraBuffer>> mAllocatedBuffers;
     // Save all buffers allocated internally.
-    std::list<std::shared_ptr<CameraBuffer>> mPendingBuffers;
+    CameraBufQ mPendingBuffers;
     // The buffers that are going to be queued.
-    std::list<std::shared_ptr<CameraBuffer>> mBuffersInDevice;  // The buffers that have been queued
+    CameraBufQ mBuffersInDevice;  // The buffers that have been queued
     Mutex mBufferLock;  // The lock for protecting the internal buffers.
 
     uint32_t mMaxBufferNumber;
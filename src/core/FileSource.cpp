@@ -20,11 +20,13 @@
 
 #include <dirent.h>
 #include <expat.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <algorithm>
-#include <fstream>
 #include <utility>
 
 #include "PlatformData.h"
@@ -38,12 +40,96 @@ using std::vector;
 
 namespace icamera {
 
+FrameFileCache::~FrameFileCache() {
+    for (auto& item : mFrameFiles) {
+        if (item.second.addr != nullptr) {
+            (void)munmap(item.second.addr, item.second.size);
+        }
+    }
+}
+
+FrameFileCache::FrameFile* FrameFileCache::getFrameFileLocked(const string& fileName) {
+    auto it = mFrameFiles.find(fileName);
+    if (it != mFrameFiles.end()) {
+        return (it->second.addr != nullptr) ? &it->second : nullptr;
+    }
+
+    // Save the failed file as well to avoid opening it for every frame
+    FrameFile& frameFile = mFrameFiles[fileName];
+    frameFile.addr = nullptr;
+    frameFile.size = 0U;
+    frameFile.populated = false;
+
+    const int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    CheckAndLogError(fd < 0, nullptr, "Cannot open frame file:%s", fileName.c_str());
+
+    struct stat statBuf;
+    if ((fstat(fd, &statBuf) == 0) && (statBuf.st_size > 0)) {
+        /*
+         * Private writable mapping: PSYS may pin the pages for write when the mapping is
+         * handed out, and any write goes to a private copy instead of the file.
+         */
+        void* addr = mmap(nullptr, statBuf.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            frameFile.addr = addr;
+            frameFile.size = statBuf.st_size;
+        }
+    }
+    (void)close(fd);
+    CheckAndLogError(frameFile.addr == nullptr, nullptr, "Cannot map frame file:%s, %s",
+                     fileName.c_str(), strerror(errno));
+
+    LOG2("%s: frame file:%s, size %zu, addr %p", __func__, fileName.c_str(), frameFile.size,
+         frameFile.addr);
+    return &frameFile;
+}
+
+const FrameFileCache::FrameFile* FrameFileCache::getFrameFile(const string& fileName) {
+    std::lock_guard<std::mutex> l(mLock);
+    return getFrameFileLocked(fileName);
+}
+
+void FrameFileCache::readAhead(const string& fileName, bool populate) {
+    void* addr = nullptr;
+    size_t size = 0U;
+    {
+        std::lock_guard<std::mutex> l(mLock);
+        FrameFile* frameFile = getFrameFileLocked(fileName);
+        if ((frameFile == nullptr) || frameFile->populated) {
+            return;
+        }
+        addr = frameFile->addr;
+        size = frameFile->size;
+        if (populate) {
+            frameFile->populated = true;
+        }
+    }
+
+    // Start the read ahead of the page cache, it doesn't wait for the IO
+    (void)madvise(addr, size, MADV_WILLNEED);
+    if (!populate) {
+        return;
+    }
+
+    // Fault in the pages, then the copy or PSYS pinning doesn't stall on the disk
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    const volatile char* data = static_cast<const volatile char*>(addr);
+    for (size_t offset = 0U; offset < size; offset += pageSize) {
+        (void)data[offset];
+    }
+}
+
 FileSource::FileSource(int cameraId)
         : StreamSource(V4L2_MEMORY_USERPTR),
           mCameraId(cameraId),
           mExitPending(false),
           mFps(30.0),
-          mSequence(-1) {
+          mSequence(-1),
+          mReadAheadSequence(-1),
+          mStartTime(0),
+          mLastFrameTime(0),
+          mReportTime(0),
+          mReportSequence(-1) {
     LOG1("%s: FileSource is created for debugging.", __func__);
 
     const char* injectedFile = PlatformData::getInjectedFile();
@@ -78,9 +164,11 @@ FileSource::FileSource(int cameraId)
     mOutputPorts.clear();
 
     mProduceThread = new ProduceThread(this);
+    mReadAheadThread = new ReadAheadThread(this);
 }
 
 FileSource::~FileSource() {
+    delete mReadAheadThread;
     delete mProduceThread;
 }
 
@@ -107,54 +195,66 @@ int FileSource::configure(const map<uuid, stream_t>& outputFrames) {
     return OK;
 }
 
-int FileSource::allocateSourceBuffer() {
-    const int fmt = mStreamConfig.format;
-    const int width = mStreamConfig.width;
-    const int height = mStreamConfig.height;
-    // Get frame size with aligned height taking in count for internal buffers.
-    const uint32_t size = CameraUtils::getFrameSize(fmt, width, height, true);
-    map<int, string> frameFileName;
+int FileSource::prepareFrameFiles() {
+    mFrameFileNames.clear();
     if (mInjectionWay == USING_CONFIG_FILE) {
         FileSourceProfile profile(mInjectedFile);
+        map<int, string> frameFileName;
         const int ret = profile.getFrameFiles(mCameraId, frameFileName);
         CheckAndLogError(ret != OK, BAD_VALUE, "Cannot find the frame files");
         for (const auto& item : frameFileName)
-            frameFileName[item.first] = profile.getFrameFile(mCameraId, item.first);
+            mFrameFileNames[item.first] = profile.getFrameFile(mCameraId, item.first);
+        mFps = profile.getFps(mCameraId);
     } else if (mInjectionWay == USING_INJECTION_PATH) {
         int ret = access(mInjectedFile.c_str(), 0);
         CheckAndLogError(ret != OK, BAD_VALUE, "Cannot access: %s", mInjectedFile.c_str());
         FileSourceFromDir fSource(mInjectedFile);
-        ret = fSource.getInjectionFileInfo(&frameFileName);
+        ret = fSource.getInjectionFileInfo(&mFrameFileNames);
         CheckAndLogError(ret != OK, BAD_VALUE, "Cannot find the frame files");
     } else if (mInjectionWay == USING_FRAME_FILE) {
-        frameFileName[0] = mInjectedFile;
+        mFrameFileNames[0] = mInjectedFile;
     } else {
         CheckAndLogError(
             (mInjectionWay < USING_FRAME_FILE) || (mInjectionWay >= UNKNOWN_INJECTED_WAY),
              BAD_VALUE, "Invalid Injected Way");
     }
 
-    for (const auto& item : frameFileName) {
-        string fileName = item.second;
-        // Prepare the buffers to read the files for frame
-        shared_ptr<CameraBuffer> buf = CameraBuffer::create(V4L2_MEMORY_USERPTR, size, 0, fmt,
-                                                            width, height);
-        CheckAndLogError(buf == nullptr, BAD_VALUE, "@%s: Allocate producer buffer failed",
-                         __func__);
-        fillFrameBuffer(fileName, buf);
-        mFrameFileBuffers[fileName] = buf;
+    // Map all the files, their pages are read in the read ahead thread
+    for (const auto& item : mFrameFileNames) {
+        CheckAndLogError(mFrameFileCache.getFrameFile(item.second) == nullptr, BAD_VALUE,
+                         "@%s: Failed to map frame file %s", __func__, item.second.c_str());
     }
     return OK;
 }
 
+/**
+ * Find the frame file which is the equal or most closest to the given sequence.
+ */
+string FileSource::getFrameFileName(int64_t sequence) {
+    auto it = mFrameFileNames.upper_bound(static_cast<int>(sequence));
+    if (it == mFrameFileNames.begin()) {
+        return string();
+    }
+    --it;
+    return it->second;
+}
+
 int FileSource::start() {
     LOG1("%s", __func__);
 
     AutoMutex l(mLock);
 
-    (void)allocateSourceBuffer();
+    (void)prepareFrameFiles();
     mSequence = -1;
     mExitPending = false;
+    mStartTime = 0;
+    mLastFrameTime = 0;
+    mReportSequence = -1;
+    {
+        std::lock_guard<std::mutex> lock(mReadAheadLock);
+        mReadAheadSequence = 0;
+    }
+    mReadAheadThread->start();
     mProduceThread->start();
 
     return OK;
@@ -169,15 +269,25 @@ int FileSource::stop() {
         mProduceThread->exit();
         mBufferSignal.notify_one();
     }
+    {
+        std::lock_guard<std::mutex> lock(mReadAheadLock);
+        mReadAheadThread->exit();
+        mReadAheadSignal.notify_one();
+    }
 
     mProduceThread->wait();
-    mFrameFileBuffers.clear();
+    mReadAheadThread->wait();
+    reportFps(true);
 
+    // The files are still mapped, and they are reused in the next start.
+    AutoMutex l(mLock);
     for (auto &bufQueue : mBufferQueue) {
         while (bufQueue.second.size() > 0) {
             bufQueue.second.pop();
         }
     }
+    mHeldBuffers.clear();
+    mMappedBuffers.clear();
 
     return OK;
 }
@@ -187,7 +297,15 @@ int FileSource::qbuf(uuid port, const shared_ptr<CameraBuffer>& camBuffer) {
 
     AutoMutex l(mLock);
     const bool needSignal = mBufferQueue[port].empty();
-    mBufferQueue[port].push(camBuffer);
+    // The file mapping is returned, queue the buffer of consumer back
+    if (mMappedBuffers.erase(camBuffer.get()) != 0U) {
+        CameraBufQ& heldBuffers = mHeldBuffers[port];
+        CheckAndLogError(heldBuffers.empty(), UNKNOWN_ERROR, "No buffer held for port:%x", port);
+        mBufferQueue[port].push(heldBuffers.front());
+        heldBuffers.pop();
+    } else {
+        mBufferQueue[port].push(camBuffer);
+    }
     if (needSignal) {
         mBufferSignal.notify_one();
     }
@@ -214,7 +332,7 @@ bool FileSource::produce() {
             if (mExitPending) {
                 return false;
             }
-            std::cv_status ret;
+            std::cv_status ret = std::cv_status::no_timeout;
             if (bufQueue.second.empty()) {
                 ret = mBufferSignal.wait_for(lock, std::chrono::nanoseconds(kWaitDuration));
             }
@@ -229,6 +347,12 @@ bool FileSource::produce() {
 
     notifySofEvent();
 
+    {
+        std::lock_guard<std::mutex> lock(mReadAheadLock);
+        mReadAheadSequence = mSequence + 1;
+        mReadAheadSignal.notify_one();
+    }
+
     clock_gettime(CLOCK_MONOTONIC, &end);
     const long seconds = end.tv_sec - start.tv_sec;
     const long nSeconds = end.tv_nsec - start.tv_nsec;
@@ -257,69 +381,103 @@ bool FileSource::produce() {
     }
 
     for (auto& buf : qBuffer) {
+        buf.second = fillFrameBuffer(buf.first, buf.second);
         buf.second->setSequence(mSequence);
         buf.second->setTimestamp(stamp);
-        fillFrameBuffer(buf.second);
     }
 
     notifyFrame(qBuffer);
+    reportFps(false);
 
     return !mExitPending;
 }
 
-void FileSource::fillFrameBuffer(string fileName, shared_ptr<CameraBuffer>& buffer) {
-    CheckAndLogError(fileName.empty(), VOID_VALUE, "Invalid frame file.");
-    LOG2("Read frame from frame file:%s", fileName.c_str());
-
-    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
-    CheckAndLogError(!file.is_open(), VOID_VALUE, "Cannot open frame file:%s", fileName.c_str());
-
-    const size_t fileSize = file.tellg();
-    file.seekg(0, std::ios::beg);
+/**
+ * The thread loop function that's used to read the upcoming frame files into memory.
+ */
+bool FileSource::readAhead() {
+    int64_t sequence = -1;
+    {
+        std::unique_lock<std::mutex> lock(mReadAheadLock);
+        while ((mReadAheadSequence < 0) && (!mExitPending)) {
+            mReadAheadSignal.wait(lock);
+        }
+        if (mExitPending) {
+            return false;
+        }
+        sequence = mReadAheadSequence;
+        mReadAheadSequence = -1;
+    }
 
-    CheckWarningNoReturn(fileSize < buffer->getBufferSize(),
-                         "The size of file:%s is less than buffer's requirement.",
-                         fileName.c_str());
-    file.read(reinterpret_cast<char*>(buffer->getBufferAddr()),
-              std::min(fileSize, static_cast<size_t>(buffer->getBufferSize())));
+    for (int64_t seq = sequence; seq < sequence + kReadAheadFrames; seq++) {
+        const string fileName = getFrameFileName(seq);
+        if (!fileName.empty()) {
+            mFrameFileCache.readAhead(fileName, true);
+        }
+    }
+    return true;
 }
 
-void FileSource::fillFrameBuffer(shared_ptr<CameraBuffer>& buffer) {
-    string fileName;
-
-    if (mInjectionWay == USING_CONFIG_FILE) {
-        FileSourceProfile profile(mInjectedFile);
-        fileName = profile.getFrameFile(mCameraId, mSequence);
-        mFps = profile.getFps(mCameraId);
-    } else if (mInjectionWay == USING_INJECTION_PATH) {
-        if (access(mInjectedFile.c_str(), 0) != 0) {
-            LOGE("Cannot access:  %s for fillFrameBuffer", mInjectedFile.c_str());
+void FileSource::reportFps(bool finished) {
+    if (finished) {
+        if ((mSequence > 0) && (mLastFrameTime > mStartTime)) {
+            LOGI("<id%d>FileSource produced %ld frames, achieved %.2f fps, configured %.2f fps",
+                 mCameraId, mSequence + 1,
+                 mSequence * 1000000000.0 / (mLastFrameTime - mStartTime), mFps);
         }
-        map<int, string> frameFileName;
-        FileSourceFromDir fSource(mInjectedFile);
-        const int ret = fSource.getInjectionFileInfo(&frameFileName);
-        if (ret != OK) {
-            LOGE("Cannot find the frame files for fillFrameBuffer");
-        }
-        fileName = fSource.getFrameFile(frameFileName, mSequence);
-    } else if (mInjectionWay == USING_FRAME_FILE) {
-        fileName = mInjectedFile;
-    } else {
-        LOGE("Invalid Injected Way for fillFrameBuffer");
+        return;
     }
 
-    CheckAndLogError(fileName.empty(), VOID_VALUE, "Invalid frame file.");
+    const nsecs_t now = CameraUtils::systemTime();
+    mLastFrameTime = now;
+    if (mStartTime == 0) {
+        mStartTime = now;
+        mReportTime = now;
+        mReportSequence = mSequence;
+        return;
+    }
+
+    if (now - mReportTime >= kFpsReportInterval) {
+        LOG1("<id%d>FileSource achieved %.2f fps, configured %.2f fps", mCameraId,
+             (mSequence - mReportSequence) * 1000000000.0 / (now - mReportTime), mFps);
+        mReportTime = now;
+        mReportSequence = mSequence;
+    }
+}
+
+/**
+ * Fill the frame file of mSequence into the buffer.
+ *
+ * \return the buffer to be sent to the consumer, which is the file mapping for zero-copy.
+ */
+shared_ptr<CameraBuffer> FileSource::fillFrameBuffer(uuid port, shared_ptr<CameraBuffer>& buffer) {
+    const string fileName = getFrameFileName(mSequence);
+    CheckAndLogError(fileName.empty(), buffer, "Invalid frame file for sequence:%ld", mSequence);
+
+    const FrameFileCache::FrameFile* frameFile = mFrameFileCache.getFrameFile(fileName);
+    CheckAndLogError(frameFile == nullptr, buffer, "Not find the framefile: %s",
+                     fileName.c_str());
     LOG2("<seq%ld>Frame uses frame file:%s, buffer %p", mSequence, fileName.c_str(),
          buffer->getBufferAddr());
 
-    for (auto& item : mFrameFileBuffers) {
-        if (fileName.compare(item.first) == 0) {
-            MEMCPY_S((buffer->getBufferAddr()), buffer->getBufferSize(),
-                     (item.second->getBufferAddr()), item.second->getBufferSize());
-            return;
+    const size_t bufferSize = buffer->getBufferSize();
+    if ((buffer->getMemory() == V4L2_MEMORY_USERPTR) && (frameFile->size >= bufferSize)) {
+        shared_ptr<CameraBuffer> mappedBuffer =
+            CameraBuffer::create(buffer->getWidth(), buffer->getHeight(), bufferSize,
+                                 buffer->getFormat(), buffer->getIndex(), frameFile->addr);
+        if (mappedBuffer != nullptr) {
+            AutoMutex l(mLock);
+            mHeldBuffers[port].push(buffer);
+            mMappedBuffers.insert(mappedBuffer.get());
+            return mappedBuffer;
         }
     }
-    LOGE("Not find the framefile: %s", fileName.c_str());
+
+    CheckWarningNoReturn(frameFile->size < bufferSize,
+                         "The size of file:%s is less than buffer's requirement.",
+                         fileName.c_str());
+    MEMCPY_S(buffer->getBufferAddr(), bufferSize, frameFile->addr, frameFile->size);
+    return buffer;
 }
 
 void FileSource::notifyFrame(std::map<uuid, std::shared_ptr<CameraBuffer>> buffers) {
@@ -652,24 +810,28 @@ string FileSourceFromDir::getFrameFile(const map<int, string>& frameFilesInfo, i
     return frameFilesInfo.at(targetSequence);
 }
 
+string FileSourceFromDir::getInjectionFile(uint32_t index) {
+    if (mInjectionPath.back() == '/') {
+        return mInjectionPath + mInjectionFiles[index];
+    }
+    return mInjectionPath + "/" + mInjectionFiles[index];
+}
+
 void FileSourceFromDir::fillFrameBuffer(void* addr, size_t bufferSize, uint32_t sequence) {
     if ((mInjectionFiles.size() == 0) || (addr == nullptr)) {
         return;
     }
 
     const uint32_t index = sequence % mInjectionFiles.size();
-    string fileName;
-    if (mInjectionPath.back() == '/') {
-        fileName = mInjectionPath + mInjectionFiles[index];
-    } else {
-        fileName = mInjectionPath + "/" + mInjectionFiles[index];
-    }
-    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
-    CheckAndLogError(!file.is_open(), VOID_VALUE, "Cannot open frame file:%s", fileName.c_str());
+    const string fileName = getInjectionFile(index);
+    const FrameFileCache::FrameFile* frameFile = mFrameFileCache.getFrameFile(fileName);
+    CheckAndLogError(frameFile == nullptr, VOID_VALUE, "Cannot open frame file:%s",
+                     fileName.c_str());
+
+    // Read the next file in background while this frame is processed
+    mFrameFileCache.readAhead(getInjectionFile((index + 1) % mInjectionFiles.size()), false);
 
-    const size_t fileSize = file.tellg();
-    file.seekg(0, std::ios::beg);
-    file.read(reinterpret_cast<char*>(addr), std::min(fileSize, bufferSize));
+    MEMCPY_S(addr, bufferSize, frameFile->addr, frameFile->size);
 }
 
 int DummyImageSource::init() {
@@ -16,12 +16,55 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+#include <unordered_set>
+
 #include "StreamSource.h"
 #include "iutils/Thread.h"
 #include "PlatformData.h"
 
 namespace icamera {
 
+/**
+ * \class FrameFileCache
+ *
+ * It keeps the frame files mapped in memory, so that the frames are copied from the page
+ * cache instead of being read from the disk in the producer thread.
+ * The mappings are kept until the cache is destroyed, because the addresses may be still
+ * registered to PSYS by the zero-copy consumers.
+ */
+class FrameFileCache {
+ public:
+    struct FrameFile {
+        void* addr;
+        size_t size;
+        bool populated;
+    };
+
+    FrameFileCache() {}
+    ~FrameFileCache();
+
+    // Map the file if it isn't mapped yet, return nullptr if it can't be mapped.
+    const FrameFile* getFrameFile(const std::string& fileName);
+    /**
+     * Start reading the file into the page cache in background.
+     *
+     * \param populate: also fault in the pages, it blocks until the file is read.
+     */
+    void readAhead(const std::string& fileName, bool populate);
+
+ private:
+    FrameFile* getFrameFileLocked(const std::string& fileName);
+
+ private:
+    std::mutex mLock;
+    std::map<std::string, FrameFile> mFrameFiles;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(FrameFileCache);
+};
+
 /**
  * \class FileSource
  *
@@ -37,6 +80,10 @@ namespace icamera {
  * 3. The third mode which can inject files in sequence by specifying injection folder path.
  *    How to enable: export cameraInjectFile="Injection Folder"
  *    ("Injection Folder" is the specified injection folder path you want to run file injection)
+ *
+ * The frame files are mapped in memory and the upcoming frames are read ahead in a helper
+ * thread. If the consumer queues a userptr buffer which isn't larger than the frame file,
+ * the mapping of the file is handed to the consumer without copy.
  */
 class FileSource : public StreamSource {
  public:
@@ -62,11 +109,13 @@ class FileSource : public StreamSource {
 
  private:
     bool produce();
-    int allocateSourceBuffer();
-    void fillFrameBuffer(std::shared_ptr<CameraBuffer>& buffer);
-    void fillFrameBuffer(std::string fileName, std::shared_ptr<CameraBuffer>& buffer);
+    bool readAhead();
+    int prepareFrameFiles();
+    std::string getFrameFileName(int64_t sequence);
+    std::shared_ptr<CameraBuffer> fillFrameBuffer(uuid port, std::shared_ptr<CameraBuffer>& buffer);
     void notifyFrame(std::map<uuid, std::shared_ptr<CameraBuffer>> buffers);
     void notifySofEvent();
+    void reportFps(bool finished);
 
  protected:
     float mFps;
@@ -98,7 +147,26 @@ class FileSource : public StreamSource {
         virtual bool threadLoop() { return mFileSrc->produce(); }
     };
 
+    class ReadAheadThread : public Thread {
+        FileSource* mFileSrc;
+
+     public:
+        explicit ReadAheadThread(FileSource* fileSource) : mFileSrc(fileSource) {}
+
+        virtual void run() {
+            bool ret = true;
+            while (ret) {
+                ret = mFileSrc->readAhead();
+            }
+        }
+    };
+
+    // The number of the frames read ahead of the producing sequence
+    static const int kReadAheadFrames = 4;
+    static const nsecs_t kFpsReportInterval = 1000000000;  // 1s
+
     ProduceThread* mProduceThread;
+    ReadAheadThread* mReadAheadThread;
     int mCameraId;
     bool mExitPending;
     int64_t mSequence;
@@ -106,11 +174,26 @@ class FileSource : public StreamSource {
     std::set<uuid> mOutputPorts;
 
     std::vector<BufferConsumer*> mBufferConsumerList;
-    std::map<std::string, std::shared_ptr<CameraBuffer>> mFrameFileBuffers;
+    // Frame file of each sequence, the nearest lower one is used for the missing sequence
+    std::map<int, std::string> mFrameFileNames;
+    FrameFileCache mFrameFileCache;
     std::map<uuid, CameraBufQ> mBufferQueue;
+    // The buffers of the consumer are held here while the file mappings are handed out
+    std::map<uuid, CameraBufQ> mHeldBuffers;
+    std::unordered_set<CameraBuffer*> mMappedBuffers;
     std::condition_variable mBufferSignal;
     // Guard for FileSource Public API
     Mutex mLock;
+
+    std::mutex mReadAheadLock;
+    std::condition_variable mReadAheadSignal;
+    int64_t mReadAheadSequence;
+
+    // Achieved fps
+    nsecs_t mStartTime;
+    nsecs_t mLastFrameTime;
+    nsecs_t mReportTime;
+    int64_t mReportSequence;
 };
 
 /**
@@ -178,9 +261,13 @@ class FileSourceFromDir {
     std::string getFrameFile(const std::map<int, std::string>& frameFilesInfo, int64_t sequence);
     void fillFrameBuffer(void* addr, size_t bufferSize, uint32_t sequence);
 
+ private:
+    std::string getInjectionFile(uint32_t index);
+
  private:
     std::string mInjectionPath;
     std::vector<std::string> mInjectionFiles;
+    FrameFileCache mFrameFileCache;
 };
 
 class DummyImageSource : public FileSource {
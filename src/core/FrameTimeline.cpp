@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG FrameTimeline
+
+#include "FrameTimeline.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "iutils/CameraLog.h"
+
+namespace icamera {
+
+static std::once_flag gTimelineOnce;
+static std::string gTimelineDir;
+
+bool FrameTimeline::isEnabled() {
+    std::call_once(gTimelineOnce, [] {
+        const char* timelineDir = getenv("cameraTimeline");
+        if (timelineDir != nullptr) {
+            gTimelineDir = timelineDir;
+        }
+    });
+
+    return !gTimelineDir.empty();
+}
+
+FrameTimeline::FrameTimeline(int cameraId)
+        : mCameraId(cameraId),
+          mAddr(MAP_FAILED),
+          mSize(0U),
+          mHeader(nullptr),
+          mRecords(nullptr) {
+    const std::string fileName = gTimelineDir + "/camtimeline_" + std::to_string(getpid()) +
+                                 "_" + std::to_string(cameraId) + ".bin";
+
+    const int fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    CheckAndLogError(fd < 0, VOID_VALUE, "Failed to open %s, error %s", fileName.c_str(),
+                     strerror(errno));
+
+    mSize = FRAME_TIMELINE_RECORD_OFFSET +
+            FRAME_TIMELINE_RECORD_COUNT * sizeof(FrameTimelineRecord);
+    if (ftruncate(fd, mSize) == 0) {
+        mAddr = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    (void)close(fd);
+    CheckAndLogError(mAddr == MAP_FAILED, VOID_VALUE, "Failed to map %s, error %s",
+                     fileName.c_str(), strerror(errno));
+
+    mHeader = static_cast<FrameTimelineHeader*>(mAddr);
+    MEMCPY_S(mHeader->magic, sizeof(mHeader->magic), FRAME_TIMELINE_MAGIC,
+             sizeof(mHeader->magic));
+    mHeader->version = FRAME_TIMELINE_VERSION;
+    mHeader->recordSize = sizeof(FrameTimelineRecord);
+    mHeader->recordCount = FRAME_TIMELINE_RECORD_COUNT;
+    mHeader->cameraId = cameraId;
+    mHeader->pid = static_cast<uint32_t>(getpid());
+    mRecords = reinterpret_cast<FrameTimelineRecord*>(static_cast<char*>(mAddr) +
+                                                      FRAME_TIMELINE_RECORD_OFFSET);
+    reset();
+
+    LOG1("<id%d>@%s, record frame timeline to %s", mCameraId, __func__, fileName.c_str());
+}
+
+FrameTimeline::~FrameTimeline() {
+    if (mAddr != MAP_FAILED) {
+        (void)munmap(mAddr, mSize);
+    }
+}
+
+void FrameTimeline::reset() {
+    std::lock_guard<std::mutex> l(mLock);
+    if (mRecords == nullptr) {
+        return;
+    }
+
+    memset(mRecords, 0, FRAME_TIMELINE_RECORD_COUNT * sizeof(FrameTimelineRecord));
+    mStaleRecords.reset();
+    for (int i = 0; i < FRAME_TIMELINE_RECORD_COUNT; i++) {
+        mRecords[i].sequence = -1;
+        mRecords[i].ccaId = -1;
+    }
+}
+
+void FrameTimeline::markStale() {
+    std::lock_guard<std::mutex> l(mLock);
+    mStaleRecords.set();
+}
+
+int FrameTimeline::registerStage(const std::string& name) {
+    std::lock_guard<std::mutex> l(mLock);
+    if (mHeader == nullptr) {
+        return -1;
+    }
+
+    for (uint32_t i = 0U; i < mHeader->stageCount; i++) {
+        if (strncmp(mHeader->stageName[i], name.c_str(), FRAME_TIMELINE_NAME_LEN - 1) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+    CheckWarning(mHeader->stageCount >= FRAME_TIMELINE_MAX_STAGES, -1,
+                 "Too many stages, %s isn't recorded", name.c_str());
+
+    const uint32_t stage = mHeader->stageCount;
+    snprintf(mHeader->stageName[stage], FRAME_TIMELINE_NAME_LEN, "%s", name.c_str());
+    mHeader->stageCount++;
+    return static_cast<int>(stage);
+}
+
+FrameTimelineRecord* FrameTimeline::getRecordLocked(int64_t sequence) {
+    if ((mRecords == nullptr) || (sequence < 0)) {
+        return nullptr;
+    }
+
+    const size_t index = static_cast<size_t>(sequence % FRAME_TIMELINE_RECORD_COUNT);
+    FrameTimelineRecord* record = &mRecords[index];
+    if (mStaleRecords.test(index)) {
+        // Recorded before the streams restarted, any sequence is newer
+        mStaleRecords.reset(index);
+        record->sequence = -1;
+    } else if (record->sequence > sequence) {
+        // Too late, the slot is used by a newer sequence
+        return nullptr;
+    }
+    if (record->sequence != sequence) {
+        // Reuse the slot of an old sequence
+        memset(record, 0, sizeof(FrameTimelineRecord));
+        record->sequence = sequence;
+        record->ccaId = -1;
+    }
+    return record;
+}
+
+void FrameTimeline::recordEvent(int64_t sequence, FrameTimelineEvent event, uint64_t timeNs) {
+    if (timeNs == 0U) {
+        timeNs = static_cast<uint64_t>(CameraUtils::systemTime());
+    }
+
+    std::lock_guard<std::mutex> l(mLock);
+    FrameTimelineRecord* record = getRecordLocked(sequence);
+    if (record == nullptr) {
+        return;
+    }
+    // Multiple streams: keep the first begin and dqbuf, and the last end of the frame
+    if ((record->eventTime[event] != 0U) &&
+        ((event == TIMELINE_POST_PROCESS_BEGIN) || (event == TIMELINE_DQBUF))) {
+        return;
+    }
+    record->eventTime[event] = timeNs;
+}
+
+void FrameTimeline::recordStage(int64_t sequence, int stage, bool done) {
+    if ((stage < 0) || (stage >= FRAME_TIMELINE_MAX_STAGES)) {
+        return;
+    }
+    const uint64_t timeNs = static_cast<uint64_t>(CameraUtils::systemTime());
+
+    std::lock_guard<std::mutex> l(mLock);
+    FrameTimelineRecord* record = getRecordLocked(sequence);
+    if (record != nullptr) {
+        if (done) {
+            record->stageDone[stage] = timeNs;
+        } else {
+            record->stageSubmit[stage] = timeNs;
+        }
+    }
+}
+
+void FrameTimeline::recordFlags(int64_t sequence, uint32_t flags) {
+    std::lock_guard<std::mutex> l(mLock);
+    FrameTimelineRecord* record = getRecordLocked(sequence);
+    if (record != nullptr) {
+        record->flags |= flags;
+    }
+}
+
+void FrameTimeline::recordCcaId(int64_t sequence, int64_t ccaId) {
+    std::lock_guard<std::mutex> l(mLock);
+    FrameTimelineRecord* record = getRecordLocked(sequence);
+    if (record != nullptr) {
+        record->ccaId = ccaId;
+    }
+}
+
+}  // namespace icamera
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <bitset>
+#include <mutex>
+#include <string>
+
+#include "iutils/Utils.h"
+
+namespace icamera {
+
+/**
+ * Frame timeline recorder, enabled by "export cameraTimeline=<dir>", e.g. /var/tmp.
+ *
+ * It keeps one record per frame sequence in a shared file mapping
+ * <dir>/camtimeline_<pid>_<cameraId>.bin, which survives a crash of the process and is
+ * decoded by camtimeline_analyzer. The file layout is:
+ *   FrameTimelineHeader              at offset 0
+ *   FrameTimelineRecord[recordCount] at FRAME_TIMELINE_RECORD_OFFSET, the record of
+ *                                    a sequence is stored in slot (sequence % recordCount)
+ * All the times are CLOCK_MONOTONIC in ns, 0 means the event didn't happen.
+ */
+#define FRAME_TIMELINE_MAGIC "CAMTLINE"
+#define FRAME_TIMELINE_VERSION 1
+#define FRAME_TIMELINE_RECORD_COUNT 1024
+#define FRAME_TIMELINE_MAX_STAGES 8
+#define FRAME_TIMELINE_NAME_LEN 32
+#define FRAME_TIMELINE_RECORD_OFFSET 4096
+
+enum FrameTimelineEvent {
+    TIMELINE_SOF = 0,
+    TIMELINE_EXPOSURE_APPLIED,  // Exposure of a 3A result is written to sensor in this frame
+    TIMELINE_ISYS_DONE,
+    TIMELINE_POST_PROCESS_BEGIN,
+    TIMELINE_POST_PROCESS_END,
+    TIMELINE_DQBUF,  // The first buffer of the frame is dequeued by the app
+    TIMELINE_EVENT_MAX,
+};
+
+// The frame is captured by ISYS but skipped, e.g. initial skip frames or buffer error
+#define FRAME_TIMELINE_FLAG_ISYS_SKIPPED (1U << 0)
+
+struct FrameTimelineHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t recordCount;
+    uint32_t stageCount;
+    int32_t cameraId;
+    uint32_t pid;
+    char stageName[FRAME_TIMELINE_MAX_STAGES][FRAME_TIMELINE_NAME_LEN];
+};
+
+struct FrameTimelineRecord {
+    int64_t sequence;  // -1 if the slot is unused
+    int64_t ccaId;     // The 3A run whose result takes effect in this frame, -1 if unknown
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t eventTime[TIMELINE_EVENT_MAX];
+    uint64_t stageSubmit[FRAME_TIMELINE_MAX_STAGES];
+    uint64_t stageDone[FRAME_TIMELINE_MAX_STAGES];
+};
+
+class FrameTimeline {
+ public:
+    static bool isEnabled();
+
+    explicit FrameTimeline(int cameraId);
+    ~FrameTimeline();
+
+    // Clear all the records, called when the streams are configured
+    void reset();
+    // The sequences restart when the streams start again, so the records of the stopped
+    // streams are kept until the slots are used by the new frames
+    void markStale();
+
+    /**
+     * Get the stage index of the name, a new index is allocated for a new name.
+     *
+     * \return the stage index, -1 if there are too many stages
+     */
+    int registerStage(const std::string& name);
+
+    // timeNs is 0 to use the current time
+    void recordEvent(int64_t sequence, FrameTimelineEvent event, uint64_t timeNs = 0U);
+    void recordStage(int64_t sequence, int stage, bool done);
+    void recordFlags(int64_t sequence, uint32_t flags);
+    void recordCcaId(int64_t sequence, int64_t ccaId);
+
+ private:
+    FrameTimelineRecord* getRecordLocked(int64_t sequence);
+
+ private:
+    int mCameraId;
+
+    std::mutex mLock;
+    void* mAddr;
+    size_t mSize;
+    FrameTimelineHeader* mHeader;
+    FrameTimelineRecord* mRecords;
+    // The slots recorded before the last stop, overwritten by any sequence
+    std::bitset<FRAME_TIMELINE_RECORD_COUNT> mStaleRecords;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(FrameTimeline);
+};
+
+}  // namespace icamera
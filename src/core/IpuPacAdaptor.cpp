@@ -27,8 +27,10 @@
 #include "iutils/Utils.h"
 #include "iutils/CameraLog.h"
 #include "iutils/CameraDump.h"
+#include "iutils/MemoryAccounting.h"
 #include "CameraContext.h"
 #include "AiqResultStorage.h"
+#include "SceneChangeDetector.h"
 #include "PlatformData.h"
 #include "ia_pal_types_isp_ids_autogen.h"
 
@@ -54,6 +56,7 @@ int IpuPacAdaptor::init(std::vector<int> streamIds) {
     mIntelCca = IntelCca::getInstance(mCameraId, TUNING_MODE_VIDEO);
     CheckAndLogError(mIntelCca == nullptr, UNKNOWN_ERROR, "%s, mIntelCca is nullptr", __func__);
 
+    MemoryAccounting::Scope scope(mCameraId, CAMERA_MEMORY_PAC_PAYLOAD);
     mStreamIdToInputParams.clear();
     for (const auto& id : streamIds) {
         cca::cca_pal_input_params* p = static_cast<cca::cca_pal_input_params*>(
@@ -147,6 +150,10 @@ void* IpuPacAdaptor::allocateBufferL(int streamId, uint8_t contextId,
     std::string name = std::string("termBuf") + std::to_string(memIndex);
     memIndex++;
 
+    // The buffers of the callers accounting them separately, e.g. CB stage metadata, keep
+    // the subsystem of the caller
+    MemoryAccounting::Scope scope(mCameraId,
+                                  MemoryAccounting::currentSubsystem(CAMERA_MEMORY_PAC_PAYLOAD));
     void* addr = mIntelCca->allocMem(streamId, name, termId, size);
     CheckAndLogError(addr == nullptr, nullptr,
                      "%s, Failed to allocate terminal buffer. termId: %d", __func__, termId);
@@ -534,6 +541,9 @@ status_t IpuPacAdaptor::decodeStats(int streamId, uint8_t contextId, int64_t seq
             outStats = &aiqResult->mOutStats;
             outStats->get_rgbs_stats = true;
         }
+        if (PlatformData::isSceneChangeDetectionEnabled(mCameraId)) {
+            outStats->get_rgbs_stats = true;
+        }
     }
 
     const ia_err iaErr = mIntelCca->decodeStats(contextId, sequenceId, streamId, outStats);
@@ -543,6 +553,12 @@ status_t IpuPacAdaptor::decodeStats(int streamId, uint8_t contextId, int64_t seq
             aiqStatistics->mSequence = sequenceId;
             aiqStatistics->mTimestamp = timestamp;
             aiqStatistics->mTuningMode = TUNING_MODE_VIDEO;
+            if (outStats->get_rgbs_stats &&
+                PlatformData::isSceneChangeDetectionEnabled(mCameraId)) {
+                SceneChangeDetector::summarizeRgbs(*outStats, aiqStatistics);
+            } else {
+                aiqStatistics->mSceneLumaValid = false;
+            }
 
             mAiqResultStorage->updateAiqStatistics(sequenceId);
         }
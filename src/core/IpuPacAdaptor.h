@@ -22,6 +22,7 @@
 #include <map>
 
 #include "iutils/Errors.h"
+#include "iutils/FlatMap.h"
 #include "CameraBuffer.h"
 #include "CameraTypes.h"
 #include "PlatformData.h"
@@ -43,8 +44,8 @@ struct PacTerminalBuf {
     PacTerminalBuf() : size(0), payloadPtr(nullptr) {}
 };
 
-// terminal id -> PacTerminalBuf
-typedef std::map<uint8_t, PacTerminalBuf> PacTerminalBufMap;
+// terminal id -> PacTerminalBuf, copied for each task of the CB stages
+typedef FlatMap<uint8_t, PacTerminalBuf, cca::MAX_PG_TERMINAL_NUM> PacTerminalBufMap;
 
 class IpuPacAdaptor {
 public:
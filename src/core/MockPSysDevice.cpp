@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2024 Intel Corporation.
+ * Copyright (C) 2024-2025 Intel Corporation.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -25,14 +25,58 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include "CBLayoutUtils.h"
 #include "CameraLog.h"
 #include "Errors.h"
+#include "PlatformData.h"
+#include "src/platformdata/PnpDebugControl.h"
 
 namespace icamera {
 
-MockPSysDevice::MockPSysDevice(int cameraId) : PSysDevice(cameraId) {
+// The tasks of all the nodes may run at the same time
+static const size_t kMaxPendingTasks = MAX_NODE_NUM * MAX_TASK_NUM;
+
+std::mutex MockPSysDevice::sBusLock;
+NodePool MockPSysDevice::sBusPool(kMaxPendingTasks);
+std::multiset<nsecs_t, std::less<nsecs_t>, PoolAllocator<nsecs_t>> MockPSysDevice::sBusTasks{
+    std::less<nsecs_t>(), PoolAllocator<nsecs_t>(&sBusPool)};
+
+bool MockPSysProfileParser::run(const std::string& filename) {
+    auto root = openJsonFile(filename);
+    if (root.empty() || !root.isMember("MockPSysProfile")) {
+        return false;
+    }
+
+    const Json::Value& node = root["MockPSysProfile"];
+    if (node.isMember("seed")) {
+        mProfile->seed = node["seed"].asUInt();
+    }
+    if (node.isMember("nodes")) {
+        const Json::Value& nodes = node["nodes"];
+        for (const auto& name : nodes.getMemberNames()) {
+            MockPSysNodeTiming timing;
+            timing.latencyUs = nodes[name].get("latencyUs", 0).asInt64();
+            timing.jitterUs = nodes[name].get("jitterUs", 0).asInt64();
+            mProfile->nodes[name] = timing;
+        }
+    }
+    if (node.isMember("bandwidth")) {
+        const Json::Value& ele = node["bandwidth"];
+        mProfile->bytesPerUs = ele.get("bytesPerUs", 0).asInt64();
+        mProfile->contention = ele.get("contention", false).asBool();
+    }
+
+    mProfile->valid = true;
+    return true;
+}
+
+MockPSysDevice::MockPSysDevice(int cameraId)
+        : PSysDevice(cameraId),
+          mTaskPool(kMaxPendingTasks),
+          mPendingTasks(std::less<nsecs_t>(), PoolAllocator<PendingTask>(&mTaskPool)) {
     mPollThread = new PollThread<MockPSysDevice>(this);
     mFileSource = new icamera::FileSourceFromDir(PNP_INJECTION_NAME);
+    loadProfile();
 }
 
 MockPSysDevice::~MockPSysDevice() {
@@ -50,10 +94,91 @@ int MockPSysDevice::init() {
     return OK;
 }
 
+void MockPSysDevice::loadProfile() {
+    const std::string profile = PnpDebugControl::mockPSysProfile();
+    if (profile.empty()) {
+        return;
+    }
+
+    const std::string fullpath =
+        (profile[0] == '/') ? profile : PlatformData::getCameraCfgPath() + profile;
+    MockPSysProfileParser parser(&mProfile);
+    CheckWarningNoReturn(!parser.run(fullpath), "Failed to load %s, tasks are done immediately",
+                         fullpath.c_str());
+    mRandom.seed(mProfile.seed);
+    LOG1("%s: %s, %zu nodes, %ld bytes/us, contention %d", __func__, fullpath.c_str(),
+         mProfile.nodes.size(), mProfile.bytesPerUs, mProfile.contention);
+}
+
 void MockPSysDevice::registerPSysDeviceCallback(uint8_t contextId, IPSysDeviceCallback* callback) {
     mPSysDeviceCallbackMap[contextId] = callback;
 }
 
+int MockPSysDevice::addGraph(const PSysGraph& graph) {
+    std::unique_lock<std::mutex> lock(mDataLock);
+    for (const auto& node : graph.nodes) {
+        std::string name = "node" + std::to_string(node.nodeRsrcId);
+        if (node.nodeRsrcId == NODE_RESOURCE_ID_LBFF) {
+            name = "lbff";
+#ifndef IPU_SYSVER_ipu8
+        } else if (node.nodeRsrcId == NODE_RESOURCE_ID_BBPS) {
+            name = "bbps";
+#endif
+        }
+        mNodeNames[node.nodeCtxId] = name;
+    }
+    return OK;
+}
+
+nsecs_t MockPSysDevice::getTaskDoneTime(const PSysTask& task) {
+    const nsecs_t now = CameraUtils::systemTime();
+    if (!mProfile.valid) {
+        return now;
+    }
+
+    MockPSysNodeTiming timing;
+    auto name = mNodeNames.find(task.nodeCtxId);
+    auto it = mProfile.nodes.find((name != mNodeNames.end()) ? name->second : "default");
+    if (it == mProfile.nodes.end()) {
+        it = mProfile.nodes.find("default");
+    }
+    if (it != mProfile.nodes.end()) {
+        timing = it->second;
+    }
+
+    // The node runs the tasks one by one
+    const nsecs_t start = std::max(now, mNodeBusyTime[task.nodeCtxId]);
+    int64_t durationUs = timing.latencyUs;
+    if (timing.jitterUs > 0) {
+        std::uniform_int_distribution<int64_t> jitter(-timing.jitterUs, timing.jitterUs);
+        durationUs += jitter(mRandom);
+    }
+    durationUs = std::max(durationUs, static_cast<int64_t>(0));
+
+    if (mProfile.bytesPerUs > 0) {
+        uint64_t bytes = 0U;
+        for (const auto& item : task.terminalBuffers) {
+            bytes += item.second.size;
+        }
+        int64_t transferUs = static_cast<int64_t>(bytes) / mProfile.bytesPerUs;
+
+        if (mProfile.contention) {
+            std::lock_guard<std::mutex> l(sBusLock);
+            // The tasks done before the start don't share the bandwidth
+            sBusTasks.erase(sBusTasks.begin(), sBusTasks.upper_bound(start));
+            transferUs *= static_cast<int64_t>(sBusTasks.size()) + 1;
+            sBusTasks.insert(start + (durationUs + transferUs) * 1000);
+        }
+        durationUs += transferUs;
+    }
+
+    const nsecs_t doneTime = start + durationUs * 1000;
+    mNodeBusyTime[task.nodeCtxId] = doneTime;
+    LOG2("<seq%ld>%s: context %u, start delay %ld us, duration %ld us", task.sequence, __func__,
+         task.nodeCtxId, (start - now) / 1000, durationUs);
+    return doneTime;
+}
+
 int MockPSysDevice::addTask(const PSysTask& task) {
     for (const auto& item : task.terminalBuffers) {
         if (task.sequence < kStartingFrameCount && item.second.handle > 0) {
@@ -71,7 +196,9 @@ int MockPSysDevice::addTask(const PSysTask& task) {
 
     {
         std::unique_lock<std::mutex> lock(mDataLock);
-        mTasksMap[task.sequence].insert(task.nodeCtxId);
+        const nsecs_t doneTime = getTaskDoneTime(task);
+        mPendingTasks.insert(
+            std::make_pair(doneTime, std::make_pair(task.sequence, task.nodeCtxId)));
 
         mTaskReadyCondition.notify_one();
     }
@@ -83,31 +210,33 @@ int MockPSysDevice::poll() {
         return -1;
     }
 
-    auto task = mTasksMap.begin();
+    int64_t sequence = -1;
+    uint8_t contextId = 0U;
     {
         std::unique_lock<std::mutex> lock(mDataLock);
-        if (mTasksMap.empty()) {
+        if (mPendingTasks.empty()) {
             const std::cv_status ret =
                 mTaskReadyCondition.wait_for(lock, std::chrono::nanoseconds(2000000000));
-            if (mTasksMap.empty() || (ret == std::cv_status::timeout)) {
+            if (mPendingTasks.empty() || (ret == std::cv_status::timeout)) {
                 return 0;
             }
         }
-        task = mTasksMap.begin();
-    }
 
-    auto sec = task->second.begin();
-    LOG2("%s, task.nodeCtxId %u, task.sequence %ld", __func__, *sec, task->first);
-    mPSysDeviceCallbackMap[*sec]->bufferDone(task->first);
-
-    {
-        std::unique_lock<std::mutex> lock(mDataLock);
-        task->second.erase(sec);
-        if (task->second.empty()) {
-            mTasksMap.erase(task);
+        auto task = mPendingTasks.begin();
+        const nsecs_t now = CameraUtils::systemTime();
+        if (task->first > now) {
+            // Check again when the task is done, or a new task is added
+            mTaskReadyCondition.wait_for(lock, std::chrono::nanoseconds(task->first - now));
+            return 0;
         }
+        sequence = task->second.first;
+        contextId = task->second.second;
+        mPendingTasks.erase(task);
     }
 
+    LOG2("%s, task.nodeCtxId %u, task.sequence %ld", __func__, contextId, sequence);
+    mPSysDeviceCallbackMap[contextId]->bufferDone(sequence);
+
     return 0;
 }
 
@@ -21,17 +21,70 @@
 #include <list>
 #include <map>
 #include <mutex>
+#include <random>
 #include <set>
+#include <string>
 #include <unordered_map>
 
 #include "Errors.h"
 #include "FileSource.h"
+#include "JsonParserBase.h"
 #include "PSysDevice.h"
+#include "iutils/NodePool.h"
 #include "iutils/Thread.h"
+#include "iutils/Utils.h"
 #include "modules/ipu_desc/ipu-psys.h"
 
 namespace icamera {
 
+/**
+ * The timing model of the mocked PSYS, loaded from the json file set by "mockPSysProfile"
+ * of the PnP debug config:
+ * {
+ *   "MockPSysProfile": {
+ *     "seed": 1,
+ *     "nodes": {
+ *       "lbff": { "latencyUs": 8000, "jitterUs": 1000 },
+ *       "bbps": { "latencyUs": 4000, "jitterUs": 500 },
+ *       "default": { "latencyUs": 2000, "jitterUs": 0 }
+ *     },
+ *     "bandwidth": { "bytesPerUs": 4000, "contention": true }
+ *   }
+ * }
+ *
+ * A task starts after the previous task of the same node is done, and takes latencyUs plus
+ * a random jitter in [-jitterUs, jitterUs], plus the buffer size / bytesPerUs for the memory
+ * transfer. With contention, the transfer time is multiplied by the number of tasks running
+ * at the same time in all the mocked devices, e.g. the other pipes and cameras.
+ * Without the profile the tasks are done immediately.
+ */
+struct MockPSysNodeTiming {
+    int64_t latencyUs = 0;
+    int64_t jitterUs = 0;
+};
+
+struct MockPSysProfile {
+    bool valid = false;
+    uint32_t seed = 1U;
+    // Node name (lbff, bbps, ...) -> timing, "default" for the nodes not listed
+    std::map<std::string, MockPSysNodeTiming> nodes;
+    int64_t bytesPerUs = 0;  // 0 means no transfer time
+    bool contention = false;
+};
+
+class MockPSysProfileParser : public JsonParserBase {
+ public:
+    explicit MockPSysProfileParser(MockPSysProfile* profile) : mProfile(profile) {}
+    ~MockPSysProfileParser() {}
+
+    bool run(const std::string& filename) final override;
+
+ private:
+    MockPSysProfile* mProfile;
+
+    DISALLOW_COPY_AND_ASSIGN(MockPSysProfileParser);
+};
+
 /**
  * PSYS uAPI Mock
  */
@@ -45,7 +98,7 @@ class MockPSysDevice : public PSysDevice {
     virtual void registerPSysDeviceCallback(uint8_t contextId,
                                             IPSysDeviceCallback* callback) override;
 
-    virtual int addGraph(const PSysGraph& graph) override { return OK; }
+    virtual int addGraph(const PSysGraph& graph) override;
     virtual int closeGraph() override { return OK; }
 
     virtual int addTask(const PSysTask& task) override;
@@ -54,10 +107,14 @@ class MockPSysDevice : public PSysDevice {
         buf->psysBuf.base.fd = ++mFd;
         return OK;
     }
-    virtual void unregisterBuffer(TerminalBuffer* buf) override {}
+    virtual void unregisterBuffer(const TerminalBuffer* buf) override {}
 
     virtual int poll() override;
 
+ private:
+    void loadProfile();
+    nsecs_t getTaskDoneTime(const PSysTask& task);
+
  private:
     static const int kStartingFrameCount = 20;
     icamera::FileSourceFromDir* mFileSource;
@@ -70,7 +127,21 @@ class MockPSysDevice : public PSysDevice {
     int mFd = 0;
     std::mutex mDataLock;
     std::unordered_map<uint8_t, IPSysDeviceCallback*> mPSysDeviceCallbackMap;
-    std::map<int64_t, std::set<uint8_t>> mTasksMap;
+    // Done time -> {sequence, context id}, the tasks are done in the time order
+    typedef std::pair<const nsecs_t, std::pair<int64_t, uint8_t>> PendingTask;
+    NodePool mTaskPool;
+    std::multimap<nsecs_t, std::pair<int64_t, uint8_t>, std::less<nsecs_t>,
+                  PoolAllocator<PendingTask>> mPendingTasks;
+
+    MockPSysProfile mProfile;
+    std::mt19937 mRandom;
+    std::unordered_map<uint8_t, std::string> mNodeNames;  // context id -> node name
+    std::unordered_map<uint8_t, nsecs_t> mNodeBusyTime;   // context id -> last task done time
+
+    // The done time of the running tasks in all the mocked devices, for the contention
+    static std::mutex sBusLock;
+    static NodePool sBusPool;
+    static std::multiset<nsecs_t, std::less<nsecs_t>, PoolAllocator<nsecs_t>> sBusTasks;
 }; /* MockPSysDevice */
 
 } /* namespace icamera */
@@ -28,6 +28,7 @@
 #include "CameraLog.h"
 #include "Errors.h"
 #include "Utils.h"
+#include "v4l2/SysCall.h"
 
 namespace icamera {
 
@@ -64,7 +65,7 @@ PSysDevice::~PSysDevice() {
     }
 
     if (mFd >= 0) {
-        const int ret = ::close(mFd);
+        const int ret = SysCall::getInstance()->close(mFd);
         if (ret < 0) {
             LOGE("Failed to close psys device %s, ret %d", strerror(errno), ret);
         }
@@ -80,7 +81,7 @@ PSysDevice::~PSysDevice() {
     }
 
     if (mEventFd >= 0) {
-        close(mEventFd);
+        (void)SysCall::getInstance()->close(mEventFd);
     }
 }
 
@@ -99,7 +100,7 @@ void PSysDevice::deinit() {
 }
 
 int PSysDevice::init() {
-    mFd = open(DRIVER_NAME, O_RDWR | O_NONBLOCK, 0);
+    mFd = SysCall::getInstance()->open(DRIVER_NAME, O_RDWR | O_NONBLOCK);
     CheckAndLogError(mFd < 0, INVALID_OPERATION, "Failed to open psys device %s", strerror(errno));
 
     mPollThread->start();
@@ -162,7 +163,7 @@ int PSysDevice::addGraph(const PSysGraph& graph) {
         linkIndex++;
     }
 
-    int ret = ::ioctl(mFd, static_cast<int>(IPU_IOC_GRAPH_OPEN), &graphDrv);
+    int ret = SysCall::getInstance()->ioctl(mFd, static_cast<int>(IPU_IOC_GRAPH_OPEN), &graphDrv);
     CheckAndLogError((ret != 0) || (graphDrv.graph_id == INVALID_GRAPH_ID), INVALID_OPERATION,
                      "Failed to open graph %s", strerror(errno));
 
@@ -175,7 +176,8 @@ int PSysDevice::closeGraph() {
     CheckAndLogError(mFd < 0, INVALID_OPERATION, "psys device wasn't opened");
 
     if (mGraphId != INVALID_GRAPH_ID) {
-        int ret = ::ioctl(mFd, static_cast<int>(IPU_IOC_GRAPH_CLOSE), &mGraphId);
+        int ret = SysCall::getInstance()->ioctl(mFd, static_cast<int>(IPU_IOC_GRAPH_CLOSE),
+                                                &mGraphId);
         CheckAndLogError(ret != 0, INVALID_OPERATION, "Failed to close graph %s", strerror(errno));
         mGraphId = INVALID_GRAPH_ID;
     }
@@ -218,7 +220,8 @@ int PSysDevice::addTask(const PSysTask& task) {
         }
     }
 
-    const int ret = ioctl(mFd, static_cast<int>(IPU_IOC_TASK_REQUEST), &taskData);
+    const int ret = SysCall::getInstance()->ioctl(mFd, static_cast<int>(IPU_IOC_TASK_REQUEST),
+                                                  &taskData);
     CheckAndLogError(ret != 0, INVALID_OPERATION, "Failed to add task %s", strerror(errno));
 
     return OK;
@@ -227,7 +230,7 @@ int PSysDevice::addTask(const PSysTask& task) {
 int PSysDevice::wait(ipu_psys_event& event) {
     CheckAndLogError(mFd < 0, INVALID_OPERATION, "psys device wasn't opened");
 
-    int ret = ioctl(mFd, static_cast<int>(IPU_IOC_DQEVENT), &event);
+    int ret = SysCall::getInstance()->ioctl(mFd, static_cast<int>(IPU_IOC_DQEVENT), &event);
     CheckAndLogError(ret != 0, INVALID_OPERATION, "Failed to dequeue event %s", strerror(errno));
 
     return OK;
@@ -287,7 +290,7 @@ int PSysDevice::registerBuffer(TerminalBuffer* buf) {
         buf->psysBuf.base.userptr = buf->userPtr;
         buf->psysBuf.flags |= IPU_BUFFER_FLAG_USERPTR;
 
-        ret = ioctl(mFd, static_cast<int>(IPU_IOC_GETBUF), &buf->psysBuf);
+        ret = SysCall::getInstance()->ioctl(mFd, static_cast<int>(IPU_IOC_GETBUF), &buf->psysBuf);
         CheckAndLogError(ret != 0, INVALID_OPERATION, "Failed to get buffer %s", strerror(errno));
 
         if ((buf->psysBuf.flags & IPU_BUFFER_FLAG_DMA_HANDLE) == 0U) {
@@ -309,8 +312,9 @@ int PSysDevice::registerBuffer(TerminalBuffer* buf) {
     buf->psysBuf.data_offset = 0U;
     buf->psysBuf.bytes_used = buf->psysBuf.len;
 
-    ret = ioctl(mFd, static_cast<int>(IPU_IOC_MAPBUF),
-                reinterpret_cast<void*>(static_cast<intptr_t>(buf->psysBuf.base.fd)));
+    ret = SysCall::getInstance()->ioctl(
+        mFd, static_cast<int>(IPU_IOC_MAPBUF),
+        reinterpret_cast<void*>(static_cast<intptr_t>(buf->psysBuf.base.fd)));
     CheckAndLogError(ret != 0, INVALID_OPERATION, "Failed to map buffer %s", strerror(errno));
 
     // Save PSYS buf
@@ -337,14 +341,21 @@ void PSysDevice::unregisterBuffer(const TerminalBuffer* buf) {
         return;
     }
 
-    int ret = ioctl(mFd, static_cast<int>(IPU_IOC_UNMAPBUF),
-                    reinterpret_cast<void*>(static_cast<intptr_t>(buf->psysBuf.base.fd)));
+    // The buffer isn't used by any task yet
+    TerminalBuffer mapped = *buf;
+    if (!getPsysBufMap(&mapped)) {
+        return;
+    }
+
+    int ret = SysCall::getInstance()->ioctl(
+        mFd, static_cast<int>(IPU_IOC_UNMAPBUF),
+        reinterpret_cast<void*>(static_cast<intptr_t>(buf->psysBuf.base.fd)));
     if (ret != 0) {
         LOGW("Failed to unmap buffer %s", strerror(errno));
     }
 
     if ((buf->flags & IPU_BUFFER_FLAG_USERPTR) != 0U) {
-        ret = close(buf->psysBuf.base.fd);
+        ret = SysCall::getInstance()->close(buf->psysBuf.base.fd);
         if (ret < 0) {
             LOGE("Failed to close fd %d, error %s", buf->psysBuf.base.fd, strerror(errno));
         }
@@ -360,16 +371,16 @@ void PSysDevice::registerPSysDeviceCallback(uint8_t contextId, IPSysDeviceCallba
 
 int PSysDevice::poll(short events, int timeout)
 {
-    std::vector<struct pollfd> pollfds;
-    pollfds.reserve(1 + ((mEventFd >= 0) ? 1 : 0));
+    struct pollfd pollfds[2] = {};
+    nfds_t count = 0;
 
-    pollfds.push_back({ mFd, events, 0 });
+    pollfds[count++] = { mFd, events, 0 };
 
     if (mEventFd >= 0) {
-        pollfds.push_back({ mEventFd, POLLIN, 0 });
+        pollfds[count++] = { mEventFd, POLLIN, 0 };
     }
 
-    return ::poll(pollfds.data(), pollfds.size(), timeout);
+    return SysCall::getInstance()->poll(pollfds, count, timeout);
 }
 
 void PSysDevice::handleEvent(const ipu_psys_event& event) {
@@ -21,6 +21,7 @@
 #include <unordered_map>
 
 #include "modules/ipu_desc/ipu-psys.h"
+#include "iutils/FlatMap.h"
 #include "iutils/Thread.h"
 
 namespace icamera {
@@ -79,11 +80,13 @@ struct TerminalBuffer {
     bool isExtDmaBuf;
 };
 
+// first: terminal id, second: TerminalBuffer
+typedef FlatMap<uint8_t, TerminalBuffer, MAX_GRAPH_TERMINALS> TerminalBufferMap;
+
 struct PSysTask {
     uint8_t nodeCtxId = 0;
     int64_t sequence = 0;
-    // first: terminal id, second: TerminalBuffer
-    std::unordered_map<uint8_t, TerminalBuffer> terminalBuffers;
+    TerminalBufferMap terminalBuffers;
 };
 
 /**
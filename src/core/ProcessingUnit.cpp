@@ -27,6 +27,7 @@
 #include "iutils/CameraLog.h"
 #include "iutils/Utils.h"
 #include "CameraContext.h"
+#include "CameraStatistics.h"
 #include "PipeManager.h"
 #include "StageDescriptor.h"
 
@@ -46,12 +47,16 @@ ProcessingUnit::ProcessingUnit(int cameraId, std::shared_ptr<CameraScheduler> sc
         : mCameraId(cameraId),
           mTuningMode(TUNING_MODE_MAX),
           mRawPort(INVALID_PORT),
+          mMaxLentBuffers(0U),
           mStatus(PIPELINE_UNCREATED),
           mScheduler(scheduler),
           mLastStillTnrSequence(-1) {
     mProcessThread = new ProcessThread(this);
 
     CLEAR(mTnrTriggerInfo);
+    mInflightTraceName =
+        PERF_CAMERA_ATRACE_COUNTER_NAME("Cam" + std::to_string(cameraId) + " PSYS inflight");
+    setQueueTraceTag(cameraId, "ProcessingUnit");
 }
 
 ProcessingUnit::~ProcessingUnit() {
@@ -144,6 +149,14 @@ int ProcessingUnit::start() {
         CheckAndLogError(ret != OK, NO_MEMORY, "Allocating producer buffer failed:%d", ret);
     }
 
+    {
+        // Lending more would leave ISYS fewer buffers than the pipeline depth and drop frames
+        const int pipelineDepth = PlatformData::getMaxPipelineDepth(mCameraId);
+        std::lock_guard<std::mutex> l(mLentBufferLock);
+        mMaxLentBuffers =
+            (rawBufferNum > pipelineDepth) ? static_cast<size_t>(rawBufferNum - pipelineDepth) : 0U;
+    }
+
     IProcessingUnit::mThreadRunning = true;
     BufferQueue::setThreadWaiting(true);
     mProcessThread->start();
@@ -179,6 +192,10 @@ void ProcessingUnit::stop() {
     mProcessThread->wait();
 
     mRawBufferMap.clear();
+    {
+        std::lock_guard<std::mutex> l(mLentBufferLock);
+        mLentBuffers.clear();
+    }
     // Thread is not running. It is safe to clear the Queue
     BufferQueue::clearBufferQueues();
 }
@@ -462,7 +479,7 @@ int ProcessingUnit::handleYuvReprocessing(const CameraBufferPortMap* buffersMap)
         return -1;
     }
 
-    mPipeManager->addTask(taskParam);
+    mPipeManager->addTask(std::move(taskParam));
 
     // handle metadata event after running pal(update metadata from pal result)
     sendPsysRequestEvent(&dstBuffers, bufSequence, timestamp, EVENT_REQUEST_METADATA_READY);
@@ -611,7 +628,7 @@ void ProcessingUnit::returnRawBuffer() {
         if (mBufferProducer != nullptr) {
             const CameraBufferPortMap& bufferPortMap = it->second;
             for (auto& item : bufferPortMap) {
-                 mBufferProducer->qbuf(item.first, item.second);
+                returnInputBuffer(item.first, item.second);
             }
         }
         LOG2("@%s, returned sequence %ld", __func__, it->first);
@@ -650,6 +667,7 @@ status_t ProcessingUnit::prepareTask(CameraBufferPortMap* srcBuffers,
             for (auto& output : BufferQueue::mOutputQueue) {
                 output.second.pop();
             }
+            traceQueueDepth();
             return OK;
         }
     } else if (!mYuvInputInfo.empty()) {
@@ -685,7 +703,7 @@ status_t ProcessingUnit::prepareTask(CameraBufferPortMap* srcBuffers,
                 break;
             }
         }
-        outputRawImage(mainBuf, dstBuf);
+        outputRawImage(defaultPort, mainBuf, dstBuf);
     }
 
     const int64_t settingSequence = getSettingSequence(*dstBuffers);
@@ -700,6 +718,8 @@ status_t ProcessingUnit::prepareTask(CameraBufferPortMap* srcBuffers,
             for (auto& output : BufferQueue::mOutputQueue) {
                 output.second.pop();
             }
+        } else if (needRunPipe) {
+            CameraContext::getInstance(mCameraId)->getStatistics()->onFrameSkipped();
         }
 
         // If input buffer will be used later, don't pop it from the queue.
@@ -708,6 +728,7 @@ status_t ProcessingUnit::prepareTask(CameraBufferPortMap* srcBuffers,
                 input.second.pop();
             }
         }
+        traceQueueDepth();
     }
 
     if (needRunPipe) {
@@ -758,7 +779,7 @@ status_t ProcessingUnit::prepareTask(CameraBufferPortMap* srcBuffers,
     } else if ((!holdOnInput) && (!isBufferHoldForRawReprocess(inputSequence))
                && mBufferProducer != nullptr) {
         for (const auto& src : *srcBuffers) {
-            mBufferProducer->qbuf(src.first, src.second);
+            returnInputBuffer(src.first, src.second);
         }
     }
 
@@ -903,6 +924,9 @@ void ProcessingUnit::dispatchTask(CameraBufferPortMap& inBuf, CameraBufferPortMa
     {
         std::unique_lock<std::mutex> lock(mBufferQueueLock);
         mSequencesInflight.insert(currentSequence);
+        PERF_CAMERA_ATRACE_COUNTER(mInflightTraceName, mSequencesInflight.size());
+        CameraContext::getInstance(mCameraId)->getStatistics()->frameBegin(
+            CameraStatistics::DURATION_PSYS, currentSequence);
         LOG2("<id%d:seq:%ld>@%s, fake task %d, pending task: %zu", mCameraId, currentSequence,
              __func__, fakeTask, mSequencesInflight.size());
     }  // End of lock mBufferQueueLock
@@ -940,7 +964,7 @@ void ProcessingUnit::dispatchTask(CameraBufferPortMap& inBuf, CameraBufferPortMa
         return;
     }
 
-    mPipeManager->addTask(taskParam);
+    mPipeManager->addTask(std::move(taskParam));
 }
 
 void ProcessingUnit::onBufferDone(int64_t sequence, uuid port,
@@ -1008,6 +1032,8 @@ void ProcessingUnit::onTaskDone(const PipeTaskData& result) {
     LOG2("<id%d:seq%ld>@%s", mCameraId, sequence, __func__);
     TRACE_LOG_POINT("ProcessingUnit", __func__, MAKE_COLOR(sequence), sequence);
     PERF_CAMERA_ATRACE_PARAM1("Task Done Sequence", sequence);
+    CameraContext::getInstance(mCameraId)->getStatistics()->frameEnd(
+        CameraStatistics::DURATION_PSYS, sequence);
 
     // If it is YUV reprocessing, its request doesn't have extra processing
     if (result.mYuvTask) {
@@ -1044,7 +1070,7 @@ void ProcessingUnit::onTaskDone(const PipeTaskData& result) {
                         it->onBufferAvailable(src.first, src.second);
                     }
                 } else {
-                    mBufferProducer->qbuf(src.first, src.second);
+                    returnInputBuffer(src.first, src.second);
                 }
             }
         }
@@ -1056,6 +1082,7 @@ void ProcessingUnit::onTaskDone(const PipeTaskData& result) {
         if (it != mSequencesInflight.end()) {
             mSequencesInflight.erase(it);
         }
+        PERF_CAMERA_ATRACE_COUNTER(mInflightTraceName, mSequencesInflight.size());
     }
 
     returnRawBuffer();
@@ -1068,21 +1095,103 @@ void ProcessingUnit::onMetadataReady(int64_t sequence, const CameraBufferPortMap
     sendPsysRequestEvent(&outBuf, sequence, 0U, EVENT_REQUEST_METADATA_READY);
 }
 
-void ProcessingUnit::outputRawImage(shared_ptr<CameraBuffer>& srcBuf,
-                                   shared_ptr<CameraBuffer>& dstBuf) {
+void ProcessingUnit::outputRawImage(uuid srcPort, shared_ptr<CameraBuffer>& srcBuf,
+                                    shared_ptr<CameraBuffer>& dstBuf) {
     if ((srcBuf == nullptr) || (dstBuf == nullptr)) {
         return;
     }
 
-    // Copy from source buffer
-    CameraBufferMapper srcMapper(srcBuf);
-    CameraBufferMapper dstMapper(dstBuf);
+    if (!lendRawBuffer(srcPort, srcBuf, dstBuf)) {
+        // Copy from source buffer
+        CameraBufferMapper srcMapper(srcBuf, DMA_BUF_SYNC_READ);
+        CameraBufferMapper dstMapper(dstBuf, DMA_BUF_SYNC_WRITE);
 
-    MEMCPY_S(dstMapper.addr(), dstMapper.size(), srcMapper.addr(), srcMapper.size());
+        MEMCPY_S(dstMapper.addr(), dstMapper.size(), srcMapper.addr(), srcMapper.size());
+    }
 
     // Send output buffer to its consumer
     for (auto& it : BufferQueue::mBufferConsumerList) {
         it->onBufferAvailable(mRawPort, dstBuf);
     }
 }
+
+bool ProcessingUnit::lendRawBuffer(uuid srcPort, const shared_ptr<CameraBuffer>& srcBuf,
+                                   const shared_ptr<CameraBuffer>& dstBuf) {
+    if ((!dstBuf->isFlagsSet(BUFFER_FLAG_ZERO_COPY)) ||
+        (dstBuf->getMemory() != V4L2_MEMORY_USERPTR)) {
+        return false;
+    }
+
+    // The app reads the frame as its own buffer, so the layout must be the same
+    if ((srcBuf->getBufferAddr() == nullptr) || (srcBuf->getFormat() != dstBuf->getFormat()) ||
+        (srcBuf->getWidth() != dstBuf->getWidth()) ||
+        (srcBuf->getHeight() != dstBuf->getHeight()) ||
+        (srcBuf->getStride() != dstBuf->getStride()) ||
+        (srcBuf->getBufferSize() < dstBuf->getBufferSize())) {
+        LOG2("%s, incompatible ISYS buffer, copy the raw frame", __func__);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> l(mLentBufferLock);
+        // The input buffer may be used by several requests, only lent once
+        if (mLentBuffers.find(srcBuf.get()) != mLentBuffers.end()) {
+            return false;
+        }
+        if (mLentBuffers.size() >= mMaxLentBuffers) {
+            LOG2("%s, %zu ISYS buffers are lent, copy the raw frame", __func__,
+                 mLentBuffers.size());
+            return false;
+        }
+        mLentBuffers[srcBuf.get()] = {srcPort, false};
+    }
+
+    dstBuf->lendBuffer(srcBuf);
+    LOG2("<seq%u>%s, lend ISYS buffer %p", srcBuf->getSequence(), __func__,
+         srcBuf->getBufferAddr());
+    return true;
+}
+
+void ProcessingUnit::returnInputBuffer(uuid port, const shared_ptr<CameraBuffer>& buffer) {
+    {
+        std::lock_guard<std::mutex> l(mLentBufferLock);
+        auto it = mLentBuffers.find(buffer.get());
+        if (it != mLentBuffers.end()) {
+            it->second.port = port;
+            it->second.returned = true;
+            return;
+        }
+    }
+
+    mBufferProducer->qbuf(port, buffer);
+}
+
+void ProcessingUnit::returnLentBuffer(const shared_ptr<CameraBuffer>& buffer) {
+    bool returned = false;
+    uuid inputPort = INVALID_PORT;
+    {
+        std::lock_guard<std::mutex> l(mLentBufferLock);
+        auto it = mLentBuffers.find(buffer.get());
+        if (it != mLentBuffers.end()) {
+            returned = it->second.returned;
+            inputPort = it->second.port;
+            mLentBuffers.erase(it);
+        }
+    }
+    // Otherwise it is returned by PSYS later
+    if (returned && (mBufferProducer != nullptr)) {
+        mBufferProducer->qbuf(inputPort, buffer);
+    }
+}
+
+int ProcessingUnit::qbuf(uuid port, const shared_ptr<CameraBuffer>& camBuffer) {
+    if ((port == mRawPort) && (camBuffer != nullptr)) {
+        shared_ptr<CameraBuffer> lentBuffer = camBuffer->reclaimLentBuffer();
+        if (lentBuffer != nullptr) {
+            returnLentBuffer(lentBuffer);
+        }
+    }
+
+    return BufferQueue::qbuf(port, camBuffer);
+}
 }  // namespace icamera
@@ -17,6 +17,7 @@
 #pragma once
 #include <queue>
 #include <set>
+#include <string>
 
 #include "CameraScheduler.h"
 #include "IProcessingUnit.h"
@@ -30,8 +31,6 @@ namespace icamera {
 class IPipeManager;
 class AiqResult;
 
-typedef std::map<uuid, std::shared_ptr<CameraBuffer>> CameraBufferPortMap;
-
 /**
  * ProcessingUnit runs the Image Process Algorithm in the PSYS.
  * It implements the BufferConsumer and BufferProducer Interface
@@ -45,6 +44,10 @@ class ProcessingUnit : public IProcessingUnit, public PipeManagerCallback {
     virtual int start();
     virtual void stop();
 
+    // Overwrite BufferQueue API, to reclaim the ISYS buffer lent to the RAW output buffer
+    virtual int qbuf(uuid port, const std::shared_ptr<CameraBuffer>& camBuffer);
+    virtual void returnLentBuffer(const std::shared_ptr<CameraBuffer>& buffer);
+
     // Overwrite PipeManagerCallback API, used for returning back buffers from PipeManager.
     virtual void onTaskDone(const PipeTaskData& result);
     virtual void onBufferDone(int64_t sequence, uuid port,
@@ -69,8 +72,12 @@ class ProcessingUnit : public IProcessingUnit, public PipeManagerCallback {
     bool needExecutePipe(int64_t settingSequence, int64_t inputSequence) const;
     bool needHoldOnInputFrame(int64_t settingSequence, int64_t inputSequence) const;
 
-    void outputRawImage(std::shared_ptr<CameraBuffer>& srcBuf,
+    void outputRawImage(uuid srcPort, std::shared_ptr<CameraBuffer>& srcBuf,
                         std::shared_ptr<CameraBuffer>& dstBuf);
+    bool lendRawBuffer(uuid srcPort, const std::shared_ptr<CameraBuffer>& srcBuf,
+                       const std::shared_ptr<CameraBuffer>& dstBuf);
+    // Return the input buffer to the producer, or after the app finishes the lent buffer
+    void returnInputBuffer(uuid port, const std::shared_ptr<CameraBuffer>& buffer);
     status_t handleYuvReprocessing(const CameraBufferPortMap* buffersMap);
     void handleRawReprocessing(CameraBufferPortMap* srcBuffers, CameraBufferPortMap* dstBuffers,
                                bool* allBufDone, bool* hasRawOutput, bool* hasRawInput);
@@ -106,6 +113,7 @@ class ProcessingUnit : public IProcessingUnit, public PipeManagerCallback {
 
     // Save the sequences which are being processed.
     std::multiset<int64_t> mSequencesInflight;
+    const char* mInflightTraceName;  // Interned counter track name
 
     std::unique_ptr<IPipeManager> mPipeManager;
     ConfigMode mConfigMode;
@@ -119,6 +127,16 @@ class ProcessingUnit : public IProcessingUnit, public PipeManagerCallback {
 
     uuid mRawPort;
 
+    // The ISYS buffers lent to the RAW output buffers of the app, see BUFFER_FLAG_ZERO_COPY
+    struct LentBuffer {
+        uuid port;
+        bool returned;  // PSYS doesn't need it, return it when the app queues the RAW buffer
+    };
+    std::mutex mLentBufferLock;
+    std::map<CameraBuffer*, LentBuffer> mLentBuffers;
+    // The ISYS buffers beyond the pipeline depth, only they can be lent, set in start()
+    size_t mMaxLentBuffers;
+
     // variables for opaque raw
     std::set<uuid> mOpaqueRawPorts;
     std::mutex mBufferMapLock;
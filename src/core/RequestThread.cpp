@@ -20,6 +20,7 @@
 #include "iutils/CameraLog.h"
 
 #include "CameraContext.h"
+#include "FrameTimeline.h"
 #include "RequestThread.h"
 
 using std::vector;
@@ -32,6 +33,8 @@ RequestThread::RequestThread(int cameraId, AiqUnitBase *a3AControl) :
     m3AControl(a3AControl),
     mPerframeControlSupport(false),
     mGet3AStatWithFakeRequest(false),
+    mRequestPool(kMaxRequests),
+    mPendingRequests(PoolAllocator<CameraRequest>(&mRequestPool)),
     mRequestsInProcessing(0),
     mFirstRequest(true),
     mState(EXIT),
@@ -47,6 +50,8 @@ RequestThread::RequestThread(int cameraId, AiqUnitBase *a3AControl) :
     mPerframeControlSupport = PlatformData::isFeatureSupported(mCameraId, PER_FRAME_CONTROL);
 
     mSofEnabled = PlatformData::isIsysEnabled(cameraId);
+    mPendingTraceName =
+        PERF_CAMERA_ATRACE_COUNTER_NAME("Cam" + std::to_string(cameraId) + " pending requests");
     // FILE_SOURCE_S
     mSofEnabled = mSofEnabled || PlatformData::isFileSourceEnabled();
     // FILE_SOURCE_E
@@ -81,10 +86,11 @@ void RequestThread::resetSequence() {
     mLastAppliedSeq = -1;
     mLastSofSeq = -1;
     mBlockRequest = false;
-    for (size_t i = 0; i < mPendingRequests.size(); ++i) {
-        auto &req = mPendingRequests[i];
+    int64_t i = 0;
+    for (auto &req : mPendingRequests) {
         req.mBuffer[0]->sequence = i;
         req.mBuffer[0]->frameNumber = i;
+        ++i;
     }
     LOG2("%s: reset processing state", __func__);
 }
@@ -204,6 +210,7 @@ int RequestThread::processRequest(int bufferNum, camera_buffer_t **ubuffer) {
     }
 
     mPendingRequests.push_back(request);
+    PERF_CAMERA_ATRACE_COUNTER(mPendingTraceName, mPendingRequests.size());
 
     if (mState != PROCESSING) {
         mState = PROCESSING;
@@ -214,6 +221,12 @@ int RequestThread::processRequest(int bufferNum, camera_buffer_t **ubuffer) {
     return OK;
 }
 
+void RequestThread::getRequestCount(int* pending, int* inProcessing) {
+    AutoMutex l(mPendingReqLock);
+    *pending = mPendingRequests.size();
+    *inProcessing = mRequestsInProcessing;
+}
+
 int RequestThread::waitFrame(int streamId, camera_buffer_t **ubuffer) {
     FrameQueue& frameQueue = mOutputFrames[streamId];
     std::unique_lock<std::mutex> lock(frameQueue.mFrameMutex);
@@ -332,6 +345,7 @@ void RequestThread::handleEvent(EventData eventData) {
                     fakeRequest.mBuffer[0] = &mFakeReqBuf;
                     mFakeReqBuf.sequence = -1;
                     mPendingRequests.push_back(fakeRequest);
+                    PERF_CAMERA_ATRACE_COUNTER(mPendingTraceName, mPendingRequests.size());
                     mRequestTriggerEvent |= static_cast<uint32_t>(NEW_REQUEST);
                     mRequestSignal.notify_one();
                 }
@@ -358,6 +372,7 @@ bool RequestThread::fetchNextRequest(CameraRequest& request) {
     request = mPendingRequests.front();
     mRequestsInProcessing++;
     mPendingRequests.pop_front();
+    PERF_CAMERA_ATRACE_COUNTER(mPendingTraceName, mPendingRequests.size());
     LOG2("@%s, mRequestsInProcessing %d", __func__, mRequestsInProcessing);
     return true;
 }
@@ -478,6 +493,10 @@ void RequestThread::handleRequest(CameraRequest& request, int64_t applyingSeq) {
         }
 
         auto cameraContext = CameraContext::getInstance(mCameraId);
+        FrameTimeline* timeline = cameraContext->getFrameTimeline();
+        if ((timeline != nullptr) && (ccaId >= 0)) {
+            timeline->recordCcaId(effectSeq, ccaId);
+        }
         const auto dataContext =
             cameraContext->acquireDataContextByFn(request.mBuffer[0]->frameNumber);
 
@@ -17,8 +17,11 @@
 #pragma once
 #include <atomic>
 #include <condition_variable>
-#include <deque>
+#include <list>
+#include <queue>
+#include <string>
 
+#include "iutils/NodePool.h"
 #include "iutils/Thread.h"
 #include "PlatformData.h"
 #include "AiqUnit.h"
@@ -57,6 +60,11 @@ public:
 
     int waitFrame(int streamId, camera_buffer_t **ubuffer);
 
+    /**
+     * \Get the number of pending and in processing requests.
+     */
+    void getRequestCount(int* pending, int* inProcessing);
+
     /**
      * \Block the caller until the first request is processed.
      */
@@ -108,11 +116,15 @@ private:
     static const nsecs_t kWaitFrameDuration = 5000000000; // 5s
     static const nsecs_t kWaitDuration = 2000000000; // 2s
     static const nsecs_t kWaitFirstRequestDoneDuration = 1000000000; // 1s
+    // The nodes of a frame queue, the pending requests use kMaxRequests nodes
+    static const size_t kQueuePoolBlocks = 4;
 
     //Guard for all the pending requests
     Mutex mPendingReqLock;
     std::condition_variable mRequestSignal;
-    std::deque <CameraRequest> mPendingRequests;
+    NodePool mRequestPool;
+    std::list<CameraRequest, PoolAllocator<CameraRequest>> mPendingRequests;
+    const char* mPendingTraceName;  // Interned counter track name
     int mRequestsInProcessing;
 
     // Guard for the first request.
@@ -121,9 +133,16 @@ private:
     bool mFirstRequest;
 
     struct FrameQueue {
+        typedef PoolAllocator<std::shared_ptr<CameraBuffer>> FrameAllocator;
+        FrameQueue()
+                : mFramePool(kQueuePoolBlocks),
+                  mFrameQueue(FrameAllocator(&mFramePool)) {}
+
         Mutex mFrameMutex;
         std::condition_variable mFrameAvailableSignal;
-        CameraBufQ mFrameQueue;
+        NodePool mFramePool;
+        std::queue<std::shared_ptr<CameraBuffer>,
+                   std::list<std::shared_ptr<CameraBuffer>, FrameAllocator>> mFrameQueue;
     };
     FrameQueue mOutputFrames[MAX_STREAM_NUMBER];
 
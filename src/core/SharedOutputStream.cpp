@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG SharedOutputStream
+
+#include "SharedOutputStream.h"
+
+#include "iutils/CameraLog.h"
+#include "iutils/Errors.h"
+#include "iutils/Utils.h"
+
+using std::shared_ptr;
+
+namespace icamera {
+
+SharedOutputStream::SharedOutputStream(int cameraId, int streamId, const stream_t& stream)
+        : CameraStream(cameraId, streamId, stream),
+          mSourceStream(nullptr) {}
+
+SharedOutputStream::~SharedOutputStream() {}
+
+int SharedOutputStream::stop() {
+    {
+        AutoMutex l(mBufferPoolLock);
+        mPendingBuffers.clear();
+    }
+
+    return CameraStream::stop();
+}
+
+int SharedOutputStream::qbuf(camera_buffer_t* ubuffer, int64_t sequence, bool addExtraBuf) {
+    UNUSED(addExtraBuf);
+    // No image for this stream in the request
+    if (ubuffer == nullptr) {
+        return OK;
+    }
+    CheckAndLogError(mSourceStream == nullptr, BAD_VALUE, "@%s: no source stream", __func__);
+
+    shared_ptr<CameraBuffer> camBuffer = userBufferToCameraBuffer(ubuffer);
+    CheckAndLogError(camBuffer == nullptr, BAD_VALUE, "@%s: fail to get CameraBuffer", __func__);
+
+    // The buffer is queued again, so it doesn't use the source buffer any more
+    shared_ptr<CameraBuffer> srcBuffer = camBuffer->reclaimLentBuffer();
+    if (srcBuffer != nullptr) {
+        mSourceStream->releaseSharedBuffer(srcBuffer);
+    }
+
+    camBuffer->setSettingSequence(sequence);
+    LOG2("<id%d:seq%ld>@%s, mStreamId:%d, CameraBuffer:%p, ubuffer:%p", mCameraId, sequence,
+         __func__, mStreamId, camBuffer.get(), ubuffer);
+
+    AutoMutex l(mBufferPoolLock);
+    mPendingBuffers.push_back(camBuffer);
+#ifdef LINUX_PRIVACY_MODE
+    mBufferInProcessing.push_back(camBuffer);
+#else
+    mBufferInProcessing++;
+#endif
+
+    return OK;
+}
+
+void SharedOutputStream::releaseLentBuffer(const shared_ptr<CameraBuffer>& buffer) {
+    if (mSourceStream != nullptr) {
+        mSourceStream->releaseSharedBuffer(buffer);
+    }
+}
+
+bool SharedOutputStream::onSourceBufferAvailable(const shared_ptr<CameraBuffer>& srcBuffer) {
+    shared_ptr<CameraBuffer> camBuffer = nullptr;
+    {
+        AutoMutex l(mBufferPoolLock);
+        for (auto it = mPendingBuffers.begin(); it != mPendingBuffers.end(); ++it) {
+            if ((*it)->getSettingSequence() == srcBuffer->getSettingSequence()) {
+                camBuffer = *it;
+                mPendingBuffers.erase(it);
+                break;
+            }
+        }
+    }
+    if (camBuffer == nullptr) {
+        return false;
+    }
+
+    camBuffer->lendBuffer(srcBuffer);
+    camBuffer->setSequence(srcBuffer->getSequence());
+    camBuffer->setTimestamp(srcBuffer->getTimestamp());
+    camBuffer->setField(srcBuffer->getField());
+
+    (void)CameraStream::onBufferAvailable(mPort, camBuffer);
+    return true;
+}
+
+}  // namespace icamera
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+
+#include "CameraStream.h"
+
+namespace icamera {
+
+/**
+ * SharedOutputStream: The HAL represent of the CAMERA_STREAM_SHARED_OUTPUT stream.
+ *
+ * It isn't bound to any producer port. The queued buffers wait for the buffer of the source
+ * stream in the same request, then get the memory of it, so one produced image is delivered
+ * to several streams. The source buffer is held until all the shared buffers are queued again.
+ */
+class SharedOutputStream : public CameraStream {
+ public:
+    SharedOutputStream(int cameraId, int streamId, const stream_t& stream);
+    virtual ~SharedOutputStream();
+
+    void setSourceStream(CameraStream* source) { mSourceStream = source; }
+
+    virtual int stop();
+    virtual int qbuf(camera_buffer_t* ubuffer, int64_t sequence, bool addExtraBuf = false);
+
+    /**
+     * \brief The buffer of the source stream is ready
+     *
+     * \return true if the buffer is delivered to this stream
+     */
+    bool onSourceBufferAvailable(const std::shared_ptr<CameraBuffer>& srcBuffer);
+
+ protected:
+    virtual void releaseLentBuffer(const std::shared_ptr<CameraBuffer>& buffer);
+
+ private:
+    CameraStream* mSourceStream;
+    // The queued buffers waiting for the source buffer, guarded by mBufferPoolLock
+    std::list<std::shared_ptr<CameraBuffer>> mPendingBuffers;
+
+    DISALLOW_COPY_AND_ASSIGN(SharedOutputStream);
+};
+
+}  // namespace icamera
@@ -108,10 +108,16 @@ int SofSource::initDev() {
     CheckAndLogError(status != OK, status, "Failed to subscribe sync event %d", vcId);
     LOG1("%s: Using SOF event id %d for sync", __func__, vcId);
 
+    std::vector<V4L2Device*> pollDevs;
+    pollDevs.push_back(mIsysReceiverSubDev);
+    mPoller.reset(new V4L2DevicePoller(pollDevs, mFlushFd[0]));
+    mReadyDevices.reserve(pollDevs.size());
+
     return OK;
 }
 
 int SofSource::deinitDev() {
+    mPoller.reset();
     if (mIsysReceiverSubDev == nullptr) {
         return OK;
     }
@@ -182,11 +188,8 @@ int SofSource::poll() {
     const int pollTimeoutCount = 10;
     const int pollTimeout = 1000;
 
-    std::vector<V4L2Device*> pollDevs;
-    pollDevs.push_back(mIsysReceiverSubDev);
-    V4L2DevicePoller poller{pollDevs, mFlushFd[0]};
-
-    std::vector<V4L2Device*> readyDevices;
+    CheckAndLogError(mPoller == nullptr, -1, "%s: no subdevice to poll", __func__);
+    mReadyDevices.clear();
 
     int timeOutCount = pollTimeoutCount;
 
@@ -196,7 +199,7 @@ int SofSource::poll() {
             return -1;
         }
 
-        ret = poller.Poll(pollTimeout, POLLPRI | POLLIN | POLLOUT | POLLERR, &readyDevices);
+        ret = mPoller->Poll(pollTimeout, POLLPRI | POLLIN | POLLOUT | POLLERR, &mReadyDevices);
     }
 
     if (mExitPending) {
@@ -15,6 +15,7 @@
  */
 
 #pragma once
+#include <memory>
 #include <vector>
 
 #include <v4l2_device.h>
@@ -45,6 +46,9 @@ class SofSource : public EventSource {
 
     int mCameraId;
     V4L2Subdevice* mIsysReceiverSubDev;
+    // Built with the subdevice, not to allocate per SOF
+    std::unique_ptr<V4L2DevicePoller> mPoller;
+    std::vector<V4L2Device*> mReadyDevices;
     bool mExitPending;
     bool mSofDisabled;
 };
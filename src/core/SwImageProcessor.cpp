@@ -31,6 +31,7 @@ SwImageProcessor::SwImageProcessor(int cameraId) : mCameraId(cameraId) {
     LOG1("<id%d>@%s", mCameraId, __func__);
 
     mProcessThread = new ProcessThread(this);
+    setQueueTraceTag(cameraId, "SwImageProcessor");
 }
 
 SwImageProcessor::~SwImageProcessor() {
@@ -77,7 +78,7 @@ int SwImageProcessor::processNewFrame() {
     PERF_CAMERA_ATRACE();
 
     int ret = OK;
-    std::map<uuid, std::shared_ptr<CameraBuffer> > srcBuffers, dstBuffers;
+    CameraBufferPortMap srcBuffers, dstBuffers;
     std::shared_ptr<CameraBuffer> cInBuffer;
     uuid inputPort = INVALID_PORT;
     LOG1("<id%d>@%s", mCameraId, __func__);
@@ -113,6 +114,7 @@ int SwImageProcessor::processNewFrame() {
         for (auto& input : BufferQueue::mInputQueue) {
             input.second.pop();
         }
+        traceQueueDepth();
     }
     CheckAndLogError(cInBuffer == nullptr, BAD_VALUE, "Invalid input buffer.");
 
@@ -20,6 +20,9 @@
 
 #include <vector>
 
+#include "CameraContext.h"
+#include "CameraStatistics.h"
+#include "FrameTimeline.h"
 #include "iutils/CameraLog.h"
 
 namespace icamera {
@@ -224,6 +227,21 @@ status_t SwPostProcessUnit::doPostProcessing(const std::shared_ptr<CameraBuffer>
                  inBuf->getBufferAddr(), inBuf->getBufferSize());
         return OK;
     }
-    return mPostProcessorCore->doPostProcessing(inBuf, outBuf);
+
+    CameraContext* cameraContext = CameraContext::getInstance(mCameraId);
+    FrameTimeline* timeline = cameraContext->getFrameTimeline();
+    if (timeline != nullptr) {
+        timeline->recordEvent(inBuf->getSequence(), TIMELINE_POST_PROCESS_BEGIN);
+    }
+
+    const nsecs_t startTime = CameraUtils::systemTime();
+    const status_t ret = mPostProcessorCore->doPostProcessing(inBuf, outBuf);
+    cameraContext->getStatistics()->addDuration(CameraStatistics::DURATION_POST_PROCESSING,
+                                                CameraUtils::systemTime() - startTime);
+
+    if (timeline != nullptr) {
+        timeline->recordEvent(inBuf->getSequence(), TIMELINE_POST_PROCESS_END);
+    }
+    return ret;
 }
 }  // namespace icamera
@@ -19,10 +19,13 @@
 #include "CBStage.h"
 
 #include "CBLayoutUtils.h"
+#include "CameraContext.h"
+#include "FrameTimeline.h"
 #include "PlatformData.h"
 #include "StageDescriptor.h"
 #include "ia_pal_types_isp_ids_autogen.h"
 #include "iutils/CameraLog.h"
+#include "iutils/MemoryAccounting.h"
 
 namespace icamera {
 
@@ -39,16 +42,26 @@ CBStage::CBStage(int cameraId, int streamId, int stageId, uint8_t contextId, uin
           mHasStatsTerminal(false),
           mPacAdapt(pacAdapt),
           mLinkStreamMode(LINK_STREAMING_MODE_SOFF),
+          mStageTaskPool(MAX_FRAME_NUM),
+          mStageTaskList(PoolAllocator<StageTask>(&mStageTaskPool)),
           sPayloadDesc(nullptr),
           mPayloadDescCount(0),
           sTerminalDesc(nullptr),
           mTerminalDescCount(0),
           mKernelOffsetBuf(nullptr),
           mIaAicBuf(nullptr),
-          mNode2SelfBufIndex(0) {
+          mNode2SelfBufIndex(0),
+          mTimelineStage(-1) {
     LOG1("%s, graph ctxId %d, psys ctxId %d, mPSysDevice %p", __func__, mContextId, mOuterNodeCtxId,
          mPSysDevice);
 
+    mTaskTraceName =
+        PERF_CAMERA_ATRACE_COUNTER_NAME("Cam" + std::to_string(cameraId) + " " + cbName + " tasks");
+    setQueueTraceTag(cameraId, cbName);
+    FrameTimeline* timeline = CameraContext::getInstance(cameraId)->getFrameTimeline();
+    if (timeline != nullptr) {
+        mTimelineStage = timeline->registerStage(std::to_string(streamId) + ":" + cbName);
+    }
     psysDevice->registerPSysDeviceCallback(mContextId, this);
 }
 
@@ -85,12 +98,14 @@ void CBStage::deInit() {
     for (auto bufmap : mTerminalBufferMaps) {
         auto& terminalBufMap = bufmap.second.mMetadataBufferMap;
         for (auto it : terminalBufMap) {
+            BufferAllocator::unlock(it.second.userPtr, it.second.size);
             mPacAdapt->releaseBuffer(mStreamId, mContextId, it.first, it.second.userPtr);
         }
     }
     for (auto bufmap : mTerminalBufferMaps) {
         auto& terminalBufMap = bufmap.second.mPayloadBufferMap;
         for (auto it : terminalBufMap) {
+            BufferAllocator::unlock(it.second.userPtr, it.second.size);
             mPacAdapt->releaseBuffer(mStreamId, mContextId, it.first, it.second.userPtr);
         }
     }
@@ -101,7 +116,9 @@ void CBStage::deInit() {
 
     for (auto& it : mNode2SelfBuffers) {
         for (auto& buf: it.second) {
+            BufferAllocator::unlock(buf.userPtr, PAGE_ALIGN(buf.size));
             free(buf.userPtr);
+            MemoryAccounting::remove(mCameraId, CAMERA_MEMORY_CB_STAGE, PAGE_ALIGN(buf.size));
         }
     }
     mNode2SelfBuffers.clear();
@@ -204,13 +221,13 @@ int32_t CBStage::processTask(StageTask* task) {
         item.second->setSequence(task->sequence);
     }
 
-    std::unordered_map<uint8_t, TerminalBuffer> terminalBuffers;
+    TerminalBufferMap terminalBuffers;
 
     if (mInputPortTerminals.empty()) {
         ret = addFrameTerminals(&terminalBuffers, task->inBuffers);
         CheckAndLogError(ret != OK, ret, "Failed to add terminals for task->inBuffers");
     } else {
-        std::map<uuid, std::shared_ptr<CameraBuffer>> inBuffers;
+        CameraBufferPortMap inBuffers;
         // Map input port to terminal uuid
         for (auto& item : task->inBuffers) {
             CheckAndLogError(mInputPortTerminals.find(item.first) == mInputPortTerminals.end(),
@@ -226,14 +243,25 @@ int32_t CBStage::processTask(StageTask* task) {
 
     {
         std::lock_guard<std::mutex> l(mDataLock);
-        mStageTaskList.push_back(*task);
+        // The output buffers are still returned below in BCLM mode
+        if (mLinkStreamMode == LINK_STREAMING_MODE_BCLM) {
+            mStageTaskList.push_back(*task);
+        } else {
+            mStageTaskList.push_back(std::move(*task));
+        }
+        PERF_CAMERA_ATRACE_COUNTER(mTaskTraceName, mStageTaskList.size());
+    }
+    if (mTimelineStage >= 0) {
+        CameraContext::getInstance(mCameraId)->getFrameTimeline()->recordStage(task->sequence,
+                                                                               mTimelineStage,
+                                                                               false);
     }
 
     ret = addTask(&terminalBuffers, bufferMap, task->sequence);
     CheckAndLogError(ret != OK, ret, "Failed to add task ret %d", ret);
 
     if (mLinkStreamMode == LINK_STREAMING_MODE_BCLM) {
-        std::map<uuid, std::shared_ptr<CameraBuffer> > inBuffers;
+        CameraBufferPortMap inBuffers;
         returnBuffers(inBuffers, task->outBuffers);
     }
 
@@ -241,10 +269,16 @@ int32_t CBStage::processTask(StageTask* task) {
 }
 
 int CBStage::bufferDone(int64_t sequence) {
+    if (mTimelineStage >= 0) {
+        CameraContext::getInstance(mCameraId)->getFrameTimeline()->recordStage(sequence,
+                                                                               mTimelineStage,
+                                                                               true);
+    }
+
     std::lock_guard<std::mutex> l(mDataLock);
 
     if (mStageTaskList.size() > 0) {
-        auto task = mStageTaskList.front();
+        StageTask task = std::move(mStageTaskList.front());
 
         // Remove internal output buffers
         for (auto& item : task.outBuffers) {
@@ -256,7 +290,7 @@ int CBStage::bufferDone(int64_t sequence) {
         updateInfoAndSendEvents(&task);
 
         if (mLinkStreamMode == LINK_STREAMING_MODE_BCLM) {
-            std::map<uuid, std::shared_ptr<CameraBuffer> > outBuffers;
+            CameraBufferPortMap outBuffers;
             returnBuffers(task.inBuffers, outBuffers);
         } else {
             returnBuffers(task.inBuffers, task.outBuffers);
@@ -267,6 +301,7 @@ int CBStage::bufferDone(int64_t sequence) {
         }
 
         mStageTaskList.pop_front();
+        PERF_CAMERA_ATRACE_COUNTER(mTaskTraceName, mStageTaskList.size());
     } else {
         LOGW("%s, sequence %ld wasn't missing", __func__, sequence);
     }
@@ -290,7 +325,7 @@ int32_t CBStage::fetchTask(StageTask* task) {
 }
 
 void CBStage::updateInfoAndSendEvents(StageTask* task) {
-    std::shared_ptr<CameraBuffer> inBuf = task->inBuffers.begin()->second;
+    const std::shared_ptr<CameraBuffer>& inBuf = task->inBuffers.begin()->second;
     v4l2_buffer_t inV4l2Buf = *inBuf->getV4L2Buffer().Get();
 
     EventData bufferEvent;
@@ -337,7 +372,9 @@ void CBStage::updateInfoAndSendEvents(StageTask* task) {
 }
 
 int32_t CBStage::allocateFrameBuffers() {
+    MemoryAccounting::Scope scope(mCameraId, CAMERA_MEMORY_CB_STAGE);
     mInternalOutputBuffers.clear();
+    BufferAllocator* allocator = BufferAllocator::getInstance(mStreamId);
     // Allocate internal output buffers to support pipe execution without user output buffer
     for (auto const& item : mOutputFrameInfo) {
         const int fmt = item.second.format;
@@ -345,7 +382,7 @@ int32_t CBStage::allocateFrameBuffers() {
         const int height = item.second.height;
         const int size = CameraUtils::getFrameSize(fmt, width, height, true);
         std::shared_ptr<CameraBuffer> buf =
-            CameraBuffer::create(V4L2_MEMORY_USERPTR, size, 0, fmt, width, height);
+            CameraBuffer::create(V4L2_MEMORY_USERPTR, size, 0, fmt, width, height, allocator);
         CheckAndLogError(buf == nullptr, NO_MEMORY, "@%s: Allocate internal output buffer failed",
                          __func__);
         mInternalOutputBuffers[item.first] = buf;
@@ -353,17 +390,75 @@ int32_t CBStage::allocateFrameBuffers() {
 
     const int bufCount = PlatformData::getMaxRequestsInflight(mCameraId);
     if (mBufferProducer != nullptr) {
-        return allocProducerBuffers(mCameraId, bufCount);
+        return allocProducerBuffers(mCameraId, bufCount, allocator);
     }
 
     return OK;
 }
 
+void CBStage::warmUpBuffers() {
+    PERF_CAMERA_ATRACE();
+
+    // The buffers hold the data from configure or the last run, so they aren't written
+    for (const auto& bufmap : mTerminalBufferMaps) {
+        for (const auto& it : bufmap.second.mMetadataBufferMap) {
+            BufferAllocator::warmUp(it.second.userPtr, it.second.size, true);
+        }
+        for (const auto& it : bufmap.second.mPayloadBufferMap) {
+            BufferAllocator::warmUp(it.second.userPtr, it.second.size, true);
+        }
+    }
+    for (const auto& it : mNode2SelfBuffers) {
+        for (const auto& buf : it.second) {
+            BufferAllocator::warmUp(buf.userPtr, PAGE_ALIGN(buf.size), true);
+        }
+    }
+
+    // Map the internal frame buffers to PSys, which is done by the first frames using them
+    TerminalBufferMap terminalBuffers;
+    CameraBufferPortMap buffers;
+    for (const auto& item : mInternalOutputBuffers) {
+        buffers.clear();
+        buffers[item.first] = item.second;
+        (void)addFrameTerminals(&terminalBuffers, buffers);
+    }
+    for (const auto& item : mInternalBuffers) {
+        for (const auto& buf : item.second) {
+            buffers.clear();
+            buffers[item.first] = buf;
+            (void)addFrameTerminals(&terminalBuffers, buffers);
+        }
+    }
+    LOG1("<id%d>@%s, stream %u, context %u", mCameraId, __func__, mStreamId, mContextId);
+}
+
 int CBStage::start() {
-    return allocateFrameBuffers();
+    const int32_t ret = allocateFrameBuffers();
+    if ((ret == OK) && BufferAllocator::isPrefaultEnabled()) {
+        warmUpBuffers();
+    }
+
+    return ret;
+}
+
+void CBStage::unregisterDmaHeapBuffers() {
+    std::unordered_map<int, TerminalBuffer> buffers;
+    {
+        std::lock_guard<std::mutex> l(mDataLock);
+        buffers.swap(mDmaHeapTerminalBuffers);
+    }
+
+    for (auto& item : buffers) {
+        // Owned by the pipeline, so it can be unmapped as the external dma-buf
+        item.second.isExtDmaBuf = true;
+        mPSysDevice->unregisterBuffer(&item.second);
+    }
 }
 
 int CBStage::stop() {
+    // The dma-heap buffers of this stage and of the next stages are reallocated at start,
+    // and their fds may be reused, so unmap all of them
+    unregisterDmaHeapBuffers();
     mInternalOutputBuffers.clear();
     return OK;
 }
@@ -393,6 +488,7 @@ int CBStage::allocateNode2SelfBuffers(const PSysLink& psysLink, uint32_t bufferS
             free(terminalBuf.userPtr);
             return ret;
         }
+        MemoryAccounting::add(mCameraId, CAMERA_MEMORY_CB_STAGE, PAGE_ALIGN(terminalBuf.size));
 
         mUserToTerminalBuffer[terminalBuf.userPtr] = terminalBuf;
         bufV.push_back(terminalBuf);
@@ -500,6 +596,7 @@ int CBStage::allocMetadataBuffer(const GraphLink** links, uint8_t numOfLink,
                                                             : link->destTerminalId;
         const uint32_t size = ALIGN_64(link->linkConfiguration->bufferSize);
         if (CBLayoutUtils::isMetaDataTerminal(mResourceId, terminalId)) {
+            MemoryAccounting::Scope scope(mCameraId, CAMERA_MEMORY_CB_STAGE);
             for (auto& bufmap : mTerminalBufferMaps) {
                 auto& terminalBufMap = bufmap.second.mMetadataBufferMap;
                 TerminalBuffer terminalBuf;
@@ -847,16 +944,19 @@ int CBStage::registerPayloadBuffer(aic::IaAicBuffer** iaAicBuf, PacTerminalBufMa
     return OK;
 }
 
-int CBStage::addFrameTerminals(std::unordered_map<uint8_t, TerminalBuffer>* terminalBuffers,
-                               const std::map<uuid, std::shared_ptr<CameraBuffer>>& buffers,
-                               int64_t sequence) {
-    for (auto it : buffers) {
+int CBStage::addFrameTerminals(TerminalBufferMap* terminalBuffers,
+                               const CameraBufferPortMap& buffers, int64_t sequence) {
+    for (const auto& it : buffers) {
         const uint8_t terminalId = GET_TERMINAL_ID(it.first);
-        std::shared_ptr<CameraBuffer> buf = it.second;
+        const std::shared_ptr<CameraBuffer>& buf = it.second;
         TerminalBuffer terminalBuf;
         CLEAR(terminalBuf);
         terminalBuf.size = buf->getBufferSize();
-        if (buf->getMemory() == V4L2_MEMORY_DMABUF) {
+        if (buf->isDmaHeapBuffer()) {
+            // Mapped by fd once, it's unmapped when the stage stops, whichever stage owns it
+            terminalBuf.handle = buf->getFd();
+            terminalBuf.flags |= IPU_BUFFER_FLAG_DMA_HANDLE;
+        } else if (buf->getMemory() == V4L2_MEMORY_DMABUF) {
             terminalBuf.handle = buf->getFd();
             terminalBuf.flags |= IPU_BUFFER_FLAG_DMA_HANDLE;
             if (PlatformData::unregisterExtDmaBuf(mCameraId)) {
@@ -890,6 +990,12 @@ int CBStage::addFrameTerminals(std::unordered_map<uint8_t, TerminalBuffer>* term
         if (terminalBuf.isExtDmaBuf) {
             std::lock_guard<std::mutex> l(mDataLock);
             mSeqToTerminalBufferMaps.emplace(sequence, terminalBuf);
+        } else if (buf->isDmaHeapBuffer()) {
+            std::lock_guard<std::mutex> l(mDataLock);
+            // Only the first frame of the buffer adds it, emplace() allocates a node anyway
+            if (mDmaHeapTerminalBuffers.find(buf->getFd()) == mDmaHeapTerminalBuffers.end()) {
+                mDmaHeapTerminalBuffers.emplace(buf->getFd(), terminalBuf);
+            }
         }
     }
 
@@ -910,8 +1016,8 @@ void CBStage::unregisterExtDmaBuf(int64_t sequence) {
     }
 }
 
-int CBStage::addTask(std::unordered_map<uint8_t, TerminalBuffer>* terminalBuffers,
-                     const PacTerminalBufMap& bufferMap, int64_t sequence) {
+int CBStage::addTask(TerminalBufferMap* terminalBuffers, const PacTerminalBufMap& bufferMap,
+                     int64_t sequence) {
     PSysTask psysTask;
 
     psysTask.nodeCtxId = mContextId;
@@ -931,7 +1037,7 @@ int CBStage::addTask(std::unordered_map<uint8_t, TerminalBuffer>* terminalBuffer
         const uint8_t referInIdx = mNode2SelfBufIndex;
         const uint8_t referOutIdx = (referInIdx + 1) % kMaxNode2SelfBufArray;
         mNode2SelfBufIndex = referOutIdx;
-        for (auto it : mNode2SelfBuffers) {
+        for (auto& it : mNode2SelfBuffers) {
             TerminalBuffer& outBuf = it.second[referOutIdx];
             const TerminalBuffer& inBuf = it.second[referInIdx];
             psysTask.terminalBuffers[it.first] = mUserToTerminalBuffer[outBuf.userPtr];
@@ -38,6 +38,7 @@
 #endif
 #include "Utils.h"
 #include "cb_payload_descriptor.h"
+#include "iutils/NodePool.h"
 
 namespace icamera {
 
@@ -71,8 +72,8 @@ class CBStage : public IPipeStage, public IPSysDeviceCallback {
 
  private:
     struct StageTask {
-        std::map<uuid, std::shared_ptr<CameraBuffer>> inBuffers;
-        std::map<uuid, std::shared_ptr<CameraBuffer>> outBuffers;
+        CameraBufferPortMap inBuffers;
+        CameraBufferPortMap outBuffers;
         int64_t sequence;
     };
 
@@ -83,6 +84,8 @@ class CBStage : public IPipeStage, public IPSysDeviceCallback {
 
     // There are 4 types of buffer: frame, node2self, metadata and payload buffer.
     int32_t allocateFrameBuffers();
+    // Populate the buffers and map them to PSys before the first frame, see BufferAllocator
+    void warmUpBuffers();
     int allocateNode2SelfBuffers(const PSysLink& psysLink, uint32_t bufferSize);
     int setTerminalLinkAndAllocNode2SelfBuffers(const GraphLink** links, uint8_t numOfLink);
 
@@ -105,11 +108,11 @@ class CBStage : public IPipeStage, public IPSysDeviceCallback {
     int registerPayloadBuffer(aic::IaAicBuffer** iaAicBuf, PacTerminalBufMap& termBufMap);
 
     void unregisterExtDmaBuf(int64_t sequence);
-    int addFrameTerminals(std::unordered_map<uint8_t, TerminalBuffer>* terminalBuffers,
-                          const std::map<uuid, std::shared_ptr<CameraBuffer>>& buffers,
+    void unregisterDmaHeapBuffers();
+    int addFrameTerminals(TerminalBufferMap* terminalBuffers, const CameraBufferPortMap& buffers,
                           int64_t sequence = -1);
-    int addTask(std::unordered_map<uint8_t, TerminalBuffer>* terminalBuffers,
-                const PacTerminalBufMap& bufferMap, int64_t sequence);
+    int addTask(TerminalBufferMap* terminalBuffers, const PacTerminalBufMap& bufferMap,
+                int64_t sequence);
     void dumpTerminalData(const PacTerminalBufMap& bufferMap, int64_t sequence);
 
  private:
@@ -133,7 +136,9 @@ class CBStage : public IPipeStage, public IPSysDeviceCallback {
 
     std::mutex mDataLock;
     static const uint8_t MAX_FRAME_NUM = 2;
-    std::list<StageTask> mStageTaskList;
+    NodePool mStageTaskPool;
+    std::list<StageTask, PoolAllocator<StageTask>> mStageTaskList;
+    const char* mTaskTraceName;  // Interned counter track name
 
     // Used to dump all used terminal buffers
     // Ignore (psys) ctx id of consumer or producer because they are invalid
@@ -149,6 +154,8 @@ class CBStage : public IPipeStage, public IPSysDeviceCallback {
 
     static const uint8_t kMaxNode2SelfBufArray = MAX_BUFFER_COUNT;
     uint8_t mNode2SelfBufIndex;
+    // The stage index in the frame timeline, -1 if the timeline isn't enabled
+    int mTimelineStage;
     /**
      * node2self, example:
      * BB:8 -> BB:11, apply on current frame (buffer chasing)
@@ -175,6 +182,9 @@ class CBStage : public IPipeStage, public IPSysDeviceCallback {
 
     // first: sequence, second:: TerminalBuffer
     std::unordered_multimap<int64_t, TerminalBuffer> mSeqToTerminalBufferMaps;
+
+    // first: fd, second: TerminalBuffer of the mapped dma-heap buffers, guarded by mDataLock
+    std::unordered_map<int, TerminalBuffer> mDmaHeapTerminalBuffers;
 };
 
 }  // namespace icamera
@@ -182,7 +182,7 @@ int FaceStage::onBufferAvailable(uuid port, const shared_ptr<CameraBuffer>& camB
                     faceBuffer = mAvailableBufferQ.front();
                 }
 
-                CameraBufferMapper mapper(camBuffer);
+                CameraBufferMapper mapper(camBuffer, DMA_BUF_SYNC_READ);
                 CheckAndLogError(camBuffer->getBufferAddr() == nullptr, BAD_VALUE,
                                  "%s, Failed to get addr for camBuffer", __func__);
 
@@ -31,6 +31,7 @@ GPUPostStage::GPUPostStage(int cameraId, int stageId, const std::string& stageNa
           mTnr7usParam(nullptr) {
     LOG1("%s, %d", __func__, mCameraId);
     mTnr7Stage = std::unique_ptr<IntelTNR7Stage>(IntelTNR7Stage::createIntelTNR(cameraId));
+    setQueueTraceTag(cameraId, stageName);
 }
 
 GPUPostStage::~GPUPostStage() {}
@@ -103,8 +104,8 @@ bool GPUPostStage::fetchRequestBuffer(int64_t sequence, std::shared_ptr<CameraBu
 bool GPUPostStage::process(int64_t triggerId) {
     PERF_CAMERA_ATRACE_PARAM1(getName(), triggerId);
 
-    std::map<uuid, std::shared_ptr<CameraBuffer> > inBuffers;
-    std::map<uuid, std::shared_ptr<CameraBuffer> > outBuffers;
+    CameraBufferPortMap inBuffers;
+    CameraBufferPortMap outBuffers;
 
     {
         AutoMutex l(mBufferQueueLock);
@@ -151,8 +152,7 @@ void GPUPostStage::updateInfoAndSendEvents(const v4l2_buffer_t& inV4l2Buf,
     notifyListeners(bufferEvent);
 }
 
-void GPUPostStage::returnBuffers(std::map<uuid, std::shared_ptr<CameraBuffer> >& inBuffers,
-                                 std::map<uuid, std::shared_ptr<CameraBuffer> >& outBuffers) {
+void GPUPostStage::returnBuffers(CameraBufferPortMap& inBuffers, CameraBufferPortMap& outBuffers) {
     // Check and return internal input buffer
     if (inBuffers.find(mInputPort) != inBuffers.end() && !mQueuedInputBuffers.empty()) {
         AutoMutex l(mBufferQueueLock);
@@ -51,18 +51,17 @@ class GPUPostStage : public IPipeStage {
                                  std::shared_ptr<CameraBuffer> outBuffer, int32_t outPort);
 
     bool fetchRequestBuffer(int64_t sequence, std::shared_ptr<CameraBuffer>& inBuffer);
-    void returnBuffers(std::map<uuid, std::shared_ptr<CameraBuffer>>& inBuffers,
-                       std::map<uuid, std::shared_ptr<CameraBuffer>>& outBuffers);
+    void returnBuffers(CameraBufferPortMap& inBuffers, CameraBufferPortMap& outBuffers);
 
  private:
     int32_t mCameraId;
     uuid mInputPort;
     // Collect all buffers for one request. Protected by mBufferQueueLock
     int32_t mOutputBuffersNum;
-    std::map<uuid, std::shared_ptr<CameraBuffer>> mPendingOutBuffers;
+    CameraBufferPortMap mPendingOutBuffers;
 
     // Save internal buffers queued to producers. Protected by mBufferQueueLock
-    std::queue<std::shared_ptr<CameraBuffer>> mQueuedInputBuffers;
+    CameraBufQ mQueuedInputBuffers;
     std::unique_ptr<IntelTNR7Stage> mTnr7Stage;
     Tnr7Param* mTnr7usParam;
 };
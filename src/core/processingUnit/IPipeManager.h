@@ -33,8 +33,6 @@
 
 namespace icamera {
 
-typedef std::map<uuid, std::shared_ptr<CameraBuffer>> CameraBufferPortMap;
-
 struct PipeTaskData {
     IspSettings mIspSettings;
     TuningMode mTuningMode;
@@ -23,6 +23,7 @@
 #include "CameraContext.h"
 #include "3a/AiqResultStorage.h"
 #include "iutils/CameraLog.h"
+#include "iutils/MemoryAccounting.h"
 #include "iutils/Utils.h"
 
 namespace icamera {
@@ -34,7 +35,7 @@ IntelTNR7Stage* IntelTNR7Stage::createIntelTNR(int cameraId) {
     return new IntelTNR7Stage(cameraId);
 }
 
-IntelTNR7Stage::IntelTNR7Stage(int cameraId) : mCameraId(cameraId) {
+IntelTNR7Stage::IntelTNR7Stage(int cameraId) : mCameraId(cameraId), mIcbmBufSize(0U) {
     LOG1("<id%d> %s, Construct", cameraId, __func__);
 }
 
@@ -103,17 +104,23 @@ int IntelTNR7Stage::runTnrFrame(void* inBufAddr, void* outBufAddr, uint32_t inBu
 
 void* IntelTNR7Stage::allocCamBuf(uint32_t bufSize, int id) {
     CheckAndLogError(mIntelICBM == nullptr, nullptr, "%s: No ICBM", __func__);
-    return mIntelICBM->allocBuffer(bufSize, id);
+    void* buf = mIntelICBM->allocBuffer(bufSize, id);
+    if (buf != nullptr) {
+        MemoryAccounting::add(mCameraId, CAMERA_MEMORY_ICBM, bufSize);
+        mIcbmBufSize += bufSize;
+    }
+    return buf;
 }
 
 void IntelTNR7Stage::freeAllBufs() {
     CheckAndLogError(mIntelICBM == nullptr, VOID_VALUE, "%s: No ICBM", __func__);
     mIntelICBM->freeAllBufs();
+    MemoryAccounting::remove(mCameraId, CAMERA_MEMORY_ICBM, mIcbmBufSize);
+    mIcbmBufSize = 0U;
 }
 
 Tnr7Param* IntelTNR7Stage::allocTnr7ParamBuf() {
-    CheckAndLogError(mIntelICBM == nullptr, nullptr, "%s: No ICBM", __func__);
-    return reinterpret_cast<Tnr7Param*>(mIntelICBM->allocBuffer(sizeof(Tnr7Param), 0xFF));
+    return reinterpret_cast<Tnr7Param*>(allocCamBuf(sizeof(Tnr7Param), 0xFF));
 }
 
 int IntelTNR7Stage::getStillTnrTriggerInfo(TuningMode mode) {
@@ -49,6 +49,8 @@ class IntelTNR7Stage {
     int mWidth;
     int mHeight;
     tnr7us_trigger_info_t mStillTnrTriggerInfo;
+    // The bytes of the ICBM buffers allocated, all are freed by freeAllBufs
+    size_t mIcbmBufSize;
 
  private:
     int getStillTnrTriggerInfo(TuningMode mode = TUNING_MODE_VIDEO);
@@ -18,11 +18,13 @@
 
 #include "src/core/processingUnit/PipeLine.h"
 #include "PSysDevice.h"
+#include "MockPSysDevice.h"
 #include "CBStage.h"
 #include "IpuPacAdaptor.h"
 #include "GraphUtils.h"
 #include "iutils/CameraLog.h"
 #include "StageDescriptor.h"
+#include "src/platformdata/PnpDebugControl.h"
 namespace icamera {
 
 PipeLine::PipeLine(int cameraId, int streamId, std::shared_ptr<GraphConfig> gc,
@@ -218,7 +220,11 @@ status_t PipeLine::createPipeStages() {
     if (mPSysDevice) {
         delete mPSysDevice;
     }
-    mPSysDevice = new PSysDevice(mCameraId);
+    if (PnpDebugControl::isUsingMockPSys()) {
+        mPSysDevice = new MockPSysDevice(mCameraId);
+    } else {
+        mPSysDevice = new PSysDevice(mCameraId);
+    }
 
     ret = mPSysDevice->init();
     CheckAndLogError(ret != OK, ret, "%s: failed to initialize psys device", __func__);
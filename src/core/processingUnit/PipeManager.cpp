@@ -32,6 +32,8 @@ PipeManager::PipeManager(int cameraId, PipeManagerCallback* callback,
         : mCameraId(cameraId),
           mScheduler(scheduler),
           mTuningMode(TUNING_MODE_MAX),
+          mOngoingTasks(std::less<int64_t>(),
+                        PoolAllocator<std::pair<const int64_t, TaskInfo>>(&mTaskPool)),
           mPMCallback(callback) {
     LOG1("<id%d>@%s ", mCameraId, __func__);
 
@@ -76,6 +78,9 @@ int PipeManager::configure(const std::map<uuid, stream_t>& inputInfo,
     ret = mPacAdaptor->init(activeStreamIds);
     CheckAndLogError(ret != OK, ret, "Init pac Adaptor failed, tuningMode %d", mTuningMode);
 
+    mTaskPool.setBlocksPerChunk(PlatformData::getMaxRequestsInflight(mCameraId));
+    mActiveStreamIds.reserve(activeStreamIds.size());
+
     mPipeLines.clear();
     ret = createPipeLines(activeStreamIds);
     CheckAndLogError(ret != OK, ret, "@%s, create pipelines failed", __func__);
@@ -402,44 +407,49 @@ void PipeManager::setControl(int64_t sequence, const PipeControl& control) {
 void PipeManager::addTask(PipeTaskData taskParam) {
     LOG2("<id%d>@%s", mCameraId, __func__);
 
-    TaskInfo task = {};
-    // Save the task data into mOngoingTasks
-    task.mTaskData = taskParam;
-    // Count how many valid output buffers need to be returned.
-    for (auto& outBuf : taskParam.mOutputBuffers) {
-        if (outBuf.second != nullptr) {
-            task.mNumOfValidBuffers++;
-        }
-    }
-
-    uuid port = mDefaultMainInputPort;
-    if (taskParam.mYuvTask) {
-        port = YUV_REPROCESSING_INPUT_PORT_ID;
-    }
-
+    const bool yuvTask = taskParam.mYuvTask;
+    const uuid port = yuvTask ? YUV_REPROCESSING_INPUT_PORT_ID : mDefaultMainInputPort;
     const int64_t sequence = taskParam.mInputBuffers.at(port)->getSequence();
-    LOG2("%s:<id%d:seq%ld> push task with %d output buffers", __func__, mCameraId,
-         sequence, task.mNumOfValidBuffers);
-    {
-        AutoMutex taskLock(mTaskLock);
-        std::pair<int64_t, TaskInfo> p(sequence, task);
-        mOngoingTasks.insert(p);
-    }
 
-    if (taskParam.mYuvTask) {
-        queueBuffers(taskParam, mYuvInputMaps, mYuvOutputMaps, YUV_REPROCESSING_INPUT_PORT_ID);
-    } else {
+    // The tasks are added in the processing thread only, so the ids are reused without lock
+    mActiveStreamIds.clear();
+    (void)getActiveStreamIds(taskParam, &mActiveStreamIds);
+
+    if (!yuvTask) {
         // Normally run AIC before execute psys
-        std::vector<int32_t> activeStreamIds;
-        (void)getActiveStreamIds(taskParam, &activeStreamIds);
         LOG2("%s, <seq%ld> run AIC before execute psys, active stream Ids: %zu",
-             __func__, sequence, activeStreamIds.size());
+             __func__, sequence, mActiveStreamIds.size());
 
         TRACE_LOG_PROCESS("run PAC", __func__, MAKE_COLOR(sequence), sequence);
-        for (const auto& id : activeStreamIds) {
+        for (const auto& id : mActiveStreamIds) {
             (void)prepareIpuParams(&taskParam.mIspSettings, sequence, id);
         }
-        queueBuffers(taskParam, mInputMaps, mOutputMaps, mDefaultMainInputPort);
+    }
+
+    // Count how many valid output buffers need to be returned.
+    int validBuffers = 0;
+    for (auto& outBuf : taskParam.mOutputBuffers) {
+        if (outBuf.second != nullptr) {
+            validBuffers++;
+        }
+    }
+    LOG2("%s:<id%d:seq%ld> push task with %d output buffers", __func__, mCameraId, sequence,
+         validBuffers);
+
+    // Save the task data into mOngoingTasks, it's moved, so the buffers are queued from there.
+    // They're queued with mTaskLock, then the task can't be done and erased while they're read,
+    // the stages only queue the buffers in qbuf() and onBufferAvailable().
+    AutoMutex taskLock(mTaskLock);
+    TaskInfo& task = mOngoingTasks.emplace(sequence, TaskInfo())->second;
+    task.mNumOfValidBuffers = validBuffers;
+    task.mTaskData = std::move(taskParam);
+
+    if (yuvTask) {
+        queueBuffers(task.mTaskData, mActiveStreamIds, mYuvInputMaps, mYuvOutputMaps,
+                     YUV_REPROCESSING_INPUT_PORT_ID);
+    } else {
+        queueBuffers(task.mTaskData, mActiveStreamIds, mInputMaps, mOutputMaps,
+                     mDefaultMainInputPort);
     }
 }
 
@@ -597,13 +607,12 @@ bool PipeManager::updateZoomSettings(const camera_zoom_region_t& zoom, PtzInfo*
     return ratioChanged;
 }
 
-void PipeManager::queueBuffers(const PipeTaskData& task, const std::vector<PortMapping>& inputMaps,
+void PipeManager::queueBuffers(const PipeTaskData& task,
+                               const std::vector<int32_t>& activeStreamIds,
+                               const std::vector<PortMapping>& inputMaps,
                                const std::vector<PortMapping>& outputMaps, uuid inputPort) {
     LOG2("<id%d>@%s", mCameraId, __func__);
 
-    std::vector<int32_t> activeStreamIds;
-    (void)getActiveStreamIds(task, &activeStreamIds);
-
     int64_t sequence = task.mInputBuffers.at(inputPort)->getSequence();
     // Provide the output buffers for the output edge.
     for (auto& outputMap : outputMaps) {
@@ -696,7 +705,7 @@ int PipeManager::onBufferDone(uuid port, const std::shared_ptr<CameraBuffer>& bu
 
             task.mNumOfReturnedBuffers++;
             if (task.mNumOfReturnedBuffers >= task.mNumOfValidBuffers) {
-                result = task.mTaskData;
+                result = std::move(task.mTaskData);
                 needReturn = true;
                 LOG2("<Id%d:seq%ld> finish task with %d returned output buffers, ", mCameraId,
                      sequence, task.mNumOfReturnedBuffers);
@@ -26,6 +26,7 @@
 #include "IpuPacAdaptor.h"
 #include "PipeLine.h"
 #include "PlatformData.h"
+#include "iutils/NodePool.h"
 
 namespace icamera {
 
@@ -84,8 +85,13 @@ class PipeManager : public IPipeManager {
     IpuPacAdaptor* mPacAdaptor;
     std::shared_ptr<GraphConfig> mGraphConfig;
     Mutex mTaskLock;
+    // The nodes of mOngoingTasks, sized to the max requests in flight at configure
+    NodePool mTaskPool;
     // map of sequence and taskinfo
-    std::multimap<int64_t, TaskInfo> mOngoingTasks;
+    std::multimap<int64_t, TaskInfo, std::less<int64_t>,
+                  PoolAllocator<std::pair<const int64_t, TaskInfo>>> mOngoingTasks;
+    // The active stream ids of the task being added, reserved at configure
+    std::vector<int32_t> mActiveStreamIds;
 
     // map of output stream to stream id
     std::map<uuid, int32_t> mOutputPortToStreamId;
@@ -138,7 +144,8 @@ class PipeManager : public IPipeManager {
      * @brief queue the task to active pipeLines.
      * @return ICamera::OK if everything goes ok.
      */
-    void queueBuffers(const PipeTaskData& task, const std::vector<PortMapping>& inputMaps,
+    void queueBuffers(const PipeTaskData& task, const std::vector<int32_t>& activeStreamIds,
+                      const std::vector<PortMapping>& inputMaps,
                       const std::vector<PortMapping>& outputMaps, uuid inputPort);
 
     /**
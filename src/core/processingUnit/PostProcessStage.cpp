@@ -28,7 +28,9 @@ PostProcessStage::PostProcessStage(int cameraId, int stageId, const std::string&
           mCameraId(cameraId),
           mMemoryType(V4L2_MEMORY_USERPTR),
           mInputPort(INVALID_PORT),
-          mOutputBuffersNum(0) {}
+          mOutputBuffersNum(0) {
+    setQueueTraceTag(cameraId, stageName);
+}
 PostProcessStage::~PostProcessStage() {}
 
 void PostProcessStage::setFrameInfo(const std::map<uuid, stream_t>& inputInfo,
@@ -138,8 +140,8 @@ void PostProcessStage::setControl(int64_t sequence, const StageControl& control)
 
 bool PostProcessStage::process(int64_t triggerId) {
     PERF_CAMERA_ATRACE_PARAM1(getName(), triggerId);
-    std::map<uuid, std::shared_ptr<CameraBuffer> > inBuffers;
-    std::map<uuid, std::shared_ptr<CameraBuffer> > outBuffers;
+    CameraBufferPortMap inBuffers;
+    CameraBufferPortMap outBuffers;
 
     StageControl control;
     std::shared_ptr<CameraBuffer> inBuffer;
@@ -169,6 +171,7 @@ bool PostProcessStage::process(int64_t triggerId) {
 
         // Do processing only it is for usr request
         if (!control.stillTnrReferIn) {
+            CameraBufferMapper inMapper(inBuffer, DMA_BUF_SYNC_READ);
             CameraBufferMapper mapper(output.second);
 
             int32_t ret = mPostProcessors[outPort]->doPostProcessing(inBuffer, output.second);
@@ -196,8 +199,8 @@ void PostProcessStage::updateInfoAndSendEvents(const v4l2_buffer_t& inV4l2Buf,
     notifyListeners(bufferEvent);
 }
 
-void PostProcessStage::returnBuffers(std::map<uuid, std::shared_ptr<CameraBuffer> >& inBuffers,
-                                     std::map<uuid, std::shared_ptr<CameraBuffer> >& outBuffers) {
+void PostProcessStage::returnBuffers(CameraBufferPortMap& inBuffers,
+                                     CameraBufferPortMap& outBuffers) {
     // Check and return internal input buffer
     if (inBuffers.find(mInputPort) != inBuffers.end() && !mQueuedInputBuffers.empty()) {
         AutoMutex l(mBufferQueueLock);
@@ -228,9 +231,10 @@ int32_t PostProcessStage::allocateBuffers() {
          input.width, input.height);
 
     int32_t size = CameraUtils::getFrameSize(input.format, input.width, input.height);
+    BufferAllocator* allocator = BufferAllocator::getInstance(GET_STREAM_ID(mInputPort));
     for (int i = 0; i < MAX_BUFFER_COUNT; i++) {
-        std::shared_ptr<CameraBuffer> camBuffer =
-            CameraBuffer::create(mMemoryType, size, i, input.format, input.width, input.height);
+        std::shared_ptr<CameraBuffer> camBuffer = CameraBuffer::create(
+            mMemoryType, size, i, input.format, input.width, input.height, allocator);
         CheckAndLogError(!camBuffer, NO_MEMORY, "Allocate producer userptr buffer failed");
 
         camBuffer->setUserBufferFlags(BUFFER_FLAG_SW_READ);
@@ -61,7 +61,7 @@ void FaceSSD::runFaceDetection(const shared_ptr<CameraBuffer>& camBuffer) {
     CheckAndLogError(mInitialized == false, VOID_VALUE, "@%s, mInitialized is false", __func__);
     CheckAndLogError(!camBuffer, VOID_VALUE, "@%s, ccBuf buffer is nullptr", __func__);
 
-    CameraBufferMapper mapper(camBuffer);
+    CameraBufferMapper mapper(camBuffer, DMA_BUF_SYNC_READ);
 
     int64_t sequence = camBuffer->getSequence();
     int input_stride = camBuffer->getStride();
@@ -24,6 +24,7 @@
 #include "Parameters.h"
 #include "PlatformData.h"
 #include "ParameterConvert.h"
+#include "iutils/CameraDump.h"
 #include "iutils/CameraLog.h"
 
 namespace icamera {
@@ -113,6 +114,9 @@ int CameraHal::deinit() {
     // created in init() period
     PlatformData::releaseInstance();
 
+    // Make sure the dump files are completed when HAL is deinit
+    CameraDump::flush();
+
 #ifdef CAMERA_TRACE
     CameraTrace::closeDevice();
 #endif
@@ -365,6 +369,14 @@ int CameraHal::getParameters(int cameraId, Parameters& param, int64_t sequence)
     return OK;
 }
 
+int CameraHal::getStatistics(int cameraId, camera_stats_t* stats) {
+    LOG2("<id%d> @%s", cameraId, __func__);
+    CameraDevice* device = mCameraDevices[cameraId];
+    checkCameraDevice(device, BAD_VALUE);
+
+    return device->getStatistics(stats);
+}
+
 int CameraHal::setParameters(int cameraId, const Parameters& param) {
     LOG2("<id%d> @%s", cameraId, __func__);
     CameraDevice* device = mCameraDevices[cameraId];
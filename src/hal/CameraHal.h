@@ -66,6 +66,7 @@ class CameraHal {
                             Parameters* settings = nullptr);
     virtual int setParameters(int cameraId, const Parameters& param);
     virtual int getParameters(int cameraId, Parameters& param, int64_t sequence);
+    virtual int getStatistics(int cameraId, camera_stats_t* stats);
 
  private:
     DISALLOW_COPY_AND_ASSIGN(CameraHal);
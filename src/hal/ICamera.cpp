@@ -323,6 +323,15 @@ int camera_get_parameters(int camera_id, Parameters& param, int64_t sequence) {
     return gCameraHal->getParameters(camera_id, param, sequence);
 }
 
+int camera_get_statistics(int camera_id, camera_stats_t& stats) {
+    HAL_TRACE_CALL(2);
+    CheckCameraId(camera_id, BAD_VALUE);
+    CheckAndLogError(gCameraHal == nullptr, INVALID_OPERATION,
+                     "camera device is not opened before getting statistics.");
+
+    return gCameraHal->getStatistics(camera_id, &stats);
+}
+
 int get_frame_size(int camera_id, int format, int width, int height, int field, int* bpp) {
     CheckAndLogError(width <= 0, BAD_VALUE, "width <= 0");
     CheckAndLogError(height <= 0, BAD_VALUE, "height <= 0");
@@ -358,6 +367,8 @@ __attribute__((destructor)) void deinitCameraHAL() {
         delete gCameraHal;
         gCameraHal = nullptr;
     }
+    CameraDump::releaseWriter();
+    Log::stopAsyncLog();
 }
 
 }  // namespace icamera
@@ -233,6 +233,11 @@ int MockCameraHal::setParameters(int cameraId, const Parameters& param) {
     return OK;
 }
 
+int MockCameraHal::getStatistics(int cameraId, camera_stats_t* stats) {
+    CLEAR(*stats);
+    return OK;
+}
+
 void MockCameraHal::generateFrames(int cameraId) {
     std::shared_ptr<CaptureRequest> req = nullptr;
     {
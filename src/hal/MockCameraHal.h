@@ -68,6 +68,7 @@ class MockCameraHal : public CameraHal, public Thread {
                             Parameters* settings = nullptr);
     virtual int setParameters(int cameraId, const Parameters& param);
     virtual int getParameters(int cameraId, Parameters& param, int64_t sequence);
+    virtual int getStatistics(int cameraId, camera_stats_t* stats);
 
  private:
     virtual bool threadLoop();
@@ -144,6 +144,7 @@ static void load_camera_hal_library() {
     GET_FUNC_CALL(cameraStreamDqbuf, camera_stream_dqbuf);
     GET_FUNC_CALL(cameraSetParameters, camera_set_parameters);
     GET_FUNC_CALL(cameraGetParameters, camera_get_parameters);
+    GET_FUNC_CALL(cameraGetStatistics, camera_get_statistics);
     GET_FUNC_CALL(getHalFrameSize, get_frame_size);
 }
 
@@ -241,6 +242,11 @@ int camera_get_parameters(int camera_id, Parameters& param, int64_t sequence) {
     return gCameraHalAdaptor.cameraGetParameters(camera_id, param, sequence);
 }
 
+int camera_get_statistics(int camera_id, camera_stats_t& stats) {
+    CheckFuncCall(gCameraHalAdaptor.cameraGetStatistics);
+    return gCameraHalAdaptor.cameraGetStatistics(camera_id, stats);
+}
+
 int get_frame_size(int camera_id, int format, int width, int height, int field, int* bpp) {
     CheckFuncCall(gCameraHalAdaptor.getHalFrameSize);
     return gCameraHalAdaptor.getHalFrameSize(camera_id, format, width, height, field, bpp);
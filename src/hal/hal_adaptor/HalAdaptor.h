@@ -43,6 +43,7 @@ struct HalApiHandle {
                   Parameters* settings);
     _DEF_HAL_FUNC(int, cameraSetParameters, int camera_id, const Parameters& param);
     _DEF_HAL_FUNC(int, cameraGetParameters, int camera_id, Parameters& param, int64_t sequence);
+    _DEF_HAL_FUNC(int, cameraGetStatistics, int camera_id, camera_stats_t& stats);
     _DEF_HAL_FUNC(int, getHalFrameSize, int camera_id, int format, int width, int height,
                   int field, int* bpp);
 };
@@ -19,6 +19,7 @@
 #include "PostProcessorCore.h"
 
 #include "iutils/CameraLog.h"
+#include "iutils/MemoryAccounting.h"
 
 using std::shared_ptr;
 
@@ -103,6 +104,7 @@ bool PostProcessorCore::isBypassed(int64_t sequence) {
 
 status_t PostProcessorCore::allocateInternalBuffers() {
     LOG1("<id%d>@%s,mProcessorVector.size: %zu", mCameraId, __func__, mProcessorVector.size());
+    MemoryAccounting::Scope scope(mCameraId, CAMERA_MEMORY_POST_PROCESSING);
 
     mInterBuffersMap.clear();
 
@@ -127,6 +129,9 @@ status_t PostProcessorCore::doPostProcessing(const shared_ptr<CameraBuffer>& inB
     CheckAndLogError(!inBuf, UNKNOWN_ERROR, "%s, the inBuf is nullptr", __func__);
     CheckAndLogError(!outBuf, UNKNOWN_ERROR, "%s, the outBuf is nullptr", __func__);
 
+    // The processors allocate their crop, scale and thumbnail buffers at the first frame
+    MemoryAccounting::Scope scope(mCameraId, CAMERA_MEMORY_POST_PROCESSING);
+
     shared_ptr<CameraBuffer> input = inBuf;
     shared_ptr<CameraBuffer> output = nullptr;
     std::vector<std::shared_ptr<PostProcessorBase>> processors;
@@ -31,6 +31,7 @@
 
 #include "PlatformData.h"
 #include "iutils/CameraLog.h"
+#include "iutils/DumpWriter.h"
 #include "iutils/Errors.h"
 #include "iutils/Utils.h"
 
@@ -57,6 +58,15 @@ uint32_t gDumpPatternMask = 0xffffffffU;
 uint32_t gDumpPatternLineMin = 0U;
 uint32_t gDumpPatternLineMax = 0U;
 bool gDumpPatternLineEnabled = false;
+bool gDumpAsync = true;
+DumpWriter::Config gDumpWriterConfig = {256ULL << 20, DumpWriter::DROP_NEWEST, false};
+DumpWriter* gDumpWriter = nullptr;
+
+// Never destroyed, releaseWriter() may run after the static destructors at exit
+static Mutex& getDumpWriterLock() {
+    static Mutex* lock = new Mutex;
+    return *lock;
+}
 
 static const char* ModuleName[] = {
     "na",      "sensor",  "isys", "psys", "de-inter",
@@ -111,6 +121,10 @@ void CameraDump::setDumpLevel(void) {
     const char* PROP_CAMERA_HAL_DUMP_PATTERN = "cameraDumpPattern";
     const char* PROP_CAMERA_HAL_DUMP_PATTERN_MASK = "cameraDumpPatternMask";
     const char* PROP_CAMERA_HAL_DUMP_PATTERN_RANGE = "cameraDumpPatternRange";
+    const char* PROP_CAMERA_HAL_DUMP_ASYNC = "cameraDumpAsync";
+    const char* PROP_CAMERA_HAL_DUMP_QUEUE_SIZE = "cameraDumpQueueSize";
+    const char* PROP_CAMERA_HAL_DUMP_DROP_POLICY = "cameraDumpDropPolicy";
+    const char* PROP_CAMERA_HAL_DUMP_DIRECT_IO = "cameraDumpDirectIo";
 
     // dump, it's used to dump images or some parameters to a file.
     char* dumpType = getenv(PROP_CAMERA_HAL_DUMP);
@@ -178,6 +192,39 @@ void CameraDump::setDumpLevel(void) {
         LOG1("Dump pattern range is line %d-%d", gDumpPatternLineMin, gDumpPatternLineMax);
     }
 
+    // Write dump files in a dedicated thread, export cameraDumpAsync=0 to write in caller thread
+    char* cameraDumpAsync = getenv(PROP_CAMERA_HAL_DUMP_ASYNC);
+    if (cameraDumpAsync != nullptr) {
+        gDumpAsync = (strtoul(cameraDumpAsync, nullptr, 0) != 0U);
+        LOG1("Dump async is %d", gDumpAsync);
+    }
+
+    // The max memory (MB) held by the pending dump data
+    char* cameraDumpQueueSize = getenv(PROP_CAMERA_HAL_DUMP_QUEUE_SIZE);
+    if (cameraDumpQueueSize != nullptr) {
+        const uint64_t queueSize = strtoull(cameraDumpQueueSize, nullptr, 0);
+        if (queueSize > 0U) {
+            gDumpWriterConfig.maxQueueBytes = queueSize << 20;
+        }
+        LOG1("Dump queue size is %lu bytes", gDumpWriterConfig.maxQueueBytes);
+    }
+
+    // 0: drop the newest data, 1: drop the oldest data, 2: block the caller when queue is full
+    char* cameraDumpDropPolicy = getenv(PROP_CAMERA_HAL_DUMP_DROP_POLICY);
+    if (cameraDumpDropPolicy != nullptr) {
+        const uint32_t policy = static_cast<uint32_t>(strtoul(cameraDumpDropPolicy, nullptr, 0));
+        if (policy <= static_cast<uint32_t>(DumpWriter::DROP_NONE)) {
+            gDumpWriterConfig.dropPolicy = static_cast<DumpWriter::DropPolicy>(policy);
+        }
+        LOG1("Dump drop policy is %d", gDumpWriterConfig.dropPolicy);
+    }
+
+    char* cameraDumpDirectIo = getenv(PROP_CAMERA_HAL_DUMP_DIRECT_IO);
+    if (cameraDumpDirectIo != nullptr) {
+        gDumpWriterConfig.directIo = (strtoul(cameraDumpDirectIo, nullptr, 0) != 0U);
+        LOG1("Dump direct io is %d", gDumpWriterConfig.directIo);
+    }
+
     // the PG dump is implemented in libiacss
     if ((gDumpType & static_cast<int>(DUMP_PSYS_PG)) != 0U) {
         const char* PROP_CAMERA_CSS_DEBUG = "camera_css_debug";
@@ -222,6 +269,20 @@ void CameraDump::writeData(const void* data, int size, const char* fileName) {
     CheckAndLogError((data == nullptr) || (size == 0) || (fileName == nullptr), VOID_VALUE,
                      "Nothing needs to be dumped");
 
+    if (gDumpAsync) {
+        DumpWriter* writer = nullptr;
+        {
+            AutoMutex l(getDumpWriterLock());
+            if (gDumpWriter == nullptr) {
+                gDumpWriter = new DumpWriter(gDumpWriterConfig);
+                (void)gDumpWriter->run("DumpWriter", PRIORITY_BACKGROUND);
+            }
+            writer = gDumpWriter;
+        }
+        (void)writer->post(data, size, fileName);
+        return;
+    }
+
     FILE* fp = fopen(fileName, "w+");
     CheckAndLogError(fp == nullptr, VOID_VALUE, "open dump file %s failed", fileName);
 
@@ -231,6 +292,22 @@ void CameraDump::writeData(const void* data, int size, const char* fileName) {
     (void)fclose(fp);
 }
 
+void CameraDump::flush(void) {
+    AutoMutex l(getDumpWriterLock());
+    if (gDumpWriter != nullptr) {
+        gDumpWriter->flush();
+    }
+}
+
+void CameraDump::releaseWriter(void) {
+    AutoMutex l(getDumpWriterLock());
+    if (gDumpWriter != nullptr) {
+        gDumpWriter->flush();
+        delete gDumpWriter;
+        gDumpWriter = nullptr;
+    }
+}
+
 static string getNamePrefix(int cameraId, ModuleType_t type, uuid port, int sUsage = 0) {
     const char* dumpPath = CameraDump::getDumpPath();
     const char* sensorName = PlatformData::getSensorName(cameraId);
@@ -508,7 +585,7 @@ void CameraDump::dumpImage(int cameraId, const shared_ptr<CameraBuffer>& camBuff
         CameraUtils::format2string(camBuffer->getFormat()).c_str(), camBuffer->getSequence(),
         camBuffer->getWidth(), camBuffer->getHeight());
 
-    CameraBufferMapper mapper(camBuffer);
+    CameraBufferMapper mapper(camBuffer, DMA_BUF_SYNC_READ);
     if (gDumpPatternEnabled != 0U) {
         if (matchPattern(mapper.addr(), mapper.size(),
                          camBuffer->getWidth(), camBuffer->getHeight(),
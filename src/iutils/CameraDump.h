@@ -138,7 +138,19 @@ namespace CameraDump {
 void setDumpLevel(void);
 bool isDumpTypeEnable(uint32_t dumpType);
 bool isDumpFormatEnable(uint32_t dumpFormat);
+/**
+ * Write data to file. By default the data is copied and written by a dedicated thread,
+ * it may be dropped when the pending dump data exceeds cameraDumpQueueSize.
+ */
 void writeData(const void* data, int size, const char* fileName);
+/**
+ * Wait until all the pending dump data is written.
+ */
+void flush(void);
+/**
+ * Flush the pending dump data and stop the writer thread.
+ */
+void releaseWriter(void);
 const char* getDumpPath(void);
 void parseRange(const char* rangeStr, uint32_t* rangeMin, uint32_t* rangeMax);
 int matchPattern(void* data, int bufferSize, int w, int h, int stride, int format);
@@ -47,6 +47,7 @@ int32_t gSlowlyRunRatio = 0;
 static bool gIsDumpMediaTopo = false;
 // DUMP_ENTITY_TOPOLOGY_E
 static bool gIsDumpMediaInfo = false;
+static AsyncLogSink* gAsyncLogSink = nullptr;
 
 const char* cameraDebugLogToString(uint32_t level) {
     switch (level) {
@@ -122,13 +123,10 @@ void doLogBody(int logTag, uint32_t level, int grpPosition, const char* fmt, ...
         return;
     }
 
-    char message[256];
     va_list ap;
     va_start(ap, fmt);
-    vsnprintf(message, sizeof(message), fmt, ap);
+    globalLogSink->sendOffLogV(level, tagNames[grpPosition], fmt, ap);
     va_end(ap);
-
-    globalLogSink->sendOffLog({message, level, tagNames[grpPosition]});
 }
 
 void doLogBody(int logTag, uint32_t level, const char* fmt, ...) {
@@ -136,13 +134,10 @@ void doLogBody(int logTag, uint32_t level, const char* fmt, ...) {
         return;
     }
 
-    char message[256];
     va_list ap;
     va_start(ap, fmt);
-    vsnprintf(message, sizeof(message), fmt, ap);
+    globalLogSink->sendOffLogV(level, tagNames[logTag], fmt, ap);
     va_end(ap);
-
-    globalLogSink->sendOffLog({message, level, tagNames[logTag]});
 }
 
 namespace Log {
@@ -158,6 +153,21 @@ static void initLogSinks() {
 #endif
     globalLogSink = new StdconLogSink();
     LOG2("Enable Stdcon LOG");
+
+    // Send logs off in background thread, export cameraLogAsync=1 to reduce the timing impact
+    const char* PROP_CAMERA_LOG_ASYNC = "cameraLogAsync";
+    char* logAsync = ::getenv(PROP_CAMERA_LOG_ASYNC);
+    if ((logAsync != nullptr) && (strtoul(logAsync, nullptr, 0) != 0U)) {
+        gAsyncLogSink = new AsyncLogSink(globalLogSink);
+        globalLogSink = gAsyncLogSink;
+        LOG2("Enable async LOG");
+    }
+}
+
+void stopAsyncLog(void) {
+    if (gAsyncLogSink != nullptr) {
+        gAsyncLogSink->stop();
+    }
 }
 
 static void setLogTagLevel() {
@@ -116,6 +116,8 @@ const char* cameraDebugLogToString(uint32_t level);
 
 namespace Log {
 void setDebugLevel(void);
+// Send the pending async logs, the later logs are sent synchronously
+void stopAsyncLog(void);
 bool isDebugLevelEnable(uint32_t level);
 bool isLogTagEnabled(int tag);
 // DUMP_ENTITY_TOPOLOGY_S
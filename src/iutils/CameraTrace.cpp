@@ -19,8 +19,14 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
 
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -34,9 +40,139 @@ int CameraTrace::mTraceFd = -1;
 Mutex CameraTrace::sLock;
 std::unordered_map<std::string, TraceEvent> CameraTrace::mRegisteredEvent;
 
+namespace {
+std::once_flag gTraceRingOnce;
+std::string gTraceRingDir;
+
+/**
+ * The trace ring of one thread, it's only accessed by the owner thread and unmapped
+ * when the thread exits, the file is kept for offline decoding.
+ */
+class TraceRing {
+ public:
+    TraceRing()
+            : mInitFailed(false),
+              mAddr(MAP_FAILED),
+              mSize(0U),
+              mHeader(nullptr),
+              mRecords(nullptr) {}
+
+    ~TraceRing() {
+        if (mAddr != MAP_FAILED) {
+            (void)munmap(mAddr, mSize);
+        }
+    }
+
+    bool init() {
+        if (mAddr != MAP_FAILED) {
+            return true;
+        }
+        // Don't retry in every trace event
+        if (mInitFailed) {
+            return false;
+        }
+        mInitFailed = true;
+
+        const pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+        const std::string fileName = gTraceRingDir + "/camtrace_" + std::to_string(getpid()) +
+                                     "_" + std::to_string(tid) + ".bin";
+
+        const int fd = open(fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+
+        mSize = TRACE_RING_RECORD_OFFSET + TRACE_RING_RECORD_COUNT * sizeof(TraceRingRecord);
+        if (ftruncate(fd, mSize) != 0) {
+            (void)close(fd);
+            return false;
+        }
+        mAddr = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        (void)close(fd);
+        if (mAddr == MAP_FAILED) {
+            return false;
+        }
+        mInitFailed = false;
+
+        mHeader = static_cast<TraceRingHeader*>(mAddr);
+        MEMCPY_S(mHeader->magic, sizeof(mHeader->magic), TRACE_RING_MAGIC,
+                 sizeof(mHeader->magic));
+        mHeader->version = TRACE_RING_VERSION;
+        mHeader->recordSize = sizeof(TraceRingRecord);
+        mHeader->recordCount = TRACE_RING_RECORD_COUNT;
+        mHeader->pid = static_cast<uint32_t>(getpid());
+        mHeader->tid = static_cast<uint32_t>(tid);
+        (void)prctl(PR_GET_NAME, mHeader->threadName);
+        mRecords = reinterpret_cast<TraceRingRecord*>(static_cast<char*>(mAddr) +
+                                                      TRACE_RING_RECORD_OFFSET);
+        return true;
+    }
+
+    int getEventId(const char* eventName) {
+        // The event names are mostly string literals, so look up by address first
+        auto it = mEventIds.find(eventName);
+        if (it != mEventIds.end()) {
+            return it->second;
+        }
+
+        if (mHeader->eventCount >= TRACE_RING_MAX_EVENTS) {
+            return -1;
+        }
+
+        const int id = static_cast<int>(mHeader->eventCount);
+        char* name = static_cast<char*>(mAddr) + TRACE_RING_NAME_OFFSET +
+                     id * CAMERA_TRACE_NAME_LEN;
+        snprintf(name, CAMERA_TRACE_NAME_LEN, "%s", eventName);
+        mHeader->eventCount++;
+        mEventIds[eventName] = id;
+        return id;
+    }
+
+    void write(int eventId, TraceEventType type, TraceLogType payloadType, const void* payload,
+               size_t payloadSize, uint32_t data1, uint32_t data2) {
+        const uint64_t index = mHeader->writeIndex;
+        TraceRingRecord* record = &mRecords[index % TRACE_RING_RECORD_COUNT];
+
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        record->timestamp = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+        record->eventId = static_cast<uint16_t>(eventId);
+        record->type = static_cast<uint8_t>(type);
+        record->payloadType = static_cast<uint8_t>(payloadType);
+        record->payloadSize = 0U;
+        record->data1 = data1;
+        record->data2 = data2;
+        if ((payload != nullptr) && (payloadSize > 0U)) {
+            record->payloadSize = std::min(payloadSize, sizeof(record->payload));
+            MEMCPY_S(record->payload, sizeof(record->payload), payload, record->payloadSize);
+        }
+
+        // Publish the record after it's completed
+        std::atomic_thread_fence(std::memory_order_release);
+        mHeader->writeIndex = index + 1U;
+    }
+
+ private:
+    bool mInitFailed;
+    void* mAddr;
+    size_t mSize;
+    TraceRingHeader* mHeader;
+    TraceRingRecord* mRecords;
+    std::unordered_map<const char*, int> mEventIds;
+};
+
+thread_local TraceRing gTraceRing;
+}  // namespace
+
 CameraTrace::CameraTrace(TraceEventType type, const char* eventName, uint32_t data1, uint32_t data2)
         : mEventType(type),
-          mTraceEvent(0) {
+          mTraceEvent(0),
+          mRingEventId(-1) {
+    if (isTraceRingEnabled()) {
+        (void)ringTraceLog(eventName, TraceLog, nullptr, 0U, data1, data2);
+        return;
+    }
+
     if ((mTraceEvent = registerTraceEvent(eventName)) == 0) {
         return;
     }
@@ -47,7 +183,14 @@ CameraTrace::CameraTrace(TraceEventType type, const char* eventName, uint32_t da
 CameraTrace::CameraTrace(TraceEventType type, const char* eventName, const char* paramStr,
                          uint32_t data1, uint32_t data2)
         : mEventType(type),
-          mTraceEvent(0) {
+          mTraceEvent(0),
+          mRingEventId(-1) {
+    if (isTraceRingEnabled()) {
+        (void)ringTraceLog(eventName, TraceMetaStringMBS, paramStr,
+                           (paramStr != nullptr) ? strlen(paramStr) + 1 : 0U, data1, data2);
+        return;
+    }
+
     if ((mTraceEvent = registerTraceEvent(eventName)) == 0) {
         return;
     }
@@ -58,7 +201,13 @@ CameraTrace::CameraTrace(TraceEventType type, const char* eventName, const char*
 CameraTrace::CameraTrace(TraceEventType type, const char* eventName, const char* structName,
                          void* pStruct, size_t structSize, uint32_t data1, uint32_t data2)
         : mEventType(type),
-          mTraceEvent(0) {
+          mTraceEvent(0),
+          mRingEventId(-1) {
+    if (isTraceRingEnabled()) {
+        (void)ringTraceLog(eventName, TraceMetaStructure, pStruct, structSize, data1, data2);
+        return;
+    }
+
     if ((mTraceEvent = registerTraceEvent(eventName)) == 0) {
         return;
     }
@@ -67,6 +216,13 @@ CameraTrace::CameraTrace(TraceEventType type, const char* eventName, const char*
 }
 
 CameraTrace::~CameraTrace() {
+    if (mRingEventId >= 0) {
+        if (mEventType == TraceEventStart) {
+            gTraceRing.write(mRingEventId, TraceEventEnd, TraceLog, nullptr, 0U, 0U, 0U);
+        }
+        return;
+    }
+
     if (mTraceEvent == 0) {
         return;
     }
@@ -87,6 +243,33 @@ void CameraTrace::closeDevice() {
     }
 }
 
+bool CameraTrace::isTraceRingEnabled() {
+    std::call_once(gTraceRingOnce, [] {
+        const char* traceRingDir = getenv("cameraTraceRing");
+        if (traceRingDir != nullptr) {
+            gTraceRingDir = traceRingDir;
+        }
+    });
+
+    return !gTraceRingDir.empty();
+}
+
+bool CameraTrace::ringTraceLog(const char* eventName, TraceLogType payloadType,
+                               const void* payload, size_t payloadSize, uint32_t data1,
+                               uint32_t data2) {
+    if ((eventName == nullptr) || !gTraceRing.init()) {
+        return false;
+    }
+
+    mRingEventId = gTraceRing.getEventId(eventName);
+    if (mRingEventId < 0) {
+        return false;
+    }
+
+    gTraceRing.write(mRingEventId, mEventType, payloadType, payload, payloadSize, data1, data2);
+    return true;
+}
+
 void CameraTrace::enableEvent(TraceEvent event) {
     unsigned int cmd[3];
     cmd[0] = event;
@@ -73,6 +73,52 @@ struct TraceMetadataLog {
     TraceMetadata metaData;
 };
 
+/**
+ * Trace ring backend, enabled by "export cameraTraceRing=<dir>", e.g. /dev/shm.
+ *
+ * Instead of one ioctl per event, each tracing thread writes fixed-size records into
+ * its own shared file mapping <dir>/camtrace_<pid>_<tid>.bin, which survives a crash
+ * and can be decoded offline. The file layout is:
+ *   TraceRingHeader                  at offset 0
+ *   char name[TRACE_RING_MAX_EVENTS][CAMERA_TRACE_NAME_LEN]
+ *                                    at TRACE_RING_NAME_OFFSET, indexed by eventId
+ *   TraceRingRecord[recordCount]     at TRACE_RING_RECORD_OFFSET, record i is stored
+ *                                    in slot (i % recordCount)
+ * writeIndex is the total number of records written, so the valid records are
+ * [max(0, writeIndex - recordCount), writeIndex).
+ */
+#define TRACE_RING_MAGIC "CAMTRACE"
+#define TRACE_RING_VERSION 1
+#define TRACE_RING_MAX_EVENTS 256
+#define TRACE_RING_RECORD_COUNT 4096
+#define TRACE_RING_PAYLOAD_SIZE 40
+#define TRACE_RING_NAME_OFFSET 4096
+#define TRACE_RING_RECORD_OFFSET \
+    (TRACE_RING_NAME_OFFSET + TRACE_RING_MAX_EVENTS * CAMERA_TRACE_NAME_LEN)
+
+struct TraceRingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t recordCount;
+    uint32_t eventCount;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t writeIndex;
+    char threadName[16];
+};
+
+struct TraceRingRecord {
+    uint64_t timestamp;    // CLOCK_MONOTONIC in ns
+    uint16_t eventId;      // index of the event name table
+    uint8_t type;          // TraceEventType
+    uint8_t payloadType;   // TraceLogType of payload
+    uint32_t payloadSize;  // valid bytes in payload, the string or structure is truncated
+    uint32_t data1;
+    uint32_t data2;
+    uint8_t payload[TRACE_RING_PAYLOAD_SIZE];
+};
+
 class CameraTrace {
  public:
     // Basic trace: support to print two uint32_t parameters
@@ -103,9 +149,15 @@ class CameraTrace {
     int cameraTraceLogStructure(const char* structName = nullptr, size_t structSize = 0,
                                 void* pStruct = 0, uint32_t data1 = 0, uint32_t data2 = 0);
 
+    static bool isTraceRingEnabled();
+    bool ringTraceLog(const char* eventName, TraceLogType payloadType, const void* payload,
+                      size_t payloadSize, uint32_t data1, uint32_t data2);
+
  private:
     TraceEventType mEventType;
     TraceEvent mTraceEvent;
+    // The event id in the trace ring of current thread, -1 if the ring isn't used
+    int mRingEventId;
 
     static std::unordered_map<std::string, TraceEvent> mRegisteredEvent;
     static int mTraceFd;
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG DumpWriter
+
+#include "iutils/DumpWriter.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "iutils/CameraLog.h"
+#include "iutils/Errors.h"
+
+namespace icamera {
+
+// O_DIRECT needs the buffer address and the write size aligned to the logical block size
+static const size_t kDirectIoAlignment = 4096U;
+
+DumpWriter::DumpWriter(const Config& config)
+        : mConfig(config),
+          mQueueBytes(0U),
+          mWriting(false),
+          mStopping(false) {
+    CLEAR(mStats);
+    LOG1("%s, max queue %lu bytes, drop policy %d, direct io %d", __func__,
+         mConfig.maxQueueBytes, mConfig.dropPolicy, mConfig.directIo);
+}
+
+DumpWriter::~DumpWriter() {
+    stop();
+}
+
+int DumpWriter::post(const void* data, int size, const char* fileName) {
+    CheckAndLogError((data == nullptr) || (size <= 0) || (fileName == nullptr), BAD_VALUE,
+                     "Nothing needs to be dumped");
+
+    std::unique_ptr<Item> item(new Item());
+    item->fileName = fileName;
+    item->size = size;
+    item->allocSize = ALIGN(static_cast<size_t>(size), kDirectIoAlignment);
+
+    {
+        ConditionLock lock(mLock);
+        // Make room before copying, so the dropped data doesn't cost the copy
+        while (!mQueue.empty() && (mQueueBytes + item->allocSize > mConfig.maxQueueBytes)) {
+            if (mConfig.dropPolicy == DROP_OLDEST) {
+                dropOldestLocked();
+            } else if ((mConfig.dropPolicy == DROP_NONE) && !mStopping) {
+                mSpaceSignal.wait(lock);
+            } else {
+                mStats.dropped++;
+                LOG2("%s, queue is full (%lu bytes), drop %s", __func__, mQueueBytes, fileName);
+                return NO_MEMORY;
+            }
+        }
+        mQueueBytes += item->allocSize;
+    }
+
+    // Copy out of the lock, the queue bytes are already reserved
+    void* buf = nullptr;
+    if (posix_memalign(&buf, kDirectIoAlignment, item->allocSize) != 0) {
+        AutoMutex l(mLock);
+        mQueueBytes -= item->allocSize;
+        mStats.dropped++;
+        LOGW("%s, failed to allocate %zu bytes for %s", __func__, item->allocSize, fileName);
+        return NO_MEMORY;
+    }
+    item->data.reset(static_cast<uint8_t*>(buf));
+    MEMCPY_S(item->data.get(), item->allocSize, data, size);
+    if (item->allocSize > static_cast<size_t>(size)) {
+        memset(item->data.get() + size, 0, item->allocSize - size);
+    }
+
+    {
+        AutoMutex l(mLock);
+        mQueue.push_back(std::move(item));
+        mStats.queued++;
+        if (mQueueBytes > mStats.peakQueueBytes) {
+            mStats.peakQueueBytes = mQueueBytes;
+        }
+    }
+    mPendingSignal.signal();
+
+    return OK;
+}
+
+void DumpWriter::dropOldestLocked() {
+    const std::unique_ptr<Item>& oldest = mQueue.front();
+    LOG2("%s, queue is full (%lu bytes), drop %s", __func__, mQueueBytes,
+         oldest->fileName.c_str());
+    mQueueBytes -= oldest->allocSize;
+    mQueue.pop_front();
+    mStats.dropped++;
+}
+
+void DumpWriter::flush() {
+    ConditionLock lock(mLock);
+    while (!mQueue.empty() || mWriting) {
+        if (!isRunning()) {
+            break;
+        }
+        (void)mSpaceSignal.waitRelative(lock, kWaitDuration);
+    }
+}
+
+void DumpWriter::stop() {
+    Thread::exit();
+    {
+        AutoMutex l(mLock);
+        mStopping = true;
+        mPendingSignal.signal();
+        mSpaceSignal.broadcast();
+    }
+    Thread::wait();
+
+    AutoMutex l(mLock);
+    if (mStats.queued > 0U) {
+        LOGI("Dump writer: queued %lu, written %lu (%lu bytes), dropped %lu, failed %lu, "
+             "peak queue %lu bytes", mStats.queued, mStats.written, mStats.writtenBytes,
+             mStats.dropped, mStats.failed, mStats.peakQueueBytes);
+    }
+}
+
+void DumpWriter::getStats(Stats* stats) {
+    CheckAndLogError(stats == nullptr, VOID_VALUE, "stats is nullptr");
+
+    AutoMutex l(mLock);
+    *stats = mStats;
+}
+
+bool DumpWriter::writeItem(const Item& item) {
+    int fd = -1;
+    bool directIo = false;
+    if (mConfig.directIo) {
+        fd = open(item.fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT | O_CLOEXEC,
+                  S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+        // Some file systems (e.g. tmpfs) don't support O_DIRECT
+        directIo = (fd >= 0);
+    }
+    if (fd < 0) {
+        fd = open(item.fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    }
+    CheckAndLogError(fd < 0, false, "open dump file %s failed, error %s", item.fileName.c_str(),
+                     strerror(errno));
+
+    LOG1("Write data to file:%s", item.fileName.c_str());
+    // Direct io writes the padded buffer, and the padding is truncated afterwards
+    const size_t writeSize = directIo ? item.allocSize : static_cast<size_t>(item.size);
+    size_t offset = 0U;
+    while (offset < writeSize) {
+        const ssize_t ret = write(fd, item.data.get() + offset, writeSize - offset);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        offset += static_cast<size_t>(ret);
+    }
+
+    bool success = (offset == writeSize);
+    if (success && directIo && (ftruncate(fd, item.size) != 0)) {
+        success = false;
+    }
+    if (!success) {
+        LOGW("Error or short count writing %d bytes to %s, error %s", item.size,
+             item.fileName.c_str(), strerror(errno));
+    }
+    (void)close(fd);
+
+    return success;
+}
+
+bool DumpWriter::threadLoop() {
+    std::unique_ptr<Item> item;
+    {
+        ConditionLock lock(mLock);
+        if (mQueue.empty()) {
+            if (mStopping) {
+                return false;
+            }
+            (void)mPendingSignal.waitRelative(lock, kWaitDuration);
+            return true;
+        }
+
+        item = std::move(mQueue.front());
+        mQueue.pop_front();
+        mWriting = true;
+    }
+
+    const bool success = writeItem(*item);
+
+    {
+        AutoMutex l(mLock);
+        mQueueBytes -= item->allocSize;
+        mWriting = false;
+        if (success) {
+            mStats.written++;
+            mStats.writtenBytes += item->size;
+        } else {
+            mStats.failed++;
+        }
+        mSpaceSignal.broadcast();
+    }
+
+    return true;
+}
+
+}  // namespace icamera
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "iutils/Thread.h"
+#include "iutils/Utils.h"
+
+namespace icamera {
+
+/**
+ * DumpWriter writes the dump files in its own thread, so the pipeline thread which
+ * dumps a frame or a parameter only pays a memory copy.
+ *
+ * The pending data is capped by memory size. When the queue is full, the drop policy
+ * decides whether the new data, the oldest data is dropped, or the caller is blocked
+ * until there is room (for complete captures where frame drops are acceptable).
+ */
+class DumpWriter : public Thread {
+ public:
+    enum DropPolicy {
+        DROP_NEWEST = 0,
+        DROP_OLDEST,
+        DROP_NONE,
+    };
+
+    struct Config {
+        uint64_t maxQueueBytes;
+        DropPolicy dropPolicy;
+        bool directIo;
+    };
+
+    struct Stats {
+        uint64_t queued;
+        uint64_t written;
+        uint64_t dropped;
+        uint64_t failed;
+        uint64_t writtenBytes;
+        uint64_t peakQueueBytes;
+    };
+
+    explicit DumpWriter(const Config& config);
+    ~DumpWriter();
+
+    /**
+     * Copy the data and queue it for writing to fileName.
+     *
+     * \return OK if queued, NO_MEMORY if the data is dropped.
+     */
+    int post(const void* data, int size, const char* fileName);
+
+    /**
+     * Wait until all the queued data is written.
+     */
+    void flush();
+    void stop();
+
+    void getStats(Stats* stats);
+
+ private:
+    struct Item {
+        std::string fileName;
+        std::unique_ptr<uint8_t, void (*)(void*)> data;
+        int size;
+        size_t allocSize;
+
+        Item() : data(nullptr, free), size(0), allocSize(0U) {}
+    };
+
+    bool threadLoop();
+    void dropOldestLocked();
+    bool writeItem(const Item& item);
+
+ private:
+    static const nsecs_t kWaitDuration = 1000000000;  // 1s
+
+    Config mConfig;
+
+    Mutex mLock;
+    Condition mPendingSignal;
+    Condition mSpaceSignal;
+    std::deque<std::unique_ptr<Item>> mQueue;
+    uint64_t mQueueBytes;
+    bool mWriting;
+    bool mStopping;
+    Stats mStats;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(DumpWriter);
+};
+
+}  // namespace icamera
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace icamera {
+
+// Log the misuse of FlatMap, the templates can't use the LOG_TAG of the including file
+void reportFlatMapError(const char* func, size_t capacity);
+
+/**
+ * FlatMap: a map with a fixed capacity, the items are stored sorted in an array.
+ *
+ * It's used for the small per-frame maps, such as the buffers of one task indexed by port.
+ * Building and copying it doesn't allocate memory, and finding a key is a short linear scan.
+ * The interface is the subset of std::map used in the HAL, and the items are iterated in the
+ * key order as std::map.
+ * The slots after size() always hold the default value, so the copy and move are the default
+ * ones, and an erased item releases what it holds (e.g. the buffer reference) immediately.
+ */
+template <typename Key, typename T, size_t Capacity>
+class FlatMap {
+ public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef std::pair<Key, T> value_type;
+    typedef value_type* iterator;
+    typedef const value_type* const_iterator;
+
+    FlatMap() : mSize(0U) {}
+
+    iterator begin() { return mItems.data(); }
+    iterator end() { return mItems.data() + mSize; }
+    const_iterator begin() const { return mItems.data(); }
+    const_iterator end() const { return mItems.data() + mSize; }
+
+    bool empty() const { return mSize == 0U; }
+    size_t size() const { return mSize; }
+    static size_t max_size() { return Capacity; }
+
+    void clear() {
+        for (size_t i = 0U; i < mSize; i++) {
+            mItems[i] = value_type();
+        }
+        mSize = 0U;
+    }
+
+    iterator find(const Key& key) {
+        iterator it = lowerBound(key);
+        return ((it != end()) && (it->first == key)) ? it : end();
+    }
+    const_iterator find(const Key& key) const {
+        const_iterator it = std::lower_bound(begin(), end(), key, keyLess);
+        return ((it != end()) && (it->first == key)) ? it : end();
+    }
+    size_t count(const Key& key) const { return (find(key) != end()) ? 1U : 0U; }
+
+    // Return the spare slot if the map is full, the item isn't added
+    T& operator[](const Key& key) { return insert(value_type(key, T())).first->second; }
+
+    // Return the spare slot if the key doesn't exist
+    const T& at(const Key& key) const {
+        const_iterator it = find(key);
+        if (it == end()) {
+            reportFlatMapError(__func__, Capacity);
+            return mSpare.second;
+        }
+        return it->second;
+    }
+    T& at(const Key& key) {
+        iterator it = find(key);
+        if (it == end()) {
+            reportFlatMapError(__func__, Capacity);
+            mSpare = value_type();
+            return mSpare.second;
+        }
+        return it->second;
+    }
+
+    std::pair<iterator, bool> insert(value_type&& item) {
+        iterator it = lowerBound(item.first);
+        if ((it != end()) && (it->first == item.first)) {
+            return std::make_pair(it, false);
+        }
+        if (mSize == Capacity) {
+            reportFlatMapError(__func__, Capacity);
+            mSpare = value_type();
+            return std::make_pair(&mSpare, false);
+        }
+
+        std::move_backward(it, end(), end() + 1);
+        *it = std::move(item);
+        mSize++;
+        return std::make_pair(it, true);
+    }
+    std::pair<iterator, bool> insert(const value_type& item) { return insert(value_type(item)); }
+
+    iterator erase(iterator pos) {
+        std::move(pos + 1, end(), pos);
+        mSize--;
+        mItems[mSize] = value_type();
+        return pos;
+    }
+    size_t erase(const Key& key) {
+        iterator it = find(key);
+        if (it == end()) {
+            return 0U;
+        }
+        (void)erase(it);
+        return 1U;
+    }
+
+ private:
+    static bool keyLess(const value_type& item, const Key& key) { return item.first < key; }
+    iterator lowerBound(const Key& key) { return std::lower_bound(begin(), end(), key, keyLess); }
+
+ private:
+    std::array<value_type, Capacity> mItems;
+    size_t mSize;
+    value_type mSpare;  // Returned when the item can't be stored or found
+};
+
+}  // namespace icamera
@@ -17,9 +17,14 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/types.h>
 
 #ifdef LIBCAMERA_BUILD
 #include <libcamera/base/log.h>
@@ -29,6 +34,9 @@
 #include <sys/time.h>
 #include <time.h>
 
+#include <algorithm>
+#include <chrono>
+
 #include "iutils/LogSink.h"
 #include "iutils/Utils.h"
 
@@ -67,14 +75,25 @@ void LibcameraLogSink::sendOffLog(LogItem logItem) {
 #endif
 void StdconLogSink::sendOffLog(LogItem logItem) {
     char timeInfo[TIME_BUF_SIZE];
-    LogOutputSink::setLogTime(timeInfo);
+    LogOutputSink::setLogTime(timeInfo, logItem.timeUs);
     fprintf(stdout, "[%s] CamHAL[%s] %s: %s\n", timeInfo,
             icamera::cameraDebugLogToString(logItem.level), logItem.logTags, logItem.logEntry);
 }
 
-void LogOutputSink::setLogTime(char* timeBuf) {
+static int64_t getLogTimeUs() {
     struct timeval tv;
     gettimeofday(&tv, nullptr);
+    return static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+void LogOutputSink::setLogTime(char* timeBuf, int64_t timeUs) {
+    struct timeval tv;
+    if (timeUs > 0) {
+        tv.tv_sec = static_cast<time_t>(timeUs / 1000000);
+        tv.tv_usec = static_cast<suseconds_t>(timeUs % 1000000);
+    } else {
+        gettimeofday(&tv, nullptr);
+    }
     const time_t nowtime = tv.tv_sec;
     struct tm local_tm;
 
@@ -98,7 +117,7 @@ FtraceLogSink::FtraceLogSink() {
 
 void FtraceLogSink::sendOffLog(LogItem logItem) {
     char timeInfo[TIME_BUF_SIZE];
-    setLogTime(timeInfo);
+    setLogTime(timeInfo, logItem.timeUs);
     dprintf(mFtraceFD, "%s CamHAL[%s] %s\n", timeInfo, cameraDebugLogToString(logItem.level),
             logItem.logEntry);
 }
@@ -116,10 +135,601 @@ FileLogSink::FileLogSink() {
 
 void FileLogSink::sendOffLog(LogItem logItem) {
     char timeInfo[TIME_BUF_SIZE];
-    LogOutputSink::setLogTime(timeInfo);
+    LogOutputSink::setLogTime(timeInfo, logItem.timeUs);
     fprintf(mFp, "[%s] CamHAL[%s] %s:%s\n", timeInfo,
             icamera::cameraDebugLogToString(logItem.level), logItem.logTags, logItem.logEntry);
     (void)fflush(mFp);
 }
 
+// The max length of one log message, the longer message is truncated
+static const int LOG_ENTRY_SIZE = 256;
+
+void LogOutputSink::sendOffLogV(uint32_t level, const char* logTags, const char* fmt,
+                                va_list ap) {
+    char message[LOG_ENTRY_SIZE];
+    vsnprintf(message, sizeof(message), fmt, ap);
+    sendOffLog({message, level, logTags, 0});
+}
+
+// Must be power of 2
+static const uint32_t ASYNC_LOG_RING_SIZE = 256U;
+static const int ASYNC_LOG_POLL_INTERVAL_MS = 2;
+// The logs with more arguments are formatted in the logging thread
+static const uint32_t ASYNC_LOG_MAX_ARGS = 16U;
+
+namespace {
+union LogArg {
+    long long i;
+    unsigned long long u;
+    double d;
+    const void* p;
+};
+
+enum LogArgLength {
+    ARG_LEN_NONE,
+    ARG_LEN_HH,
+    ARG_LEN_H,
+    ARG_LEN_L,
+    ARG_LEN_LL,
+    ARG_LEN_J,
+    ARG_LEN_Z,
+    ARG_LEN_T,
+    ARG_LEN_LONG_DOUBLE,
+};
+
+// One conversion specification of the printf format
+struct LogFormatSpec {
+    char flags[8];
+    bool hasWidth;
+    bool widthArg;  // The width is given by an int argument
+    int width;
+    bool hasPrecision;
+    bool precisionArg;  // The precision is given by an int argument
+    int precision;
+    LogArgLength length;
+    char conversion;
+};
+
+// Parse the specification after '%', return the end of it or nullptr if it isn't supported
+const char* parseFormatSpec(const char* fmt, LogFormatSpec* spec) {
+    CLEAR(*spec);
+    size_t flagNum = 0U;
+    while ((*fmt != '\0') && (strchr("-+ #0", *fmt) != nullptr)) {
+        if (flagNum < sizeof(spec->flags) - 1U) {
+            spec->flags[flagNum++] = *fmt;
+        }
+        fmt++;
+    }
+
+    if (*fmt == '*') {
+        spec->hasWidth = true;
+        spec->widthArg = true;
+        fmt++;
+    } else if ((*fmt >= '0') && (*fmt <= '9')) {
+        spec->hasWidth = true;
+        spec->width = static_cast<int>(strtol(fmt, const_cast<char**>(&fmt), 10));
+    }
+
+    if (*fmt == '.') {
+        spec->hasPrecision = true;
+        fmt++;
+        if (*fmt == '*') {
+            spec->precisionArg = true;
+            fmt++;
+        } else {
+            spec->precision = static_cast<int>(strtol(fmt, const_cast<char**>(&fmt), 10));
+        }
+    }
+
+    switch (*fmt) {
+        case 'h':
+            spec->length = (fmt[1] == 'h') ? ARG_LEN_HH : ARG_LEN_H;
+            fmt += (fmt[1] == 'h') ? 2 : 1;
+            break;
+        case 'l':
+            spec->length = (fmt[1] == 'l') ? ARG_LEN_LL : ARG_LEN_L;
+            fmt += (fmt[1] == 'l') ? 2 : 1;
+            break;
+        case 'j':
+            spec->length = ARG_LEN_J;
+            fmt++;
+            break;
+        case 'z':
+            spec->length = ARG_LEN_Z;
+            fmt++;
+            break;
+        case 't':
+            spec->length = ARG_LEN_T;
+            fmt++;
+            break;
+        case 'L':
+            spec->length = ARG_LEN_LONG_DOUBLE;
+            fmt++;
+            break;
+        default:
+            break;
+    }
+
+    spec->conversion = *fmt;
+    return (*fmt == '\0') ? nullptr : fmt + 1;
+}
+
+struct LogSlot {
+    // The format isn't copied, it's a string literal. nullptr if text has the message.
+    const char* fmt;
+    uint32_t argNum;
+    LogArg args[ASYNC_LOG_MAX_ARGS];
+    // The copies of the string arguments, or the message formatted in the logging thread
+    char text[LOG_ENTRY_SIZE];
+    size_t textSize;
+    uint32_t level;
+    const char* logTags;
+    int64_t timeUs;
+};
+}  // namespace
+
+struct AsyncLogSink::LogRing {
+    LogRing() : head(0U), tail(0U), dropped(0U), pushing(false), retired(false) {}
+
+    LogSlot slots[ASYNC_LOG_RING_SIZE];
+    std::atomic<uint32_t> head;  // Written by the logging thread
+    std::atomic<uint32_t> tail;  // Written by the background thread
+    std::atomic<uint32_t> dropped;
+    std::atomic<bool> pushing;   // The logging thread is pushing, stop() waits for it
+    std::atomic<bool> retired;   // The logging thread has exited
+};
+
+namespace {
+// Mark the ring as retired when the logging thread exits, the ring is released after drained
+struct ThreadLogRing {
+    std::shared_ptr<void> owner;
+    std::atomic<bool>* retired = nullptr;
+
+    ~ThreadLogRing() {
+        if (retired != nullptr) {
+            retired->store(true, std::memory_order_release);
+        }
+    }
+};
+thread_local ThreadLogRing gThreadLogRing;
+
+// Store the arguments of fmt in the slot, the strings are copied into the slot text.
+// Return false if the format isn't supported, ap is undefined then.
+bool captureLogArgs(const char* fmt, va_list ap, LogSlot* slot) {
+    slot->argNum = 0U;
+    slot->textSize = 0U;
+
+    LogFormatSpec spec;
+    while ((fmt = strchr(fmt, '%')) != nullptr) {
+        fmt++;
+        if (*fmt == '%') {
+            fmt++;
+            continue;
+        }
+        fmt = parseFormatSpec(fmt, &spec);
+        if (fmt == nullptr) {
+            return false;
+        }
+        const uint32_t argNum = (spec.widthArg ? 1U : 0U) + (spec.precisionArg ? 1U : 0U) + 1U;
+        if (slot->argNum + argNum > ASYNC_LOG_MAX_ARGS) {
+            return false;
+        }
+        if (spec.widthArg) {
+            slot->args[slot->argNum++].i = va_arg(ap, int);
+        }
+        if (spec.precisionArg) {
+            slot->args[slot->argNum++].i = va_arg(ap, int);
+        }
+
+        LogArg& arg = slot->args[slot->argNum++];
+        switch (spec.conversion) {
+            case 'd':
+            case 'i':
+                switch (spec.length) {
+                    case ARG_LEN_HH:
+                        arg.i = static_cast<signed char>(va_arg(ap, int));
+                        break;
+                    case ARG_LEN_H:
+                        arg.i = static_cast<short>(va_arg(ap, int));
+                        break;
+                    case ARG_LEN_L:
+                        arg.i = va_arg(ap, long);
+                        break;
+                    case ARG_LEN_LL:
+                        arg.i = va_arg(ap, long long);
+                        break;
+                    case ARG_LEN_J:
+                        arg.i = va_arg(ap, intmax_t);
+                        break;
+                    case ARG_LEN_Z:
+                        arg.i = va_arg(ap, ssize_t);
+                        break;
+                    case ARG_LEN_T:
+                        arg.i = va_arg(ap, ptrdiff_t);
+                        break;
+                    case ARG_LEN_NONE:
+                        arg.i = va_arg(ap, int);
+                        break;
+                    default:
+                        return false;
+                }
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                switch (spec.length) {
+                    case ARG_LEN_HH:
+                        arg.u = static_cast<unsigned char>(va_arg(ap, unsigned int));
+                        break;
+                    case ARG_LEN_H:
+                        arg.u = static_cast<unsigned short>(va_arg(ap, unsigned int));
+                        break;
+                    case ARG_LEN_L:
+                        arg.u = va_arg(ap, unsigned long);
+                        break;
+                    case ARG_LEN_LL:
+                        arg.u = va_arg(ap, unsigned long long);
+                        break;
+                    case ARG_LEN_J:
+                        arg.u = va_arg(ap, uintmax_t);
+                        break;
+                    case ARG_LEN_Z:
+                        arg.u = va_arg(ap, size_t);
+                        break;
+                    case ARG_LEN_T:
+                        arg.u = static_cast<size_t>(va_arg(ap, ptrdiff_t));
+                        break;
+                    case ARG_LEN_NONE:
+                        arg.u = va_arg(ap, unsigned int);
+                        break;
+                    default:
+                        return false;
+                }
+                break;
+            case 'c':
+                if (spec.length != ARG_LEN_NONE) {
+                    return false;
+                }
+                arg.i = va_arg(ap, int);
+                break;
+            case 'p':
+                arg.p = va_arg(ap, void*);
+                break;
+            case 's': {
+                if (spec.length != ARG_LEN_NONE) {
+                    return false;
+                }
+                const char* str = va_arg(ap, const char*);
+                if (str == nullptr) {
+                    str = "(null)";
+                }
+                // Truncated if the strings are too long, the message is truncated anyway
+                const size_t space = sizeof(slot->text) - slot->textSize;
+                const size_t len = strnlen(str, space - 1U);
+                memcpy(slot->text + slot->textSize, str, len);
+                slot->text[slot->textSize + len] = '\0';
+                arg.u = slot->textSize;
+                slot->textSize += len + 1U;
+                if (slot->textSize == sizeof(slot->text)) {
+                    // No room for the next string
+                    slot->textSize--;
+                }
+                break;
+            }
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (spec.length == ARG_LEN_LONG_DOUBLE) {
+                    return false;
+                }
+                arg.d = va_arg(ap, double);
+                break;
+            default:
+                // %n and the unknown conversions
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Format the message of the slot captured by captureLogArgs()
+void formatLogSlot(const LogSlot& slot, char* message, size_t size) {
+    const char* fmt = slot.fmt;
+    size_t pos = 0U;
+    uint32_t argIndex = 0U;
+    LogFormatSpec spec;
+
+    message[0] = '\0';
+    while ((*fmt != '\0') && (pos < size - 1U)) {
+        if (*fmt != '%') {
+            message[pos++] = *fmt++;
+            continue;
+        }
+        fmt++;
+        if (*fmt == '%') {
+            message[pos++] = *fmt++;
+            continue;
+        }
+        fmt = parseFormatSpec(fmt, &spec);
+
+        int width = spec.widthArg ? static_cast<int>(slot.args[argIndex++].i) : spec.width;
+        const int precision =
+            spec.precisionArg ? static_cast<int>(slot.args[argIndex++].i) : spec.precision;
+        const LogArg& arg = slot.args[argIndex++];
+
+        // Rebuild the specification with the width and precision values and the length of
+        // the stored argument
+        char specBuf[48];
+        int specLen = snprintf(specBuf, sizeof(specBuf), "%%%s", spec.flags);
+        if (spec.hasWidth) {
+            if (width < 0) {
+                width = -width;
+                specBuf[specLen++] = '-';
+            }
+            specLen += snprintf(specBuf + specLen, sizeof(specBuf) - specLen, "%d", width);
+        }
+        if (spec.hasPrecision && (precision >= 0)) {
+            specLen += snprintf(specBuf + specLen, sizeof(specBuf) - specLen, ".%d", precision);
+        }
+
+        int len = 0;
+        switch (spec.conversion) {
+            case 'd':
+            case 'i':
+                snprintf(specBuf + specLen, sizeof(specBuf) - specLen, "ll%c", spec.conversion);
+                len = snprintf(message + pos, size - pos, specBuf, arg.i);
+                break;
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                snprintf(specBuf + specLen, sizeof(specBuf) - specLen, "ll%c", spec.conversion);
+                len = snprintf(message + pos, size - pos, specBuf, arg.u);
+                break;
+            case 'c':
+                snprintf(specBuf + specLen, sizeof(specBuf) - specLen, "c");
+                len = snprintf(message + pos, size - pos, specBuf, static_cast<int>(arg.i));
+                break;
+            case 'p':
+                snprintf(specBuf + specLen, sizeof(specBuf) - specLen, "p");
+                len = snprintf(message + pos, size - pos, specBuf, arg.p);
+                break;
+            case 's':
+                snprintf(specBuf + specLen, sizeof(specBuf) - specLen, "s");
+                len = snprintf(message + pos, size - pos, specBuf, slot.text + arg.u);
+                break;
+            default:
+                snprintf(specBuf + specLen, sizeof(specBuf) - specLen, "%c", spec.conversion);
+                len = snprintf(message + pos, size - pos, specBuf, arg.d);
+                break;
+        }
+        if (len > 0) {
+            pos = std::min(pos + static_cast<size_t>(len), size - 1U);
+        }
+    }
+    message[pos] = '\0';
+}
+}  // namespace
+
+AsyncLogSink::AsyncLogSink(LogOutputSink* sink)
+        : mSink(sink),
+          mRunning(true),
+          mLogCount(0U),
+          mDropCount(0U) {
+    mThread = std::thread(&AsyncLogSink::threadLoop, this);
+}
+
+AsyncLogSink::~AsyncLogSink() {
+    stop();
+    delete mSink;
+}
+
+AsyncLogSink::LogRing* AsyncLogSink::getThreadRing() {
+    if (gThreadLogRing.owner == nullptr) {
+        std::shared_ptr<LogRing> ring = std::make_shared<LogRing>();
+        {
+            std::lock_guard<std::mutex> l(mRingLock);
+            mRings.push_back(ring);
+        }
+        gThreadLogRing.retired = &ring->retired;
+        gThreadLogRing.owner = ring;
+    }
+
+    return static_cast<LogRing*>(gThreadLogRing.owner.get());
+}
+
+AsyncLogSink::LogRing* AsyncLogSink::beginPush(bool* dropped) {
+    *dropped = false;
+    if (!mRunning.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+
+    LogRing* ring = getThreadRing();
+    // Set before mRunning is checked again, so stop() either waits for the push or the log is
+    // sent by the caller
+    ring->pushing.store(true);
+    if (!mRunning.load()) {
+        ring->pushing.store(false, std::memory_order_release);
+        return nullptr;
+    }
+
+    const uint32_t head = ring->head.load(std::memory_order_relaxed);
+    const uint32_t tail = ring->tail.load(std::memory_order_acquire);
+    if (head - tail >= ASYNC_LOG_RING_SIZE) {
+        ring->dropped.fetch_add(1U, std::memory_order_relaxed);
+        ring->pushing.store(false, std::memory_order_release);
+        *dropped = true;
+        return nullptr;
+    }
+
+    ring->slots[head & (ASYNC_LOG_RING_SIZE - 1U)].timeUs = getLogTimeUs();
+    return ring;
+}
+
+void AsyncLogSink::endPush(LogRing* ring) {
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + 1U,
+                     std::memory_order_release);
+    ring->pushing.store(false, std::memory_order_release);
+}
+
+void AsyncLogSink::sendOffLog(LogItem logItem) {
+    bool dropped = false;
+    LogRing* ring = beginPush(&dropped);
+    if (ring == nullptr) {
+        if (!dropped) {
+            mSink->sendOffLog(logItem);
+        }
+        return;
+    }
+
+    const uint32_t head = ring->head.load(std::memory_order_relaxed);
+    LogSlot* slot = &ring->slots[head & (ASYNC_LOG_RING_SIZE - 1U)];
+    slot->fmt = nullptr;
+    snprintf(slot->text, sizeof(slot->text), "%s", logItem.logEntry);
+    slot->level = logItem.level;
+    slot->logTags = logItem.logTags;
+    if (logItem.timeUs > 0) {
+        slot->timeUs = logItem.timeUs;
+    }
+    endPush(ring);
+}
+
+void AsyncLogSink::sendOffLogV(uint32_t level, const char* logTags, const char* fmt,
+                               va_list ap) {
+    bool dropped = false;
+    LogRing* ring = beginPush(&dropped);
+    if (ring == nullptr) {
+        if (!dropped) {
+            mSink->sendOffLogV(level, logTags, fmt, ap);
+        }
+        return;
+    }
+
+    const uint32_t head = ring->head.load(std::memory_order_relaxed);
+    LogSlot* slot = &ring->slots[head & (ASYNC_LOG_RING_SIZE - 1U)];
+    // Only the arguments are stored, the message is formatted in the background thread
+    va_list args;
+    va_copy(args, ap);
+    slot->fmt = fmt;
+    if (!captureLogArgs(fmt, args, slot)) {
+        slot->fmt = nullptr;
+        vsnprintf(slot->text, sizeof(slot->text), fmt, ap);
+    }
+    va_end(args);
+    slot->level = level;
+    slot->logTags = logTags;
+    endPush(ring);
+}
+
+bool AsyncLogSink::drainLogs() {
+    std::vector<std::shared_ptr<LogRing>> rings;
+    {
+        std::lock_guard<std::mutex> l(mRingLock);
+        rings = mRings;
+    }
+
+    bool drained = false;
+    for (auto& ring : rings) {
+        const uint32_t dropped = ring->dropped.exchange(0U, std::memory_order_relaxed);
+        if (dropped > 0U) {
+            char entry[LOG_ENTRY_SIZE];
+            snprintf(entry, sizeof(entry), "%u logs are dropped, the log ring is full", dropped);
+            mSink->sendOffLog({entry, CAMERA_DEBUG_LOG_WARNING, "AsyncLogSink", 0});
+            mDropCount += dropped;
+        }
+    }
+
+    // Merge the rings by capture time, so the logs of different threads keep their order
+    char message[LOG_ENTRY_SIZE];
+    while (true) {
+        LogRing* next = nullptr;
+        int64_t nextTime = 0;
+        for (auto& ring : rings) {
+            const uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+            if (tail == ring->head.load(std::memory_order_acquire)) {
+                continue;
+            }
+            const LogSlot& slot = ring->slots[tail & (ASYNC_LOG_RING_SIZE - 1U)];
+            if ((next == nullptr) || (slot.timeUs < nextTime)) {
+                next = ring.get();
+                nextTime = slot.timeUs;
+            }
+        }
+        if (next == nullptr) {
+            break;
+        }
+
+        const uint32_t tail = next->tail.load(std::memory_order_relaxed);
+        const LogSlot& slot = next->slots[tail & (ASYNC_LOG_RING_SIZE - 1U)];
+        if (slot.fmt == nullptr) {
+            mSink->sendOffLog({slot.text, slot.level, slot.logTags, slot.timeUs});
+        } else {
+            formatLogSlot(slot, message, sizeof(message));
+            mSink->sendOffLog({message, slot.level, slot.logTags, slot.timeUs});
+        }
+        next->tail.store(tail + 1U, std::memory_order_release);
+        mLogCount++;
+        drained = true;
+    }
+
+    // Release the rings of the exited threads
+    {
+        std::lock_guard<std::mutex> l(mRingLock);
+        for (auto it = mRings.begin(); it != mRings.end();) {
+            LogRing* ring = it->get();
+            if (ring->retired.load(std::memory_order_acquire) &&
+                (ring->tail.load(std::memory_order_relaxed) ==
+                 ring->head.load(std::memory_order_acquire))) {
+                it = mRings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return drained;
+}
+
+void AsyncLogSink::threadLoop() {
+    while (mRunning.load(std::memory_order_acquire)) {
+        if (!drainLogs()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ASYNC_LOG_POLL_INTERVAL_MS));
+        }
+    }
+    (void)drainLogs();
+}
+
+void AsyncLogSink::stop() {
+    if (!mRunning.exchange(false)) {
+        return;
+    }
+
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+
+    // The logs pushed while the background thread was exiting
+    {
+        std::lock_guard<std::mutex> l(mRingLock);
+        for (auto& ring : mRings) {
+            while (ring->pushing.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    (void)drainLogs();
+
+    char entry[LOG_ENTRY_SIZE];
+    snprintf(entry, sizeof(entry), "Async log: %lu logs sent, %lu logs dropped",
+             static_cast<unsigned long>(mLogCount), static_cast<unsigned long>(mDropCount));
+    mSink->sendOffLog({entry, CAMERA_DEBUG_LOG_INFO, "AsyncLogSink", 0});
+}
+
 }  // namespace icamera
@@ -16,21 +16,32 @@
 
 #pragma once
 
+#include <stdarg.h>
+
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace icamera {
 struct LogItem {
     const char* logEntry;
     uint32_t level;
     const char* logTags;
+    int64_t timeUs;  // The time when the log is captured, 0 means now
 };
 
 class LogOutputSink {
  public:
+    virtual ~LogOutputSink() {}
     virtual void sendOffLog(LogItem logItem) = 0;
+    // Format the message in the calling thread and send it off
+    virtual void sendOffLogV(uint32_t level, const char* logTags, const char* fmt, va_list ap);
 
  protected:
-    static void setLogTime(char* timeBuf);
+    static void setLogTime(char* timeBuf, int64_t timeUs = 0);
 };
 
 #ifdef LIBCAMERA_BUILD
@@ -66,4 +77,54 @@ class FileLogSink : public LogOutputSink {
     FILE* mFp;
 };
 
+/**
+ * AsyncLogSink moves the message formatting, the time formatting and the sink I/O out of
+ * the logging thread.
+ *
+ * The logging thread only stores the format pointer and the arguments, the strings of %s
+ * are copied, and the background thread formats the message. So the format must be a string
+ * literal, as in the LOGx macros. The formats not supported (%n, %ls, %Lf, too many arguments)
+ * are formatted in the logging thread.
+ *
+ * Each logging thread owns a single-producer/single-consumer ring, so logging doesn't
+ * take any lock. One background thread drains the rings in capture time order and sends
+ * the logs to the wrapped sink. When a ring is full the log is dropped and counted, the
+ * count is reported by a warning log in place of the dropped logs.
+ */
+class AsyncLogSink : public LogOutputSink {
+ public:
+    explicit AsyncLogSink(LogOutputSink* sink);
+    ~AsyncLogSink();
+
+    void sendOffLog(LogItem logItem) override;
+    void sendOffLogV(uint32_t level, const char* logTags, const char* fmt, va_list ap) override;
+    // Drain the pending logs and send the later logs synchronously
+    void stop();
+
+ private:
+    struct LogRing;
+
+    LogRing* getThreadRing();
+    // Return the ring of the thread with pushing set, nullptr if the log is sent synchronously
+    // or dropped (the ring is full)
+    LogRing* beginPush(bool* dropped);
+    // Publish the slot at the head and clear pushing
+    void endPush(LogRing* ring);
+    void threadLoop();
+    bool drainLogs();
+
+ private:
+    LogOutputSink* mSink;
+    std::atomic<bool> mRunning;
+    std::thread mThread;
+
+    // Guard for mRings, only taken when a thread logs for the first time
+    std::mutex mRingLock;
+    std::vector<std::shared_ptr<LogRing>> mRings;
+
+    // Accessed by the background thread only
+    uint64_t mLogCount;
+    uint64_t mDropCount;
+};
+
 }  // namespace icamera
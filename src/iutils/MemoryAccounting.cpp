@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG MemoryAccounting
+
+#include "iutils/MemoryAccounting.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+
+#include "PlatformData.h"
+#include "iutils/CameraLog.h"
+
+namespace icamera {
+
+static const char* kSubsystemNames[CAMERA_MEMORY_SUBSYSTEM_NUM] = {
+    "buffers", "cca_shm", "pac_payload", "cb_stage", "post_processing", "icbm",
+};
+
+// The last slot is for the memory allocated out of any camera scope
+static const int kUnattributedSlot = MAX_CAMERA_NUMBER;
+
+struct CameraMemoryUsage {
+    camera_memory_usage_t total;
+    camera_memory_usage_t subsystems[CAMERA_MEMORY_SUBSYSTEM_NUM];
+};
+
+static std::mutex sLock;
+static CameraMemoryUsage sUsage[MAX_CAMERA_NUMBER + 1];
+
+static thread_local int sScopeCameraId = -1;
+static thread_local int sScopeSubsystem = -1;
+
+static int getSlot(int cameraId) {
+    return ((cameraId >= 0) && (cameraId < MAX_CAMERA_NUMBER)) ? cameraId : kUnattributedSlot;
+}
+
+static bool isValidSubsystem(camera_memory_subsystem_t subsystem) {
+    return (subsystem >= CAMERA_MEMORY_BUFFERS) && (subsystem < CAMERA_MEMORY_SUBSYSTEM_NUM);
+}
+
+static void dumpUsage(const char* name, const CameraMemoryUsage& usage) {
+    LOG1("%s memory: current %lu, peak %lu", name, usage.total.current_bytes,
+         usage.total.peak_bytes);
+    for (int i = 0; i < CAMERA_MEMORY_SUBSYSTEM_NUM; i++) {
+        if (usage.subsystems[i].peak_bytes > 0U) {
+            LOG1("    %s: current %lu, peak %lu", kSubsystemNames[i],
+                 usage.subsystems[i].current_bytes, usage.subsystems[i].peak_bytes);
+        }
+    }
+}
+
+MemoryAccounting::Scope::Scope(int cameraId)
+        : mPrevCameraId(sScopeCameraId),
+          mPrevSubsystem(sScopeSubsystem) {
+    sScopeCameraId = cameraId;
+    sScopeSubsystem = -1;
+}
+
+MemoryAccounting::Scope::Scope(int cameraId, camera_memory_subsystem_t subsystem)
+        : mPrevCameraId(sScopeCameraId),
+          mPrevSubsystem(sScopeSubsystem) {
+    sScopeCameraId = cameraId;
+    sScopeSubsystem = subsystem;
+}
+
+MemoryAccounting::Scope::~Scope() {
+    sScopeCameraId = mPrevCameraId;
+    sScopeSubsystem = mPrevSubsystem;
+}
+
+int MemoryAccounting::currentCameraId() {
+    return sScopeCameraId;
+}
+
+camera_memory_subsystem_t MemoryAccounting::currentSubsystem(
+    camera_memory_subsystem_t defaultSubsystem) {
+    return (sScopeSubsystem >= 0) ? static_cast<camera_memory_subsystem_t>(sScopeSubsystem)
+                                  : defaultSubsystem;
+}
+
+void MemoryAccounting::add(int cameraId, camera_memory_subsystem_t subsystem, size_t size) {
+    CheckAndLogError(!isValidSubsystem(subsystem), VOID_VALUE, "%s, invalid subsystem %d",
+                     __func__, subsystem);
+
+    std::lock_guard<std::mutex> l(sLock);
+    CameraMemoryUsage& usage = sUsage[getSlot(cameraId)];
+    camera_memory_usage_t& item = usage.subsystems[subsystem];
+    item.current_bytes += size;
+    item.peak_bytes = std::max(item.peak_bytes, item.current_bytes);
+    usage.total.current_bytes += size;
+    usage.total.peak_bytes = std::max(usage.total.peak_bytes, usage.total.current_bytes);
+}
+
+void MemoryAccounting::remove(int cameraId, camera_memory_subsystem_t subsystem, size_t size) {
+    CheckAndLogError(!isValidSubsystem(subsystem), VOID_VALUE, "%s, invalid subsystem %d",
+                     __func__, subsystem);
+
+    std::lock_guard<std::mutex> l(sLock);
+    CameraMemoryUsage& usage = sUsage[getSlot(cameraId)];
+    camera_memory_usage_t& item = usage.subsystems[subsystem];
+    CheckWarningNoReturn(item.current_bytes < size, "%s, <id%d> %s frees %zu more than %lu",
+                         __func__, cameraId, kSubsystemNames[subsystem], size,
+                         item.current_bytes);
+    const uint64_t freed = std::min<uint64_t>(item.current_bytes, size);
+    item.current_bytes -= freed;
+    usage.total.current_bytes -= freed;
+}
+
+void MemoryAccounting::getStatistics(int cameraId, camera_memory_stats_t* stats) {
+    CheckAndLogError(stats == nullptr, VOID_VALUE, "stats is nullptr");
+
+    std::lock_guard<std::mutex> l(sLock);
+    const CameraMemoryUsage& usage = sUsage[getSlot(cameraId)];
+    stats->total = usage.total;
+    for (int i = 0; i < CAMERA_MEMORY_SUBSYSTEM_NUM; i++) {
+        stats->subsystems[i] = usage.subsystems[i];
+    }
+}
+
+void MemoryAccounting::dump(int cameraId) {
+    std::lock_guard<std::mutex> l(sLock);
+    const std::string name = "<id" + std::to_string(cameraId) + ">";
+    dumpUsage(name.c_str(), sUsage[getSlot(cameraId)]);
+    dumpUsage("Unattributed", sUsage[kUnattributedSlot]);
+}
+
+}  // namespace icamera
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include "ICamera.h"
+#include "iutils/Utils.h"
+
+namespace icamera {
+
+/**
+ * MemoryAccounting: the registry of the memory allocated by the subsystems, tagged by
+ * camera and subsystem. It keeps the current and peak bytes, which are reported by
+ * camera_get_statistics() and dumped when the device is closed.
+ *
+ * The allocators which don't know their camera or subsystem (e.g. CameraBuffer) take
+ * them from the Scope of the current thread, the memory allocated out of any scope is
+ * accounted as unattributed.
+ */
+class MemoryAccounting {
+ public:
+    /**
+     * Scope: tag the allocations of the current thread until it's destroyed, e.g.
+     *   MemoryAccounting::Scope scope(mCameraId, CAMERA_MEMORY_CB_STAGE);
+     * The scope without subsystem only tags the camera, the allocators use their default.
+     * The scopes can be nested, the previous one is restored when it's destroyed.
+     */
+    class Scope {
+     public:
+        explicit Scope(int cameraId);
+        Scope(int cameraId, camera_memory_subsystem_t subsystem);
+        ~Scope();
+
+     private:
+        int mPrevCameraId;
+        int mPrevSubsystem;
+
+        DISALLOW_COPY_AND_ASSIGN(Scope);
+    };
+
+    // The camera id of the current scope, -1 if there's no scope
+    static int currentCameraId();
+    // The subsystem of the current scope, or defaultSubsystem if there's no scope
+    static camera_memory_subsystem_t currentSubsystem(camera_memory_subsystem_t defaultSubsystem);
+
+    static void add(int cameraId, camera_memory_subsystem_t subsystem, size_t size);
+    static void remove(int cameraId, camera_memory_subsystem_t subsystem, size_t size);
+
+    static void getStatistics(int cameraId, camera_memory_stats_t* stats);
+    // Print the current and peak usage of the camera and the unattributed memory
+    static void dump(int cameraId);
+};
+
+}  // namespace icamera
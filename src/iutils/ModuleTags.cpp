@@ -48,6 +48,7 @@ const char* tagNames[] = {
     "CASE_VIRTUAL_CHANNEL",
     "CBLayoutUtils",
     "CBStage",
+    "CamHalBench",
     "Camera3AMetadata",
     "Camera3Buffer",
     "Camera3Format",
@@ -64,6 +65,7 @@ const char* tagNames[] = {
     "CameraParserInvoker",
     "CameraSensorsParser",
     "CameraShm",
+    "CameraStatistics",
     "CameraStream",
     "CaptureUnit",
     "ColorConverter",
@@ -71,6 +73,7 @@ const char* tagNames[] = {
     "Customized3A",
     "CustomizedAic",
     "DeviceBase",
+    "DumpWriter",
     "Dvs",
     "EXIFMaker",
     "EXIFMetaData",
@@ -80,6 +83,7 @@ const char* tagNames[] = {
     "FaceSSD",
     "FaceStage",
     "FileSource",
+    "FrameTimeline",
     "GPUPostProcessor",
     "GPUPostStage",
     "GenGfx",
@@ -137,12 +141,14 @@ const char* tagNames[] = {
     "MANUAL_POST_PROCESSING",
     "MakerNote",
     "MediaControl",
+    "MemoryAccounting",
     "MetadataConvert",
     "MockCamera3HAL",
     "MockCameraHal",
     "MockPSysDevice",
     "MockSysCall",
     "MsgHandler",
+    "NodePool",
     "OnePunchIC2",
     "OpenSourceGFX",
     "PSysDevice",
@@ -163,15 +169,18 @@ const char* tagNames[] = {
     "ResultProcessor",
     "SWJpegEncoder",
     "SWPostProcessor",
+    "SceneChangeDetector",
     "SchedPolicy",
     "Scheduler",
     "SensorHwCtrl",
     "SensorManager",
+    "SharedOutputStream",
     "SofSource",
     "SwImageConverter",
     "SwImageProcessor",
     "SwPostProcessUnit",
     "SysCall",
+    "SysCallTrace",
     "TCPServer",
     "Thread",
     "Trace",
@@ -55,147 +55,156 @@ enum ModuleTags {
       GENERATED_TAGS_CASE_VIRTUAL_CHANNEL = 26,
       GENERATED_TAGS_CBLayoutUtils = 27,
       GENERATED_TAGS_CBStage = 28,
-      GENERATED_TAGS_Camera3AMetadata = 29,
-      GENERATED_TAGS_Camera3Buffer = 30,
-      GENERATED_TAGS_Camera3Format = 31,
-      GENERATED_TAGS_Camera3HAL = 32,
-      GENERATED_TAGS_Camera3HALModule = 33,
-      GENERATED_TAGS_CameraBuffer = 34,
-      GENERATED_TAGS_CameraContext = 35,
-      GENERATED_TAGS_CameraDevice = 36,
-      GENERATED_TAGS_CameraDump = 37,
-      GENERATED_TAGS_CameraEvent = 38,
-      GENERATED_TAGS_CameraHal = 39,
-      GENERATED_TAGS_CameraLog = 40,
-      GENERATED_TAGS_CameraMetadata = 41,
-      GENERATED_TAGS_CameraParserInvoker = 42,
-      GENERATED_TAGS_CameraSensorsParser = 43,
-      GENERATED_TAGS_CameraShm = 44,
-      GENERATED_TAGS_CameraStream = 45,
-      GENERATED_TAGS_CaptureUnit = 46,
-      GENERATED_TAGS_ColorConverter = 47,
-      GENERATED_TAGS_CsiMetaDevice = 48,
-      GENERATED_TAGS_Customized3A = 49,
-      GENERATED_TAGS_CustomizedAic = 50,
-      GENERATED_TAGS_DeviceBase = 51,
-      GENERATED_TAGS_Dvs = 52,
-      GENERATED_TAGS_EXIFMaker = 53,
-      GENERATED_TAGS_EXIFMetaData = 54,
-      GENERATED_TAGS_ExifCreator = 55,
-      GENERATED_TAGS_FaceDetection = 56,
-      GENERATED_TAGS_FaceDetectionPVL = 57,
-      GENERATED_TAGS_FaceSSD = 58,
-      GENERATED_TAGS_FaceStage = 59,
-      GENERATED_TAGS_FileSource = 60,
-      GENERATED_TAGS_GPUPostProcessor = 61,
-      GENERATED_TAGS_GPUPostStage = 62,
-      GENERATED_TAGS_GenGfx = 63,
-      GENERATED_TAGS_GraphConfig = 64,
-      GENERATED_TAGS_GraphConfigManager = 65,
-      GENERATED_TAGS_GraphUtils = 66,
-      GENERATED_TAGS_HAL_FACE_DETECTION_TEST = 67,
-      GENERATED_TAGS_HAL_basic = 68,
-      GENERATED_TAGS_HAL_inset_portrait = 69,
-      GENERATED_TAGS_HAL_jpeg = 70,
-      GENERATED_TAGS_HAL_multi_streams_test = 71,
-      GENERATED_TAGS_HAL_rotation_test = 72,
-      GENERATED_TAGS_HAL_supported_streams_test = 73,
-      GENERATED_TAGS_HAL_yuv = 74,
-      GENERATED_TAGS_HalAdaptor = 75,
-      GENERATED_TAGS_HalV3Utils = 76,
-      GENERATED_TAGS_I3AControlFactory = 77,
-      GENERATED_TAGS_ICBMThread = 78,
-      GENERATED_TAGS_ICamera = 79,
-      GENERATED_TAGS_IFaceDetection = 80,
-      GENERATED_TAGS_IPCIntelCca = 81,
-      GENERATED_TAGS_IPC_FACE_DETECTION = 82,
-      GENERATED_TAGS_IProcessingUnitFactory = 83,
-      GENERATED_TAGS_ImageProcessorCore = 84,
-      GENERATED_TAGS_ImageScalerCore = 85,
-      GENERATED_TAGS_InputEventMonitor = 86,
-      GENERATED_TAGS_Intel3AParameter = 87,
-      GENERATED_TAGS_IntelAEStateMachine = 88,
-      GENERATED_TAGS_IntelAFStateMachine = 89,
-      GENERATED_TAGS_IntelAWBStateMachine = 90,
-      GENERATED_TAGS_IntelAlgoClient = 91,
-      GENERATED_TAGS_IntelAlgoCommonClient = 92,
-      GENERATED_TAGS_IntelAlgoServer = 93,
-      GENERATED_TAGS_IntelCPUAlgoServer = 94,
-      GENERATED_TAGS_IntelCca = 95,
-      GENERATED_TAGS_IntelCcaClient = 96,
-      GENERATED_TAGS_IntelCcaServer = 97,
-      GENERATED_TAGS_IntelCcaWorker = 98,
-      GENERATED_TAGS_IntelFDServer = 99,
-      GENERATED_TAGS_IntelFaceDetection = 100,
-      GENERATED_TAGS_IntelFaceDetectionClient = 101,
-      GENERATED_TAGS_IntelGPUAlgoServer = 102,
-      GENERATED_TAGS_IntelICBM = 103,
-      GENERATED_TAGS_IntelICBMClient = 104,
-      GENERATED_TAGS_IntelICBMServer = 105,
-      GENERATED_TAGS_IntelTNR7Stage = 106,
-      GENERATED_TAGS_IpuPacAdaptor = 107,
-      GENERATED_TAGS_JpegEncoderCore = 108,
-      GENERATED_TAGS_JpegMaker = 109,
-      GENERATED_TAGS_JsonCommonParser = 110,
-      GENERATED_TAGS_JsonParserBase = 111,
-      GENERATED_TAGS_LensHw = 112,
-      GENERATED_TAGS_LensManager = 113,
-      GENERATED_TAGS_LiveTuning = 114,
-      GENERATED_TAGS_MANUAL_POST_PROCESSING = 115,
-      GENERATED_TAGS_MakerNote = 116,
-      GENERATED_TAGS_MediaControl = 117,
-      GENERATED_TAGS_MetadataConvert = 118,
-      GENERATED_TAGS_MockCamera3HAL = 119,
-      GENERATED_TAGS_MockCameraHal = 120,
-      GENERATED_TAGS_MockPSysDevice = 121,
-      GENERATED_TAGS_MockSysCall = 122,
-      GENERATED_TAGS_MsgHandler = 123,
-      GENERATED_TAGS_OnePunchIC2 = 124,
-      GENERATED_TAGS_OpenSourceGFX = 125,
-      GENERATED_TAGS_PSysDevice = 126,
-      GENERATED_TAGS_ParameterConvert = 127,
-      GENERATED_TAGS_ParameterHelper = 128,
-      GENERATED_TAGS_Parameters = 129,
-      GENERATED_TAGS_PipeLine = 130,
-      GENERATED_TAGS_PipeManager = 131,
-      GENERATED_TAGS_PipeManagerStub = 132,
-      GENERATED_TAGS_PlatformData = 133,
-      GENERATED_TAGS_PnpDebugControl = 134,
-      GENERATED_TAGS_PostProcessStage = 135,
-      GENERATED_TAGS_PostProcessorBase = 136,
-      GENERATED_TAGS_PostProcessorCore = 137,
-      GENERATED_TAGS_ProcessingUnit = 138,
-      GENERATED_TAGS_RequestManager = 139,
-      GENERATED_TAGS_RequestThread = 140,
-      GENERATED_TAGS_ResultProcessor = 141,
-      GENERATED_TAGS_SWJpegEncoder = 142,
-      GENERATED_TAGS_SWPostProcessor = 143,
-      GENERATED_TAGS_SchedPolicy = 144,
-      GENERATED_TAGS_Scheduler = 145,
-      GENERATED_TAGS_SensorHwCtrl = 146,
-      GENERATED_TAGS_SensorManager = 147,
-      GENERATED_TAGS_SofSource = 148,
-      GENERATED_TAGS_SwImageConverter = 149,
-      GENERATED_TAGS_SwImageProcessor = 150,
-      GENERATED_TAGS_SwPostProcessUnit = 151,
-      GENERATED_TAGS_SysCall = 152,
-      GENERATED_TAGS_TCPServer = 153,
-      GENERATED_TAGS_Thread = 154,
-      GENERATED_TAGS_Trace = 155,
-      GENERATED_TAGS_Utils = 156,
-      GENERATED_TAGS_V4l2DeviceFactory = 157,
-      GENERATED_TAGS_V4l2_device_cc = 158,
-      GENERATED_TAGS_V4l2_subdevice_cc = 159,
-      GENERATED_TAGS_V4l2_video_node_cc = 160,
-      GENERATED_TAGS_VendorTags = 161,
-      GENERATED_TAGS_camera_metadata_tests = 162,
-      GENERATED_TAGS_icamera_metadata_base = 163,
-      GENERATED_TAGS_metadata_test = 164,
-      ST_FPS = 165,
-      ST_GPU_TNR = 166,
-      ST_STATS = 167,
+      GENERATED_TAGS_CamHalBench = 29,
+      GENERATED_TAGS_Camera3AMetadata = 30,
+      GENERATED_TAGS_Camera3Buffer = 31,
+      GENERATED_TAGS_Camera3Format = 32,
+      GENERATED_TAGS_Camera3HAL = 33,
+      GENERATED_TAGS_Camera3HALModule = 34,
+      GENERATED_TAGS_CameraBuffer = 35,
+      GENERATED_TAGS_CameraContext = 36,
+      GENERATED_TAGS_CameraDevice = 37,
+      GENERATED_TAGS_CameraDump = 38,
+      GENERATED_TAGS_CameraEvent = 39,
+      GENERATED_TAGS_CameraHal = 40,
+      GENERATED_TAGS_CameraLog = 41,
+      GENERATED_TAGS_CameraMetadata = 42,
+      GENERATED_TAGS_CameraParserInvoker = 43,
+      GENERATED_TAGS_CameraSensorsParser = 44,
+      GENERATED_TAGS_CameraShm = 45,
+      GENERATED_TAGS_CameraStatistics = 46,
+      GENERATED_TAGS_CameraStream = 47,
+      GENERATED_TAGS_CaptureUnit = 48,
+      GENERATED_TAGS_ColorConverter = 49,
+      GENERATED_TAGS_CsiMetaDevice = 50,
+      GENERATED_TAGS_Customized3A = 51,
+      GENERATED_TAGS_CustomizedAic = 52,
+      GENERATED_TAGS_DeviceBase = 53,
+      GENERATED_TAGS_DumpWriter = 54,
+      GENERATED_TAGS_Dvs = 55,
+      GENERATED_TAGS_EXIFMaker = 56,
+      GENERATED_TAGS_EXIFMetaData = 57,
+      GENERATED_TAGS_ExifCreator = 58,
+      GENERATED_TAGS_FaceDetection = 59,
+      GENERATED_TAGS_FaceDetectionPVL = 60,
+      GENERATED_TAGS_FaceSSD = 61,
+      GENERATED_TAGS_FaceStage = 62,
+      GENERATED_TAGS_FileSource = 63,
+      GENERATED_TAGS_FrameTimeline = 64,
+      GENERATED_TAGS_GPUPostProcessor = 65,
+      GENERATED_TAGS_GPUPostStage = 66,
+      GENERATED_TAGS_GenGfx = 67,
+      GENERATED_TAGS_GraphConfig = 68,
+      GENERATED_TAGS_GraphConfigManager = 69,
+      GENERATED_TAGS_GraphUtils = 70,
+      GENERATED_TAGS_HAL_FACE_DETECTION_TEST = 71,
+      GENERATED_TAGS_HAL_basic = 72,
+      GENERATED_TAGS_HAL_inset_portrait = 73,
+      GENERATED_TAGS_HAL_jpeg = 74,
+      GENERATED_TAGS_HAL_multi_streams_test = 75,
+      GENERATED_TAGS_HAL_rotation_test = 76,
+      GENERATED_TAGS_HAL_supported_streams_test = 77,
+      GENERATED_TAGS_HAL_yuv = 78,
+      GENERATED_TAGS_HalAdaptor = 79,
+      GENERATED_TAGS_HalV3Utils = 80,
+      GENERATED_TAGS_I3AControlFactory = 81,
+      GENERATED_TAGS_ICBMThread = 82,
+      GENERATED_TAGS_ICamera = 83,
+      GENERATED_TAGS_IFaceDetection = 84,
+      GENERATED_TAGS_IPCIntelCca = 85,
+      GENERATED_TAGS_IPC_FACE_DETECTION = 86,
+      GENERATED_TAGS_IProcessingUnitFactory = 87,
+      GENERATED_TAGS_ImageProcessorCore = 88,
+      GENERATED_TAGS_ImageScalerCore = 89,
+      GENERATED_TAGS_InputEventMonitor = 90,
+      GENERATED_TAGS_Intel3AParameter = 91,
+      GENERATED_TAGS_IntelAEStateMachine = 92,
+      GENERATED_TAGS_IntelAFStateMachine = 93,
+      GENERATED_TAGS_IntelAWBStateMachine = 94,
+      GENERATED_TAGS_IntelAlgoClient = 95,
+      GENERATED_TAGS_IntelAlgoCommonClient = 96,
+      GENERATED_TAGS_IntelAlgoServer = 97,
+      GENERATED_TAGS_IntelCPUAlgoServer = 98,
+      GENERATED_TAGS_IntelCca = 99,
+      GENERATED_TAGS_IntelCcaClient = 100,
+      GENERATED_TAGS_IntelCcaServer = 101,
+      GENERATED_TAGS_IntelCcaWorker = 102,
+      GENERATED_TAGS_IntelFDServer = 103,
+      GENERATED_TAGS_IntelFaceDetection = 104,
+      GENERATED_TAGS_IntelFaceDetectionClient = 105,
+      GENERATED_TAGS_IntelGPUAlgoServer = 106,
+      GENERATED_TAGS_IntelICBM = 107,
+      GENERATED_TAGS_IntelICBMClient = 108,
+      GENERATED_TAGS_IntelICBMServer = 109,
+      GENERATED_TAGS_IntelTNR7Stage = 110,
+      GENERATED_TAGS_IpuPacAdaptor = 111,
+      GENERATED_TAGS_JpegEncoderCore = 112,
+      GENERATED_TAGS_JpegMaker = 113,
+      GENERATED_TAGS_JsonCommonParser = 114,
+      GENERATED_TAGS_JsonParserBase = 115,
+      GENERATED_TAGS_LensHw = 116,
+      GENERATED_TAGS_LensManager = 117,
+      GENERATED_TAGS_LiveTuning = 118,
+      GENERATED_TAGS_MANUAL_POST_PROCESSING = 119,
+      GENERATED_TAGS_MakerNote = 120,
+      GENERATED_TAGS_MediaControl = 121,
+      GENERATED_TAGS_MemoryAccounting = 122,
+      GENERATED_TAGS_MetadataConvert = 123,
+      GENERATED_TAGS_MockCamera3HAL = 124,
+      GENERATED_TAGS_MockCameraHal = 125,
+      GENERATED_TAGS_MockPSysDevice = 126,
+      GENERATED_TAGS_MockSysCall = 127,
+      GENERATED_TAGS_MsgHandler = 128,
+      GENERATED_TAGS_NodePool = 129,
+      GENERATED_TAGS_OnePunchIC2 = 130,
+      GENERATED_TAGS_OpenSourceGFX = 131,
+      GENERATED_TAGS_PSysDevice = 132,
+      GENERATED_TAGS_ParameterConvert = 133,
+      GENERATED_TAGS_ParameterHelper = 134,
+      GENERATED_TAGS_Parameters = 135,
+      GENERATED_TAGS_PipeLine = 136,
+      GENERATED_TAGS_PipeManager = 137,
+      GENERATED_TAGS_PipeManagerStub = 138,
+      GENERATED_TAGS_PlatformData = 139,
+      GENERATED_TAGS_PnpDebugControl = 140,
+      GENERATED_TAGS_PostProcessStage = 141,
+      GENERATED_TAGS_PostProcessorBase = 142,
+      GENERATED_TAGS_PostProcessorCore = 143,
+      GENERATED_TAGS_ProcessingUnit = 144,
+      GENERATED_TAGS_RequestManager = 145,
+      GENERATED_TAGS_RequestThread = 146,
+      GENERATED_TAGS_ResultProcessor = 147,
+      GENERATED_TAGS_SWJpegEncoder = 148,
+      GENERATED_TAGS_SWPostProcessor = 149,
+      GENERATED_TAGS_SceneChangeDetector = 150,
+      GENERATED_TAGS_SchedPolicy = 151,
+      GENERATED_TAGS_Scheduler = 152,
+      GENERATED_TAGS_SensorHwCtrl = 153,
+      GENERATED_TAGS_SensorManager = 154,
+      GENERATED_TAGS_SharedOutputStream = 155,
+      GENERATED_TAGS_SofSource = 156,
+      GENERATED_TAGS_SwImageConverter = 157,
+      GENERATED_TAGS_SwImageProcessor = 158,
+      GENERATED_TAGS_SwPostProcessUnit = 159,
+      GENERATED_TAGS_SysCall = 160,
+      GENERATED_TAGS_SysCallTrace = 161,
+      GENERATED_TAGS_TCPServer = 162,
+      GENERATED_TAGS_Thread = 163,
+      GENERATED_TAGS_Trace = 164,
+      GENERATED_TAGS_Utils = 165,
+      GENERATED_TAGS_V4l2DeviceFactory = 166,
+      GENERATED_TAGS_V4l2_device_cc = 167,
+      GENERATED_TAGS_V4l2_subdevice_cc = 168,
+      GENERATED_TAGS_V4l2_video_node_cc = 169,
+      GENERATED_TAGS_VendorTags = 170,
+      GENERATED_TAGS_camera_metadata_tests = 171,
+      GENERATED_TAGS_icamera_metadata_base = 172,
+      GENERATED_TAGS_metadata_test = 173,
+      ST_FPS = 174,
+      ST_GPU_TNR = 175,
+      ST_STATS = 176,
 };
 
-#define TAGS_MAX_NUM 168
+#define TAGS_MAX_NUM 177
 
 // !!! DO NOT EDIT THIS FILE !!!
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG NodePool
+
+#include "iutils/NodePool.h"
+
+#include <new>
+
+#include "iutils/CameraLog.h"
+
+namespace icamera {
+
+// The blocks keep the alignment of operator new
+static const size_t kBlockAlign = alignof(max_align_t);
+
+static size_t alignBlockSize(size_t size) {
+    return (size + kBlockAlign - 1U) & ~(kBlockAlign - 1U);
+}
+
+NodePool::NodePool(size_t blocksPerChunk)
+        : mBlocksPerChunk(blocksPerChunk > 0U ? blocksPerChunk : 1U),
+          mBlockListNum(0U),
+          mChunks(nullptr) {
+    for (size_t i = 0U; i < kMaxBlockSizes; i++) {
+        mBlockLists[i] = {0U, nullptr};
+    }
+}
+
+NodePool::~NodePool() {
+    while (mChunks != nullptr) {
+        void* next = *static_cast<void**>(mChunks);
+        ::operator delete(mChunks);
+        mChunks = next;
+    }
+}
+
+void NodePool::setBlocksPerChunk(size_t blocksPerChunk) {
+    mBlocksPerChunk = (blocksPerChunk > 0U) ? blocksPerChunk : 1U;
+}
+
+NodePool::BlockList* NodePool::getBlockList(size_t size) {
+    for (size_t i = 0U; i < mBlockListNum; i++) {
+        if (mBlockLists[i].size == size) {
+            return &mBlockLists[i];
+        }
+    }
+
+    if (mBlockListNum >= kMaxBlockSizes) {
+        return nullptr;
+    }
+    mBlockLists[mBlockListNum] = {size, nullptr};
+    return &mBlockLists[mBlockListNum++];
+}
+
+void NodePool::allocateChunk(BlockList* list) {
+    // The first block of the chunk is the header linking the chunks
+    const size_t headerSize = alignBlockSize(sizeof(void*));
+    char* chunk = static_cast<char*>(::operator new(headerSize + list->size * mBlocksPerChunk));
+    LOG2("%s, %zu blocks of %zu bytes", __func__, mBlocksPerChunk, list->size);
+
+    *reinterpret_cast<void**>(chunk) = mChunks;
+    mChunks = chunk;
+    for (size_t i = 0U; i < mBlocksPerChunk; i++) {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + headerSize + i * list->size);
+        block->next = list->freeList;
+        list->freeList = block;
+    }
+}
+
+void* NodePool::allocate(size_t size) {
+    BlockList* list = getBlockList(alignBlockSize(size));
+    // Too many block sizes, the odd ones are allocated from the heap
+    if (list == nullptr) {
+        return ::operator new(size);
+    }
+
+    if (list->freeList == nullptr) {
+        allocateChunk(list);
+    }
+
+    FreeBlock* block = list->freeList;
+    list->freeList = block->next;
+    return block;
+}
+
+void NodePool::deallocate(void* ptr, size_t size) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    const size_t blockSize = alignBlockSize(size);
+    for (size_t i = 0U; i < mBlockListNum; i++) {
+        if (mBlockLists[i].size == blockSize) {
+            FreeBlock* block = static_cast<FreeBlock*>(ptr);
+            block->next = mBlockLists[i].freeList;
+            mBlockLists[i].freeList = block;
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+}  // namespace icamera
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <new>
+
+#include "iutils/Utils.h"
+
+namespace icamera {
+
+/**
+ * NodePool: the memory of the nodes of the per-frame node containers (std::map, std::list,
+ * std::multiset ...), used with PoolAllocator.
+ *
+ * The freed blocks are kept in the free list of their size and reused, so a container
+ * doesn't allocate from the heap once it has held its maximum number of items. The blocks
+ * are allocated in chunks of blocksPerChunk, which the owner sets to its maximum in-flight
+ * frames at configure time, so the first frames allocate one chunk of each block size.
+ *
+ * It isn't thread safe, the containers using it are guarded by the lock of their owner.
+ * The pool must outlive the containers, i.e. it's declared before them.
+ */
+class NodePool {
+ public:
+    explicit NodePool(size_t blocksPerChunk = kDefaultBlocksPerChunk);
+    ~NodePool();
+
+    // Only affects the chunks allocated after, the allocated blocks are kept
+    void setBlocksPerChunk(size_t blocksPerChunk);
+
+    void* allocate(size_t size);
+    void deallocate(void* ptr, size_t size);
+
+ private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct BlockList {
+        size_t size;
+        FreeBlock* freeList;
+    };
+
+    BlockList* getBlockList(size_t size);
+    void allocateChunk(BlockList* list);
+
+ private:
+    static const size_t kDefaultBlocksPerChunk = 16U;
+    // A container uses 1 or 2 block sizes, e.g. the node and the bucket array
+    static const size_t kMaxBlockSizes = 4U;
+
+    size_t mBlocksPerChunk;
+    BlockList mBlockLists[kMaxBlockSizes];
+    size_t mBlockListNum;
+    void* mChunks;  // The chunks are linked by their first word
+
+    DISALLOW_COPY_AND_ASSIGN(NodePool);
+};
+
+/**
+ * PoolAllocator: the std allocator allocating the nodes from a NodePool, e.g.
+ *   NodePool mTaskPool;
+ *   std::list<Task, PoolAllocator<Task>> mTasks;  // constructed with (&mTaskPool)
+ *
+ * The arrays (deque maps and chunks, bucket arrays) have variable sizes and would each take
+ * a chunk of the pool, they are allocated from the heap, so don't use it for std::deque.
+ */
+template <typename T>
+class PoolAllocator {
+ public:
+    typedef T value_type;
+
+    explicit PoolAllocator(NodePool* pool) : mPool(pool) {}
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) : mPool(other.mPool) {}
+
+    T* allocate(size_t n) {
+        if (n != 1U) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(mPool->allocate(sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) {
+        if (n != 1U) {
+            ::operator delete(ptr);
+            return;
+        }
+        mPool->deallocate(ptr, sizeof(T));
+    }
+
+    NodePool* mPool;
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) {
+    return a.mPool == b.mPool;
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b) {
+    return a.mPool != b.mPool;
+}
+
+}  // namespace icamera
@@ -18,7 +18,9 @@
 
 #include <cstdlib>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_set>
 
 namespace icamera {
 bool gPerfettoEnabled = false;
@@ -43,6 +45,10 @@ PERFETTO_TRACK_EVENT_STATIC_STORAGE();
 static PerfettoTrace* gPerfettoAgent = nullptr;
 static std::once_flag gPerfettoOnce;
 
+// The counter track keeps the name pointer, so the names are kept here
+static std::mutex gCounterNameLock;
+static std::unordered_set<std::string> gCounterNames;
+
 static void uninitPerfettoTrace() {
     ::perfetto::TrackEvent::Flush();
     icamera::gPerfettoEnabled = false;
@@ -87,3 +93,16 @@ ScopedPerfetto::~ScopedPerfetto() {
         TRACE_EVENT_END(PERFETTO_CATEGORIES);
     }
 }
+
+const char* perfettoInternCounterName(const std::string& name) {
+    std::lock_guard<std::mutex> l(gCounterNameLock);
+    return gCounterNames.insert(name).first->c_str();
+}
+
+void perfettoTraceCounter(const char* name, int64_t value) {
+    if (!icamera::gPerfettoEnabled || (name == nullptr)) {
+        return;
+    }
+
+    TRACE_COUNTER(PERFETTO_CATEGORIES, perfetto::CounterTrack(name), value);
+}
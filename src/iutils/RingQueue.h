@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <utility>
+#include <vector>
+
+namespace icamera {
+
+/**
+ * RingQueue: a FIFO queue stored in a ring, with the interface of std::queue used in the HAL,
+ * and clear().
+ *
+ * std::queue on std::deque frees and allocates a chunk every few items even when its size
+ * doesn't change, the ring only allocates when it grows, i.e. in the first frames.
+ * A popped slot is reset, so it releases what it holds (e.g. the buffer reference) immediately.
+ */
+template <typename T>
+class RingQueue {
+ public:
+    RingQueue() : mHead(0U), mSize(0U) {}
+
+    bool empty() const { return mSize == 0U; }
+    size_t size() const { return mSize; }
+
+    T& front() { return mItems[mHead]; }
+    const T& front() const { return mItems[mHead]; }
+    T& back() { return mItems[index(mSize - 1U)]; }
+    const T& back() const { return mItems[index(mSize - 1U)]; }
+
+    void push(const T& item) {
+        grow();
+        mItems[index(mSize)] = item;
+        mSize++;
+    }
+    void push(T&& item) {
+        grow();
+        mItems[index(mSize)] = std::move(item);
+        mSize++;
+    }
+
+    void pop() {
+        mItems[mHead] = T();
+        mHead = index(1U);
+        mSize--;
+    }
+
+    // The capacity is kept
+    void clear() {
+        while (mSize > 0U) {
+            pop();
+        }
+        mHead = 0U;
+    }
+
+ private:
+    static const size_t kMinCapacity = 8U;
+
+    size_t index(size_t offset) const { return (mHead + offset) % mItems.size(); }
+
+    void grow() {
+        if (mSize < mItems.size()) {
+            return;
+        }
+
+        const size_t capacity = mItems.empty() ? kMinCapacity : mItems.size() * 2U;
+        std::vector<T> items(capacity);
+        for (size_t i = 0U; i < mSize; i++) {
+            items[i] = std::move(mItems[index(i)]);
+        }
+        mItems.swap(items);
+        mHead = 0U;
+    }
+
+ private:
+    std::vector<T> mItems;
+    size_t mHead;
+    size_t mSize;
+};
+
+}  // namespace icamera
@@ -16,6 +16,9 @@
 
 #include "utils/ScopedAtrace.h"
 
+#include <mutex>
+#include <unordered_set>
+
 #include "Trace.h"
 
 namespace icamera {
@@ -58,4 +61,22 @@ void ScopedAtrace::setTraceLevel(uint32_t level) {
     gScopedAtraceLevel = level;
 }
 
+bool ScopedAtrace::isTraceEnabled(uint32_t level) {
+    return (gScopedAtraceLevel & level) != 0U;
+}
+
+const char* ScopedAtrace::internCounterName(const std::string& name) {
+    static std::mutex sLock;
+    static std::unordered_set<std::string> sNames;
+
+    std::lock_guard<std::mutex> l(sLock);
+    return sNames.insert(name).first->c_str();
+}
+
+void ScopedAtrace::traceCounter(uint32_t level, const char* name, int64_t value) {
+    if (((gScopedAtraceLevel & level) != 0U) && (name != nullptr)) {
+        atrace_int64(ATRACE_TAG, name, value);
+    }
+}
+
 }  // namespace icamera
@@ -33,6 +33,7 @@
 
 #include "iutils/CameraLog.h"
 #include "iutils/Errors.h"
+#include "iutils/FlatMap.h"
 #include "linux/ipu-isys.h"
 #include "linux/media-bus-format.h"
 
@@ -868,4 +869,9 @@ frame_usage_mode_t CameraUtils::getFrameUsage(const stream_config_t *streamList)
     return frameUsage;
 }
 
+void reportFlatMapError(const char* func, size_t capacity) {
+    LOGE("FlatMap::%s failed, the key isn't found or the capacity %zu is used up", func,
+         capacity);
+}
+
 }  // namespace icamera
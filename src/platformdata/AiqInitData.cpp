@@ -19,7 +19,10 @@
 #include "AiqInitData.h"
 
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <unordered_map>
 
@@ -33,9 +36,19 @@ using std::string;
 
 namespace icamera {
 
+Mutex AiqData::sMappingLock;
+std::unordered_map<std::string, std::weak_ptr<AiqData::FileMapping>> AiqData::sMappings;
+
+AiqData::FileMapping::~FileMapping() {
+    if (addr != MAP_FAILED) {
+        (void)munmap(addr, size);
+    }
+}
+
 AiqData::AiqData(const std::string& fileName, int maxSize) : mDataPtr(nullptr) {
     LOG1("%s, file name %s", __func__, fileName.c_str());
 
+    CLEAR(mData);
     mFileName = fileName;
     loadFile(fileName, &mData, maxSize);
 }
@@ -45,10 +58,10 @@ AiqData::~AiqData() {
 }
 
 ia_binary_data* AiqData::getData() {
-    return mDataPtr ? &mData : nullptr;
+    return (mDataPtr || mMapping) ? &mData : nullptr;
 }
 
-void AiqData::saveData(const ia_binary_data& data) {
+void AiqData::setData(const ia_binary_data& data) {
     LOG1("%s", __func__);
 
     if ((mDataPtr == nullptr) || (data.size != mData.size)) {
@@ -56,11 +69,59 @@ void AiqData::saveData(const ia_binary_data& data) {
         mData.size = data.size;
         mData.data = mDataPtr.get();
     }
+    // The data is owned by the heap buffer from now on
+    mMapping.reset();
     MEMCPY_S(mData.data, mData.size, data.data, data.size);
+}
+
+void AiqData::saveData(const ia_binary_data& data) {
+    LOG1("%s", __func__);
 
+    setData(data);
     saveDataToFile(mFileName, &mData);
 }
 
+std::shared_ptr<AiqData::FileMapping> AiqData::mapFile(const std::string& fileName,
+                                                       size_t size) {
+    const int fd = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    CLEAR(fileStat);
+    if (fstat(fd, &fileStat) != 0) {
+        (void)close(fd);
+        return nullptr;
+    }
+
+    const std::string key = std::to_string(fileStat.st_dev) + ":" +
+                            std::to_string(fileStat.st_ino) + ":" + std::to_string(size);
+
+    AutoMutex l(sMappingLock);
+    auto it = sMappings.find(key);
+    if (it != sMappings.end()) {
+        std::shared_ptr<FileMapping> mapping = it->second.lock();
+        if (mapping) {
+            (void)close(fd);
+            LOG2("%s, share mapping of %s", __func__, fileName.c_str());
+            return mapping;
+        }
+        sMappings.erase(it);
+    }
+
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    (void)close(fd);
+    if (addr == MAP_FAILED) {
+        LOG1("%s, failed to mmap %s, error %s", __func__, fileName.c_str(), strerror(errno));
+        return nullptr;
+    }
+
+    std::shared_ptr<FileMapping> mapping = std::make_shared<FileMapping>(addr, size);
+    sMappings[key] = mapping;
+    return mapping;
+}
+
 void AiqData::loadFile(const std::string& fileName, ia_binary_data* data, int maxSize) {
     LOG1("%s, file name %s", __func__, fileName.c_str());
     CheckAndLogError(data == nullptr, VOID_VALUE, "data is nullptr");
@@ -79,6 +140,17 @@ void AiqData::loadFile(const std::string& fileName, ia_binary_data* data, int ma
         usedFileSize = maxSize;
     }
 
+    // Map the file read-only, the pages are only loaded when they are accessed
+    if (usedFileSize > 0) {
+        mMapping = mapFile(fileName, static_cast<size_t>(usedFileSize));
+        if (mMapping) {
+            data->data = mMapping->addr;
+            data->size = usedFileSize;
+            LOG1("%s, file %s mapped, size %d", __func__, fileName.c_str(), data->size);
+            return;
+        }
+    }
+
     // Open file
     FILE* fp = fopen(fileName.c_str(), "rb");
     CheckWarning(fp == nullptr, VOID_VALUE, "Failed to open file %s, error %s", fileName.c_str(),
@@ -103,25 +175,122 @@ void AiqData::saveDataToFile(const std::string& fileName, const ia_binary_data*
     LOG1("%s", __func__);
     CheckAndLogError(data == nullptr, VOID_VALUE, "data is nullptr");
 
+    // Write to a temporary file and rename it, so the file is replaced atomically and
+    // the old file which may still be mapped by others is never truncated.
+    std::string tmpFileName = fileName + ".XXXXXX";
+    std::unique_ptr<char[]> tmpName(new char[tmpFileName.size() + 1]);
+    MEMCPY_S(tmpName.get(), tmpFileName.size() + 1, tmpFileName.c_str(), tmpFileName.size() + 1);
+
     // Open file
-    FILE* fp = fopen(fileName.c_str(), "wb");
-    CheckWarning(fp == nullptr, VOID_VALUE, "Failed to open file %s, error %s", fileName.c_str(),
+    const int fd = mkstemp(tmpName.get());
+    CheckWarning(fd < 0, VOID_VALUE, "Failed to create file %s, error %s", tmpName.get(),
                  strerror(errno));
+    tmpFileName = tmpName.get();
+    (void)fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    FILE* fp = fdopen(fd, "wb");
+    if (fp == nullptr) {
+        LOGW("Failed to open file %s, error %s", tmpFileName.c_str(), strerror(errno));
+        (void)close(fd);
+        (void)unlink(tmpFileName.c_str());
+        return;
+    }
 
     // Write data to file
     const size_t writeSize = fwrite(data->data, 1, data->size, fp);
     if (writeSize != data->size) {
-        LOGW("Failed to write data %s, error %s", fileName.c_str(), strerror(errno));
+        LOGW("Failed to write data %s, error %s", tmpFileName.c_str(), strerror(errno));
         (void)fclose(fp);
+        (void)unlink(tmpFileName.c_str());
         return;
     }
 
     (void)fflush(fp);
     (void)fclose(fp);
 
+    if (rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        LOGW("Failed to rename %s, error %s", tmpFileName.c_str(), strerror(errno));
+        (void)unlink(tmpFileName.c_str());
+        return;
+    }
+
     LOG1("%s, file %s, size %d", __func__, fileName.c_str(), data->size);
 }
 
+AiqInitData::AiqdWriter::AiqdWriter() : mWriting(false) {}
+
+AiqInitData::AiqdWriter::~AiqdWriter() {
+    stop();
+}
+
+void AiqInitData::AiqdWriter::post(const std::string& fileName, const ia_binary_data& data) {
+    {
+        AutoMutex l(mLock);
+        // Only the latest data of one file is useful, it replaces the pending one
+        const char* src = static_cast<const char*>(data.data);
+        mPending[fileName].assign(src, src + data.size);
+    }
+    mPendingSignal.signal();
+}
+
+int AiqInitData::AiqdWriter::flush(int64_t timeout) {
+    ConditionLock lock(mLock);
+    const nsecs_t deadline = systemTime() + timeout;
+    while (!mPending.empty() || mWriting) {
+        const nsecs_t remaining = deadline - systemTime();
+        if (remaining <= 0) {
+            LOGW("%s, %zu aiqd files not saved in time, drop them", __func__, mPending.size());
+            mPending.clear();
+            return TIMED_OUT;
+        }
+        (void)mDoneSignal.waitRelative(lock, remaining);
+    }
+
+    return OK;
+}
+
+void AiqInitData::AiqdWriter::stop() {
+    Thread::exit();
+    {
+        AutoMutex l(mLock);
+        mPendingSignal.signal();
+    }
+    Thread::wait();
+}
+
+bool AiqInitData::AiqdWriter::threadLoop() {
+    std::string fileName;
+    std::vector<char> data;
+    {
+        ConditionLock lock(mLock);
+        if (mPending.empty()) {
+            if (isExiting()) {
+                return false;
+            }
+            (void)mPendingSignal.waitRelative(lock, kWaitDuration);
+            return true;
+        }
+
+        auto it = mPending.begin();
+        fileName = it->first;
+        data.swap(it->second);
+        mPending.erase(it);
+        mWriting = true;
+    }
+
+    PERF_CAMERA_ATRACE_PARAM1("saveAiqd", data.size());
+    ia_binary_data binData = {data.data(), static_cast<unsigned int>(data.size())};
+    AiqData::saveDataToFile(fileName, &binData);
+
+    {
+        AutoMutex l(mLock);
+        mWriting = false;
+    }
+    mDoneSignal.broadcast();
+
+    return true;
+}
+
 AiqInitData::AiqInitData(const std::string& sensorName, const std::string& camCfgDir,
                          const std::vector<TuningConfig>& tuningCfg, const std::string& nvmDir,
                          int maxNvmSize, const std::string& camModuleName)
@@ -168,8 +337,9 @@ AiqInitData::AiqInitData(const std::string& sensorName, const std::string& camCf
             return;
         }
 
-        if (mCpf.find(cfg.tuningMode) == mCpf.end()) {
-            mCpf[cfg.tuningMode] = new AiqData(aiqbName);
+        // The aiqb is loaded on first use of the tuning mode
+        if (mCpfFileName.find(cfg.tuningMode) == mCpfFileName.end()) {
+            mCpfFileName[cfg.tuningMode] = aiqbName;
         }
     }
 
@@ -179,6 +349,11 @@ AiqInitData::AiqInitData(const std::string& sensorName, const std::string& camCf
 AiqInitData::~AiqInitData() {
     LOG1("@%s", __func__);
 
+    if (mAiqdWriter) {
+        (void)mAiqdWriter->flush(kMaxAiqdFlushTime);
+        mAiqdWriter->stop();
+    }
+
     for (auto aiqb : mCpf) {
         delete aiqb.second;
     }
@@ -229,8 +404,13 @@ int AiqInitData::getCpf(TuningMode mode, ia_binary_data* cpfData) {
     LOG1("@%s mode = %d", __func__, mode);
     CheckAndLogError(cpfData == nullptr, BAD_VALUE, "@%s, cpfData is nullptr", __func__);
 
-    CheckAndLogError(mCpf.find(mode) == mCpf.end(), NO_INIT, "@%s, no aiqb, mode = %d", __func__,
-                     mode);
+    AutoMutex l(mDataLock);
+    if (mCpf.find(mode) == mCpf.end()) {
+        auto it = mCpfFileName.find(mode);
+        CheckAndLogError(it == mCpfFileName.end(), NO_INIT, "@%s, no aiqb, mode = %d", __func__,
+                         mode);
+        mCpf[mode] = new AiqData(it->second);
+    }
 
     AiqData* cpf = mCpf[mode];
     CheckAndLogError(cpf == nullptr, NO_INIT, "@%s, cpf is nullptr", __func__);
@@ -287,6 +467,7 @@ std::string AiqInitData::getAiqdFileNameWithPath(TuningMode mode) {
 }
 
 ia_binary_data* AiqInitData::getAiqd(TuningMode mode) {
+    AutoMutex l(mDataLock);
     if (mAiqd.find(mode) == mAiqd.end()) {
         mAiqd[mode] = new AiqData(getAiqdFileNameWithPath(mode));
     }
@@ -297,6 +478,7 @@ ia_binary_data* AiqInitData::getAiqd(TuningMode mode) {
 }
 
 void AiqInitData::saveAiqd(TuningMode mode, const ia_binary_data& data) {
+    AutoMutex l(mDataLock);
     if (mAiqd.find(mode) == mAiqd.end()) {
         mAiqd[mode] = new AiqData(getAiqdFileNameWithPath(mode));
     }
@@ -304,11 +486,14 @@ void AiqInitData::saveAiqd(TuningMode mode, const ia_binary_data& data) {
     AiqData* aiqd = mAiqd[mode];
     CheckAndLogError(!aiqd, VOID_VALUE, "@%s, aiqd is nullptr", __func__);
 
-    aiqd->saveData(data);
+    // Keep the latest aiqd in memory for the next start, and write the file in background
+    aiqd->setData(data);
 
-    // After saved aiqd data, the aiqd data should be reloaded next time.
-    delete aiqd;
-    mAiqd.erase(mode);
+    if (!mAiqdWriter) {
+        mAiqdWriter = std::unique_ptr<AiqdWriter>(new AiqdWriter());
+        (void)mAiqdWriter->run("AiqdWriter", PRIORITY_BACKGROUND);
+    }
+    mAiqdWriter->post(getAiqdFileNameWithPath(mode), *aiqd->getData());
 }
 
 int AiqInitData::initMakernote(int cameraId, TuningMode tuningMode) {
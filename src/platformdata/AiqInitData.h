@@ -22,27 +22,52 @@
 #include <vector>
 
 #include "iutils/Errors.h"
+#include "iutils/Thread.h"
 #include "iutils/Utils.h"
 
 #include "MakerNote.h"
 
 namespace icamera {
 
+/**
+ * AiqData maps a tuning file read-only when possible, and falls back to reading it
+ * into heap memory (e.g. for sysfs NVM nodes which don't support mmap).
+ * Mappings are shared by all AiqData objects opening the same file, so the cameras
+ * using the same sensor and the tuning modes using the same aiqb share one copy.
+ */
 class AiqData {
  public:
     explicit AiqData(const std::string& fileName, int maxSize = -1);
     ~AiqData();
 
     ia_binary_data* getData();
+    // Replace the data in memory only, the file isn't touched
+    void setData(const ia_binary_data& data);
     void saveData(const ia_binary_data& data);
 
     void loadFile(const std::string& fileName, ia_binary_data* data, int maxSize);
-    void saveDataToFile(const std::string& fileName, const ia_binary_data* data);
+    static void saveDataToFile(const std::string& fileName, const ia_binary_data* data);
+
+ private:
+    struct FileMapping {
+        FileMapping(void* a, size_t s) : addr(a), size(s) {}
+        ~FileMapping();
+
+        void* addr;
+        size_t size;
+    };
+
+    static std::shared_ptr<FileMapping> mapFile(const std::string& fileName, size_t size);
 
  private:
     std::string mFileName;
     ia_binary_data mData;
     std::unique_ptr<char[]> mDataPtr;
+    std::shared_ptr<FileMapping> mMapping;
+
+    // Guard for sMappings, the key is "dev:inode:size" of the mapped file
+    static Mutex sMappingLock;
+    static std::unordered_map<std::string, std::weak_ptr<FileMapping>> sMappings;
 
  private:
     DISALLOW_COPY_AND_ASSIGN(AiqData);
@@ -79,13 +104,51 @@ class AiqInitData {
     std::string getAiqdFileNameWithPath(TuningMode mode);
     int findConfigFile(const std::string& camCfgDir, std::string* cpfPathName);
 
+ private:
+    /**
+     * AiqdWriter saves the aiqd files in background, so that stopping or closing camera
+     * doesn't wait for the file system. Saves of the same file are coalesced.
+     */
+    class AiqdWriter : public Thread {
+     public:
+        AiqdWriter();
+        ~AiqdWriter();
+
+        void post(const std::string& fileName, const ia_binary_data& data);
+        // Wait at most timeout(ns) for the pending saves, the left ones are dropped.
+        int flush(int64_t timeout);
+        void stop();
+
+     private:
+        bool threadLoop();
+
+     private:
+        static const nsecs_t kWaitDuration = 1000000000;  // 1s
+
+        Mutex mLock;
+        Condition mPendingSignal;
+        Condition mDoneSignal;
+        std::unordered_map<std::string, std::vector<char>> mPending;
+        bool mWriting;
+
+     private:
+        DISALLOW_COPY_AND_ASSIGN(AiqdWriter);
+    };
+
+    // The max time to wait for the pending aiqd saves when releasing
+    static const nsecs_t kMaxAiqdFlushTime = 500000000;  // 500ms
+
  private:
     std::string mSensorName;
     std::string mNvmPath;
     int mMaxNvmSize;
     std::vector<TuningConfig> mTuningCfg;
 
+    // Guard for mCpf and mAiqd which are loaded on first use
+    Mutex mDataLock;
+
     // cpf
+    std::unordered_map<TuningMode, std::string> mCpfFileName;
     std::unordered_map<TuningMode, AiqData*> mCpf;
 
     // nvm
@@ -93,6 +156,7 @@ class AiqInitData {
 
     // aiqd
     std::unordered_map<TuningMode, AiqData*> mAiqd;
+    std::unique_ptr<AiqdWriter> mAiqdWriter;
 
     // makernote
     std::unique_ptr<MakerNote> mMkn;
@@ -907,6 +907,12 @@ void CameraSensorsParser::parseSensorSection(const Json::Value& node) {
     if (node.isMember("removeCacheFlushOutputBuffer")) {
         mCurCam->mRemoveCacheFlushOutputBuffer = node["removeCacheFlushOutputBuffer"].asBool();
     }
+    if (node.isMember("sceneChangeDetection")) {
+        mCurCam->mSceneChangeDetection = node["sceneChangeDetection"].asBool();
+    }
+    if (node.isMember("staticSceneRunningRate")) {
+        mCurCam->mStaticSceneRunningRate = node["staticSceneRunningRate"].asFloat();
+    }
     if (node.isMember("sensorExposureNum")) {
         mCurCam->mSensorExposureNum = node["sensorExposureNum"].asInt();
     }
@@ -89,12 +89,13 @@ int PlatformData::init() {
     parseGraphFromXmlFile();
 
     StaticCfg* staticCfg = &(getInstance()->mStaticCfg);
+    // Only the tuning file paths are resolved here, the aiqb is loaded on first use
+    const std::string cfgPath = getCameraCfgPath();
     for (size_t i = 0U; i < staticCfg->mCameras.size(); i++) {
-        std::string camModuleName;
-        AiqInitData* aiqInitData = new AiqInitData(
-            staticCfg->mCameras[i].sensorName, getCameraCfgPath(),
-            staticCfg->mCameras[i].mSupportedTuningConfig, staticCfg->mCameras[i].mNvmDirectory,
-            staticCfg->mCameras[i].mMaxNvmDataSize, staticCfg->mCameras[i].mCamModuleName);
+        const StaticCfg::CameraInfo& cam = staticCfg->mCameras[i];
+        AiqInitData* aiqInitData = new AiqInitData(cam.sensorName, cfgPath,
+                                                   cam.mSupportedTuningConfig, cam.mNvmDirectory,
+                                                   cam.mMaxNvmDataSize, cam.mCamModuleName);
         getInstance()->mAiqInitData.push_back(aiqInitData);
     }
 
@@ -221,6 +222,14 @@ bool PlatformData::isStatsRunningRateSupport(int cameraId) {
     return getInstance()->mStaticCfg.mCameras[cameraId].mStatsRunningRate;
 }
 
+bool PlatformData::isSceneChangeDetectionEnabled(int cameraId) {
+    return getInstance()->mStaticCfg.mCameras[cameraId].mSceneChangeDetection;
+}
+
+float PlatformData::getStaticSceneRunningRate(int cameraId) {
+    return getInstance()->mStaticCfg.mCameras[cameraId].mStaticSceneRunningRate;
+}
+
 bool PlatformData::isFaceDetectionSupported(int cameraId) {
     const std::string str = "statistics.info.availableFaceDetectModes";
     auto v = getByteStaticMetadata(cameraId, str);
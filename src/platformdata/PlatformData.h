@@ -196,6 +196,8 @@ class PlatformData {
                       mEnableAIQ(false),
                       mAiqRunningInterval(1),
                       mStatsRunningRate(false),
+                      mSceneChangeDetection(false),
+                      mStaticSceneRunningRate(0.1F),
                       mEnableMkn(true),
                       mIspTuningUpdate(true),
                       mSkipFrameV4L2Error(false),
@@ -280,6 +282,8 @@ class PlatformData {
             bool mEnableAIQ;
             int mAiqRunningInterval;
             bool mStatsRunningRate;
+            bool mSceneChangeDetection;
+            float mStaticSceneRunningRate;
             bool mEnableMkn;
             bool mIspTuningUpdate;
             // first: one algo type in imaging_algorithm_t, second: running rate
@@ -592,6 +596,22 @@ class PlatformData {
      */
     static bool isStatsRunningRateSupport(int cameraId);
 
+    /**
+     * if algo running rate is adjusted by scene change detection
+     *
+     * \param cameraId: [0, MAX_CAMERA_NUMBER - 1]
+     * \return if scene change detection is enabled or not.
+     */
+    static bool isSceneChangeDetectionEnabled(int cameraId);
+
+    /**
+     * get the algo running rate used when the scene is static
+     *
+     * \param cameraId: [0, MAX_CAMERA_NUMBER - 1]
+     * \return float: the running rate for static scene.
+     */
+    static float getStaticSceneRunningRate(int cameraId);
+
     /**
      * Check if sensor digital gain is used or not
      *
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2021-2024 Intel Corporation.
+ * Copyright (C) 2021-2025 Intel Corporation.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -101,6 +101,10 @@ bool PnpDebugControl::useMockPipes() {
     return getInstance()->mStaticCfg.useMockPipes;
 }
 
+std::string PnpDebugControl::mockPSysProfile() {
+    return getInstance()->mStaticCfg.mockPSysProfile;
+}
+
 #define PNP_DEBUG_FILE_NAME "pnp_profiles.json"
 PnpDebugParser::PnpDebugParser(PnpDebugControl::StaticCfg* cfg)
         : mStaticCfg(cfg) {
@@ -162,6 +166,9 @@ bool PnpDebugParser::run(const std::string& filename) {
         if (ele.isMember("useMockPSys")) {
             mStaticCfg->useMockPSys = ele["useMockPSys"].asBool();
         }
+        if (ele.isMember("mockPSysProfile")) {
+            mStaticCfg->mockPSysProfile = ele["mockPSysProfile"].asString();
+        }
     }
 
     if (node.isMember("Performance")) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2021-2024 Intel Corporation.
+ * Copyright (C) 2021-2025 Intel Corporation.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -127,6 +127,13 @@ class PnpDebugControl {
      */
     static bool useMockPipes();
 
+    /**
+     * the timing profile of the mock PSys, see MockPSysDevice.h
+     *
+     * \return the profile file name, empty if not set.
+     */
+    static std::string mockPSysProfile();
+
     static void updateConfig();
 
     static void releaseInstance();
@@ -159,6 +166,7 @@ class PnpDebugControl {
         bool useMockPSys;
         bool useMockHal;
         bool useMockPipes;
+        std::string mockPSysProfile;
     };
 
  private:
@@ -68,6 +68,9 @@ int GraphConfigManager::createHalStreamVector(ConfigMode configMode,
         // Don't handle opaque RAW stream when configure graph configuration.
         if (streamList->streams[i].usage == CAMERA_STREAM_OPAQUE_RAW)
             continue;
+        // The shared output stream gets the image of another stream.
+        if (streamList->streams[i].streamType == CAMERA_STREAM_SHARED_OUTPUT)
+            continue;
 
         bool stored = false;
         PipeUseCase useCase = getUseCaseFromStream(configMode, streamList->streams[i]);
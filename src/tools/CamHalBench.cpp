@@ -0,0 +1,842 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * camhal_bench: run a stream combination through libcamhal for a number of frames,
+ * and report the fps, the CPU time of each thread, the request latencies and the
+ * peak RSS in JSON.
+ *
+ * Only the public API is used, so the same scenario can be run on the devices, or
+ * without any device by replaying a recorded session:
+ *   export cameraSysCallReplay=<file>       (recorded with cameraSysCallRecord=<file>)
+ *   export cameraSysCallReplayFast=1        (optional, don't wait for the recorded timing)
+ *
+ * The page faults of the setup (open, configure and the warmup frames) and the measured
+ * frames are reported too, to compare the internal buffer allocators:
+ *   export cameraBufferAllocator=heap|thp|hugetlb|memfd|memfd_hugetlb
+ *   export cameraBufferPrefault=1
+ *
+ * With -a, the operator new calls of all the threads in the measured frames are counted,
+ * and the bench fails if there is any, to check that the pipeline doesn't allocate memory
+ * per frame once it is warmed up, e.g. replaying a session with the mocked PSYS. The call
+ * stacks of the first allocations are printed to stderr.
+ *
+ * With -l, no camera is opened, the log calls per second of each level are measured instead,
+ * the disabled levels only cost the level check:
+ *   export cameraDebug=<level>              (the enabled levels)
+ *   export cameraLogAsync=1                 (optional, send the logs off in background)
+ * The logs are printed to stdout, so write the report to a file with -o.
+ *
+ * Usage: camhal_bench [-s scenario] [-c cameraId[,cameraId...]] [-n frames] [-o file] [-a]
+ *        camhal_bench -l calls [-o file]
+ */
+
+#define LOG_TAG CamHalBench
+
+#include <dirent.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <linux/videodev2.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ICamera.h"
+#include "iutils/CameraLog.h"
+
+using icamera::camera_buffer_t;
+using icamera::camera_stats_t;
+using icamera::stream_config_t;
+using icamera::stream_t;
+
+// The frames to fill the pipeline and converge 3A, they aren't measured
+static const int kWarmupFrames = 30;
+static const int kDefaultFrames = 3000;
+static const uint32_t kMaxBuffersPerStream = 8U;
+static const size_t kMaxStreams = 8U;
+
+struct LogLevelDesc {
+    const char* name;
+    uint32_t level;
+};
+
+static const LogLevelDesc kLogLevels[] = {
+    {"LEVEL1", icamera::CAMERA_DEBUG_LOG_LEVEL1},   {"LEVEL2", icamera::CAMERA_DEBUG_LOG_LEVEL2},
+    {"INFO", icamera::CAMERA_DEBUG_LOG_INFO},       {"WARNING", icamera::CAMERA_DEBUG_LOG_WARNING},
+    {"ERR", icamera::CAMERA_DEBUG_LOG_ERR},
+};
+
+struct StreamDesc {
+    const char* name;
+    int width;
+    int height;
+    int usage;
+    bool sparse;  // Only queued every Scenario::sparseInterval requests, e.g. still capture
+};
+
+struct Scenario {
+    const char* name;
+    const char* cameras;  // Default camera list
+    int sparseInterval;
+    std::vector<StreamDesc> streams;
+};
+
+static const Scenario kScenarios[] = {
+    {"preview", "0", 0, {{"preview", 1920, 1080, icamera::CAMERA_STREAM_PREVIEW, false}}},
+    {"preview_video",
+     "0",
+     0,
+     {{"preview", 1280, 720, icamera::CAMERA_STREAM_PREVIEW, false},
+      {"video", 1920, 1080, icamera::CAMERA_STREAM_VIDEO_CAPTURE, false}}},
+    {"preview_video_still",
+     "0",
+     30,
+     {{"preview", 1280, 720, icamera::CAMERA_STREAM_PREVIEW, false},
+      {"video", 1920, 1080, icamera::CAMERA_STREAM_VIDEO_CAPTURE, false},
+      {"still", 1920, 1080, icamera::CAMERA_STREAM_STILL_CAPTURE, true}}},
+    // The still stream is configured with preview, and captured without restarting
+    {"zsl",
+     "0",
+     10,
+     {{"preview", 1280, 720, icamera::CAMERA_STREAM_PREVIEW, false},
+      {"still", 1920, 1080, icamera::CAMERA_STREAM_STILL_CAPTURE, true}}},
+    {"multi_camera", "0,1", 0, {{"preview", 1920, 1080, icamera::CAMERA_STREAM_PREVIEW, false}}},
+};
+
+struct StreamContext {
+    StreamDesc desc;
+    stream_t stream;
+    std::vector<camera_buffer_t> buffers;
+    // The containers of the frame loop are sized before start, not to allocate per frame
+    std::vector<camera_buffer_t*> freeBuffers;
+    std::map<camera_buffer_t*, int64_t> queueTime;
+    std::vector<double> latency;  // in ms, from qbuf to dqbuf
+    uint64_t frames;
+};
+
+struct CameraContext {
+    int cameraId;
+    std::vector<StreamContext> streams;
+    // The stream masks of the queued requests, in a ring as the requests are dequeued in order
+    uint32_t pendingRequests[kMaxBuffersPerStream];
+    size_t pendingHead;
+    size_t pendingNum;
+    int64_t requestIndex;
+    int64_t startTime;  // After the warmup frames
+    int64_t endTime;
+    int measuredFrames;
+    camera_stats_t stats;
+    int ret;
+    bool warmedUp;
+    bool finished;
+};
+
+// The CPU time is measured from all the cameras finish the warmup frames, to all the
+// cameras finish the frames, before the HAL threads exit with stop
+struct BenchSync {
+    std::atomic<int> warmedUp;
+    std::atomic<int> finished;
+    std::atomic<bool> cpuMeasured;
+};
+
+struct PageFaults {
+    long minor;
+    long major;
+};
+
+struct ThreadCpu {
+    std::string name;
+    uint64_t ticks;
+};
+
+// Count the allocations of all the threads, including the HAL, with the replaced operator new
+static std::atomic<bool> sCountAllocations(false);
+static std::atomic<uint64_t> sAllocations(0U);
+
+// The call stacks of the first allocations, to find where they come from
+static const int kMaxAllocationStacks = 4;
+static const int kAllocationStackDepth = 16;
+static void* sAllocationStacks[kMaxAllocationStacks][kAllocationStackDepth];
+static int sAllocationStackDepth[kMaxAllocationStacks];
+
+static void* countedAlloc(size_t size) {
+    if (sCountAllocations.load(std::memory_order_relaxed)) {
+        const uint64_t index = sAllocations.fetch_add(1U, std::memory_order_relaxed);
+        if (index < static_cast<uint64_t>(kMaxAllocationStacks)) {
+            // backtrace() uses malloc, not operator new, so it doesn't count itself
+            sAllocationStackDepth[index] =
+                backtrace(sAllocationStacks[index], kAllocationStackDepth);
+        }
+    }
+    return malloc((size > 0U) ? size : 1U);
+}
+
+void* operator new(size_t size) {
+    void* ptr = countedAlloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    free(ptr);
+}
+
+static int64_t getTimeNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// Thread id -> name and user + system CPU time
+static PageFaults getPageFaults() {
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    getrusage(RUSAGE_SELF, &usage);
+    return {usage.ru_minflt, usage.ru_majflt};
+}
+
+static std::map<int, ThreadCpu> getThreadCpu() {
+    std::map<int, ThreadCpu> threads;
+    DIR* dir = opendir("/proc/self/task");
+    if (dir == nullptr) {
+        return threads;
+    }
+
+    struct dirent* entry = nullptr;
+    while ((entry = readdir(dir)) != nullptr) {
+        const int tid = atoi(entry->d_name);
+        if (tid <= 0) {
+            continue;
+        }
+        const std::string fileName = std::string("/proc/self/task/") + entry->d_name + "/stat";
+        FILE* fp = fopen(fileName.c_str(), "r");
+        if (fp == nullptr) {
+            continue;
+        }
+        char buf[1024] = {};
+        const size_t len = fread(buf, 1, sizeof(buf) - 1, fp);
+        fclose(fp);
+        buf[len] = '\0';
+
+        // "tid (name) state ... utime stime ...", the name may have spaces
+        const char* begin = strchr(buf, '(');
+        const char* end = strrchr(buf, ')');
+        unsigned long utime = 0, stime = 0;
+        if ((begin == nullptr) || (end == nullptr) || (end < begin) ||
+            (sscanf(end + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime,
+                    &stime) != 2)) {
+            continue;
+        }
+        threads[tid] = {std::string(begin + 1, end), utime + stime};
+    }
+    closedir(dir);
+    return threads;
+}
+
+static int queueRequest(CameraContext* ctx, const Scenario& scenario) {
+    camera_buffer_t* buffers[kMaxStreams] = {};
+    int bufferNum = 0;
+    uint32_t streamMask = 0U;
+    const int64_t now = getTimeNs();
+    for (size_t i = 0; i < ctx->streams.size(); i++) {
+        StreamContext& s = ctx->streams[i];
+        if (s.desc.sparse && ((scenario.sparseInterval <= 0) ||
+                              (ctx->requestIndex % scenario.sparseInterval != 0))) {
+            continue;
+        }
+        if (s.freeBuffers.empty()) {
+            if (s.desc.sparse) {
+                continue;
+            }
+            fprintf(stderr, "Camera %d: no free buffer of stream %s\n", ctx->cameraId,
+                    s.desc.name);
+            return -1;
+        }
+        // The buffers are used in turn, the same as a FIFO
+        camera_buffer_t* buffer = s.freeBuffers.front();
+        s.freeBuffers.erase(s.freeBuffers.begin());
+        s.queueTime[buffer] = now;
+        buffers[bufferNum++] = buffer;
+        streamMask |= 1U << i;
+    }
+
+    const int ret = icamera::camera_stream_qbuf(ctx->cameraId, buffers, bufferNum);
+    if (ret != 0) {
+        fprintf(stderr, "Camera %d: qbuf failed %d\n", ctx->cameraId, ret);
+        return ret;
+    }
+    ctx->pendingRequests[(ctx->pendingHead + ctx->pendingNum) % kMaxBuffersPerStream] =
+        streamMask;
+    ctx->pendingNum++;
+    ctx->requestIndex++;
+    return 0;
+}
+
+static int configCamera(CameraContext* ctx, const Scenario& scenario) {
+    if (scenario.streams.size() > kMaxStreams) {
+        fprintf(stderr, "Camera %d: too many streams %zu\n", ctx->cameraId,
+                scenario.streams.size());
+        return -1;
+    }
+
+    std::vector<stream_t> streams;
+    for (const auto& desc : scenario.streams) {
+        stream_t stream;
+        memset(&stream, 0, sizeof(stream));
+        stream.format = V4L2_PIX_FMT_NV12;
+        stream.width = desc.width;
+        stream.height = desc.height;
+        stream.field = V4L2_FIELD_ANY;
+        stream.stride = desc.width;
+        stream.size = icamera::get_frame_size(ctx->cameraId, stream.format, desc.width,
+                                              desc.height, V4L2_FIELD_ANY, nullptr);
+        stream.memType = V4L2_MEMORY_USERPTR;
+        stream.usage = desc.usage;
+        stream.streamType = icamera::CAMERA_STREAM_OUTPUT;
+        streams.push_back(stream);
+    }
+
+    stream_config_t config = {static_cast<int>(streams.size()), streams.data(),
+                              icamera::CAMERA_STREAM_CONFIGURATION_MODE_AUTO};
+    int ret = icamera::camera_device_config_streams(ctx->cameraId, &config);
+    if (ret != 0) {
+        fprintf(stderr, "Camera %d: config streams failed %d\n", ctx->cameraId, ret);
+        return ret;
+    }
+
+    ctx->streams.resize(streams.size());
+    for (size_t i = 0; i < streams.size(); i++) {
+        StreamContext& s = ctx->streams[i];
+        s.desc = scenario.streams[i];
+        s.stream = streams[i];
+        s.frames = 0U;
+
+        const uint32_t count =
+            std::max(1U, std::min(streams[i].max_buffers, kMaxBuffersPerStream));
+        s.buffers.resize(count);
+        s.freeBuffers.reserve(count);
+        for (auto& buffer : s.buffers) {
+            memset(&buffer, 0, sizeof(buffer));
+            buffer.s = s.stream;
+            if (posix_memalign(&buffer.addr, getpagesize(), s.stream.size) != 0) {
+                fprintf(stderr, "Camera %d: failed to allocate %d bytes\n", ctx->cameraId,
+                        s.stream.size);
+                return -1;
+            }
+            s.freeBuffers.push_back(&buffer);
+            s.queueTime[&buffer] = 0;
+        }
+    }
+    return 0;
+}
+
+static void releaseBuffers(CameraContext* ctx) {
+    for (auto& s : ctx->streams) {
+        for (auto& buffer : s.buffers) {
+            free(buffer.addr);
+            buffer.addr = nullptr;
+        }
+    }
+}
+
+static int runFrames(CameraContext* ctx, const Scenario& scenario, int frames,
+                     BenchSync* sync) {
+    // Queue the requests of the pipeline depth before start
+    size_t depth = kMaxBuffersPerStream;
+    for (auto& s : ctx->streams) {
+        if (!s.desc.sparse) {
+            depth = std::min(depth, s.buffers.size());
+        }
+        s.latency.reserve(frames);
+    }
+    for (size_t i = 0; i < depth; i++) {
+        if (queueRequest(ctx, scenario) != 0) {
+            return -1;
+        }
+    }
+
+    int ret = icamera::camera_device_start(ctx->cameraId);
+    if (ret != 0) {
+        fprintf(stderr, "Camera %d: start failed %d\n", ctx->cameraId, ret);
+        return ret;
+    }
+
+    ctx->startTime = getTimeNs();
+    for (int frame = 0; frame < kWarmupFrames + frames; frame++) {
+        const uint32_t streamMask = ctx->pendingRequests[ctx->pendingHead];
+        ctx->pendingHead = (ctx->pendingHead + 1U) % kMaxBuffersPerStream;
+        ctx->pendingNum--;
+
+        const bool measured = frame >= kWarmupFrames;
+        for (size_t i = 0; i < ctx->streams.size(); i++) {
+            if ((streamMask & (1U << i)) == 0U) {
+                continue;
+            }
+            StreamContext& s = ctx->streams[i];
+            camera_buffer_t* buffer = nullptr;
+            ret = icamera::camera_stream_dqbuf(ctx->cameraId, s.stream.id, &buffer);
+            if ((ret != 0) || (buffer == nullptr)) {
+                fprintf(stderr, "Camera %d: dqbuf of stream %s failed %d\n", ctx->cameraId,
+                        s.desc.name, ret);
+                return -1;
+            }
+            if (measured) {
+                auto it = s.queueTime.find(buffer);
+                if (it != s.queueTime.end()) {
+                    s.latency.push_back(static_cast<double>(getTimeNs() - it->second) / 1e6);
+                }
+                s.frames++;
+            }
+            s.freeBuffers.push_back(buffer);
+        }
+
+        if (frame == kWarmupFrames - 1) {
+            ctx->startTime = getTimeNs();
+            ctx->warmedUp = true;
+            sync->warmedUp++;
+        }
+        if (measured) {
+            ctx->measuredFrames++;
+        }
+        if (queueRequest(ctx, scenario) != 0) {
+            return -1;
+        }
+    }
+    ctx->endTime = getTimeNs();
+    icamera::camera_get_statistics(ctx->cameraId, ctx->stats);
+
+    ctx->finished = true;
+    sync->finished++;
+    while (!sync->cpuMeasured) {
+        usleep(1000);
+    }
+    icamera::camera_device_stop(ctx->cameraId);
+    return 0;
+}
+
+static void runCamera(CameraContext* ctx, const Scenario& scenario, int frames,
+                      BenchSync* sync) {
+    ctx->ret = icamera::camera_device_open(ctx->cameraId);
+    if (ctx->ret == 0) {
+        ctx->ret = configCamera(ctx, scenario);
+        if (ctx->ret == 0) {
+            ctx->ret = runFrames(ctx, scenario, frames, sync);
+        }
+    } else {
+        fprintf(stderr, "Camera %d: open failed %d\n", ctx->cameraId, ctx->ret);
+    }
+
+    // Don't block the measurement of the other cameras if failed
+    if (!ctx->warmedUp) {
+        sync->warmedUp++;
+    }
+    if (!ctx->finished) {
+        sync->finished++;
+    }
+
+    icamera::camera_device_close(ctx->cameraId);
+    releaseBuffers(ctx);
+}
+
+static void printDuration(FILE* out, const char* name, const icamera::camera_duration_stats_t& d) {
+    fprintf(out, "\"%s\": {\"mean_us\": %ld, \"p99_us\": %ld, \"count\": %lu}", name, d.mean_us,
+            d.p99_us, d.count);
+}
+
+// The peak of each subsystem, in the order of camera_memory_subsystem_t
+static void printMemory(FILE* out, const icamera::camera_memory_stats_t& m) {
+    static const char* kSubsystemNames[icamera::CAMERA_MEMORY_SUBSYSTEM_NUM] = {
+        "buffers", "cca_shm", "pac_payload", "cb_stage", "post_processing", "icbm",
+    };
+
+    fprintf(out, "\"memory_kb\": {\"current\": %lu, \"peak\": %lu",
+            m.total.current_bytes / 1024U, m.total.peak_bytes / 1024U);
+    for (int i = 0; i < icamera::CAMERA_MEMORY_SUBSYSTEM_NUM; i++) {
+        fprintf(out, ", \"%s_peak\": %lu", kSubsystemNames[i],
+                m.subsystems[i].peak_bytes / 1024U);
+    }
+    fprintf(out, "}");
+}
+
+static void printLatency(FILE* out, std::vector<double>* samples) {
+    if (samples->empty()) {
+        fprintf(out, "\"latency_ms\": null");
+        return;
+    }
+    std::sort(samples->begin(), samples->end());
+    double sum = 0.0;
+    for (const auto& sample : *samples) {
+        sum += sample;
+    }
+    const size_t num = samples->size();
+    fprintf(out,
+            "\"latency_ms\": {\"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, "
+            "\"max\": %.3f}",
+            sum / num, (*samples)[num / 2], (*samples)[(num * 90 + 99) / 100 - 1],
+            (*samples)[(num * 99 + 99) / 100 - 1], (*samples)[num - 1]);
+}
+
+static void printReport(FILE* out, const Scenario& scenario, int frames,
+                        std::vector<CameraContext>* cameras,
+                        const std::map<int, ThreadCpu>& cpuBegin,
+                        const std::map<int, ThreadCpu>& cpuEnd, const PageFaults& faultStart,
+                        const PageFaults& faultBegin, const PageFaults& faultEnd,
+                        bool countAllocations) {
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    getrusage(RUSAGE_SELF, &usage);
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"scenario\": \"%s\",\n", scenario.name);
+    fprintf(out, "  \"frames\": %d,\n", frames);
+    fprintf(out, "  \"warmup_frames\": %d,\n", kWarmupFrames);
+    fprintf(out, "  \"peak_rss_kb\": %ld,\n", usage.ru_maxrss);
+
+    const char* allocator = getenv("cameraBufferAllocator");
+    const char* prefault = getenv("cameraBufferPrefault");
+    fprintf(out, "  \"page_faults\": {\"allocator\": \"%s\", \"prefault\": %s, ",
+            (allocator != nullptr) ? allocator : "heap",
+            ((prefault != nullptr) && (strcmp(prefault, "0") != 0)) ? "true" : "false");
+    fprintf(out, "\"setup_minor\": %ld, \"setup_major\": %ld, ",
+            faultBegin.minor - faultStart.minor, faultBegin.major - faultStart.major);
+    fprintf(out, "\"measured_minor\": %ld, \"measured_major\": %ld},\n",
+            faultEnd.minor - faultBegin.minor, faultEnd.major - faultBegin.major);
+
+    int totalFrames = 0;
+    for (const auto& ctx : *cameras) {
+        totalFrames += ctx.measuredFrames;
+    }
+    if (countAllocations) {
+        fprintf(out, "  \"allocations\": {\"measured\": %lu, \"per_frame\": %.2f},\n",
+                sAllocations.load(),
+                (totalFrames > 0) ? static_cast<double>(sAllocations.load()) / totalFrames : 0.0);
+    }
+
+    fprintf(out, "  \"cameras\": [\n");
+    for (size_t c = 0; c < cameras->size(); c++) {
+        CameraContext& ctx = (*cameras)[c];
+        const double seconds = static_cast<double>(ctx.endTime - ctx.startTime) / 1e9;
+
+        fprintf(out, "    {\"id\": %d, \"status\": %d, \"frames\": %d, ", ctx.cameraId, ctx.ret,
+                ctx.measuredFrames);
+        fprintf(out, "\"fps\": %.2f, ",
+                ((ctx.ret == 0) && (seconds > 0.0)) ? ctx.measuredFrames / seconds : 0.0);
+        fprintf(out, "\"dropped_frames\": %lu, \"skipped_frames\": %lu,\n",
+                ctx.stats.dropped_frames, ctx.stats.skipped_frames);
+        fprintf(out, "     ");
+        printDuration(out, "isys_time", ctx.stats.isys_time);
+        fprintf(out, ", ");
+        printDuration(out, "psys_time", ctx.stats.psys_time);
+        fprintf(out, ",\n     ");
+        printDuration(out, "post_processing_time", ctx.stats.post_processing_time);
+        fprintf(out, ", ");
+        printDuration(out, "aiq_run_time", ctx.stats.aiq_run_time);
+        fprintf(out, ",\n     ");
+        printMemory(out, ctx.stats.memory);
+        fprintf(out, ",\n     \"streams\": [\n");
+        for (size_t i = 0; i < ctx.streams.size(); i++) {
+            StreamContext& s = ctx.streams[i];
+            fprintf(out, "       {\"name\": \"%s\", \"width\": %d, \"height\": %d, ", s.desc.name,
+                    s.desc.width, s.desc.height);
+            fprintf(out, "\"buffers\": %zu, \"frames\": %lu, ", s.buffers.size(), s.frames);
+            printLatency(out, &s.latency);
+            fprintf(out, "}%s\n", (i + 1 < ctx.streams.size()) ? "," : "");
+        }
+        fprintf(out, "     ]}%s\n", (c + 1 < cameras->size()) ? "," : "");
+    }
+    fprintf(out, "  ],\n");
+
+    // The CPU time of the measured frames, grouped by the thread names
+    std::map<std::string, std::pair<int, uint64_t>> threads;
+    for (const auto& it : cpuEnd) {
+        auto begin = cpuBegin.find(it.first);
+        const uint64_t ticks =
+            it.second.ticks - ((begin != cpuBegin.end()) ? begin->second.ticks : 0U);
+        threads[it.second.name].first++;
+        threads[it.second.name].second += ticks;
+    }
+    const double msPerTick = 1000.0 / sysconf(_SC_CLK_TCK);
+    double totalMs = 0.0;
+    fprintf(out, "  \"threads\": [\n");
+    for (auto it = threads.begin(); it != threads.end(); it++) {
+        const double ms = it->second.second * msPerTick;
+        totalMs += ms;
+        fprintf(out,
+                "    {\"name\": \"%s\", \"count\": %d, \"cpu_ms\": %.1f, "
+                "\"cpu_us_per_frame\": %.1f},\n",
+                it->first.c_str(), it->second.first, ms,
+                (totalFrames > 0) ? ms * 1000.0 / totalFrames : 0.0);
+    }
+    fprintf(out, "    {\"name\": \"total\", \"count\": %zu, \"cpu_ms\": %.1f, "
+                 "\"cpu_us_per_frame\": %.1f}\n",
+            cpuEnd.size(), totalMs, (totalFrames > 0) ? totalMs * 1000.0 / totalFrames : 0.0);
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+}
+
+// Log as the LOGx macros do, the logger is set up when libcamhal is loaded
+static void runLogBench(FILE* out, int calls) {
+    const int tag = GET_FILE_SHIFT(LOG_TAG);
+    const char* async = getenv("cameraLogAsync");
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"log_calls\": %d,\n", calls);
+    fprintf(out, "  \"async\": %s,\n",
+            ((async != nullptr) && (strtoul(async, nullptr, 0) != 0U)) ? "true" : "false");
+    fprintf(out, "  \"levels\": [\n");
+    const size_t levelNum = sizeof(kLogLevels) / sizeof(kLogLevels[0]);
+    for (size_t i = 0; i < levelNum; i++) {
+        const LogLevelDesc& desc = kLogLevels[i];
+        const bool enabled = (desc.level & globalGroupsDescp[tag].level) != 0U;
+        const int64_t start = getTimeNs();
+        for (int n = 0; n < calls; n++) {
+            icamera::doLogBody(tag, desc.level, "camhal_bench %s log %d/%d", desc.name, n, calls);
+        }
+        const double durationNs = static_cast<double>(getTimeNs() - start);
+        fprintf(out,
+                "    {\"level\": \"%s\", \"enabled\": %s, \"calls_per_s\": %.0f, "
+                "\"ns_per_call\": %.1f}%s\n",
+                desc.name, enabled ? "true" : "false", calls * 1000000000.0 / durationNs,
+                durationNs / calls, (i + 1 < levelNum) ? "," : "");
+    }
+
+    // The time to send the logs left in the async rings
+    const int64_t start = getTimeNs();
+    icamera::Log::stopAsyncLog();
+    fprintf(out, "  ],\n");
+    fprintf(out, "  \"drain_ms\": %.3f\n", (getTimeNs() - start) / 1000000.0);
+    fprintf(out, "}\n");
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [-s scenario] [-c cameraId[,cameraId...]] [-n frames] [-o file] [-a]\n",
+            name);
+    fprintf(stderr, "       %s -l calls [-o file]\n", name);
+    fprintf(stderr, "  -a: fail if the measured frames allocate memory\n");
+    fprintf(stderr, "  -l: measure the log calls per second of each level, no camera is opened\n");
+    fprintf(stderr, "Scenarios:");
+    for (const auto& scenario : kScenarios) {
+        fprintf(stderr, " %s", scenario.name);
+    }
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char* argv[]) {
+    const Scenario* scenario = &kScenarios[0];
+    const char* cameraList = nullptr;
+    const char* outputFile = nullptr;
+    int frames = kDefaultFrames;
+    bool countAllocations = false;
+    int logCalls = 0;
+
+    int opt = 0;
+    while ((opt = getopt(argc, argv, "s:c:n:o:al:h")) != -1) {
+        switch (opt) {
+            case 's':
+                scenario = nullptr;
+                for (const auto& s : kScenarios) {
+                    if (strcmp(s.name, optarg) == 0) {
+                        scenario = &s;
+                    }
+                }
+                if (scenario == nullptr) {
+                    fprintf(stderr, "Unknown scenario %s\n", optarg);
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'c':
+                cameraList = optarg;
+                break;
+            case 'n':
+                frames = atoi(optarg);
+                break;
+            case 'o':
+                outputFile = optarg;
+                break;
+            case 'a':
+                countAllocations = true;
+                break;
+            case 'l':
+                logCalls = atoi(optarg);
+                if (logCalls <= 0) {
+                    fprintf(stderr, "Invalid log call number %d\n", logCalls);
+                    return 1;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (frames <= 0) {
+        fprintf(stderr, "Invalid frame number %d\n", frames);
+        return 1;
+    }
+
+    std::vector<CameraContext> cameras;
+    std::string ids = (cameraList != nullptr) ? cameraList : scenario->cameras;
+    for (char* id = strtok(&ids[0], ","); id != nullptr; id = strtok(nullptr, ",")) {
+        CameraContext ctx;
+        memset(&ctx.stats, 0, sizeof(ctx.stats));
+        ctx.cameraId = atoi(id);
+        ctx.pendingHead = 0U;
+        ctx.pendingNum = 0U;
+        ctx.requestIndex = 0;
+        ctx.startTime = 0;
+        ctx.endTime = 0;
+        ctx.measuredFrames = 0;
+        ctx.ret = 0;
+        ctx.warmedUp = false;
+        ctx.finished = false;
+        cameras.push_back(ctx);
+    }
+
+    FILE* out = stdout;
+    if (outputFile != nullptr) {
+        out = fopen(outputFile, "w");
+        if (out == nullptr) {
+            fprintf(stderr, "Failed to open %s: %s\n", outputFile, strerror(errno));
+            return 1;
+        }
+    }
+
+    if (logCalls > 0) {
+        runLogBench(out, logCalls);
+        if (out != stdout) {
+            fclose(out);
+        }
+        return 0;
+    }
+
+    int ret = icamera::camera_hal_init();
+    if (ret != 0) {
+        fprintf(stderr, "camera_hal_init failed %d\n", ret);
+        return 1;
+    }
+    const int cameraNum = icamera::get_number_of_cameras();
+    for (const auto& ctx : cameras) {
+        if ((ctx.cameraId < 0) || (ctx.cameraId >= cameraNum)) {
+            fprintf(stderr, "Invalid camera %d, %d cameras available\n", ctx.cameraId, cameraNum);
+            icamera::camera_hal_deinit();
+            return 1;
+        }
+    }
+
+    fprintf(stderr, "Run %s on %zu camera(s), %d frames\n", scenario->name, cameras.size(),
+            frames);
+    BenchSync sync;
+    sync.warmedUp = 0;
+    sync.finished = 0;
+    sync.cpuMeasured = false;
+    if (countAllocations) {
+        // The first backtrace() call loads libgcc, do it before the measured frames
+        void* stack[1];
+        (void)backtrace(stack, 1);
+    }
+    const PageFaults faultStart = getPageFaults();
+    std::vector<std::thread> threads;
+    for (auto& ctx : cameras) {
+        threads.push_back(std::thread(runCamera, &ctx, std::cref(*scenario), frames, &sync));
+    }
+
+    const int num = static_cast<int>(cameras.size());
+    while (sync.warmedUp < num) {
+        usleep(1000);
+    }
+    const std::map<int, ThreadCpu> cpuBegin = getThreadCpu();
+    const PageFaults faultBegin = getPageFaults();
+    sCountAllocations = countAllocations;
+    while (sync.finished < num) {
+        usleep(1000);
+    }
+    sCountAllocations = false;
+    const std::map<int, ThreadCpu> cpuEnd = getThreadCpu();
+    const PageFaults faultEnd = getPageFaults();
+    sync.cpuMeasured = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ret = 0;
+    for (const auto& ctx : cameras) {
+        ret = (ctx.ret != 0) ? ctx.ret : ret;
+    }
+    printReport(out, *scenario, frames, &cameras, cpuBegin, cpuEnd, faultStart, faultBegin,
+                faultEnd, countAllocations);
+    if (countAllocations && (sAllocations > 0U)) {
+        fprintf(stderr, "%lu allocations in the measured frames\n", sAllocations.load());
+        const int stackNum = static_cast<int>(
+            std::min<uint64_t>(sAllocations.load(), static_cast<uint64_t>(kMaxAllocationStacks)));
+        for (int i = 0; i < stackNum; i++) {
+            fprintf(stderr, "Allocation %d:\n", i);
+            backtrace_symbols_fd(sAllocationStacks[i], sAllocationStackDepth[i], STDERR_FILENO);
+        }
+        ret = (ret != 0) ? ret : -1;
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+
+    icamera::camera_hal_deinit();
+    return (ret == 0) ? 0 : 1;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * camtimeline_analyzer: decode the frame timeline recorded with
+ * "export cameraTimeline=<dir>", and report the frame drop causes and the
+ * per-stage latencies.
+ *
+ * Usage: camtimeline_analyzer <dir>/camtimeline_<pid>_<cameraId>.bin
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FrameTimeline.h"
+
+using icamera::FrameTimelineHeader;
+using icamera::FrameTimelineRecord;
+
+// The newest frames may be still in the pipeline when the file is copied
+static const int64_t kInflightFrames = 4;
+
+struct Latency {
+    std::string name;
+    std::vector<double> samples;  // in ms
+
+    void add(uint64_t begin, uint64_t end) {
+        if ((begin != 0U) && (end >= begin)) {
+            samples.push_back(static_cast<double>(end - begin) / 1000000.0);
+        }
+    }
+
+    void print() {
+        if (samples.empty()) {
+            printf("  %-36s %8d\n", name.c_str(), 0);
+            return;
+        }
+        std::sort(samples.begin(), samples.end());
+        double sum = 0.0;
+        for (const auto& sample : samples) {
+            sum += sample;
+        }
+        const size_t num = samples.size();
+        printf("  %-36s %8zu %8.2f %8.2f %8.2f %8.2f\n", name.c_str(), num, sum / num,
+               samples[num / 2], samples[(num * 99 + 99) / 100 - 1], samples[num - 1]);
+    }
+};
+
+static int loadFile(const char* fileName, std::vector<char>* data) {
+    FILE* fp = fopen(fileName, "rb");
+    if (fp == nullptr) {
+        fprintf(stderr, "Failed to open %s: %s\n", fileName, strerror(errno));
+        return -1;
+    }
+
+    char buf[65536];
+    size_t len = 0;
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        data->insert(data->end(), buf, buf + len);
+    }
+    fclose(fp);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <camtimeline file>\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<char> data;
+    if (loadFile(argv[1], &data) != 0) {
+        return 1;
+    }
+
+    if (data.size() < sizeof(FrameTimelineHeader)) {
+        fprintf(stderr, "Invalid file size %zu\n", data.size());
+        return 1;
+    }
+    FrameTimelineHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if ((memcmp(header.magic, FRAME_TIMELINE_MAGIC, sizeof(header.magic)) != 0) ||
+        (header.version != FRAME_TIMELINE_VERSION) ||
+        (header.recordSize != sizeof(FrameTimelineRecord)) ||
+        (header.stageCount > FRAME_TIMELINE_MAX_STAGES) ||
+        (data.size() < FRAME_TIMELINE_RECORD_OFFSET +
+                       static_cast<size_t>(header.recordCount) * header.recordSize)) {
+        fprintf(stderr, "Not a frame timeline file, or the version isn't supported\n");
+        return 1;
+    }
+
+    // Sort the valid records by sequence
+    std::map<int64_t, FrameTimelineRecord> records;
+    for (uint32_t i = 0; i < header.recordCount; i++) {
+        FrameTimelineRecord record;
+        memcpy(&record, data.data() + FRAME_TIMELINE_RECORD_OFFSET + i * header.recordSize,
+               sizeof(record));
+        if (record.sequence >= 0) {
+            records[record.sequence] = record;
+        }
+    }
+    if (records.empty()) {
+        printf("No frame is recorded\n");
+        return 0;
+    }
+
+    const int64_t firstSeq = records.begin()->first;
+    const int64_t lastSeq = records.rbegin()->first;
+    printf("Camera %d, pid %u, sequence [%ld, %ld], %zu records\n", header.cameraId, header.pid,
+           firstSeq, lastSeq, records.size());
+    printf("Stages:");
+    for (uint32_t i = 0; i < header.stageCount; i++) {
+        header.stageName[i][FRAME_TIMELINE_NAME_LEN - 1] = '\0';
+        printf(" [%u]%s", i, header.stageName[i]);
+    }
+    printf("\n\n");
+
+    // Frame drop causes, the first matched cause of each frame is counted
+    int missing = 0, noIsys = 0, isysSkipped = 0, notSubmitted = 0, notDequeued = 0;
+    std::vector<int> stageNotDone(header.stageCount, 0);
+
+    Latency sofToIsys = {"SOF -> ISYS done", {}};
+    Latency isysToSubmit = {"ISYS done -> first stage submit", {}};
+    std::vector<Latency> stageLatency(header.stageCount);
+    for (uint32_t i = 0; i < header.stageCount; i++) {
+        stageLatency[i].name = std::string("stage ") + header.stageName[i];
+    }
+    Latency postProcess = {"post process", {}};
+    Latency doneToDqbuf = {"last stage done -> dqbuf", {}};
+    Latency sofToDqbuf = {"SOF -> dqbuf", {}};
+    int exposureApplied = 0, withCcaId = 0;
+
+    for (int64_t seq = firstSeq; seq <= lastSeq - kInflightFrames; seq++) {
+        auto it = records.find(seq);
+        if (it == records.end()) {
+            missing++;
+            continue;
+        }
+        const FrameTimelineRecord& r = it->second;
+        const uint64_t sof = r.eventTime[icamera::TIMELINE_SOF];
+        const uint64_t isys = r.eventTime[icamera::TIMELINE_ISYS_DONE];
+        const uint64_t dqbuf = r.eventTime[icamera::TIMELINE_DQBUF];
+
+        if (r.eventTime[icamera::TIMELINE_EXPOSURE_APPLIED] != 0U) exposureApplied++;
+        if (r.ccaId >= 0) withCcaId++;
+
+        uint64_t firstSubmit = 0U, lastDone = 0U;
+        int undoneStage = -1;
+        for (uint32_t i = 0; i < header.stageCount; i++) {
+            if (r.stageSubmit[i] == 0U) {
+                continue;
+            }
+            if ((firstSubmit == 0U) || (r.stageSubmit[i] < firstSubmit)) {
+                firstSubmit = r.stageSubmit[i];
+            }
+            if (r.stageDone[i] == 0U) {
+                undoneStage = (undoneStage < 0) ? static_cast<int>(i) : undoneStage;
+            } else {
+                lastDone = std::max(lastDone, r.stageDone[i]);
+                stageLatency[i].add(r.stageSubmit[i], r.stageDone[i]);
+            }
+        }
+
+        sofToIsys.add(sof, isys);
+        isysToSubmit.add(isys, firstSubmit);
+        postProcess.add(r.eventTime[icamera::TIMELINE_POST_PROCESS_BEGIN],
+                        r.eventTime[icamera::TIMELINE_POST_PROCESS_END]);
+        doneToDqbuf.add(lastDone, dqbuf);
+        sofToDqbuf.add(sof, dqbuf);
+
+        if (dqbuf != 0U) {
+            continue;
+        }
+        if (isys == 0U) {
+            noIsys++;
+        } else if ((r.flags & FRAME_TIMELINE_FLAG_ISYS_SKIPPED) != 0U) {
+            isysSkipped++;
+        } else if ((firstSubmit == 0U) && (header.stageCount > 0U)) {
+            notSubmitted++;
+        } else if (undoneStage >= 0) {
+            stageNotDone[undoneStage]++;
+        } else {
+            notDequeued++;
+        }
+    }
+
+    printf("Frames not delivered to app (the newest %ld frames are ignored):\n",
+           kInflightFrames);
+    printf("  %-44s %d\n", "no record (SOF and ISYS missed)", missing);
+    printf("  %-44s %d\n", "no ISYS frame", noIsys);
+    printf("  %-44s %d\n", "skipped in ISYS (initial skip, buffer error)", isysSkipped);
+    printf("  %-44s %d\n", "not submitted to PSys (no request, 3A skip)", notSubmitted);
+    for (uint32_t i = 0; i < header.stageCount; i++) {
+        const std::string cause = std::string("stage ") + header.stageName[i] + " not done";
+        printf("  %-44s %d\n", cause.c_str(), stageNotDone[i]);
+    }
+    printf("  %-44s %d\n", "processed but not dequeued", notDequeued);
+    printf("\n");
+
+    printf("%-38s %8s %8s %8s %8s %8s\n", "Latency (ms)", "count", "mean", "p50", "p99", "max");
+    sofToIsys.print();
+    isysToSubmit.print();
+    for (auto& latency : stageLatency) {
+        latency.print();
+    }
+    postProcess.print();
+    doneToDqbuf.print();
+    sofToDqbuf.print();
+    printf("\n");
+
+    printf("3A: %d frames with a ccaId, exposure applied in %d frames\n", withCcaId,
+           exposureApplied);
+    return 0;
+}
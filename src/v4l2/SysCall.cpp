@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015-2021 Intel Corporation.
+ * Copyright (C) 2015-2025 Intel Corporation.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,37 +18,49 @@
 
 #include "SysCall.h"
 
+#include <stdlib.h>
+
+#include "SysCallTrace.h"
 #include "iutils/CameraLog.h"
 
 namespace icamera {
 
 static int sCreatedCount = 0;
-bool SysCall::sIsInitialized = false;
-SysCall* SysCall::sInstance = nullptr;
+std::atomic<SysCall*> SysCall::sInstance(nullptr);
 // Guard for singleton instance creation
 Mutex SysCall::sLock;
 
 /*static*/ SysCall* SysCall::getInstance() {
+    SysCall* instance = sInstance.load(std::memory_order_acquire);
+    if (instance != nullptr) {
+        return instance;
+    }
+
     AutoMutex lock(sLock);
-    if (!sIsInitialized) {
+    instance = sInstance.load(std::memory_order_relaxed);
+    if (instance == nullptr) {
+        const char* replayFile = getenv("cameraSysCallReplay");
+        const char* recordFile = getenv("cameraSysCallRecord");
+        if (replayFile != nullptr) {
+            instance = SysCallReplayer::create(replayFile, getenv("cameraSysCallReplayFast"));
+        } else if (recordFile != nullptr) {
+            instance = SysCallRecorder::create(recordFile);
+        }
         // Use real sys call as default
-        sInstance = new SysCall();
-        sIsInitialized = true;
+        if (instance == nullptr) {
+            instance = new SysCall();
+        }
+        sInstance.store(instance, std::memory_order_release);
     }
-    return sInstance;
+    return instance;
 }
 
 #ifdef MODULE_TEST
 void SysCall::updateInstance(SysCall* newSysCall) {
     LOG1("%s", __func__);
     AutoMutex lock(sLock);
-    if (sIsInitialized) {
-        sIsInitialized = false;
-    }
-    sInstance = newSysCall;
-    if (newSysCall != nullptr) {
-        sIsInitialized = true;
-    }
+    // The default one is created again by getInstance() if it's nullptr
+    sInstance.store(newSysCall, std::memory_order_release);
 }
 #endif
 
@@ -70,7 +82,14 @@ int SysCall::close(int fd) {
     return ::close(fd);
 }
 
-#ifdef MODULE_TEST
+int SysCall::stat(const char* pathname, struct stat* statBuf) {
+    return ::stat(pathname, statBuf);
+}
+
+ssize_t SysCall::readlink(const char* pathname, char* buf, size_t size) {
+    return ::readlink(pathname, buf, size);
+}
+
 void* SysCall::mmap(void* addr, size_t len, int prot, int flag, int filedes, off_t off) {
     return ::mmap(addr, len, prot, flag, filedes, off);
 }
@@ -78,7 +97,6 @@ void* SysCall::mmap(void* addr, size_t len, int prot, int flag, int filedes, off
 int SysCall::munmap(void* addr, size_t len) {
     return ::munmap(addr, len);
 }
-#endif
 
 int SysCall::ioctl(int fd, int request, struct media_device_info* arg) {
     return ioctl(fd, request, reinterpret_cast<void*>(arg));
@@ -174,7 +192,6 @@ int SysCall::ioctl(int fd, int request, void* arg) {
     return ret;
 }
 
-#ifdef MODULE_TEST
 int SysCall::poll(struct pollfd* pfd, nfds_t nfds, int timeout) {
     int ret = 0;
     do {
@@ -183,6 +200,5 @@ int SysCall::poll(struct pollfd* pfd, nfds_t nfds, int timeout) {
 
     return ret;
 }
-#endif
 
 }  // namespace icamera
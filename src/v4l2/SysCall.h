@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2015-2021 Intel Corporation.
+ * Copyright (C) 2015-2025 Intel Corporation.
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -28,10 +28,21 @@
 #include <linux/videodev2.h>
 #include <linux/v4l2-subdev.h>
 
+#include <atomic>
+
 #include "iutils/Thread.h"
 
 namespace icamera {
 
+/**
+ * SysCall is the only entry of the device system calls (V4L2, media, sub-device and PSYS).
+ *
+ * By default the system calls are called directly, the instance can be replaced by:
+ * 1. "export cameraSysCallRecord=<file>": SysCallRecorder saves all the calls into the file.
+ * 2. "export cameraSysCallReplay=<file>": SysCallReplayer serves the calls from the recorded
+ *    file without any device, add "export cameraSysCallReplayFast=1" to return the calls as
+ *    fast as possible instead of the recorded timing.
+ */
 class SysCall {
  protected:
     SysCall();
@@ -40,6 +51,11 @@ class SysCall {
  public:
     virtual int open(const char* pathname, int flags);
     virtual int close(int fd);
+    virtual int stat(const char* pathname, struct stat* statBuf);
+    virtual ssize_t readlink(const char* pathname, char* buf, size_t size);
+
+    // All the typed ioctl() go to this one
+    virtual int ioctl(int fd, int request, void* arg);
 
     virtual int ioctl(int fd, int request, struct media_device_info* arg);
     virtual int ioctl(int fd, int request, struct media_link_desc* arg);
@@ -68,21 +84,20 @@ class SysCall {
     virtual int ioctl(int fd, int request, struct v4l2_event* arg);
     virtual int ioctl(int fd, int request, struct v4l2_exportbuffer* arg);
 
+    static void updateInstance(SysCall* newSysCall);
+#endif
+
     virtual int poll(struct pollfd* pfd, nfds_t nfds, int timeout);
     virtual void* mmap(void* addr, size_t len, int prot, int flag, int filedes, off_t off);
     virtual int munmap(void* addr, size_t len);
-    static void updateInstance(SysCall* newSysCall);
-#endif
 
     static SysCall* getInstance();
 
  private:
-    int ioctl(int fd, int request, void* arg);
-
     SysCall& operator=(const SysCall&);  // Don't call me
 
-    static bool sIsInitialized;
-    static SysCall* sInstance;
+    // Created once, so the calls in the frame path don't take sLock
+    static std::atomic<SysCall*> sInstance;
     static Mutex sLock;
 };
 
@@ -0,0 +1,804 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG SysCallTrace
+
+#include "SysCallTrace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "iutils/CameraLog.h"
+#include "iutils/Errors.h"
+#include "modules/ipu_desc/ipu-psys.h"
+
+namespace icamera {
+
+template <typename T>
+static void appendPayload(std::vector<uint8_t>* payload, const T* data, size_t size) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    payload->insert(payload->end(), bytes, bytes + size);
+}
+
+static void appendPath(std::vector<uint8_t>* payload, const char* pathname) {
+    appendPayload(payload, pathname, strlen(pathname) + 1U);
+}
+
+// The integer argument is passed by value instead of pointer
+bool SysCallTrace::isArgByValue(int request) {
+    const uint32_t cmd = static_cast<uint32_t>(request);
+    return (cmd == static_cast<uint32_t>(IPU_IOC_MAPBUF)) ||
+           (cmd == static_cast<uint32_t>(IPU_IOC_UNMAPBUF));
+}
+
+void SysCallTrace::getArgRegions(int request, void* arg, std::vector<ArgRegion>* regions) {
+    regions->clear();
+    const uint32_t cmd = static_cast<uint32_t>(request);
+    if ((arg == nullptr) || isArgByValue(request) || (_IOC_SIZE(cmd) == 0U)) {
+        return;
+    }
+    regions->push_back({arg, static_cast<uint32_t>(_IOC_SIZE(cmd)), false});
+
+    switch (cmd) {
+        case VIDIOC_G_EXT_CTRLS:
+        case VIDIOC_S_EXT_CTRLS:
+        case VIDIOC_TRY_EXT_CTRLS: {
+            v4l2_ext_controls* controls = static_cast<v4l2_ext_controls*>(arg);
+            if ((controls->controls != nullptr) && (controls->count > 0U)) {
+                regions->push_back({controls->controls,
+                                    static_cast<uint32_t>(controls->count *
+                                                          sizeof(v4l2_ext_control)),
+                                    false});
+            }
+            break;
+        }
+        case MEDIA_IOC_ENUM_LINKS: {
+            media_links_enum* links = static_cast<media_links_enum*>(arg);
+            std::lock_guard<std::mutex> l(mEntityLock);
+            auto it = mEntityLinks.find(links->entity);
+            if (it == mEntityLinks.end()) {
+                break;
+            }
+            regions->push_back({links->pads,
+                                static_cast<uint32_t>(it->second.first * sizeof(media_pad_desc)),
+                                true});
+            regions->push_back({links->links,
+                                static_cast<uint32_t>(it->second.second *
+                                                      sizeof(media_link_desc)),
+                                true});
+            break;
+        }
+        case VIDIOC_SUBDEV_G_ROUTING:
+        case VIDIOC_SUBDEV_S_ROUTING: {
+            v4l2_subdev_routing* routing = static_cast<v4l2_subdev_routing*>(arg);
+            if (routing->routes != 0U) {
+                regions->push_back({reinterpret_cast<void*>(routing->routes),
+                                    static_cast<uint32_t>(routing->len_routes *
+                                                          sizeof(v4l2_subdev_route)),
+                                    cmd == VIDIOC_SUBDEV_G_ROUTING});
+            }
+            break;
+        }
+        case IPU_IOC_GRAPH_OPEN: {
+            ipu_psys_graph_info* graph = static_cast<ipu_psys_graph_info*>(arg);
+            regions->push_back({graph->nodes,
+                                static_cast<uint32_t>(graph->num_nodes * sizeof(graph_node)),
+                                false});
+            break;
+        }
+        case IPU_IOC_TASK_REQUEST: {
+            ipu_psys_task_request* task = static_cast<ipu_psys_task_request*>(arg);
+            regions->push_back({task->task_buffers,
+                                static_cast<uint32_t>(task->term_buf_count *
+                                                      sizeof(ipu_psys_term_buffers)),
+                                false});
+            break;
+        }
+        case VIDIOC_QUERYBUF:
+        case VIDIOC_QBUF:
+        case VIDIOC_DQBUF: {
+            v4l2_buffer* buffer = static_cast<v4l2_buffer*>(arg);
+            if (V4L2_TYPE_IS_MULTIPLANAR(buffer->type) && (buffer->m.planes != nullptr)) {
+                regions->push_back({buffer->m.planes,
+                                    static_cast<uint32_t>(buffer->length * sizeof(v4l2_plane)),
+                                    false});
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    // Drop the regions of the null arrays
+    regions->erase(std::remove_if(regions->begin(), regions->end(),
+                                  [](const ArgRegion& region) {
+                                      return (region.addr == nullptr) || (region.size == 0U);
+                                  }),
+                   regions->end());
+}
+
+void SysCallTrace::updateArgInfo(int request, const void* arg) {
+    if (static_cast<uint32_t>(request) == MEDIA_IOC_ENUM_ENTITIES) {
+        const media_entity_desc* entity = static_cast<const media_entity_desc*>(arg);
+        std::lock_guard<std::mutex> l(mEntityLock);
+        mEntityLinks[entity->id] = std::make_pair(static_cast<uint32_t>(entity->pads),
+                                                  static_cast<uint32_t>(entity->links));
+    }
+}
+
+SysCall* SysCallRecorder::create(const char* fileName) {
+    FILE* file = fopen(fileName, "wb");
+    CheckAndLogError(file == nullptr, nullptr, "Failed to open %s, %s", fileName,
+                     strerror(errno));
+
+    SysCallTraceHeader header;
+    CLEAR(header);
+    MEMCPY_S(header.magic, sizeof(header.magic), SYSCALL_TRACE_MAGIC, sizeof(header.magic));
+    header.version = SYSCALL_TRACE_VERSION;
+    header.recordSize = sizeof(SysCallRecord);
+    if (fwrite(&header, sizeof(header), 1, file) != 1U) {
+        LOGE("Failed to write %s", fileName);
+        (void)fclose(file);
+        return nullptr;
+    }
+
+    LOGI("Record the system calls to %s", fileName);
+    return new SysCallRecorder(file);
+}
+
+SysCallRecorder::SysCallRecorder(FILE* file)
+        : mFile(file),
+          mStartTime(CameraUtils::systemTime()) {}
+
+SysCallRecorder::~SysCallRecorder() {
+    (void)fclose(mFile);
+}
+
+void SysCallRecorder::saveRecord(SysCallRecord* record, nsecs_t begin,
+                                 const std::vector<uint8_t>& payload) {
+    const nsecs_t end = CameraUtils::systemTime();
+    const int error = errno;
+
+    record->beginNs = begin - mStartTime;
+    record->endNs = end - mStartTime;
+    record->size = payload.size();
+    {
+        std::lock_guard<std::mutex> l(mLock);
+        (void)fwrite(record, sizeof(SysCallRecord), 1, mFile);
+        if (!payload.empty()) {
+            (void)fwrite(payload.data(), payload.size(), 1, mFile);
+        }
+        // Devices are closed when the camera is closed, keep the file complete then
+        if (record->type == SYSCALL_CLOSE) {
+            (void)fflush(mFile);
+        }
+    }
+
+    errno = error;
+}
+
+int SysCallRecorder::open(const char* pathname, int flags) {
+    const nsecs_t begin = CameraUtils::systemTime();
+    const int ret = SysCall::open(pathname, flags);
+
+    SysCallRecord record;
+    CLEAR(record);
+    record.type = SYSCALL_OPEN;
+    record.fd = ret;
+    record.request = flags;
+    record.ret = ret;
+    record.error = (ret < 0) ? errno : 0;
+    std::vector<uint8_t> payload;
+    appendPath(&payload, pathname);
+    saveRecord(&record, begin, payload);
+
+    return ret;
+}
+
+int SysCallRecorder::close(int fd) {
+    const nsecs_t begin = CameraUtils::systemTime();
+    const int ret = SysCall::close(fd);
+
+    SysCallRecord record;
+    CLEAR(record);
+    record.type = SYSCALL_CLOSE;
+    record.fd = fd;
+    record.ret = ret;
+    record.error = (ret < 0) ? errno : 0;
+    saveRecord(&record, begin, std::vector<uint8_t>());
+
+    return ret;
+}
+
+int SysCallRecorder::stat(const char* pathname, struct stat* statBuf) {
+    const nsecs_t begin = CameraUtils::systemTime();
+    const int ret = SysCall::stat(pathname, statBuf);
+
+    SysCallRecord record;
+    CLEAR(record);
+    record.type = SYSCALL_STAT;
+    record.fd = -1;
+    record.ret = ret;
+    record.error = (ret < 0) ? errno : 0;
+    std::vector<uint8_t> payload;
+    appendPath(&payload, pathname);
+    if (ret == 0) {
+        appendPayload(&payload, statBuf, sizeof(struct stat));
+    }
+    saveRecord(&record, begin, payload);
+
+    return ret;
+}
+
+ssize_t SysCallRecorder::readlink(const char* pathname, char* buf, size_t size) {
+    const nsecs_t begin = CameraUtils::systemTime();
+    const ssize_t ret = SysCall::readlink(pathname, buf, size);
+
+    SysCallRecord record;
+    CLEAR(record);
+    record.type = SYSCALL_READLINK;
+    record.fd = -1;
+    record.ret = ret;
+    record.error = (ret < 0) ? errno : 0;
+    std::vector<uint8_t> payload;
+    appendPath(&payload, pathname);
+    if (ret > 0) {
+        appendPayload(&payload, buf, ret);
+    }
+    saveRecord(&record, begin, payload);
+
+    return ret;
+}
+
+int SysCallRecorder::ioctl(int fd, int request, void* arg) {
+    std::vector<ArgRegion> regions;
+    getArgRegions(request, arg, &regions);
+
+    // Save the input, and leave the space for the output
+    std::vector<uint8_t> payload;
+    std::vector<size_t> outputOffsets;
+    for (const auto& region : regions) {
+        const uint32_t outputOnly = region.outputOnly ? 1U : 0U;
+        appendPayload(&payload, &region.size, sizeof(region.size));
+        appendPayload(&payload, &outputOnly, sizeof(outputOnly));
+        if (!region.outputOnly) {
+            appendPayload(&payload, region.addr, region.size);
+        }
+        outputOffsets.push_back(payload.size());
+        payload.resize(payload.size() + region.size);
+    }
+
+    const nsecs_t begin = CameraUtils::systemTime();
+    const int ret = SysCall::ioctl(fd, request, arg);
+    const int error = errno;
+
+    for (size_t i = 0U; i < regions.size(); i++) {
+        MEMCPY_S(payload.data() + outputOffsets[i], regions[i].size, regions[i].addr,
+                 regions[i].size);
+    }
+    if (ret >= 0) {
+        updateArgInfo(request, arg);
+    }
+
+    SysCallRecord record;
+    CLEAR(record);
+    record.type = SYSCALL_IOCTL;
+    record.fd = fd;
+    record.request = static_cast<uint32_t>(request);
+    record.ret = ret;
+    record.error = (ret < 0) ? error : 0;
+    saveRecord(&record, begin, payload);
+
+    return ret;
+}
+
+int SysCallRecorder::poll(struct pollfd* pfd, nfds_t nfds, int timeout) {
+    const nsecs_t begin = CameraUtils::systemTime();
+    const int ret = SysCall::poll(pfd, nfds, timeout);
+
+    SysCallRecord record;
+    CLEAR(record);
+    record.type = SYSCALL_POLL;
+    record.fd = (nfds > 0U) ? pfd[0].fd : -1;
+    record.request = nfds;
+    record.ret = ret;
+    record.error = (ret < 0) ? errno : 0;
+    std::vector<uint8_t> payload;
+    appendPayload(&payload, pfd, nfds * sizeof(struct pollfd));
+    saveRecord(&record, begin, payload);
+
+    return ret;
+}
+
+void* SysCallRecorder::mmap(void* addr, size_t len, int prot, int flag, int filedes,
+                           off_t off) {
+    const nsecs_t begin = CameraUtils::systemTime();
+    void* ret = SysCall::mmap(addr, len, prot, flag, filedes, off);
+
+    SysCallRecord record;
+    CLEAR(record);
+    record.type = SYSCALL_MMAP;
+    record.fd = filedes;
+    record.ret = (ret == MAP_FAILED) ? -1 : 0;
+    record.error = (ret == MAP_FAILED) ? errno : 0;
+    SysCallMmapArgs args = {len, static_cast<uint32_t>(prot), static_cast<uint32_t>(flag),
+                            off};
+    std::vector<uint8_t> payload;
+    appendPayload(&payload, &args, sizeof(args));
+    saveRecord(&record, begin, payload);
+
+    return ret;
+}
+
+int SysCallRecorder::munmap(void* addr, size_t len) {
+    const nsecs_t begin = CameraUtils::systemTime();
+    const int ret = SysCall::munmap(addr, len);
+
+    SysCallRecord record;
+    CLEAR(record);
+    record.type = SYSCALL_MUNMAP;
+    record.fd = -1;
+    record.ret = ret;
+    record.error = (ret < 0) ? errno : 0;
+    SysCallMmapArgs args;
+    CLEAR(args);
+    args.length = len;
+    std::vector<uint8_t> payload;
+    appendPayload(&payload, &args, sizeof(args));
+    saveRecord(&record, begin, payload);
+
+    return ret;
+}
+
+SysCall* SysCallReplayer::create(const char* fileName, const char* fast) {
+    FILE* file = fopen(fileName, "rb");
+    CheckAndLogError(file == nullptr, nullptr, "Failed to open %s, %s", fileName,
+                     strerror(errno));
+
+    const int nullFd = ::open("/dev/null", O_RDWR | O_CLOEXEC);
+    if (nullFd < 0) {
+        LOGE("Failed to open /dev/null, %s", strerror(errno));
+        (void)fclose(file);
+        return nullptr;
+    }
+
+    SysCallReplayer* replayer =
+        new SysCallReplayer(nullFd, (fast != nullptr) && (atoi(fast) != 0));
+    const int ret = replayer->load(file);
+    (void)fclose(file);
+    if (ret != OK) {
+        delete replayer;
+        return nullptr;
+    }
+
+    LOGI("Replay the system calls from %s%s", fileName,
+         replayer->mFast ? " as fast as possible" : "");
+    return replayer;
+}
+
+SysCallReplayer::SysCallReplayer(int nullFd, bool fast)
+        : mNullFd(nullFd),
+          mFast(fast),
+          mStartTime(CameraUtils::systemTime()) {}
+
+SysCallReplayer::~SysCallReplayer() {
+    (void)::close(mNullFd);
+}
+
+int SysCallReplayer::load(FILE* file) {
+    SysCallTraceHeader header;
+    CheckAndLogError(fread(&header, sizeof(header), 1, file) != 1U, BAD_VALUE,
+                     "Failed to read the trace header");
+    CheckAndLogError((memcmp(header.magic, SYSCALL_TRACE_MAGIC, sizeof(header.magic)) != 0) ||
+                         (header.version != SYSCALL_TRACE_VERSION) ||
+                         (header.recordSize != sizeof(SysCallRecord)),
+                     BAD_VALUE, "Not a system call trace, or the version isn't supported");
+
+    // The fds are reused after close, so the calls are grouped by the opened instances
+    std::map<int, std::shared_ptr<FdInstance>> recordedFds;
+    int count = 0;
+    while (true) {
+        std::shared_ptr<Response> response = std::make_shared<Response>();
+        if (fread(&response->record, sizeof(SysCallRecord), 1, file) != 1U) {
+            break;
+        }
+        const SysCallRecord& record = response->record;
+        response->payload.resize(record.size);
+        if ((record.size > 0U) &&
+            (fread(response->payload.data(), record.size, 1, file) != 1U)) {
+            LOGW("The trace is truncated after %d calls", count);
+            break;
+        }
+        count++;
+
+        // The path is at the beginning of the payload
+        const char* payload = reinterpret_cast<const char*>(response->payload.data());
+        const bool hasPath =
+            (record.size > 0U) && (memchr(payload, '\0', record.size) != nullptr);
+        const std::string path = hasPath ? std::string(payload) : std::string();
+        switch (record.type) {
+            case SYSCALL_OPEN: {
+                std::shared_ptr<FdInstance> instance = std::make_shared<FdInstance>();
+                instance->open = response;
+                mOpenInstances[path].push_back(instance);
+                if (record.ret >= 0) {
+                    recordedFds[record.ret] = instance;
+                }
+                break;
+            }
+            case SYSCALL_CLOSE:
+                recordedFds.erase(record.fd);
+                break;
+            case SYSCALL_STAT:
+            case SYSCALL_READLINK:
+                mPathResponses[record.type][path].push_back(response);
+                break;
+            case SYSCALL_IOCTL:
+            case SYSCALL_POLL: {
+                auto it = recordedFds.find(record.fd);
+                if (it == recordedFds.end()) {
+                    LOG2("%s: fd %d of the call %d isn't opened", __func__, record.fd, count);
+                } else if (record.type == SYSCALL_IOCTL) {
+                    it->second->ioctls[record.request].push_back(response);
+                } else {
+                    it->second->polls.push_back(response);
+                }
+                break;
+            }
+            case SYSCALL_MMAP:
+            case SYSCALL_MUNMAP:
+                // Only for the analysis, the memory is mapped really in the replay
+                break;
+            default:
+                LOGW("Unknown call type %u", record.type);
+                break;
+        }
+    }
+
+    LOG1("%s: %d calls are loaded", __func__, count);
+    return OK;
+}
+
+int SysCallReplayer::createFd() {
+    return fcntl(mNullFd, F_DUPFD_CLOEXEC, 0);
+}
+
+std::shared_ptr<SysCallReplayer::Response> SysCallReplayer::popPathResponse(
+    SysCallType type, const char* pathname) {
+    std::lock_guard<std::mutex> l(mLock);
+    auto it = mPathResponses[type].find(pathname);
+    if ((it == mPathResponses[type].end()) || it->second.empty()) {
+        return nullptr;
+    }
+
+    std::shared_ptr<Response> response = it->second.front();
+    it->second.pop_front();
+    return response;
+}
+
+std::shared_ptr<SysCallReplayer::FdInstance> SysCallReplayer::getInstance(int fd) {
+    std::lock_guard<std::mutex> l(mLock);
+    auto it = mFds.find(fd);
+    return (it != mFds.end()) ? it->second : nullptr;
+}
+
+void SysCallReplayer::waitResponse(const Response& response) {
+    if (mFast) {
+        return;
+    }
+
+    const nsecs_t due = mStartTime + static_cast<nsecs_t>(response.record.endNs);
+    const nsecs_t now = CameraUtils::systemTime();
+    if (due > now) {
+        usleep((due - now) / 1000);
+    }
+}
+
+int SysCallReplayer::returnResponse(const Response& response) {
+    if (response.record.ret < 0) {
+        errno = response.record.error;
+    }
+    return response.record.ret;
+}
+
+int SysCallReplayer::open(const char* pathname, int flags) {
+    std::shared_ptr<FdInstance> instance;
+    {
+        std::lock_guard<std::mutex> l(mLock);
+        auto it = mOpenInstances.find(pathname);
+        if ((it != mOpenInstances.end()) && !it->second.empty()) {
+            instance = it->second.front();
+            it->second.pop_front();
+        }
+    }
+    if (instance == nullptr) {
+        LOGW("%s: %s isn't recorded", __func__, pathname);
+        errno = ENOENT;
+        return -1;
+    }
+
+    waitResponse(*instance->open);
+    if (instance->open->record.ret < 0) {
+        return returnResponse(*instance->open);
+    }
+
+    const int fd = createFd();
+    CheckAndLogError(fd < 0, -1, "Failed to create fd for %s, %s", pathname, strerror(errno));
+
+    std::lock_guard<std::mutex> l(mLock);
+    mFds[fd] = instance;
+    return fd;
+}
+
+int SysCallReplayer::close(int fd) {
+    {
+        std::lock_guard<std::mutex> l(mLock);
+        mFds.erase(fd);
+    }
+    return ::close(fd);
+}
+
+int SysCallReplayer::stat(const char* pathname, struct stat* statBuf) {
+    std::shared_ptr<Response> response = popPathResponse(SYSCALL_STAT, pathname);
+    if (response == nullptr) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    waitResponse(*response);
+    const size_t pathSize = strlen(pathname) + 1U;
+    if ((response->record.ret == 0) &&
+        (response->payload.size() >= pathSize + sizeof(struct stat))) {
+        MEMCPY_S(statBuf, sizeof(struct stat), response->payload.data() + pathSize,
+                 sizeof(struct stat));
+    }
+    return returnResponse(*response);
+}
+
+ssize_t SysCallReplayer::readlink(const char* pathname, char* buf, size_t size) {
+    std::shared_ptr<Response> response = popPathResponse(SYSCALL_READLINK, pathname);
+    if (response == nullptr) {
+        errno = ENOENT;
+        return -1;
+    }
+
+    waitResponse(*response);
+    const size_t pathSize = strlen(pathname) + 1U;
+    if (response->record.ret <= 0) {
+        return returnResponse(*response);
+    }
+
+    const size_t length = std::min(size, response->payload.size() - pathSize);
+    MEMCPY_S(buf, size, response->payload.data() + pathSize, length);
+    return length;
+}
+
+/**
+ * Save the buffer address of QBUF, the address of the DQBUF response is the one
+ * in the recording process, which is replaced by the saved one.
+ */
+void SysCallReplayer::saveQueuedBuffer(FdInstance* instance, const v4l2_buffer* buffer) {
+    std::vector<uint64_t> m;
+    uint64_t value = 0U;
+    MEMCPY_S(&value, sizeof(value), &buffer->m, sizeof(buffer->m));
+    m.push_back(value);
+    if (V4L2_TYPE_IS_MULTIPLANAR(buffer->type) && (buffer->m.planes != nullptr)) {
+        for (uint32_t i = 0U; i < buffer->length; i++) {
+            MEMCPY_S(&value, sizeof(value), &buffer->m.planes[i].m, sizeof(buffer->m.planes[i].m));
+            m.push_back(value);
+        }
+    }
+    instance->queuedBuffers[std::make_pair(buffer->type, buffer->index)] = m;
+}
+
+void SysCallReplayer::restoreQueuedBuffer(FdInstance* instance, v4l2_buffer* buffer) {
+    auto it = instance->queuedBuffers.find(std::make_pair(buffer->type, buffer->index));
+    if (it == instance->queuedBuffers.end()) {
+        return;
+    }
+
+    const std::vector<uint64_t>& m = it->second;
+    if (V4L2_TYPE_IS_MULTIPLANAR(buffer->type)) {
+        if (buffer->m.planes == nullptr) {
+            return;
+        }
+        for (uint32_t i = 0U; (i < buffer->length) && (i + 1U < m.size()); i++) {
+            MEMCPY_S(&buffer->m.planes[i].m, sizeof(buffer->m.planes[i].m), &m[i + 1U],
+                     sizeof(m[i + 1U]));
+        }
+    } else {
+        MEMCPY_S(&buffer->m, sizeof(buffer->m), &m[0], sizeof(m[0]));
+    }
+}
+
+/**
+ * Only the bytes changed by the kernel in the recording are written to the argument,
+ * so the pointers and the input of the caller are kept.
+ */
+void SysCallReplayer::applyIoctlResponse(int request, void* arg, const Response& response) {
+    std::vector<ArgRegion> regions;
+    getArgRegions(request, arg, &regions);
+
+    const uint8_t* data = response.payload.data();
+    const size_t dataSize = response.payload.size();
+    size_t offset = 0U;
+    for (size_t i = 0U; (i < regions.size()) && (offset + 2U * sizeof(uint32_t) <= dataSize);
+         i++) {
+        uint32_t size = 0U;
+        uint32_t outputOnly = 0U;
+        MEMCPY_S(&size, sizeof(size), data + offset, sizeof(size));
+        offset += sizeof(size);
+        MEMCPY_S(&outputOnly, sizeof(outputOnly), data + offset, sizeof(outputOnly));
+        offset += sizeof(outputOnly);
+
+        const uint8_t* input = data + offset;
+        if (outputOnly == 0U) {
+            offset += size;
+        }
+        const uint8_t* output = data + offset;
+        offset += size;
+        if (offset > dataSize) {
+            LOGW("%s: invalid payload of ioctl 0x%x", __func__, request);
+            break;
+        }
+
+        uint8_t* dst = static_cast<uint8_t*>(regions[i].addr);
+        const uint32_t length = std::min(size, regions[i].size);
+        if (outputOnly != 0U) {
+            MEMCPY_S(dst, regions[i].size, output, length);
+        } else {
+            for (uint32_t j = 0U; j < length; j++) {
+                if (input[j] != output[j]) {
+                    dst[j] = output[j];
+                }
+            }
+        }
+    }
+
+    // The returned fds are created in this process
+    const uint32_t cmd = static_cast<uint32_t>(request);
+    if (cmd == VIDIOC_EXPBUF) {
+        static_cast<v4l2_exportbuffer*>(arg)->fd = createFd();
+    } else if (cmd == static_cast<uint32_t>(IPU_IOC_GETBUF)) {
+        ipu_psys_buffer* buffer = static_cast<ipu_psys_buffer*>(arg);
+        if ((buffer->flags & IPU_BUFFER_FLAG_DMA_HANDLE) != 0U) {
+            buffer->base.fd = createFd();
+        }
+    }
+}
+
+int SysCallReplayer::ioctl(int fd, int request, void* arg) {
+    std::shared_ptr<FdInstance> instance = getInstance(fd);
+    if (instance == nullptr) {
+        return SysCall::ioctl(fd, request, arg);
+    }
+
+    const uint32_t cmd = static_cast<uint32_t>(request);
+    std::shared_ptr<Response> response;
+    {
+        std::lock_guard<std::mutex> l(mLock);
+        if ((cmd == VIDIOC_QBUF) && (arg != nullptr)) {
+            saveQueuedBuffer(instance.get(), static_cast<v4l2_buffer*>(arg));
+        }
+
+        ResponseQueue& queue = instance->ioctls[cmd];
+        if (!queue.empty()) {
+            response = queue.front();
+            queue.pop_front();
+        } else if (mMissingWarned.insert(std::make_pair(fd, cmd)).second) {
+            LOGW("%s: no more recorded ioctl 0x%x for fd %d", __func__, cmd, fd);
+        }
+    }
+    if (response == nullptr) {
+        errno = ENOTTY;
+        return -1;
+    }
+
+    waitResponse(*response);
+    if (response->record.ret >= 0) {
+        applyIoctlResponse(request, arg, *response);
+        if ((cmd == VIDIOC_DQBUF) && (arg != nullptr)) {
+            std::lock_guard<std::mutex> l(mLock);
+            restoreQueuedBuffer(instance.get(), static_cast<v4l2_buffer*>(arg));
+        }
+        updateArgInfo(request, arg);
+    }
+    return returnResponse(*response);
+}
+
+int SysCallReplayer::poll(struct pollfd* pfd, nfds_t nfds, int timeout) {
+    std::shared_ptr<FdInstance> instance = (nfds > 0U) ? getInstance(pfd[0].fd) : nullptr;
+    if (instance == nullptr) {
+        return SysCall::poll(pfd, nfds, timeout);
+    }
+
+    std::shared_ptr<Response> response;
+    // The fds which aren't replayed are polled really, e.g. the event fd to wake up the poll
+    std::vector<struct pollfd> realFds;
+    std::vector<nfds_t> realIndexes;
+    {
+        std::lock_guard<std::mutex> l(mLock);
+        if (!instance->polls.empty()) {
+            response = instance->polls.front();
+            instance->polls.pop_front();
+        }
+        for (nfds_t i = 0U; i < nfds; i++) {
+            pfd[i].revents = 0;
+            if (mFds.find(pfd[i].fd) == mFds.end()) {
+                realFds.push_back(pfd[i]);
+                realIndexes.push_back(i);
+            }
+        }
+    }
+
+    // Wait for the recorded return time, or the timeout if no more response
+    int waitMs = timeout;
+    if (response != nullptr) {
+        const nsecs_t due = mStartTime + static_cast<nsecs_t>(response->record.endNs);
+        const nsecs_t now = CameraUtils::systemTime();
+        waitMs = (mFast || (due <= now)) ? 0 : static_cast<int>((due - now + 999999) / 1000000);
+    } else if (waitMs < 0) {
+        // Nothing can wake up the poll
+        waitMs = realFds.empty() ? 0 : waitMs;
+    }
+
+    if (realFds.empty()) {
+        if (waitMs > 0) {
+            usleep(waitMs * 1000);
+        }
+    } else {
+        const int ret = SysCall::poll(realFds.data(), realFds.size(), waitMs);
+        if (ret != 0) {
+            for (size_t i = 0U; i < realFds.size(); i++) {
+                pfd[realIndexes[i]].revents = realFds[i].revents;
+            }
+            return ret;
+        }
+    }
+
+    if (response == nullptr) {
+        return 0;
+    }
+    if (response->record.ret < 0) {
+        return returnResponse(*response);
+    }
+
+    const struct pollfd* recorded =
+        reinterpret_cast<const struct pollfd*>(response->payload.data());
+    const nfds_t recordedNum = response->payload.size() / sizeof(struct pollfd);
+    int ready = 0;
+    std::lock_guard<std::mutex> l(mLock);
+    for (nfds_t i = 0U; (i < nfds) && (i < recordedNum); i++) {
+        if (mFds.find(pfd[i].fd) != mFds.end()) {
+            pfd[i].revents = recorded[i].revents;
+            ready += (pfd[i].revents != 0) ? 1 : 0;
+        }
+    }
+    return ready;
+}
+
+void* SysCallReplayer::mmap(void* addr, size_t len, int prot, int flag, int filedes, off_t off) {
+    void* ret = SysCall::mmap(addr, len, prot, flag, filedes, off);
+    // The replayed fds can't be mapped, the memory is allocated instead
+    if ((ret == MAP_FAILED) && (errno == ENODEV)) {
+        ret = SysCall::mmap(addr, len, prot, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    return ret;
+}
+
+}  // namespace icamera
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2025 Intel Corporation.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "SysCall.h"
+#include "iutils/Utils.h"
+
+namespace icamera {
+
+/**
+ * The trace file of the system calls, which are saved in the calling order:
+ *   SysCallTraceHeader
+ *   SysCallRecord + payload, ...
+ *
+ * The payload of each type:
+ *   SYSCALL_OPEN:     path with '\0'
+ *   SYSCALL_STAT:     path with '\0', struct stat
+ *   SYSCALL_READLINK: path with '\0', link target (ret bytes)
+ *   SYSCALL_IOCTL:    regions: {uint32_t size, uint32_t outputOnly, input[size], output[size]}
+ *                     the argument itself is the first region, the arrays it points to follow,
+ *                     input is absent in the output only regions
+ *   SYSCALL_POLL:     struct pollfd[nfds] after the call
+ *   SYSCALL_CLOSE:    none
+ *   SYSCALL_MMAP:     SysCallMmapArgs, ret is 0 or -1, the address isn't saved
+ *   SYSCALL_MUNMAP:   SysCallMmapArgs with the length only
+ */
+#define SYSCALL_TRACE_MAGIC "CAMSYSCL"
+#define SYSCALL_TRACE_VERSION 1
+
+struct SysCallTraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+};
+
+enum SysCallType {
+    SYSCALL_OPEN = 0,
+    SYSCALL_CLOSE,
+    SYSCALL_STAT,
+    SYSCALL_READLINK,
+    SYSCALL_IOCTL,
+    SYSCALL_POLL,
+    SYSCALL_MMAP,
+    SYSCALL_MUNMAP,
+    SYSCALL_MAX,
+};
+
+struct SysCallRecord {
+    uint32_t type;
+    int32_t fd;        // fd of the recording process, the first fd for poll
+    uint32_t request;  // ioctl request, open flags or poll nfds
+    int32_t ret;
+    int32_t error;     // errno when the call fails
+    uint32_t size;     // payload size
+    uint64_t beginNs;  // since the trace start
+    uint64_t endNs;
+};
+
+struct SysCallMmapArgs {
+    uint64_t length;
+    uint32_t prot;
+    uint32_t flags;
+    int64_t offset;
+};
+
+/**
+ * SysCallTrace has the knowledge of the ioctl arguments shared by the recorder and
+ * the replayer: which memory regions are read or written by the kernel.
+ */
+class SysCallTrace : public SysCall {
+ protected:
+    struct ArgRegion {
+        void* addr;
+        uint32_t size;
+        bool outputOnly;  // Filled by the kernel entirely, the input is meaningless
+    };
+
+    SysCallTrace() {}
+    virtual ~SysCallTrace() {}
+
+    static bool isArgByValue(int request);
+    // Called with the input of the argument
+    void getArgRegions(int request, void* arg, std::vector<ArgRegion>* regions);
+    // Called with the output of the argument
+    void updateArgInfo(int request, const void* arg);
+
+ private:
+    std::mutex mEntityLock;
+    // Entity id -> {pads, links}, which are the array sizes of MEDIA_IOC_ENUM_LINKS
+    std::map<uint32_t, std::pair<uint32_t, uint32_t>> mEntityLinks;
+};
+
+class SysCallRecorder : public SysCallTrace {
+ public:
+    static SysCall* create(const char* fileName);
+    virtual ~SysCallRecorder();
+
+    virtual int open(const char* pathname, int flags);
+    virtual int close(int fd);
+    virtual int stat(const char* pathname, struct stat* statBuf);
+    virtual ssize_t readlink(const char* pathname, char* buf, size_t size);
+    virtual int poll(struct pollfd* pfd, nfds_t nfds, int timeout);
+    virtual void* mmap(void* addr, size_t len, int prot, int flag, int filedes, off_t off);
+    virtual int munmap(void* addr, size_t len);
+
+    using SysCall::ioctl;
+    virtual int ioctl(int fd, int request, void* arg);
+
+ private:
+    explicit SysCallRecorder(FILE* file);
+
+    void saveRecord(SysCallRecord* record, nsecs_t begin, const std::vector<uint8_t>& payload);
+
+ private:
+    std::mutex mLock;
+    FILE* mFile;
+    nsecs_t mStartTime;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(SysCallRecorder);
+};
+
+class SysCallReplayer : public SysCallTrace {
+ public:
+    static SysCall* create(const char* fileName, const char* fast);
+    virtual ~SysCallReplayer();
+
+    virtual int open(const char* pathname, int flags);
+    virtual int close(int fd);
+    virtual int stat(const char* pathname, struct stat* statBuf);
+    virtual ssize_t readlink(const char* pathname, char* buf, size_t size);
+    virtual int poll(struct pollfd* pfd, nfds_t nfds, int timeout);
+    virtual void* mmap(void* addr, size_t len, int prot, int flag, int filedes, off_t off);
+
+    using SysCall::ioctl;
+    virtual int ioctl(int fd, int request, void* arg);
+
+ private:
+    struct Response {
+        SysCallRecord record;
+        std::vector<uint8_t> payload;
+    };
+    typedef std::deque<std::shared_ptr<Response>> ResponseQueue;
+
+    // The calls of one opened fd of the recording process
+    struct FdInstance {
+        std::shared_ptr<Response> open;
+        std::map<uint32_t, ResponseQueue> ioctls;  // request -> calls
+        ResponseQueue polls;
+        // {buffer type, index} -> m union of the v4l2_buffer and its planes of QBUF
+        std::map<std::pair<uint32_t, uint32_t>, std::vector<uint64_t>> queuedBuffers;
+    };
+
+    SysCallReplayer(int nullFd, bool fast);
+
+    int load(FILE* file);
+    std::shared_ptr<Response> popPathResponse(SysCallType type, const char* pathname);
+    std::shared_ptr<FdInstance> getInstance(int fd);
+    // Sleep until the recorded return time of the call
+    void waitResponse(const Response& response);
+    int returnResponse(const Response& response);
+    void applyIoctlResponse(int request, void* arg, const Response& response);
+    void saveQueuedBuffer(FdInstance* instance, const v4l2_buffer* buffer);
+    void restoreQueuedBuffer(FdInstance* instance, v4l2_buffer* buffer);
+    int createFd();
+
+ private:
+    int mNullFd;  // Replayed fds are duplicated from it, so they can be polled and closed
+    bool mFast;
+    nsecs_t mStartTime;
+
+    std::mutex mLock;
+    std::map<std::string, ResponseQueue> mPathResponses[SYSCALL_MAX];
+    std::map<std::string, std::deque<std::shared_ptr<FdInstance>>> mOpenInstances;
+    std::map<int, std::shared_ptr<FdInstance>> mFds;  // Replayed fd -> instance
+    std::set<std::pair<int, uint32_t>> mMissingWarned;
+
+ private:
+    DISALLOW_COPY_AND_ASSIGN(SysCallReplayer);
+};
+
+}  // namespace icamera